@@ -24,7 +24,7 @@ bool read_vox(const std::string& file_name, volume& V, volume_info* info_ptr = 0
 bool read_qim_header(const std::string& file_name, volume_info& info);
 bool read_qim(const std::string& file_name, volume& V, volume_info* info_ptr = 0);
 
-bool read_tiff(const std::string& file_name, volume& V, volume_info* info_ptr = 0);
+bool read_tiff(const std::string& file_name, volume& V, volume_info* info_ptr = 0, cgv::media::volume::slice_stack_statistics* statistics_ptr = 0);
 
 bool read_avi(const std::string& file_name, volume& V, volume_info* info_ptr = 0);
 
@@ -47,7 +47,7 @@ bool read_header(const std::string& file_name, volume_info& info, bool(*unknown_
 	return false;
 }
 
-bool read_volume(const std::string& file_name, volume& V, volume_info* info_ptr)
+bool read_volume(const std::string& file_name, volume& V, volume_info* info_ptr, cgv::media::volume::slice_stack_statistics* statistics_ptr)
 {
 	std::string ext = cgv::utils::to_upper(cgv::utils::file::get_extension(file_name));
 	if (ext == "VOX" || ext == "HD")
@@ -55,7 +55,7 @@ bool read_volume(const std::string& file_name, volume& V, volume_info* info_ptr)
 	if (ext == "QIM" || ext == "QHA")
 		return read_qim(file_name, V, info_ptr);
 	if (ext == "TIF" || ext == "TIFF")
-		return read_tiff(file_name, V, info_ptr);
+		return read_tiff(file_name, V, info_ptr, statistics_ptr);
 	if (ext == "AVI")
 		return read_avi(file_name, V, info_ptr);
 
@@ -363,15 +363,15 @@ bool read_qim(const std::string& file_name, volume& V, volume_info* info_ptr)
 	return read_volume_binary(cgv::utils::file::drop_extension(file_name) + ".qim", info, V);
 }
 
-bool read_tiff(const std::string& file_name, volume& V, volume_info* info_ptr)
+bool read_tiff(const std::string& file_name, volume& V, volume_info* info_ptr, cgv::media::volume::slice_stack_statistics* statistics_ptr)
 {
-	cgv::data::data_format df;
-	cgv::media::image::image_reader ir(df);
-	if (!ir.open(file_name)) {
+	cgv::media::volume::slice_stack_reader ssr;
+	if (!ssr.add_multi_image_file(file_name)) {
 		std::cerr << "could not open tiff file " << file_name << std::endl;
 		return false;
 	}
-	int n = ir.get_nr_images();
+	const cgv::data::data_format& df = ssr.get_format();
+	int n = int(ssr.get_nr_slices());
 	V.get_format().set_component_format(df.get_component_format());
 	if (info_ptr) {
 		info_ptr->type_id = df.get_component_type();
@@ -387,14 +387,12 @@ bool read_tiff(const std::string& file_name, volume& V, volume_info* info_ptr)
 	V.ref_extent() = volume::point_type(1, 1, 1)*size / (float)cgv::math::max_value(size);
 	if (info_ptr)
 		info_ptr->extent = V.get_extent();
-	for (int i = 0; i<n; ++i) {
-		cgv::data::data_view dv(&df, V.get_slice_ptr<void>(i));
-		if (!ir.read_image(dv)) {
-			std::cerr << "could not read slice " << i << " of file " << file_name << std::endl;
-			return false;
-		}
+	if (!ssr.read(V.get_slice_ptr<void>(0))) {
+		std::cerr << ssr.get_last_error() << std::endl;
+		return false;
 	}
-	ir.close();
+	if (statistics_ptr)
+		*statistics_ptr = ssr.get_statistics();
 	return true;
 }
 
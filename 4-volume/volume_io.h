@@ -3,6 +3,7 @@
 #include <cgv/math/fmat.h>
 #include <cgv/utils/token.h>
 #include "volume.h"
+#include <cgv/media/volume/slice_stack_reader.h>
 
 #include "lib_begin.h"
 
@@ -19,7 +20,8 @@ struct CGV_API volume_info
 	volume_info();
 };
 
-extern CGV_API bool read_volume(const std::string& file_name, volume& V, volume_info* info_ptr = 0);
+/// read volume from file, where statistics_ptr receives the decoding throughput of tiff stacks and is left untouched for other formats
+extern CGV_API bool read_volume(const std::string& file_name, volume& V, volume_info* info_ptr = 0, cgv::media::volume::slice_stack_statistics* statistics_ptr = 0);
 
 extern CGV_API bool read_volume_with_header(const std::string& header_name, const std::string& file_name, volume& V, volume_info* info_ptr = 0);
 
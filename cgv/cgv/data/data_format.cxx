@@ -7,10 +7,10 @@ using namespace cgv::utils;
 
 namespace cgv {
 	namespace data {
-data_format::data_format()
+data_format::data_format() : pad_entries(false)
 {
 }
-data_format::data_format(const std::string& description)
+data_format::data_format(const std::string& description) : pad_entries(false)
 {
 	set_data_format(description);
 }
@@ -99,26 +99,26 @@ bool data_format::set_data_format(const std::string& description)
 }
 data_format::data_format(size_t _width, TypeId _ct, const std::string& _cnl, 
 		                 unsigned a, unsigned d0, unsigned d1, unsigned d2, unsigned d3) 
-	: component_format(_ct,_cnl,a,d0,d1,d2,d3)
+	: component_format(_ct,_cnl,a,d0,d1,d2,d3), pad_entries(false)
 {
 	dimensions.push_back(dimension_info(_width));
 }
 data_format::data_format(size_t _width, TypeId _ct, ComponentFormat _cf, 
 						 unsigned a, unsigned d0, unsigned d1, unsigned d2, unsigned d3) 
-	: component_format(_ct,_cf,a,d0,d1,d2,d3)
+	: component_format(_ct,_cf,a,d0,d1,d2,d3), pad_entries(false)
 {
 	dimensions.push_back(dimension_info(_width));
 }
 data_format::data_format(size_t _width, size_t _height, TypeId _ct, const std::string& _cnl, 
 	                     unsigned a, unsigned d0, unsigned d1, unsigned d2, unsigned d3) 
-	: component_format(_ct,_cnl,a,d0,d1,d2,d3)
+	: component_format(_ct,_cnl,a,d0,d1,d2,d3), pad_entries(false)
 {
 	dimensions.push_back(dimension_info(_width));
 	dimensions.push_back(dimension_info(_height,1,1));
 }
 data_format::data_format(size_t _width, size_t _height, TypeId _ct, ComponentFormat _cf, 
 	                     unsigned a, unsigned d0, unsigned d1, unsigned d2, unsigned d3) 
-	: component_format(_ct,_cf,a,d0,d1,d2,d3)
+	: component_format(_ct,_cf,a,d0,d1,d2,d3), pad_entries(false)
 {
 	dimensions.push_back(dimension_info(_width));
 	dimensions.push_back(dimension_info(_height,1,1));
@@ -126,7 +126,7 @@ data_format::data_format(size_t _width, size_t _height, TypeId _ct, ComponentFor
 
 data_format::data_format(size_t _width, size_t _height, size_t _depth, TypeId _ct, const std::string& _cnl,
 	                     unsigned a, unsigned d0, unsigned d1, unsigned d2, unsigned d3) 
-	: component_format(_ct,_cnl,a,d0,d1,d2,d3)
+	: component_format(_ct,_cnl,a,d0,d1,d2,d3), pad_entries(false)
 {
 	dimensions.push_back(dimension_info(_width));
 	dimensions.push_back(dimension_info(_height,1,1));
@@ -134,7 +134,7 @@ data_format::data_format(size_t _width, size_t _height, size_t _depth, TypeId _c
 }
 data_format::data_format(size_t _width, size_t _height, size_t _depth, TypeId _ct, ComponentFormat _cf, 
 		                 unsigned a, unsigned d0, unsigned d1, unsigned d2, unsigned d3) 
-	: component_format(_ct,_cf,a,d0,d1,d2,d3)
+	: component_format(_ct,_cf,a,d0,d1,d2,d3), pad_entries(false)
 {
 	dimensions.push_back(dimension_info(_width));
 	dimensions.push_back(dimension_info(_height,1,1));
@@ -142,7 +142,7 @@ data_format::data_format(size_t _width, size_t _height, size_t _depth, TypeId _c
 }
 data_format::data_format(size_t _width, size_t _height, size_t _depth, size_t _count, TypeId _ct, const std::string& _cnl, 
                          unsigned a, unsigned d0, unsigned d1, unsigned d2, unsigned d3)
-	: component_format(_ct, _cnl, a, d0, d1, d2, d3)
+	: component_format(_ct, _cnl, a, d0, d1, d2, d3), pad_entries(false)
 {
 	dimensions.push_back(dimension_info(_width));
 	dimensions.push_back(dimension_info(_height,1,1));
@@ -151,7 +151,7 @@ data_format::data_format(size_t _width, size_t _height, size_t _depth, size_t _c
 }
 data_format::data_format(size_t _width, size_t _height, size_t _depth, size_t _count, TypeId _ct, ComponentFormat _cf, 
 		                 unsigned a, unsigned d0, unsigned d1, unsigned d2, unsigned d3) 
-	: component_format(_ct,_cf,a,d0,d1,d2,d3)
+	: component_format(_ct,_cf,a,d0,d1,d2,d3), pad_entries(false)
 {
 	dimensions.push_back(dimension_info(_width));
 	dimensions.push_back(dimension_info(_height,1,1));
@@ -209,7 +209,13 @@ size_t data_format::get_nr_entries() const
 }
 size_t data_format::get_nr_bytes() const
 {
-	return get_nr_entries()*get_entry_size();
+	return get_nr_entries()*get_padded_entry_size();
+}
+size_t data_format::get_padded_entry_size() const
+{
+	if (!pad_entries)
+		return get_entry_size();
+	return align(get_entry_size(), get_entry_alignment());
 }
 size_t data_format::get_width() const
 {
@@ -265,6 +271,14 @@ void data_format::set_entry_alignment(unsigned _a)
 		dimensions.resize(1);
 	dimensions[0].alignment = _a;
 }
+bool data_format::get_entry_padding() const
+{
+	return pad_entries;
+}
+void data_format::set_entry_padding(bool enable)
+{
+	pad_entries = enable;
+}
 void data_format::set_alignment(unsigned i, unsigned _a)
 {
 	if (i >= get_nr_dimensions())
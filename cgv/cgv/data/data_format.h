@@ -28,6 +28,8 @@ protected:
 	};
 	/// store for each dimension resolution and alignment in a dimension_info struct
 	std::vector<dimension_info> dimensions;
+	/// whether entries are padded to the entry alignment in the memory layout
+	bool pad_entries;
 public:
 	/// construct an undefined data format
 	data_format();
@@ -116,6 +118,8 @@ Some examples of valid data format description strings:
 	size_t get_nr_entries() const;
 	/// return the total number of bytes necessary to store the data
 	size_t get_nr_bytes() const;
+	/// return the number of bytes between consecutive entries, which is the entry size rounded up to the entry alignment if entry padding is enabled
+	size_t get_padded_entry_size() const;
 	/// set the resolution in the i-th dimension, add dimensions if necessary
 	void set_resolution(unsigned i, size_t resolution);
 	/// set the resolution in the first dimension, add dimensions if necessary
@@ -134,6 +138,10 @@ Some examples of valid data format description strings:
 	unsigned get_alignment(unsigned i) const;
 	/// set the alignment of entries
 	void set_entry_alignment(unsigned _a);
+	/// return whether entries are padded to the entry alignment in the memory layout, which is disabled by default
+	bool get_entry_padding() const;
+	/// set whether entries are padded to the entry alignment, which changes get_nr_bytes() and the step sizes of data views
+	void set_entry_padding(bool enable);
 	/** set the alignment of a given dimension, add dimensions if necessary. The
 	    alignment of the last dimension is always 1 and cannot be set.*/
 	void set_alignment(unsigned i, unsigned _a);
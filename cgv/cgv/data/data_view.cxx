@@ -1,4 +1,6 @@
 #include <cgv/data/data_view.h>
+#include <cgv/data/data_view_visitor.h>
+#include <cgv/utils/tokenizer.h>
 #include <iostream> 
 #include <memory.h>
 #include <map>
@@ -26,12 +28,15 @@ bool validate_delete(const void* ptr)
 data_view_base::data_view_base(
 		const data_format* _format, 
 		unsigned _dim, 
-		const size_t* _step_sizes) : format(_format)
+		const size_t* _step_sizes,
+		const size_t* _extents) : format(_format)
 {	
 	dim = _dim;
 	owns_format = false;
 	std::fill(step_sizes+dim,step_sizes+4,0);
 	std::copy(_step_sizes, _step_sizes+dim, step_sizes);
+	std::fill(extents+dim,extents+4,0);
+	std::copy(_extents, _extents+dim, extents);
 }
 
 /** construct the base of a data view from the given format, 
@@ -41,12 +46,15 @@ data_view_base::data_view_base(const data_format* _format)
 	: format(_format)
 {
 	owns_format = false;
+	std::fill(extents,extents+4,0);
 	if (!_format)
 		return;
 	dim = _format->get_nr_dimensions();
 	std::fill(step_sizes+dim,step_sizes+4,0);
+	for (unsigned i=0; i < dim; ++i)
+		extents[dim-1-i] = _format->get_resolution(i);
 	if (dim > 0) {
-		step_sizes[dim-1] = _format->align(format->get_entry_size(), 
+		step_sizes[dim-1] = _format->align(_format->get_padded_entry_size(),
 													  _format->get_alignment(0));
 	}
 	for (unsigned i=1; i < dim; ++i)
@@ -90,10 +98,15 @@ size_t data_view_base::get_step_size(unsigned dim) const
 { 
 	return step_sizes[dim];
 }
+/// return the number of entries in the i-th dimension of the view
+size_t data_view_base::get_extent(unsigned int i) const
+{
+	return i < dim ? extents[i] : 0;
+}
 template <class D, typename P>
 data_view_impl<D,P>::data_view_impl(const data_format* _format, 
-			P _data_ptr, unsigned _dim, const size_t* _step_sizes)
-			: data_view_base(_format, _dim, _step_sizes), data_ptr(_data_ptr)
+			P _data_ptr, unsigned _dim, const size_t* _step_sizes, const size_t* _extents)
+			: data_view_base(_format, _dim, _step_sizes, _extents), data_ptr(_data_ptr)
 {
 }
 template <class D, typename P>
@@ -115,7 +128,7 @@ D data_view_impl<D,P>::operator () (size_t i) const
 		return D();
 	}
 	return D(format, data_ptr+i*step_sizes[0], 
-			   (unsigned) (dim-1), step_sizes+1);
+			   (unsigned) (dim-1), step_sizes+1, extents+1);
 }
 template <class D, typename P>
 D data_view_impl<D,P>::operator () (size_t i, size_t j) const
@@ -125,7 +138,7 @@ D data_view_impl<D,P>::operator () (size_t i, size_t j) const
 		return D();
 	}
 	return D(format, data_ptr+i*step_sizes[0]+j*step_sizes[1],
-			   (unsigned) (dim-2),step_sizes+2);
+			   (unsigned) (dim-2),step_sizes+2,extents+2);
 }
 template <class D, typename P>
 D data_view_impl<D,P>::operator () (size_t i, size_t j, size_t k) const
@@ -135,7 +148,7 @@ D data_view_impl<D,P>::operator () (size_t i, size_t j, size_t k) const
 		return D();
 	}
 	return D(format, data_ptr+i*step_sizes[0]+j*step_sizes[1]+k*step_sizes[2],
-			   (unsigned) (dim-3),step_sizes+3);
+			   (unsigned) (dim-3),step_sizes+3,extents+3);
 }
 template <class D, typename P>
 D data_view_impl<D,P>::operator () (size_t i, size_t j, size_t k, size_t l) const
@@ -145,7 +158,7 @@ D data_view_impl<D,P>::operator () (size_t i, size_t j, size_t k, size_t l) cons
 		return D();
 	}
 	return D(format, data_ptr+i*step_sizes[0]+j*step_sizes[1]+k*step_sizes[2]+l*step_sizes[3],
-				(unsigned int) (dim-4),step_sizes+4);
+				(unsigned int) (dim-4),step_sizes+4,extents+4);
 }
 template <class D, typename P>
 D data_view_impl<D,P>::permute(const std::string& permutation) const
@@ -155,11 +168,13 @@ D data_view_impl<D,P>::permute(const std::string& permutation) const
 		std::cerr << "permutation '" << permutation.c_str() << "' has invalid length " << n << std::endl;
 		return D();
 	}
-	size_t new_step_sizes[4];
+	size_t new_step_sizes[4], new_extents[4];
 	unsigned i;
 	bool used[4] = { false, false, false, false };
-	for (i=0; i<4; ++i)
+	for (i=0; i<4; ++i) {
 		new_step_sizes[i] = step_sizes[i];
+		new_extents[i] = extents[i];
+	}
 	for (i=0; i<n; ++i) {
 		int idx = permutation[i]-'i';
 		if (idx < 0 || idx > 3) {
@@ -168,16 +183,17 @@ D data_view_impl<D,P>::permute(const std::string& permutation) const
 		}
 		used[idx] = true;
 		new_step_sizes[i] = step_sizes[idx];
+		new_extents[i] = extents[idx];
 	}
 	for (i=0; i<get_dim(); ++i)
 		if (!used[i]) {
 			std::cerr << "invalid permutation of length " << n << " without reference to '" << ('i'+i) << "'" << std::endl;
 			return D();
 		}
-	return D(get_format(), get_ptr<unsigned char>(), get_dim(), new_step_sizes);
+	return D(get_format(), get_ptr<unsigned char>(), get_dim(), new_step_sizes, new_extents);
 }
-data_view::data_view(const data_format* _format, unsigned char* _data_ptr, unsigned _dim, const size_t* _step_sizes) 
-	: data_view_impl<data_view, unsigned char*>(_format, _data_ptr, _dim, _step_sizes),
+data_view::data_view(const data_format* _format, unsigned char* _data_ptr, unsigned _dim, const size_t* _step_sizes, const size_t* _extents) 
+	: data_view_impl<data_view, unsigned char*>(_format, _data_ptr, _dim, _step_sizes, _extents),
 	  owns_ptr(false)
 {
 }
@@ -218,8 +234,10 @@ data_view& data_view::operator = (const data_view& dv)
 	const_cast<data_view&>(dv).owns_format = false;
 
 	dim = dv.dim;
-	for (int i=0; i<4; ++i)
+	for (int i=0; i<4; ++i) {
 		step_sizes[i] = dv.step_sizes[i];
+		extents[i] = dv.extents[i];
+	}
 
 	if (owns_ptr && data_ptr && data_ptr != dv.data_ptr)
 		delete [] data_ptr; 
@@ -234,8 +252,10 @@ const_data_view& const_data_view::operator = (const const_data_view& dv)
 	format = dv.format;
 	owns_format = false;
 	dim = dv.dim;
-	for (int i=0; i<4; ++i)
+	for (int i=0; i<4; ++i) {
 		step_sizes[i] = dv.step_sizes[i];
+		extents[i] = dv.extents[i];
+	}
 	data_ptr = dv.data_ptr;
 	return *this;
 }
@@ -254,8 +274,8 @@ void data_view::set_ptr(void* ptr)
 	owns_ptr = false;
 }
 const_data_view::const_data_view(const data_format* _format, const unsigned char* _data_ptr, 
-					 unsigned _dim, const size_t* _step_sizes)
-	: data_view_impl<const_data_view, const unsigned char*>(_format, _data_ptr, _dim, _step_sizes)
+					 unsigned _dim, const size_t* _step_sizes, const size_t* _extents)
+	: data_view_impl<const_data_view, const unsigned char*>(_format, _data_ptr, _dim, _step_sizes, _extents)
 {
 }
 const_data_view::const_data_view()
@@ -267,7 +287,7 @@ const_data_view::const_data_view(const data_format* _format, const void* _data_p
 }
 const_data_view::const_data_view(const data_view& dv) 
 	: data_view_impl<const_data_view, const unsigned char*>(
-		dv.get_format(), dv.get_ptr<const unsigned char>(), dv.get_dim(), dv.step_sizes)
+		dv.get_format(), dv.get_ptr<const unsigned char>(), dv.get_dim(), dv.step_sizes, dv.extents)
 {
 }
 void const_data_view::set_ptr(const void* ptr)
@@ -441,6 +461,135 @@ bool data_view::combine_components(data_view& dv, const std::vector<data_view>::
 	return true;
 }
 
+namespace {
+	/// number of entries per side of the square tiles used for copying with transposition
+	const size_t tile_size = 32;
+
+	/** copy entries of a 4d index space with given extents and byte step sizes from source to destination, where
+		destination entries are stored densely along the last index. Components are gathered through component_map. 
+		If single is true, entries consist of one component that is not remapped. */
+	template <typename T, bool single>
+	void copy_entries(const unsigned char* src, unsigned char* dst, const size_t* extents, const size_t* src_steps, const size_t* dst_steps,
+		unsigned nr_components, const unsigned* component_map, size_t src_comp_step)
+	{
+		auto copy_entry = [&](const unsigned char* s, unsigned char* d) {
+			if (single)
+				*reinterpret_cast<T*>(d) = *reinterpret_cast<const T*>(s);
+			else
+				for (unsigned c = 0; c < nr_components; ++c)
+					reinterpret_cast<T*>(d)[c] = *reinterpret_cast<const T*>(s + component_map[c] * src_comp_step);
+		};
+		// find the index along which the source steps fastest
+		unsigned a = 3;
+		for (unsigned i = 0; i < 3; ++i)
+			if (extents[i] > 1 && src_steps[i] < src_steps[a])
+				a = i;
+		if (a == 3 || extents[3] == 1) {
+			// source and destination step fastest along the same index, so copy row by row
+			int n = int(extents[0] * extents[1] * extents[2]);
+#pragma omp parallel for schedule(dynamic, 16)
+			for (int r = 0; r < n; ++r) {
+				size_t i = r / (extents[1] * extents[2]), j = (r / extents[2]) % extents[1], k = r % extents[2];
+				const unsigned char* s = src + i * src_steps[0] + j * src_steps[1] + k * src_steps[2];
+				unsigned char* d = dst + i * dst_steps[0] + j * dst_steps[1] + k * dst_steps[2];
+				for (size_t l = 0; l < extents[3]; ++l, s += src_steps[3], d += dst_steps[3])
+					copy_entry(s, d);
+			}
+			return;
+		}
+		// copy tiles spanned by index a and the last index, such that the source rows of a tile stay in cache
+		unsigned o0 = a == 0 ? 1 : 0, o1 = a == 2 ? 1 : 2;
+		size_t nr_tiles_a = (extents[a] + tile_size - 1) / tile_size;
+		size_t nr_tiles_l = (extents[3] + tile_size - 1) / tile_size;
+		int n = int(extents[o0] * extents[o1] * nr_tiles_a * nr_tiles_l);
+#pragma omp parallel for schedule(dynamic, 4)
+		for (int t = 0; t < n; ++t) {
+			size_t tl = t % nr_tiles_l, ta = (t / nr_tiles_l) % nr_tiles_a;
+			size_t r = t / (nr_tiles_l * nr_tiles_a);
+			size_t i0 = r / extents[o1], i1 = r % extents[o1];
+			const unsigned char* s = src + i0 * src_steps[o0] + i1 * src_steps[o1];
+			unsigned char* d = dst + i0 * dst_steps[o0] + i1 * dst_steps[o1];
+			size_t a_end = std::min(extents[a], (ta + 1) * tile_size), l_end = std::min(extents[3], (tl + 1) * tile_size);
+			for (size_t ia = ta * tile_size; ia < a_end; ++ia)
+				for (size_t l = tl * tile_size; l < l_end; ++l)
+					copy_entry(s + ia * src_steps[a] + l * src_steps[3], d + ia * dst_steps[a] + l * dst_steps[3]);
+		}
+	}
+}
+
+bool data_view::reformat(data_view& dst, const const_data_view& src, const std::string& component_order, unsigned entry_alignment)
+{
+	if (src.empty() || src.get_format()->is_packing())
+		return false;
+	const data_format& sf = *src.get_format();
+	// determine components of destination
+	std::vector<unsigned> component_map;
+	std::string component_names;
+	if (component_order.empty()) {
+		for (unsigned c = 0; c < sf.get_nr_components(); ++c)
+			component_map.push_back(c);
+	}
+	else {
+		std::vector<cgv::utils::token> toks;
+		cgv::utils::tokenizer(component_order).set_ws(",").bite_all(toks);
+		for (const auto& tok : toks) {
+			unsigned c = sf.get_component_index(cgv::utils::to_string(tok));
+			if (c == unsigned(-1)) {
+				std::cerr << "data_view::reformat: unknown component " << cgv::utils::to_string(tok) << std::endl;
+				return false;
+			}
+			component_map.push_back(c);
+		}
+	}
+	if (component_map.empty())
+		return false;
+	for (unsigned c : component_map) {
+		if (!component_names.empty())
+			component_names += ",";
+		component_names += sf.get_component_name(c);
+	}
+	// construct destination format, whose first dimension corresponds to the last view index
+	unsigned n = src.get_dim();
+	data_format* df = new data_format();
+	df->set_component_format(component_format(sf.get_component_type(), component_names));
+	df->set_nr_dimensions(n);
+	for (unsigned i = 0; i < n; ++i)
+		df->set_resolution(n - 1 - i, src.get_extent(i));
+	if (n > 0) {
+		df->set_entry_alignment(entry_alignment);
+		df->set_entry_padding(true);
+	}
+	dst = data_view(df);
+	dst.manage_format();
+
+	// pad the index space to four dimensions in front
+	size_t extents[4] = { 1, 1, 1, 1 }, src_steps[4] = { 0, 0, 0, 0 }, dst_steps[4] = { 0, 0, 0, 0 };
+	for (unsigned i = 0; i < n; ++i) {
+		extents[4 - n + i] = src.get_extent(i);
+		src_steps[4 - n + i] = src.get_step_size(i);
+		dst_steps[4 - n + i] = dst.get_step_size(i);
+	}
+	const unsigned char* sp = src.get_ptr<unsigned char>();
+	unsigned char* dp = dst.get_ptr<unsigned char>();
+	unsigned nc = unsigned(component_map.size());
+	size_t src_comp_step = sf.align(cgv::type::info::get_type_size(sf.get_component_type()), sf.get_component_alignment());
+	bool single = nc == 1 && component_map[0] == 0;
+	return dispatch_component_type(sf.get_component_type(), [&](auto* tag) {
+		typedef typename std::remove_pointer<decltype(tag)>::type T;
+		if (single)
+			copy_entries<T, true>(sp, dp, extents, src_steps, dst_steps, nc, &component_map[0], src_comp_step);
+		else
+			copy_entries<T, false>(sp, dp, extents, src_steps, dst_steps, nc, &component_map[0], src_comp_step);
+	});
+}
+bool data_view::permute_into(data_view& dst, const std::string& permutation) const
+{
+	data_view pv = permute(permutation);
+	if (pv.empty())
+		return false;
+	return reformat(dst, pv);
+}
+
 template class data_view_impl<data_view,unsigned char*>;
 template class data_view_impl<const_data_view,const unsigned char*>;
 
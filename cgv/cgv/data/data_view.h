@@ -20,8 +20,10 @@ protected:
 	bool owns_format;
 	unsigned int dim;
 	size_t step_sizes[4];
+	/// number of entries in each dimension of the view
+	size_t extents[4];
 	/// constructor used to construct sub views onto the data view
-	data_view_base(const data_format* _format, unsigned int _dim, const size_t* _step_sizes);
+	data_view_base(const data_format* _format, unsigned int _dim, const size_t* _step_sizes, const size_t* _extents);
 public:
 	/** construct the base of a data view from the given format, 
 		 such that the step sizes and dimension are set to view
@@ -39,6 +41,8 @@ public:
 	unsigned int get_dim() const;
 	/// return the step size in bytes in the i-th dimension
 	size_t get_step_size(unsigned int dim) const;
+	/// return the number of entries in the i-th dimension of the view or 0 if i is not smaller than the dimension
+	size_t get_extent(unsigned int i) const;
 };
 
 /** template class implementing the part of the view that depends on whether
@@ -50,7 +54,7 @@ protected:
 	/// data pointer of type unsigned char or const unsigned char
 	P data_ptr;
 	/// constructor used to construct sub views onto the data view
-	data_view_impl(const data_format* _format, P _data_ptr, unsigned _dim, const size_t* _step_sizes);
+	data_view_impl(const data_format* _format, P _data_ptr, unsigned _dim, const size_t* _step_sizes, const size_t* _extents);
 public:
 	/// construct a data view from the given format, viewing the complete data set
 	data_view_impl(const data_format* _format = 0, typename cgv::type::func::transfer_const<P,void*>::type _data_ptr = 0);
@@ -159,7 +163,7 @@ protected:
 	bool owns_ptr;
 	/// use base class for construction and don't manage data pointer 
 	data_view(const data_format* _format, unsigned char* _data_ptr, 
-				 unsigned int _dim, const size_t* _step_sizes);
+				 unsigned int _dim, const size_t* _step_sizes, const size_t* _extents);
 public:
 	/// construct an empty data view without format and with empty data pointer*/
 	data_view();
@@ -211,6 +215,16 @@ public:
 	static bool compose(data_view& composed_dv, const std::vector<data_view>& dvs);
 	/// combine n data views each with one component channel into a single data view with n component channels, the format of the input data views needs to match
 	static bool combine_components(data_view& dv, const std::vector<data_view>::iterator first, const std::vector<data_view>::iterator last);
+	/** copy the possibly permuted view src into a newly allocated and densely stored data view dst, which owns its
+		format and data pointer. The dimensions of dst are the view dimensions of src, i.e. the last index of src becomes
+		the width of dst. The component_order is a comma separated list of component names of src, like "B,G,R", that
+		selects and reorders the components of dst and keeps all components if empty. Entries of dst are aligned to 
+		entry_alignment bytes with data_format::set_entry_alignment() and data_format::set_entry_padding(). If src does not step along the last index
+		fastest, the copy is done in square tiles such that reads and writes stay in cache. Rows or tiles are copied 
+		in parallel. Return false for packed or non numeric components or unknown component names. */
+	static bool reformat(data_view& dst, const const_data_view& src, const std::string& component_order = "", unsigned entry_alignment = 1);
+	/// copy the view with permuted indices into dst, which is equivalent to reformat(dst, permute(permutation))
+	bool permute_into(data_view& dst, const std::string& permutation) const;
 };
 
 /** The const_data_view has the functionality of the data_view but 
@@ -224,7 +238,7 @@ protected:
 	friend class data_view_impl<const_data_view, const unsigned char*>;
 	/// use base class for construction
 	const_data_view(const data_format* _format, const unsigned char* _data_ptr, 
-						 unsigned _dim, const size_t* _step_sizes);
+						 unsigned _dim, const size_t* _step_sizes, const size_t* _extents);
 public:
 	/// construct an empty data view without format and with empty data pointer*/
 	const_data_view();
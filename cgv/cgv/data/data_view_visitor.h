@@ -0,0 +1,276 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cgv/type/standard_types.h>
+#include <cgv/data/data_view.h>
+
+namespace cgv {
+	namespace data {
+
+/** range over the entries of one row of a data view, where each entry consists of components of type T that
+    are comp_step bytes apart and entries are step bytes apart. T is const for views onto const data. */
+template <typename T>
+class strided_span
+{
+	typedef typename cgv::type::func::transfer_const<T*, unsigned char*>::type byte_ptr;
+	T* ptr;
+	size_t n;
+	size_t step;
+	size_t comp_step;
+public:
+	/// iterator over the entries of the span, dereferencing gives the first component of an entry
+	class iterator
+	{
+		byte_ptr p;
+		size_t step, comp_step;
+	public:
+		iterator(T* _ptr, size_t _step, size_t _comp_step) : p(reinterpret_cast<byte_ptr>(_ptr)), step(_step), comp_step(_comp_step) {}
+		/// access first component of entry
+		T& operator *() const { return *reinterpret_cast<T*>(p); }
+		/// access ci-th component of entry
+		T& operator [] (unsigned ci) const { return *reinterpret_cast<T*>(p + ci * comp_step); }
+		iterator& operator ++ () { p += step; return *this; }
+		iterator operator ++ (int) { iterator it = *this; p += step; return it; }
+		iterator& operator += (std::ptrdiff_t d) { p += d * std::ptrdiff_t(step); return *this; }
+		iterator operator + (std::ptrdiff_t d) const { iterator it = *this; return it += d; }
+		std::ptrdiff_t operator - (const iterator& it) const { return (p - it.p) / std::ptrdiff_t(step); }
+		bool operator == (const iterator& it) const { return p == it.p; }
+		bool operator != (const iterator& it) const { return p != it.p; }
+	};
+	/// construct from pointer to first component of first entry, number of entries and step sizes in bytes
+	strided_span(T* _ptr, size_t _n, size_t _step, size_t _comp_step) : ptr(_ptr), n(_n), step(_step), comp_step(_comp_step) {}
+	/// return number of entries
+	size_t size() const { return n; }
+	/// return step between entries in bytes
+	size_t get_step() const { return step; }
+	/// return step between components in bytes
+	size_t get_component_step() const { return comp_step; }
+	/// check whether entries with nr_components components are stored densely, such that the span can be processed as array of size()*nr_components values
+	bool is_contiguous(unsigned nr_components) const { return comp_step == sizeof(T) && step == nr_components * sizeof(T); }
+	/// return pointer to first component of first entry
+	T* data() const { return ptr; }
+	/// access ci-th component of i-th entry
+	T& operator () (size_t i, unsigned ci = 0) const { return *reinterpret_cast<T*>(reinterpret_cast<byte_ptr>(ptr) + i * step + ci * comp_step); }
+	iterator begin() const { return iterator(ptr, step, comp_step); }
+	iterator end() const { return begin() + std::ptrdiff_t(n); }
+};
+
+/** typed access to a data view with unpacked components of type T, where T is const for const_data_view.
+    Extents and step sizes are extracted once on construction. The data set is traversed in rows along the
+	innermost view dimension. For one dimensional views the single row is split into segments such that
+	kernels have work to distribute. */
+template <typename T>
+class typed_data_view
+{
+	typedef typename cgv::type::func::transfer_const<T*, unsigned char*>::type byte_ptr;
+	byte_ptr ptr;
+	unsigned dim;
+	size_t extents[4];
+	size_t step_sizes[4];
+	unsigned nr_components;
+	size_t comp_step;
+public:
+	/// number of entries per segment of one dimensional views
+	static const size_t segment_size = 1 << 14;
+	/// construct from data view with components of type T
+	template <class D, typename P>
+	typed_data_view(const data_view_impl<D, P>& dv) : ptr(const_cast<byte_ptr>(dv.template get_ptr<unsigned char>())), dim(dv.get_dim()) {
+		const data_format& df = *dv.get_format();
+		for (unsigned i = 0; i < 4; ++i) {
+			extents[i] = i < dim ? dv.get_extent(i) : 1;
+			step_sizes[i] = i < dim ? dv.get_step_size(i) : 0;
+		}
+		nr_components = df.get_nr_components();
+		comp_step = df.align(sizeof(T), df.get_component_alignment());
+	}
+	/// return the dimension
+	unsigned get_dim() const { return dim; }
+	/// return the number of entries in the i-th dimension
+	size_t get_extent(unsigned i) const { return extents[i]; }
+	/// return the number of components per entry
+	unsigned get_nr_components() const { return nr_components; }
+	/// return the number of rows, each of which covers the innermost dimension or a segment of it for one dimensional views
+	size_t get_nr_rows() const {
+		if (dim < 2)
+			return dim == 0 ? 1 : (extents[0] + segment_size - 1) / segment_size;
+		size_t n = 1;
+		for (unsigned i = 0; i + 1 < dim; ++i)
+			n *= extents[i];
+		return n;
+	}
+	/// return the r-th row in the order of increasing indices
+	strided_span<T> row(size_t r) const {
+		if (dim == 0)
+			return strided_span<T>(reinterpret_cast<T*>(ptr), 1, 0, comp_step);
+		if (dim == 1) {
+			size_t b = r * segment_size, n = extents[0] - b;
+			return strided_span<T>(reinterpret_cast<T*>(ptr + b * step_sizes[0]), n < segment_size ? n : size_t(segment_size), step_sizes[0], comp_step);
+		}
+		byte_ptr p = ptr;
+		for (unsigned i = dim - 1; i-- > 0; ) {
+			p += (r % extents[i]) * step_sizes[i];
+			r /= extents[i];
+		}
+		return strided_span<T>(reinterpret_cast<T*>(p), extents[dim - 1], step_sizes[dim - 1], comp_step);
+	}
+	/// access ci-th component of the entry at the given indices, where unused indices are ignored
+	T& operator () (unsigned ci, size_t i, size_t j = 0, size_t k = 0, size_t l = 0) const {
+		return *reinterpret_cast<T*>(ptr + i * step_sizes[0] + j * step_sizes[1] + k * step_sizes[2] + l * step_sizes[3] + ci * comp_step);
+	}
+};
+
+/// call f with a null pointer of the standard type corresponding to tid and return false if tid is no number type or bool
+template <typename F>
+bool dispatch_component_type(cgv::type::info::TypeId tid, F&& f)
+{
+	using namespace cgv::type;
+	switch (tid) {
+	case info::TI_BOOL: f((bool*)0); return true;
+	case info::TI_INT8: f((int8_type*)0); return true;
+	case info::TI_INT16: f((int16_type*)0); return true;
+	case info::TI_INT32: f((int32_type*)0); return true;
+	case info::TI_INT64: f((int64_type*)0); return true;
+	case info::TI_UINT8: f((uint8_type*)0); return true;
+	case info::TI_UINT16: f((uint16_type*)0); return true;
+	case info::TI_UINT32: f((uint32_type*)0); return true;
+	case info::TI_UINT64: f((uint64_type*)0); return true;
+	case info::TI_FLT32: f((flt32_type*)0); return true;
+	case info::TI_FLT64: f((flt64_type*)0); return true;
+	default: return false;
+	}
+}
+
+/** dispatch once on the component type of a data view and call f with a typed_data_view of the concrete type.
+    f must be callable for typed_data_view instances of all number types and bool, for example through a generic
+	lambda. Return false if the view is empty or uses packed components or a component type that is not a number. */
+template <typename F>
+bool visit(const data_view& dv, F&& f)
+{
+	if (dv.empty() || dv.get_format()->is_packing())
+		return false;
+	return dispatch_component_type(dv.get_format()->get_component_type(), [&](auto* tag) {
+		typedef typename std::remove_pointer<decltype(tag)>::type T;
+		f(typed_data_view<T>(dv));
+	});
+}
+/// dispatch once on the component type of a const data view and call f with a typed_data_view of the concrete const type
+template <typename F>
+bool visit(const const_data_view& dv, F&& f)
+{
+	if (dv.empty() || dv.get_format()->is_packing())
+		return false;
+	return dispatch_component_type(dv.get_format()->get_component_type(), [&](auto* tag) {
+		typedef typename std::remove_pointer<decltype(tag)>::type T;
+		f(typed_data_view<const T>(dv));
+	});
+}
+
+/// call f(span) for each row of a typed data view in parallel over the rows
+template <typename T, typename F>
+void for_each_row(const typed_data_view<T>& tv, F f)
+{
+	int n = int(tv.get_nr_rows());
+#pragma omp parallel for schedule(dynamic, 4)
+	for (int r = 0; r < n; ++r)
+		f(tv.row(r));
+}
+
+/** replace each component x of the view by f(x), where f is applied to the component value of the concrete type
+    and the result is converted back. Rows are processed in parallel and densely stored rows as flat arrays. */
+template <typename F>
+bool transform(const data_view& dv, F f)
+{
+	return visit(dv, [&](const auto& tv) {
+		typedef typename std::remove_reference<decltype(tv(0, 0))>::type T;
+		unsigned nc = tv.get_nr_components();
+		for_each_row(tv, [&](const strided_span<T>& s) {
+			if (s.is_contiguous(nc)) {
+				T* p = s.data();
+				size_t n = s.size() * nc;
+				for (size_t i = 0; i < n; ++i)
+					p[i] = T(f(p[i]));
+			}
+			else
+				for (size_t i = 0; i < s.size(); ++i)
+					for (unsigned ci = 0; ci < nc; ++ci)
+						s(i, ci) = T(f(s(i, ci)));
+		});
+	});
+}
+
+/** reduce all components of the view into result. Each row is accumulated with accumulate(R& partial, x) into a
+    partial result initialized to a copy of the incoming result, which therefore needs to be the identity of the
+	reduction. The partial results are combined in row order with combine(R& result, const R& partial), such that
+	the result is independent of the number of threads. Return false if the view cannot be visited. */
+template <typename R, typename F, typename G>
+bool reduce(const const_data_view& dv, R& result, F accumulate, G combine)
+{
+	R identity = result;
+	return visit(dv, [&](const auto& tv) {
+		typedef typename std::remove_reference<decltype(tv(0, 0))>::type T;
+		unsigned nc = tv.get_nr_components();
+		std::vector<R> partials(tv.get_nr_rows(), identity);
+		int n = int(partials.size());
+#pragma omp parallel for schedule(dynamic, 4)
+		for (int r = 0; r < n; ++r) {
+			strided_span<T> s = tv.row(r);
+			R& partial = partials[r];
+			if (s.is_contiguous(nc)) {
+				const T* p = s.data();
+				size_t m = s.size() * nc;
+				for (size_t i = 0; i < m; ++i)
+					accumulate(partial, p[i]);
+			}
+			else
+				for (size_t i = 0; i < s.size(); ++i)
+					for (unsigned ci = 0; ci < nc; ++ci)
+						accumulate(partial, s(i, ci));
+		}
+		for (const R& partial : partials)
+			combine(result, partial);
+	});
+}
+
+/** convert the components of src into the components of dst, which must have the same dimension, extents and
+    number of components but can differ in component type and layout. Values are converted with a static cast
+	and bool destinations receive whether the source is non zero. Return false if the views do not match. */
+inline bool convert_into(const const_data_view& src, const data_view& dst)
+{
+	if (src.empty() || dst.empty() || src.get_dim() != dst.get_dim() ||
+		src.get_format()->get_nr_components() != dst.get_format()->get_nr_components())
+		return false;
+	for (unsigned i = 0; i < src.get_dim(); ++i)
+		if (src.get_extent(i) != dst.get_extent(i))
+			return false;
+	bool success = false;
+	visit(src, [&](const auto& sv) {
+		typedef typename std::remove_reference<decltype(sv(0, 0))>::type S;
+		success = visit(dst, [&](const auto& dv) {
+			typedef typename std::remove_reference<decltype(dv(0, 0))>::type T;
+			unsigned nc = sv.get_nr_components();
+			int n = int(sv.get_nr_rows());
+#pragma omp parallel for schedule(dynamic, 4)
+			for (int r = 0; r < n; ++r) {
+				strided_span<S> s = sv.row(r);
+				strided_span<T> d = dv.row(r);
+				if (s.is_contiguous(nc) && d.is_contiguous(nc)) {
+					const S* sp = s.data();
+					T* dp = d.data();
+					size_t m = s.size() * nc;
+					for (size_t i = 0; i < m; ++i)
+						dp[i] = static_cast<T>(sp[i]);
+				}
+				else
+					for (size_t i = 0; i < s.size(); ++i)
+						for (unsigned ci = 0; ci < nc; ++ci)
+							d(i, ci) = static_cast<T>(s(i, ci));
+			}
+		});
+	});
+	return success;
+}
+
+	}
+}
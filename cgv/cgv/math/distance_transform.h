@@ -4,6 +4,9 @@
 #include <cgv/math/mat.h>
 #include <cgv/math/functions.h>
 #include <limits>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
 
 namespace cgv{
 	namespace math{
@@ -122,5 +125,106 @@ void dist_transf_2d(mat<T>& input, mat<T>& output,T on = 1)
   
 }
 
+/**
+* 1d squared distance transform of n samples with spacing h that uses caller provided scratch
+* memory v (n ints) and z (n+1 values) instead of allocating. Samples with value infinity
+* are no sites. The result d may not alias f and is infinity if there is no site.
+*/
+template <typename T>
+void sqrdist_transf_1d(const T* f, T* d, size_t n, T h, int* v, T* z)
+{
+	const T INF = std::numeric_limits<T>::infinity();
+	int k = -1;
+	for (size_t q = 0; q < n; q++)
+	{
+		if (f[q] == INF)
+			continue;
+		T pq = h*q;
+		T s = -INF;
+		while (k >= 0)
+		{
+			T pv = h*v[k];
+			s = ((f[q]+pq*pq)-(f[v[k]]+pv*pv))/(2*(pq-pv));
+			if (s > z[k])
+				break;
+			k--;
+		}
+		k++;
+		v[k] = int(q);
+		z[k] = k == 0 ? -INF : s;
+		z[k+1] = INF;
+	}
+	if (k < 0)
+	{
+		std::fill(d, d+n, INF);
+		return;
+	}
+	k = 0;
+	for (size_t q = 0; q < n; q++)
+	{
+		T pq = h*q;
+		while (z[k+1] < pq)
+			k++;
+		T dq = pq-h*v[k];
+		d[q] = dq*dq + f[v[k]];
+	}
+}
+
+/**
+* In place separable 3d squared euclidean distance transform of a volume of dimensions w x h x d stored
+* with x running fastest. Sites have value 0, all other voxels must be initialized to infinity. Voxel
+* spacings sx, sy and sz allow anisotropic voxels. Lines along x are processed in parallel, lines along
+* y and z are processed in parallel in blocks of adjacent x such that each gather reads whole cache lines.
+* Each thread allocates its scratch memory once.
+*/
+template <typename T>
+void sqrdist_transf_3d(T* data, size_t w, size_t h, size_t d, T sx = 1, T sy = 1, T sz = 1)
+{
+	const size_t B = 16;
+	size_t max_n = std::max(w, std::max(h, d));
+	size_t nr_x_blocks = (w+B-1)/B;
+	long long nr_rows = (long long)(h*d);
+#pragma omp parallel
+	{
+		std::vector<T> f(B*max_n), r(max_n), z(max_n+1);
+		std::vector<int> v(max_n);
+		// transform along x
+#pragma omp for schedule(dynamic, 16)
+		for (long long l = 0; l < nr_rows; l++)
+		{
+			T* row = data + size_t(l)*w;
+			std::copy(row, row+w, &f[0]);
+			sqrdist_transf_1d(&f[0], row, w, sx, &v[0], &z[0]);
+		}
+		// transform along y and z in blocks of B adjacent lines
+		for (int pass = 0; pass < 2; pass++)
+		{
+			size_t n = pass == 0 ? h : d;
+			size_t stride = pass == 0 ? w : w*h;
+			size_t outer_stride = pass == 0 ? w*h : w;
+			T s = pass == 0 ? sy : sz;
+			long long nr_blocks = (long long)(nr_x_blocks*(pass == 0 ? d : h));
+#pragma omp for schedule(dynamic, 4)
+			for (long long b = 0; b < nr_blocks; b++)
+			{
+				size_t x0 = B*(size_t(b) % nr_x_blocks);
+				size_t nb = std::min(B, w-x0);
+				T* base = data + (size_t(b) / nr_x_blocks)*outer_stride + x0;
+				for (size_t q = 0; q < n; q++)
+					for (size_t i = 0; i < nb; i++)
+						f[i*n+q] = base[q*stride+i];
+				for (size_t i = 0; i < nb; i++)
+				{
+					sqrdist_transf_1d(&f[i*n], &r[0], n, s, &v[0], &z[0]);
+					std::copy(r.begin(), r.begin()+n, &f[i*n]);
+				}
+				for (size_t q = 0; q < n; q++)
+					for (size_t i = 0; i < nb; i++)
+						base[q*stride+i] = f[i*n+q];
+			}
+		}
+	}
+}
+
 	}
 }
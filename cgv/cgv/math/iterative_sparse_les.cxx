@@ -0,0 +1,403 @@
+#include "iterative_sparse_les.h"
+#include "radix_sort.h"
+#include <cmath>
+#include <algorithm>
+
+namespace cgv {
+	namespace math {
+
+namespace {
+	/// parallel dot product
+	double dot(int n, const double* a, const double* b)
+	{
+		double s = 0;
+#pragma omp parallel for reduction(+:s)
+		for (int i = 0; i < n; ++i)
+			s += a[i] * b[i];
+		return s;
+	}
+	/// parallel y = a * x + y
+	void axpy(int n, double a, const double* x, double* y)
+	{
+#pragma omp parallel for
+		for (int i = 0; i < n; ++i)
+			y[i] += a * x[i];
+	}
+	/// built-in solver with fixed method and preconditioner as needed by sparse_les_factory_impl
+	template <IterativeSolverType st, IterativePreconditionerType pt>
+	class builtin_sparse_les : public iterative_sparse_les
+	{
+	public:
+		builtin_sparse_les(int n, int nr_rhs, int nr_nze) : iterative_sparse_les(n, nr_rhs, nr_nze, st, pt) {}
+	};
+}
+
+csr_matrix::csr_matrix(int _n) : n(_n), row_starts(_n + 1, 0)
+{
+}
+
+void csr_matrix::build(int _n, const std::vector<int>& rows, const std::vector<int>& columns, const std::vector<double>& vals)
+{
+	n = _n;
+	// sort triplets stably by row and column such that the last of equal entries wins
+	std::vector<uint32_t> row_keys(rows.begin(), rows.end()), column_keys(columns.begin(), columns.end());
+	std::vector<uint32_t> perm;
+	uint32_t max_key = uint32_t(std::max(n - 1, 0));
+	radix_sort_lexicographic(rows.size(), { &row_keys, &column_keys }, { max_key, max_key }, perm);
+	row_starts.assign(n + 1, 0);
+	column_indices.clear();
+	values.clear();
+	for (size_t i = 0; i < perm.size(); ++i) {
+		uint32_t e = perm[i];
+		if (i + 1 < perm.size() && rows[perm[i + 1]] == rows[e] && columns[perm[i + 1]] == columns[e])
+			continue;
+		++row_starts[rows[e] + 1];
+		column_indices.push_back(columns[e]);
+		values.push_back(vals[e]);
+	}
+	for (int r = 0; r < n; ++r)
+		row_starts[r + 1] += row_starts[r];
+}
+
+void csr_matrix::extract_diagonal(std::vector<double>& diagonal) const
+{
+	diagonal.assign(n, 0.0);
+#pragma omp parallel for
+	for (int r = 0; r < n; ++r)
+		for (int p = row_starts[r]; p < row_starts[r + 1]; ++p)
+			if (column_indices[p] == r)
+				diagonal[r] = values[p];
+}
+
+bool csr_matrix::is_symmetric(double tolerance) const
+{
+	bool symmetric = true;
+#pragma omp parallel for reduction(&&:symmetric)
+	for (int r = 0; r < n; ++r) {
+		for (int p = row_starts[r]; p < row_starts[r + 1] && symmetric; ++p) {
+			int c = column_indices[p];
+			const int* begin = &column_indices[0] + row_starts[c];
+			const int* end = &column_indices[0] + row_starts[c + 1];
+			const int* q = std::lower_bound(begin, end, r);
+			double v = (q != end && *q == r) ? values[q - &column_indices[0]] : 0.0;
+			if (std::abs(v - values[p]) > tolerance * std::max(std::abs(v), std::abs(values[p])))
+				symmetric = false;
+		}
+	}
+	return symmetric;
+}
+
+void csr_matrix::multiply(const double* x, double* y) const
+{
+#pragma omp parallel for schedule(static, 1024)
+	for (int r = 0; r < n; ++r) {
+		double s = 0;
+		for (int p = row_starts[r]; p < row_starts[r + 1]; ++p)
+			s += values[p] * x[column_indices[p]];
+		y[r] = s;
+	}
+}
+
+iterative_sparse_les::iterative_sparse_les(int _n, int _nr_rhs, int nr_nze, IterativeSolverType _solver_type, IterativePreconditionerType _preconditioner_type) :
+	n(_n), nr_rhs(_nr_rhs), solver_type(_solver_type), preconditioner_type(_preconditioner_type),
+	matrix_changed(true), b(size_t(_n) * _nr_rhs, 0.0), x(size_t(_n) * _nr_rhs, 0.0)
+{
+	if (nr_nze > 0) {
+		entry_rows.reserve(nr_nze);
+		entry_columns.reserve(nr_nze);
+		entry_values.reserve(nr_nze);
+	}
+	tolerance = 1e-10;
+	max_nr_iterations = -1;
+	nr_iterations = 0;
+	residual = 0;
+}
+
+void iterative_sparse_les::set_mat_entry(int r, int c, double val)
+{
+	entry_rows.push_back(r);
+	entry_columns.push_back(c);
+	entry_values.push_back(val);
+	matrix_changed = true;
+}
+
+void iterative_sparse_les::set_b_entry(int i, int j, double val)
+{
+	b[size_t(j) * n + i] = val;
+}
+
+double& iterative_sparse_les::ref_b_entry(int i, int j)
+{
+	return b[size_t(j) * n + i];
+}
+
+double iterative_sparse_les::get_x_entry(int i, int j) const
+{
+	return x[size_t(j) * n + i];
+}
+
+void iterative_sparse_les::set_x_entry(int i, int j, double val)
+{
+	x[size_t(j) * n + i] = val;
+}
+
+bool iterative_sparse_les::factorize_ic0(double diagonal_shift)
+{
+	// copy lower triangle of A, whose diagonal entry is the last one in each row
+	L.n = n;
+	L.row_starts.assign(n + 1, 0);
+	L.column_indices.clear();
+	L.values.clear();
+	for (int r = 0; r < n; ++r) {
+		for (int p = A.row_starts[r]; p < A.row_starts[r + 1] && A.column_indices[p] <= r; ++p) {
+			L.column_indices.push_back(A.column_indices[p]);
+			L.values.push_back(A.column_indices[p] == r ? (1 + diagonal_shift) * A.values[p] : A.values[p]);
+		}
+		L.row_starts[r + 1] = int(L.values.size());
+		if (L.row_starts[r + 1] == L.row_starts[r] || L.column_indices.back() != r)
+			return false;
+	}
+	// L_ij = (A_ij - sum_k<j L_ik L_jk) / L_jj restricted to the sparsity pattern of A
+	const int* C = &L.column_indices[0];
+	double* V = &L.values[0];
+	for (int i = 0; i < n; ++i) {
+		for (int p = L.row_starts[i]; p < L.row_starts[i + 1]; ++p) {
+			int j = C[p];
+			double s = V[p];
+			int pi = L.row_starts[i], pj = L.row_starts[j], pj_end = L.row_starts[j + 1] - 1;
+			while (pi < p && pj < pj_end) {
+				if (C[pi] < C[pj])
+					++pi;
+				else if (C[pi] > C[pj])
+					++pj;
+				else
+					s -= V[pi++] * V[pj++];
+			}
+			if (j < i)
+				V[p] = s / V[L.row_starts[j + 1] - 1];
+			else {
+				if (!(s > 0))
+					return false;
+				V[p] = std::sqrt(s);
+			}
+		}
+	}
+	return true;
+}
+
+void iterative_sparse_les::prepare()
+{
+	if (!matrix_changed)
+		return;
+	A.build(n, entry_rows, entry_columns, entry_values);
+	A.extract_diagonal(inverse_diagonal);
+	for (auto& d : inverse_diagonal)
+		d = d != 0 ? 1.0 / d : 1.0;
+	L = csr_matrix();
+	if (preconditioner_type == IPT_IC0 && solver_type == IST_CG) {
+		// shift diagonal until the incomplete factorization succeeds, otherwise fall back to jacobi preconditioning
+		double shift = 0;
+		bool factorized = factorize_ic0(shift);
+		while (!factorized && shift < 1) {
+			shift = shift == 0 ? 1e-3 : 2 * shift;
+			factorized = factorize_ic0(shift);
+		}
+		if (!factorized)
+			L = csr_matrix();
+	}
+	matrix_changed = false;
+}
+
+IterativePreconditionerType iterative_sparse_les::get_active_preconditioner() const
+{
+	if (!L.values.empty())
+		return IPT_IC0;
+	return preconditioner_type == IPT_IC0 ? IPT_JACOBI : preconditioner_type;
+}
+
+void iterative_sparse_les::precondition(const double* r, double* z) const
+{
+	if (!L.values.empty()) {
+		const int* C = &L.column_indices[0];
+		const double* V = &L.values[0];
+		// solve L y = r
+		for (int i = 0; i < n; ++i) {
+			double s = r[i];
+			int end = L.row_starts[i + 1] - 1;
+			for (int p = L.row_starts[i]; p < end; ++p)
+				s -= V[p] * z[C[p]];
+			z[i] = s / V[end];
+		}
+		// solve L^T z = y
+		for (int i = n; i > 0; ) {
+			--i;
+			int end = L.row_starts[i + 1] - 1;
+			z[i] /= V[end];
+			for (int p = L.row_starts[i]; p < end; ++p)
+				z[C[p]] -= V[p] * z[i];
+		}
+		return;
+	}
+	if (preconditioner_type == IPT_NONE) {
+		std::copy(r, r + n, z);
+		return;
+	}
+#pragma omp parallel for
+	for (int i = 0; i < n; ++i)
+		z[i] = inverse_diagonal[i] * r[i];
+}
+
+bool iterative_sparse_les::solve_cg(const double* b_j, double* x_j)
+{
+	double b_norm = std::sqrt(dot(n, b_j, b_j));
+	if (b_norm == 0) {
+		std::fill(x_j, x_j + n, 0.0);
+		return true;
+	}
+	std::vector<double> r(n), z(n), p(n), Ap(n);
+	A.multiply(x_j, &r[0]);
+#pragma omp parallel for
+	for (int i = 0; i < n; ++i)
+		r[i] = b_j[i] - r[i];
+	precondition(&r[0], &z[0]);
+	p = z;
+	double rz = dot(n, &r[0], &z[0]);
+	int max_it = max_nr_iterations >= 0 ? max_nr_iterations : 10 * n;
+	int it = 0;
+	double r_norm = std::sqrt(dot(n, &r[0], &r[0]));
+	while (r_norm > tolerance * b_norm && it < max_it) {
+		A.multiply(&p[0], &Ap[0]);
+		double pAp = dot(n, &p[0], &Ap[0]);
+		if (pAp == 0)
+			break;
+		double alpha = rz / pAp;
+		axpy(n, alpha, &p[0], x_j);
+		axpy(n, -alpha, &Ap[0], &r[0]);
+		precondition(&r[0], &z[0]);
+		double rz_new = dot(n, &r[0], &z[0]);
+		double beta = rz_new / rz;
+		rz = rz_new;
+#pragma omp parallel for
+		for (int i = 0; i < n; ++i)
+			p[i] = z[i] + beta * p[i];
+		r_norm = std::sqrt(dot(n, &r[0], &r[0]));
+		++it;
+	}
+	nr_iterations = std::max(nr_iterations, it);
+	residual = std::max(residual, r_norm / b_norm);
+	return r_norm <= tolerance * b_norm;
+}
+
+bool iterative_sparse_les::solve_bicgstab(const double* b_j, double* x_j)
+{
+	double b_norm = std::sqrt(dot(n, b_j, b_j));
+	if (b_norm == 0) {
+		std::fill(x_j, x_j + n, 0.0);
+		return true;
+	}
+	std::vector<double> r(n), r0(n), p(n, 0.0), v(n, 0.0), p_hat(n), s(n), s_hat(n), t(n);
+	int max_it = max_nr_iterations >= 0 ? max_nr_iterations : 10 * n;
+	int it = 0;
+	double r_norm = 0;
+	// restart from the true residual after breakdown or if the iterated residual drifted away from it
+	for (int restart = 0; restart < 4; ++restart) {
+		A.multiply(x_j, &r[0]);
+#pragma omp parallel for
+		for (int i = 0; i < n; ++i)
+			r[i] = b_j[i] - r[i];
+		r_norm = std::sqrt(dot(n, &r[0], &r[0]));
+		if (r_norm <= tolerance * b_norm || it >= max_it)
+			break;
+		r0 = r;
+		std::fill(p.begin(), p.end(), 0.0);
+		std::fill(v.begin(), v.end(), 0.0);
+		double rho = 1, alpha = 1, omega = 1;
+		while (r_norm > tolerance * b_norm && it < max_it) {
+			double rho_new = dot(n, &r0[0], &r[0]);
+			if (rho_new == 0)
+				break;
+			double beta = (rho_new / rho) * (alpha / omega);
+			rho = rho_new;
+#pragma omp parallel for
+			for (int i = 0; i < n; ++i)
+				p[i] = r[i] + beta * (p[i] - omega * v[i]);
+			precondition(&p[0], &p_hat[0]);
+			A.multiply(&p_hat[0], &v[0]);
+			double r0v = dot(n, &r0[0], &v[0]);
+			if (r0v == 0)
+				break;
+			alpha = rho / r0v;
+#pragma omp parallel for
+			for (int i = 0; i < n; ++i)
+				s[i] = r[i] - alpha * v[i];
+			++it;
+			double s_norm = std::sqrt(dot(n, &s[0], &s[0]));
+			if (s_norm <= tolerance * b_norm) {
+				axpy(n, alpha, &p_hat[0], x_j);
+				r_norm = s_norm;
+				break;
+			}
+			precondition(&s[0], &s_hat[0]);
+			A.multiply(&s_hat[0], &t[0]);
+			double tt = dot(n, &t[0], &t[0]);
+			omega = tt > 0 ? dot(n, &t[0], &s[0]) / tt : 0;
+#pragma omp parallel for
+			for (int i = 0; i < n; ++i) {
+				x_j[i] += alpha * p_hat[i] + omega * s_hat[i];
+				r[i] = s[i] - omega * t[i];
+			}
+			r_norm = std::sqrt(dot(n, &r[0], &r[0]));
+			if (omega == 0)
+				break;
+		}
+	}
+	nr_iterations = std::max(nr_iterations, it);
+	residual = std::max(residual, r_norm / b_norm);
+	return r_norm <= tolerance * b_norm;
+}
+
+bool iterative_sparse_les::solve(bool analyze_residual)
+{
+	if (n == 0)
+		return true;
+	prepare();
+	nr_iterations = 0;
+	residual = 0;
+	bool success = true;
+	for (int j = 0; j < nr_rhs; ++j) {
+		const double* b_j = &b[size_t(j) * n];
+		double* x_j = &x[size_t(j) * n];
+		if (!(solver_type == IST_CG ? solve_cg(b_j, x_j) : solve_bicgstab(b_j, x_j)))
+			success = false;
+	}
+	if (analyze_residual) {
+		// replace the iterated residual, which can drift from the true one, by the residual of the final solution
+		residual = 0;
+		std::vector<double> r(n);
+		for (int j = 0; j < nr_rhs; ++j) {
+			const double* b_j = &b[size_t(j) * n];
+			A.multiply(&x[size_t(j) * n], &r[0]);
+			axpy(n, -1.0, b_j, &r[0]);
+			double b_norm = std::sqrt(dot(n, b_j, b_j));
+			if (b_norm > 0)
+				residual = std::max(residual, std::sqrt(dot(n, &r[0], &r[0])) / b_norm);
+		}
+		success = residual <= 10 * tolerance;
+	}
+	return success;
+}
+
+std::vector<sparse_les_factory_ptr> get_builtin_solver_factories()
+{
+	std::vector<sparse_les_factory_ptr> factories;
+	factories.push_back(sparse_les_factory_ptr(new sparse_les_factory_impl<builtin_sparse_les<IST_CG, IPT_JACOBI> >(
+		"cg_jacobi", SparseLesCaps(SLC_SYMMETRIC | SLC_NZE_OPTIONAL))));
+	factories.push_back(sparse_les_factory_ptr(new sparse_les_factory_impl<builtin_sparse_les<IST_CG, IPT_IC0> >(
+		"cg_ic0", SparseLesCaps(SLC_SYMMETRIC | SLC_NZE_OPTIONAL))));
+	factories.push_back(sparse_les_factory_ptr(new sparse_les_factory_impl<builtin_sparse_les<IST_BICGSTAB, IPT_JACOBI> >(
+		"bicgstab", SLC_ALL)));
+	return factories;
+}
+
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vector>
+#include "sparse_les.h"
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace math {
+
+/// sparse matrix in compressed sparse row layout with multithreaded matrix vector product
+class CGV_API csr_matrix
+{
+public:
+	/// number of rows and columns
+	int n;
+	/// per row the index of its first entry plus the end index of the last row
+	std::vector<int> row_starts;
+	/// column indices of the entries sorted increasingly within each row
+	std::vector<int> column_indices;
+	/// values of the entries
+	std::vector<double> values;
+	/// construct empty matrix
+	csr_matrix(int _n = 0);
+	/// build matrix from (row, column, value) triplets, where for multiply given entries the last value is used
+	void build(int _n, const std::vector<int>& rows, const std::vector<int>& columns, const std::vector<double>& vals);
+	/// return the number of stored entries
+	size_t get_nr_entries() const { return values.size(); }
+	/// extract the diagonal, missing diagonal entries are zero
+	void extract_diagonal(std::vector<double>& diagonal) const;
+	/// check whether the matrix is structurally and numerically symmetric up to the given relative tolerance
+	bool is_symmetric(double tolerance = 1e-12) const;
+	/// compute y = A * x in parallel over rows
+	void multiply(const double* x, double* y) const;
+};
+
+/// iterative solution methods of iterative_sparse_les
+enum IterativeSolverType
+{
+	IST_CG,       ///< conjugate gradients for symmetric positive definite matrices
+	IST_BICGSTAB  ///< biconjugate gradient stabilized method for general square matrices
+};
+
+/// preconditioners of iterative_sparse_les
+enum IterativePreconditionerType
+{
+	IPT_NONE,     ///< no preconditioning
+	IPT_JACOBI,   ///< inverse of the diagonal
+	IPT_IC0       ///< incomplete Cholesky factorization without fill in, only for symmetric positive definite matrices
+};
+
+/** sparse linear system solver based on Krylov subspace methods. Matrix entries are collected as triplets and
+    converted to a csr_matrix when solve() is called after the matrix changed. Matrix vector products and vector
+	operations run in parallel, only the triangular solves of the incomplete Cholesky preconditioner are serial.
+	Each right hand side is solved independently, starting from the current solution vector, which is zero
+	initially and can be set with set_x_entry() for warm starts.
+
+	The built-in solvers are registered in the sparse_les factory under the names "cg_jacobi", "cg_ic0"
+	and "bicgstab" and are found after all solvers registered with register_solver_factory(). */
+class CGV_API iterative_sparse_les : public sparse_les
+{
+protected:
+	int n, nr_rhs;
+	IterativeSolverType solver_type;
+	IterativePreconditionerType preconditioner_type;
+	/// matrix entries as triplets
+	std::vector<int> entry_rows, entry_columns;
+	std::vector<double> entry_values;
+	bool matrix_changed;
+	/// right hand sides and solutions stored column after column
+	std::vector<double> b, x;
+	/// the system matrix
+	csr_matrix A;
+	/// inverse diagonal for the jacobi preconditioner
+	std::vector<double> inverse_diagonal;
+	/// lower triangular incomplete Cholesky factor with the diagonal as last entry of each row
+	csr_matrix L;
+	/// stopping criteria and statistics
+	double tolerance;
+	int max_nr_iterations;
+	int nr_iterations;
+	double residual;
+	/// update csr matrix and preconditioner from the triplets
+	void prepare();
+	/// compute the incomplete Cholesky factor and return false if the factorization broke down
+	bool factorize_ic0(double diagonal_shift);
+	/// apply preconditioner z = M^-1 r
+	void precondition(const double* r, double* z) const;
+	/// solve for one right hand side and return whether the tolerance was reached
+	bool solve_cg(const double* b_j, double* x_j);
+	bool solve_bicgstab(const double* b_j, double* x_j);
+public:
+	/// construct solver for n unknowns and nr_rhs right hand sides, nr_nze is used to reserve space for entries
+	iterative_sparse_les(int _n, int _nr_rhs, int nr_nze = -1, IterativeSolverType _solver_type = IST_CG, IterativePreconditionerType _preconditioner_type = IPT_JACOBI);
+	/// set relative residual norm at which iterations stop (default 1e-10)
+	void set_tolerance(double _tolerance) { tolerance = _tolerance; }
+	/// return relative residual tolerance
+	double get_tolerance() const { return tolerance; }
+	/// set maximal number of iterations per right hand side, where -1 (default) uses 10 times the number of unknowns
+	void set_max_nr_iterations(int _max_nr_iterations) { max_nr_iterations = _max_nr_iterations; }
+	/// return maximal number of iterations per right hand side
+	int get_max_nr_iterations() const { return max_nr_iterations; }
+	/// return the maximal number of iterations needed for a right hand side in the last solve
+	int get_nr_iterations() const { return nr_iterations; }
+	/// return the largest relative residual norm over all right hand sides of the last solve
+	double get_residual() const { return residual; }
+	/// return the matrix, which is only up to date after solve()
+	const csr_matrix& get_matrix() const { return A; }
+	/// return the preconditioner used in the last solve, which is IPT_JACOBI if the incomplete Cholesky factorization failed
+	IterativePreconditionerType get_active_preconditioner() const;
+	/**@name implementation of sparse_les interface */
+	//@{
+	/// set entry in row r and column c in the sparse matrix A
+	void set_mat_entry(int r, int c, double val);
+	/// set i-th entry in the j-th right hand side
+	void set_b_entry(int i, int j, double val);
+	/// set i-th entry in j-th right hand side
+	double& ref_b_entry(int i, int j);
+	/// solve all right hand sides, with analyze_residual the residual is recomputed from the final solution instead of using the iterated one
+	bool solve(bool analyze_residual = false);
+	/// return the i-th component of the j-th solution vector
+	double get_x_entry(int i, int j) const;
+	/// set the i-th component of the j-th solution vector used as initial guess
+	void set_x_entry(int i, int j, double val);
+	//@}
+	using sparse_les::set_b_entry;
+	using sparse_les::ref_b_entry;
+	using sparse_les::get_x_entry;
+};
+
+/// return factories of the built-in solvers, which sparse_les appends to the registered solver factories
+extern CGV_API std::vector<sparse_les_factory_ptr> get_builtin_solver_factories();
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace cgv {
+	namespace math {
+		/** stable least significant digit radix sort of the permutation perm by the 32 bit keys[perm[i]].
+		    Only the digits needed to represent max_key are processed. As the sort is stable, calling
+			it successively from the least to the most significant key of a tuple yields a lexicographic
+			order, in which equal tuples stay in their input order. Histograms and scattering are computed
+			over a fixed number of blocks, such that the result does not depend on the number of threads.
+			The blocks are only processed in parallel if the including translation unit is compiled with
+			OpenMP, which the CMake build does not enable. Otherwise they run serially. */
+		template <typename idx_type>
+		void radix_sort_permutation(const std::vector<uint32_t>& keys, std::vector<idx_type>& perm, uint32_t max_key = uint32_t(-1))
+		{
+			const unsigned digit_bits = 11;
+			const unsigned nr_buckets = 1 << digit_bits;
+			int64_t n = int64_t(perm.size());
+			if (n < 2)
+				return;
+			// the number of blocks only depends on n, small inputs avoid the parallelization overhead
+			const int nr_blocks = int(std::max(int64_t(1), std::min(int64_t(64), n / 65536)));
+			int64_t block_size = (n + nr_blocks - 1) / nr_blocks;
+			std::vector<idx_type> tmp(perm.size());
+			std::vector<size_t> offsets(size_t(nr_blocks) * nr_buckets);
+			for (unsigned shift = 0; shift < 32 && (shift == 0 || (max_key >> shift) != 0); shift += digit_bits) {
+				// per block histograms
+#pragma omp parallel for
+				for (int b = 0; b < nr_blocks; ++b) {
+					size_t* H = &offsets[size_t(b) * nr_buckets];
+					std::fill(H, H + nr_buckets, size_t(0));
+					int64_t end = std::min(n, (b + 1) * block_size);
+					for (int64_t i = b * block_size; i < end; ++i)
+						++H[(keys[perm[i]] >> shift) & (nr_buckets - 1)];
+				}
+				// exclusive prefix sum in bucket major and block minor order keeps the sort stable
+				size_t sum = 0;
+				for (unsigned d = 0; d < nr_buckets; ++d)
+					for (int b = 0; b < nr_blocks; ++b) {
+						size_t& o = offsets[size_t(b) * nr_buckets + d];
+						size_t c = o;
+						o = sum;
+						sum += c;
+					}
+				// scatter
+#pragma omp parallel for
+				for (int b = 0; b < nr_blocks; ++b) {
+					size_t* O = &offsets[size_t(b) * nr_buckets];
+					int64_t end = std::min(n, (b + 1) * block_size);
+					for (int64_t i = b * block_size; i < end; ++i)
+						tmp[O[(keys[perm[i]] >> shift) & (nr_buckets - 1)]++] = perm[i];
+				}
+				perm.swap(tmp);
+			}
+		}
+		/** sort the indices 0..n-1 lexicographically by the given key vectors, where key_vectors[0] is the most
+		    significant one and max_keys provides for each key vector an upper bound of its values. Indices with equal
+			key tuples stay in increasing order. */
+		template <typename idx_type>
+		void radix_sort_lexicographic(size_t n, const std::vector<const std::vector<uint32_t>*>& key_vectors,
+			const std::vector<uint32_t>& max_keys, std::vector<idx_type>& perm)
+		{
+			perm.resize(n);
+			for (size_t i = 0; i < n; ++i)
+				perm[i] = idx_type(i);
+			for (size_t k = key_vectors.size(); k > 0; ) {
+				--k;
+				radix_sort_permutation(*key_vectors[k], perm, max_keys[k]);
+			}
+		}
+	}
+}
@@ -1,4 +1,5 @@
 #include "sparse_les.h"
+#include "iterative_sparse_les.h"
 #include <string>
 
 namespace cgv {
@@ -9,16 +10,25 @@ sparse_les_factory::~sparse_les_factory()
 {
 }
 
+/// registered solver factories followed by the factories of the built-in solvers
 std::vector<sparse_les_factory_ptr>& ref_solver_factories()
 {
-	static std::vector<sparse_les_factory_ptr> facs;
+	static std::vector<sparse_les_factory_ptr> facs = get_builtin_solver_factories();
 	return facs;
 }
 
+/// number of registered solver factories in front of the built-in ones
+size_t& ref_nr_registered_solver_factories()
+{
+	static size_t nr = 0;
+	return nr;
+}
+
 /// register a factory for a new type of linear equation solver
 void sparse_les::register_solver_factory(sparse_les_factory_ptr sls_fac)
 {
-	ref_solver_factories().push_back(sls_fac);
+	std::vector<sparse_les_factory_ptr>& F = ref_solver_factories();
+	F.insert(F.begin() + ref_nr_registered_solver_factories()++, sls_fac);
 }
 /// return the list of registered solvers
 const std::vector<sparse_les_factory_ptr>& sparse_les::get_solver_factories()
@@ -80,6 +80,12 @@ image_reader::image_reader(data_format& file_format, std::vector<data_format>* _
 {
 }
 
+image_reader::~image_reader()
+{
+	if (rd)
+		delete rd;
+}
+
 /// return a string with a list of supported extensions, where the list entries are separated with the passed character that defaults to a semicolon
 const std::string& image_reader::get_supported_extensions(char sep)
 {
@@ -154,6 +160,8 @@ bool image_reader::open(const std::string& file_name)
 		const std::string &supported_extensions = readers[i]->get_interface<abst_image_reader>()->get_supported_extensions();
 		all_supported_extensions << supported_extensions;
 		if (cgv::utils::is_element(ext, supported_extensions)) {
+			if (rd)
+				delete rd;
 			rd = readers[i]->get_interface<abst_image_reader>()->clone();
 			return rd->open(file_name, *file_format_ptr, palette_formats);
 		}
@@ -0,0 +1,481 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cgv/utils/progression.h>
+#include <cgv/math/qem.h>
+#include <cgv/math/mfunc.h>
+#include <cgv/media/axis_aligned_box.h>
+#include "streaming_mesh.h"
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+/// node of the octree used by adaptive dual contouring
+template <typename X>
+struct adc_node
+{
+	/// cell coordinates within the level
+	unsigned i, j, k;
+	/// sign of the corners, where corner c with bits x|y<<1|z<<2 is inside if bit c is set
+	unsigned char signs;
+	/// whether the subtree can be replaced by a single cell
+	bool collapsible;
+	/// 0 .. internal, 1 .. leaf of the adaptive octree, 2 .. below a leaf
+	unsigned char state;
+	/// index of parent in the coarser level
+	int parent;
+	/// indices of children in the finer level or -1 for cells without surface
+	int children[8];
+	/// accumulated quadric error metric in the coefficient layout of cgv::math::qem<X> of dimension three, sum of edge points and number of edge points
+	cgv::math::fvec<X,10> Q;
+	cgv::math::fvec<X,3> mass;
+	int count;
+	/// minimizer of the quadric error metric and its error
+	cgv::math::fvec<X,3> vertex;
+	X error;
+	/// index of the vertex in the streaming mesh
+	unsigned int vertex_index;
+};
+
+/** adaptive variant of dual contouring that builds an octree over a regular grid of 2^max_depth cells per axis.
+    Quadric error metrics of the finest cells are built from the intersection points and gradient normals of the
+	sign change edges. Coarser cells accumulate the metrics of their children and replace them if all children
+	could be replaced, the sign configuration passes the topology test of Ju et al. 2002 and the error of the
+	minimizer does not exceed the maximum error. Sampling of the function and the metric minimization of each
+	level run in parallel. The mesh is emitted with the recursive cell, face and edge procedures on the octree,
+	which produces one quad or triangle per minimal sign change edge and thus a crack free surface. Vertex
+	normals are set to the normalized gradient. In contrast to dual_contouring no vertices are dropped. */
+template <typename X, typename T>
+class adaptive_dual_contouring : public streaming_mesh<X>
+{
+public:
+	typedef streaming_mesh<X> base_type;
+	/// points must have three components
+	typedef cgv::math::fvec<X,3> pnt_type;
+	/// vectors must have three components
+	typedef cgv::math::fvec<X,3> vec_type;
+	/// qem type must have dimension three
+	typedef cgv::math::qem<X> qem_type;
+	/// type of octree nodes
+	typedef adc_node<X> node_type;
+private:
+	/// reference to a node given by level and index in level, where index -1 denotes a cell without surface
+	struct node_ref
+	{
+		int level, index;
+		node_ref(int _level = 0, int _index = -1) : level(_level), index(_index) {}
+		bool operator == (const node_ref& n) const { return level == n.level && index == n.index; }
+	};
+	pnt_type minp;
+	vec_type d;
+	unsigned int depth, res;
+	T iso_value;
+	/// function samples on the (res+1)^3 grid
+	std::vector<T> values;
+	/// octree levels from the root at index 0 to the finest level at index depth
+	std::vector<std::vector<node_type> > levels;
+protected:
+	const cgv::math::v3_func<X,T>& func;
+	X max_error;
+	X relative_epsilon;
+	/// return sample at grid location
+	const T& value(size_t x, size_t y, size_t z) const { return values[(z*(res+1)+y)*(res+1)+x]; }
+	/// return whether sample at grid location is inside
+	bool inside(size_t x, size_t y, size_t z) const { return value(x, y, z) > iso_value; }
+	/// return sign bits of the corners of a cell of the given size in grid units
+	unsigned char compute_signs(size_t x, size_t y, size_t z, size_t s) const
+	{
+		unsigned char signs = 0;
+		for (int c = 0; c < 8; ++c)
+			if (inside(x + s*(c&1), y + s*((c>>1)&1), z + s*((c>>2)&1)))
+				signs |= 1 << c;
+		return signs;
+	}
+	/// topology test of a cell with size 2*h in grid units based on the signs at the centers of its edges, faces and itself
+	bool is_topology_preserved(size_t x, size_t y, size_t z, size_t h) const
+	{
+		size_t p[3] = { x, y, z };
+		for (int o = 0; o < 27; ++o) {
+			int m[3] = { o%3, (o/3)%3, o/9 };
+			if (m[0] != 1 && m[1] != 1 && m[2] != 1)
+				continue;
+			bool s = inside(p[0]+m[0]*h, p[1]+m[1]*h, p[2]+m[2]*h);
+			// the center sign must agree with one of the corners of the edge, face or cell with this center
+			bool agrees = false;
+			for (int c = 0; c < 8 && !agrees; ++c) {
+				size_t q[3];
+				bool valid = true;
+				for (int a = 0; a < 3; ++a) {
+					int b = (c >> a) & 1;
+					if (m[a] == 1)
+						q[a] = p[a] + 2*h*b;
+					else if (b == 1)
+						valid = false;
+					else
+						q[a] = p[a] + m[a]*h;
+				}
+				if (valid && inside(q[0], q[1], q[2]) == s)
+					agrees = true;
+			}
+			if (!agrees)
+				return false;
+		}
+		return true;
+	}
+	/// compute location of grid point
+	pnt_type grid_point(size_t x, size_t y, size_t z) const
+	{
+		return pnt_type(minp(0) + X(x)*d(0), minp(1) + X(y)*d(1), minp(2) + X(z)*d(2));
+	}
+	/// accumulate the planes of the sign change edges of a finest level cell
+	void process_cell_edges(node_type& n) const
+	{
+		n.Q = cgv::math::fvec<X,10>(X(0));
+		n.mass = pnt_type(0, 0, 0);
+		n.count = 0;
+		for (int e = 0; e < 3; ++e)
+			for (int o = 0; o < 4; ++o) {
+				// corner c0 has bit e zero and the other bits from o
+				int c0 = e == 0 ? (o << 1) : (e == 1 ? ((o & 2) << 1) | (o & 1) : o);
+				int c1 = c0 | (1 << e);
+				if (((n.signs >> c0) & 1) == ((n.signs >> c1) & 1))
+					continue;
+				size_t x0 = n.i + (c0&1), y0 = n.j + ((c0>>1)&1), z0 = n.k + ((c0>>2)&1);
+				T v0 = value(x0, y0, z0);
+				T v1 = value(x0 + (e==0), y0 + (e==1), z0 + (e==2));
+				X alpha = v1 != v0 ? X(iso_value - v0) / X(v1 - v0) : X(0.5);
+				pnt_type q = grid_point(x0, y0, z0);
+				q(e) += alpha*d(e);
+				cgv::math::vec<X> g = func.evaluate_gradient(q.to_vec());
+				vec_type nml(g.size(), g);
+				if (nml.length() < 1e-12) {
+					nml = vec_type(0, 0, 0);
+					nml(e) = X(v1 > v0 ? 1 : -1);
+				}
+				else
+					nml.normalize();
+				// plane quadric with scalar part d*d, vector part d*nml and matrix part nml*nml^T for d = -dot(q,nml)
+				X dist = -dot(q, nml);
+				n.Q(0) += dist*dist;
+				for (unsigned a = 0, k = 4; a < 3; ++a) {
+					n.Q(a+1) += dist*nml(a);
+					for (unsigned b = a; b < 3; ++b, ++k)
+						n.Q(k) += nml(a)*nml(b);
+				}
+				n.mass += q;
+				++n.count;
+			}
+	}
+	/// minimize the quadric error metric of a node of size s in grid units
+	void solve(node_type& n, size_t s) const
+	{
+		pnt_type p_ref = n.mass / X(n.count);
+		X max_distance = X(0.5)*X(s)*d.length();
+		qem_type Q(3);
+		for (unsigned k = 0; k < 10; ++k)
+			Q(k) = n.Q(k);
+		cgv::math::vec<X> v = Q.minarg(p_ref.to_vec(), relative_epsilon, max_distance);
+		n.vertex = pnt_type(v.size(), v);
+		n.error = std::max(X(0), Q.evaluate(v));
+	}
+	/// return whether node is treated as leaf during contouring
+	bool is_leaf(const node_ref& n) const { return levels[n.level][n.index].state == 1; }
+	/// return child of a node or the node itself if it is a leaf
+	node_ref child(const node_ref& n, int c) const
+	{
+		if (is_leaf(n))
+			return n;
+		return node_ref(n.level+1, levels[n.level][n.index].children[c]);
+	}
+	/// emit the polygon around a minimal edge of axis e with nodes indexed by the sides su+2*sv along the other axes
+	void process_edge(const node_ref* nodes, int e)
+	{
+		// the deepest node contains the minimal edge
+		int deepest = 0;
+		for (int q = 1; q < 4; ++q)
+			if (nodes[q].level > nodes[deepest].level)
+				deepest = q;
+		const node_type& n = levels[nodes[deepest].level][nodes[deepest].index];
+		size_t s = size_t(1) << (depth - nodes[deepest].level);
+		size_t p[3] = { n.i*s, n.j*s, n.k*s };
+		p[(e+1)%3] += (1 - (deepest&1))*s;
+		p[(e+2)%3] += (1 - (deepest>>1))*s;
+		bool s0 = inside(p[0], p[1], p[2]);
+		p[e] += s;
+		bool s1 = inside(p[0], p[1], p[2]);
+		if (s0 == s1)
+			return;
+		// collect vertices counter clockwise around axis e and orient them along the function gradient
+		int cyclic[4] = { 0, 1, 3, 2 };
+		if (s0)
+			std::swap(cyclic[1], cyclic[3]);
+		std::vector<unsigned int> vis;
+		for (int q = 0; q < 4; ++q) {
+			const node_ref& r = nodes[cyclic[q]];
+			unsigned int vi = levels[r.level][r.index].vertex_index;
+			if (vis.empty() || vis.back() != vi)
+				vis.push_back(vi);
+		}
+		if (vis.size() > 1 && vis.back() == vis.front())
+			vis.pop_back();
+		if (vis.size() == 4)
+			base_type::new_quad(vis[0], vis[1], vis[2], vis[3]);
+		else if (vis.size() == 3)
+			base_type::new_triangle(vis[0], vis[1], vis[2]);
+	}
+	/// recursive edge procedure for the four nodes around an edge of axis e
+	void edge_proc(const node_ref* nodes, int e)
+	{
+		for (int q = 0; q < 4; ++q)
+			if (nodes[q].index == -1)
+				return;
+		if (is_leaf(nodes[0]) && is_leaf(nodes[1]) && is_leaf(nodes[2]) && is_leaf(nodes[3])) {
+			process_edge(nodes, e);
+			return;
+		}
+		int u = (e+1)%3, v = (e+2)%3;
+		for (int t = 0; t < 2; ++t) {
+			node_ref sub_nodes[4];
+			for (int q = 0; q < 4; ++q)
+				sub_nodes[q] = child(nodes[q], (t << e) | ((1 - (q&1)) << u) | ((1 - (q>>1)) << v));
+			edge_proc(sub_nodes, e);
+		}
+	}
+	/// recursive face procedure for two nodes adjacent along axis a with n0 on the negative side
+	void face_proc(const node_ref& n0, const node_ref& n1, int a)
+	{
+		if (n0.index == -1 || n1.index == -1)
+			return;
+		if (is_leaf(n0) && is_leaf(n1))
+			return;
+		int b = (a+1)%3, c = (a+2)%3;
+		for (int o = 0; o < 4; ++o) {
+			int bits = ((o&1) << b) | ((o>>1) << c);
+			face_proc(child(n0, bits | (1 << a)), child(n1, bits), a);
+		}
+		// edges inside the face along both other axes
+		for (int f = 0; f < 2; ++f) {
+			int e = f == 0 ? b : c;
+			int g = f == 0 ? c : b;
+			int u = (e+1)%3;
+			for (int t = 0; t < 2; ++t) {
+				node_ref nodes[4];
+				for (int sa = 0; sa < 2; ++sa)
+					for (int sg = 0; sg < 2; ++sg) {
+						const node_ref& n = sa == 0 ? n0 : n1;
+						int q = u == a ? sa + 2*sg : sg + 2*sa;
+						nodes[q] = child(n, (t << e) | ((1 - sa) << a) | (sg << g));
+					}
+				edge_proc(nodes, e);
+			}
+		}
+	}
+	/// recursive cell procedure
+	void cell_proc(const node_ref& n)
+	{
+		if (n.index == -1 || is_leaf(n))
+			return;
+		for (int c = 0; c < 8; ++c)
+			cell_proc(child(n, c));
+		for (int a = 0; a < 3; ++a) {
+			int b = (a+1)%3, c = (a+2)%3;
+			for (int o = 0; o < 4; ++o) {
+				int bits = ((o&1) << b) | ((o>>1) << c);
+				face_proc(child(n, bits), child(n, bits | (1 << a)), a);
+			}
+		}
+		for (int e = 0; e < 3; ++e) {
+			int u = (e+1)%3, v = (e+2)%3;
+			for (int t = 0; t < 2; ++t) {
+				node_ref nodes[4];
+				for (int q = 0; q < 4; ++q)
+					nodes[q] = child(n, (t << e) | ((q&1) << u) | ((q>>1) << v));
+				edge_proc(nodes, e);
+			}
+		}
+	}
+	/// interleave the bits of the cell coordinates
+	static uint64_t morton_code(unsigned i, unsigned j, unsigned k)
+	{
+		uint64_t code = 0;
+		for (int b = 0; b < 21; ++b)
+			code |= (uint64_t((i >> b) & 1) << (3*b)) | (uint64_t((j >> b) & 1) << (3*b+1)) | (uint64_t((k >> b) & 1) << (3*b+2));
+		return code;
+	}
+public:
+	/// construct adaptive dual contouring object
+	adaptive_dual_contouring(const cgv::math::v3_func<X,T>& _func,
+		streaming_mesh_callback_handler* _smcbh,
+		const X& _max_error = 0, const X& _relative_epsilon = 0.1f) :
+		func(_func), max_error(_max_error), relative_epsilon(_relative_epsilon)
+	{
+		base_type::set_callback_handler(_smcbh);
+	}
+	/// set the maximal quadric error of a cell that replaces its children, where 0 only merges cells without error
+	void set_max_error(const X& _max_error) { max_error = _max_error; }
+	/// return maximal quadric error of collapsed cells
+	const X& get_max_error() const { return max_error; }
+	/// return the number of cells on the given level of the last extraction, which starts at 0 for the root
+	size_t get_nr_cells(unsigned level) const { return level < levels.size() ? levels[level].size() : 0; }
+	/// return the number of leaf cells of the last extraction, which equals the number of generated vertices
+	size_t get_nr_leaves() const
+	{
+		size_t nr = 0;
+		for (const auto& L : levels)
+			for (const auto& n : L)
+				if (n.state == 1)
+					++nr;
+		return nr;
+	}
+	/// extract iso surface on a grid of 2^max_depth cells along each axis and send polygons to the callback handler
+	void extract(const T& _iso_value, const axis_aligned_box<X,3>& box, unsigned int max_depth, bool show_progress = false)
+	{
+		depth = max_depth;
+		res = 1u << depth;
+		minp = box.get_min_pnt();
+		d = box.get_extent() / X(res);
+		iso_value = _iso_value;
+		levels.clear();
+		levels.resize(depth+1);
+
+		cgv::utils::progression prog;
+		if (show_progress)
+			prog.init("adaptive extraction", depth+3, 10);
+
+		// sample the function in parallel
+		long long nr_samples_1d = res+1;
+		values.resize(size_t(nr_samples_1d*nr_samples_1d*nr_samples_1d));
+#pragma omp parallel for schedule(dynamic)
+		for (long long z = 0; z < nr_samples_1d; ++z) {
+			cgv::math::vec<X> p(3);
+			for (size_t y = 0; y <= res; ++y)
+				for (size_t x = 0; x <= res; ++x) {
+					pnt_type q = grid_point(size_t(x), size_t(y), size_t(z));
+					p(0) = q(0); p(1) = q(1); p(2) = q(2);
+					values[(size_t(z)*(res+1)+y)*(res+1)+x] = func.evaluate(p);
+				}
+		}
+		if (show_progress)
+			prog.step();
+
+		// collect finest cells with sign changes per slice and sort them by morton code
+		std::vector<std::vector<node_type> > slice_cells(res);
+#pragma omp parallel for schedule(dynamic)
+		for (long long z = 0; z < (long long)res; ++z)
+			for (unsigned y = 0; y < res; ++y)
+				for (unsigned x = 0; x < res; ++x) {
+					unsigned char signs = compute_signs(x, y, size_t(z), 1);
+					if (signs == 0 || signs == 255)
+						continue;
+					node_type n;
+					n.i = x; n.j = y; n.k = unsigned(z);
+					n.signs = signs;
+					slice_cells[size_t(z)].push_back(n);
+				}
+		std::vector<node_type>& finest = levels[depth];
+		for (auto& S : slice_cells) {
+			finest.insert(finest.end(), S.begin(), S.end());
+			std::vector<node_type>().swap(S);
+		}
+		std::vector<uint64_t> codes(finest.size());
+		std::vector<size_t> order(finest.size());
+		for (size_t ni = 0; ni < finest.size(); ++ni) {
+			codes[ni] = morton_code(finest[ni].i, finest[ni].j, finest[ni].k);
+			order[ni] = ni;
+		}
+		std::sort(order.begin(), order.end(), [&codes](size_t a, size_t b) { return codes[a] < codes[b]; });
+		{
+			std::vector<node_type> sorted(finest.size());
+			for (size_t ni = 0; ni < order.size(); ++ni)
+				sorted[ni] = finest[order[ni]];
+			finest.swap(sorted);
+		}
+		// build and minimize the quadric error metrics of the finest cells in parallel
+#pragma omp parallel for schedule(dynamic, 64)
+		for (long long ni = 0; ni < (long long)finest.size(); ++ni) {
+			node_type& n = finest[size_t(ni)];
+			std::fill(n.children, n.children+8, -1);
+			n.collapsible = true;
+			n.state = 0;
+			process_cell_edges(n);
+			solve(n, 1);
+		}
+		if (show_progress)
+			prog.step();
+
+		// build coarser levels from groups of siblings, which are consecutive in morton order
+		for (unsigned l = depth; l > 0; --l) {
+			std::vector<node_type>& fine = levels[l];
+			std::vector<node_type>& coarse = levels[l-1];
+			std::vector<size_t> group_begins;
+			for (size_t ni = 0; ni < fine.size(); ++ni) {
+				if (ni == 0 || (fine[ni].i >> 1) != (fine[ni-1].i >> 1) || (fine[ni].j >> 1) != (fine[ni-1].j >> 1) || (fine[ni].k >> 1) != (fine[ni-1].k >> 1))
+					group_begins.push_back(ni);
+			}
+			group_begins.push_back(fine.size());
+			coarse.resize(group_begins.size()-1);
+			size_t s = size_t(1) << (depth - l + 1);
+#pragma omp parallel for schedule(dynamic, 64)
+			for (long long gi = 0; gi < (long long)coarse.size(); ++gi) {
+				node_type& n = coarse[size_t(gi)];
+				const node_type& f = fine[group_begins[size_t(gi)]];
+				n.i = f.i >> 1; n.j = f.j >> 1; n.k = f.k >> 1;
+				n.signs = compute_signs(n.i*s, n.j*s, n.k*s, s);
+				n.state = 0;
+				n.parent = -1;
+				std::fill(n.children, n.children+8, -1);
+				n.Q = cgv::math::fvec<X,10>(X(0));
+				n.mass = pnt_type(0, 0, 0);
+				n.count = 0;
+				n.collapsible = true;
+				for (size_t ci = group_begins[size_t(gi)]; ci < group_begins[size_t(gi)+1]; ++ci) {
+					node_type& c = fine[ci];
+					c.parent = int(gi);
+					n.children[(c.i & 1) | ((c.j & 1) << 1) | ((c.k & 1) << 2)] = int(ci);
+					n.Q += c.Q;
+					n.mass += c.mass;
+					n.count += c.count;
+					if (!c.collapsible)
+						n.collapsible = false;
+				}
+				if (n.collapsible)
+					n.collapsible = is_topology_preserved(n.i*s, n.j*s, n.k*s, s/2);
+				if (n.collapsible) {
+					solve(n, s);
+					n.collapsible = n.error <= max_error;
+				}
+			}
+			if (show_progress)
+				prog.step();
+		}
+		if (levels[0].empty())
+			return;
+		levels[0][0].parent = -1;
+
+		// select leaves as the coarsest collapsible cells and create their vertices
+		for (unsigned l = 0; l <= depth; ++l) {
+			for (auto& n : levels[l]) {
+				unsigned char parent_state = l == 0 ? 0 : levels[l-1][n.parent].state;
+				n.state = parent_state != 0 ? 2 : (n.collapsible ? 1 : 0);
+				if (n.state != 1)
+					continue;
+				n.vertex_index = base_type::new_vertex(n.vertex);
+				cgv::math::vec<X> g = func.evaluate_gradient(n.vertex.to_vec());
+				vec_type nml(g.size(), g);
+				if (nml.length() > 1e-12)
+					nml.normalize();
+				base_type::vertex_normal(n.vertex_index) = nml;
+			}
+		}
+		// generate polygons with the recursive octree procedures
+		cell_proc(node_ref(0, 0));
+		if (show_progress)
+			prog.step();
+	}
+};
+		}
+	}
+}
@@ -103,7 +103,7 @@ typename dynamic_mesh<T>::idx_type dynamic_mesh<T>::vertex_weight_end(idx_type v
 	case vertex_weight_mode::dense:
 		return uint32_t((vi+1)*get_nr_joints());
 	case vertex_weight_mode::sparse:
-		return uint32_t(vi >= vertex_weight_index_begins.size() ? vertex_weight_data.size() : vertex_weight_index_begins[vi]);
+		return uint32_t(vi + 1 >= vertex_weight_index_begins.size() ? vertex_weight_data.size() : vertex_weight_index_begins[vi + 1]);
 	case vertex_weight_mode::fixed:
 		return uint32_t((vi+1)*max_nr_weights_per_vertex);
 	}
@@ -275,33 +275,27 @@ void dynamic_mesh<T>::lbs(const std::vector<mat4>& joint_matrices, lbs_source_mo
 		tmp = this->positions;
 	const std::vector<vec3>& P = mode == lbs_source_mode::position ? tmp : (
 		mode == lbs_source_mode::intermediate ? intermediate_positions : reference_positions);
+	int n = int(P.size());
+	unsigned nr_joints = unsigned(joint_parents.size());
 	switch (weight_mode) {
 	case vertex_weight_mode::dense:
-		for (size_t pi = 0, wi = 0; pi < P.size(); ++pi) {
+#pragma omp parallel for
+		for (int pi = 0; pi < n; ++pi) {
 			vec4 p = vec4(P[pi],1.0f);
 			vec4 q = vec4(0.0f);
-			for (unsigned ji = 0; ji < joint_parents.size(); ++ji, ++wi)
+			for (unsigned ji = 0, wi = pi * nr_joints; ji < nr_joints; ++ji, ++wi)
 				q += vertex_weight_data[wi] * (joint_matrices[ji] * p);
 			this->position(idx_type(pi)) = q;
 		}
 		break;
 	case vertex_weight_mode::sparse:
-		for (size_t pi = 0; pi < P.size(); ++pi) {
-			vec4 p = vec4(P[pi], 1.0f);
-			vec4 q = vec4(0.0f);
-			size_t beg = vertex_weight_index_begins[pi];
-			size_t end = pi+1 < P.size() ? vertex_weight_index_begins[pi+1] : vertex_weight_indices.size();
-			for (size_t wi = beg; wi < end; ++wi)
-				q += vertex_weight_data[wi] * (joint_matrices[vertex_weight_indices[wi]] * p);
-			this->position(idx_type(pi)) = q;
-		}
-		break;
 	case vertex_weight_mode::fixed:
-		for (size_t pi = 0; pi < P.size(); ++pi) {
+#pragma omp parallel for
+		for (int pi = 0; pi < n; ++pi) {
 			vec4 p = vec4(P[pi], 1.0f);
 			vec4 q = vec4(0.0f);
 			size_t beg = vertex_weight_index_begins[pi];
-			size_t end = pi + 1 < P.size() ? vertex_weight_index_begins[pi + 1] : vertex_weight_indices.size();
+			size_t end = pi + 1 < n ? vertex_weight_index_begins[pi + 1] : vertex_weight_indices.size();
 			for (size_t wi = beg; wi < end; ++wi)
 				q += vertex_weight_data[wi] * (joint_matrices[vertex_weight_indices[wi]] * p);
 			this->position(idx_type(pi)) = q;
@@ -310,6 +304,149 @@ void dynamic_mesh<T>::lbs(const std::vector<mat4>& joint_matrices, lbs_source_mo
 	}
 }
 
+template <typename T>
+void dynamic_mesh<T>::prepare_skinning(lbs_source_mode mode)
+{
+	const std::vector<vec3>& P = mode == lbs_source_mode::intermediate ? intermediate_positions : (
+		mode == lbs_source_mode::reference && !reference_positions.empty() ? reference_positions : this->positions);
+	uint32_t n = uint32_t(P.size());
+	for (int c = 0; c < 3; ++c) {
+		skin_source[c].resize(n);
+		for (uint32_t vi = 0; vi < n; ++vi)
+			skin_source[c][vi] = P[vi][c];
+	}
+	// pad nonzero vertex weights to the maximum number per vertex
+	skin_nr_slots = 0;
+	skin_joints.clear();
+	skin_weights.clear();
+	if (!vertex_weight_data.empty()) {
+		// weight range of a vertex as used by lbs()
+		uint32_t nr_joints = get_nr_joints();
+		auto weight_begin = [&](uint32_t vi) -> uint32_t {
+			return weight_mode == vertex_weight_mode::dense ? vi * nr_joints : vertex_weight_index_begins[vi]; };
+		auto weight_end = [&](uint32_t vi) -> uint32_t {
+			return weight_mode == vertex_weight_mode::dense ? (vi + 1) * nr_joints :
+				(vi + 1 < n ? vertex_weight_index_begins[vi + 1] : uint32_t(vertex_weight_indices.size())); };
+		for (uint32_t vi = 0; vi < n; ++vi) {
+			uint32_t nr_weights = 0;
+			for (uint32_t wi = weight_begin(vi); wi < weight_end(vi); ++wi)
+				if (vertex_weight_data[wi] != T(0))
+					++nr_weights;
+			skin_nr_slots = std::max(skin_nr_slots, nr_weights);
+		}
+		skin_joints.resize(size_t(n) * skin_nr_slots, 0);
+		skin_weights.resize(size_t(n) * skin_nr_slots, T(0));
+		for (uint32_t vi = 0; vi < n; ++vi) {
+			size_t si = size_t(vi) * skin_nr_slots;
+			uint32_t beg = weight_begin(vi);
+			for (uint32_t wi = beg; wi < weight_end(vi); ++wi)
+				if (vertex_weight_data[wi] != T(0)) {
+					skin_joints[si] = weight_mode == vertex_weight_mode::dense ? wi - beg : vertex_weight_indices[wi];
+					skin_weights[si++] = vertex_weight_data[wi];
+				}
+		}
+	}
+	// transpose blend shapes into per vertex lists of nonzero offsets with a counting sort over the vertices
+	std::vector<std::pair<uint32_t, uint32_t> > entries;
+	for (uint32_t bi = 0; bi < uint32_t(blend_shapes.size()); ++bi) {
+		const auto& bs = blend_shapes[bi];
+		switch (bs.mode) {
+		case blend_shape_mode::direct:
+			for (uint32_t i = bs.blend_shape_data_range[0], vi = 0; i < bs.blend_shape_data_range[1] && vi < n; ++i, ++vi)
+				entries.push_back(std::make_pair(vi, i));
+			break;
+		case blend_shape_mode::indexed:
+			for (uint32_t i = bs.blend_shape_data_range[0], j = bs.blend_shape_index_range[0]; i < bs.blend_shape_data_range[1]; ++i, ++j)
+				entries.push_back(std::make_pair(blend_shape_indices[j], i));
+			break;
+		case blend_shape_mode::range_indexed:
+			for (uint32_t i = bs.blend_shape_data_range[0], j = bs.blend_shape_index_range[0]; j < bs.blend_shape_index_range[1]; j += 2)
+				for (uint32_t k = blend_shape_indices[j]; k < blend_shape_indices[j + 1]; ++k, ++i)
+					entries.push_back(std::make_pair(k, i));
+			break;
+		}
+	}
+	std::vector<uint32_t> data_to_shape(blend_shape_data.size(), 0);
+	for (uint32_t bi = 0; bi < uint32_t(blend_shapes.size()); ++bi)
+		for (uint32_t i = blend_shapes[bi].blend_shape_data_range[0]; i < blend_shapes[bi].blend_shape_data_range[1]; ++i)
+			data_to_shape[i] = bi;
+	skin_blend_shape_begins.assign(n + 1, 0);
+	for (const auto& e : entries)
+		if (e.first < n && blend_shape_data[e.second] != vec3(T(0)))
+			++skin_blend_shape_begins[e.first + 1];
+	for (uint32_t vi = 0; vi < n; ++vi)
+		skin_blend_shape_begins[vi + 1] += skin_blend_shape_begins[vi];
+	skin_blend_shape_indices.resize(skin_blend_shape_begins[n]);
+	skin_blend_shape_offsets.resize(3 * size_t(skin_blend_shape_begins[n]));
+	std::vector<uint32_t> fill(skin_blend_shape_begins.begin(), skin_blend_shape_begins.end() - 1);
+	for (const auto& e : entries) {
+		if (e.first >= n || blend_shape_data[e.second] == vec3(T(0)))
+			continue;
+		uint32_t ei = fill[e.first]++;
+		skin_blend_shape_indices[ei] = data_to_shape[e.second];
+		for (int c = 0; c < 3; ++c)
+			skin_blend_shape_offsets[3 * size_t(ei) + c] = blend_shape_data[e.second][c];
+	}
+}
+
+template <typename T>
+void dynamic_mesh<T>::skin(const std::vector<T>& blend_shape_weights, const std::vector<mat4>& joint_matrices,
+	idx_type blend_shape_offset, bool store_intermediate)
+{
+	assert(is_skinning_prepared());
+	int n = int(skin_source[0].size());
+	// weights of all blend shapes avoid range checks in the inner loop
+	std::vector<T> W(blend_shapes.size(), T(0));
+	for (size_t wi = 0; wi < blend_shape_weights.size() && blend_shape_offset + wi < W.size(); ++wi)
+		W[blend_shape_offset + wi] = blend_shape_weights[wi];
+	// upper 3x4 part of joint matrices in row major order, such that blending is a contiguous loop over 12 values
+	std::vector<T> J(12 * joint_matrices.size());
+	for (size_t ji = 0; ji < joint_matrices.size(); ++ji)
+		for (unsigned r = 0; r < 3; ++r)
+			for (unsigned c = 0; c < 4; ++c)
+				J[12 * ji + 4 * r + c] = joint_matrices[ji](r, c);
+	bool apply_skinning = skin_nr_slots > 0 && !joint_matrices.empty();
+	this->positions.resize(n);
+	if (store_intermediate)
+		intermediate_positions.resize(n);
+	// process contiguous vertex ranges per thread
+	const int range_size = 1024;
+	int nr_ranges = (n + range_size - 1) / range_size;
+#pragma omp parallel for
+	for (int ri = 0; ri < nr_ranges; ++ri) {
+		int end = std::min(n, (ri + 1) * range_size);
+		for (int vi = ri * range_size; vi < end; ++vi) {
+			T p[3] = { skin_source[0][vi], skin_source[1][vi], skin_source[2][vi] };
+			for (uint32_t ei = skin_blend_shape_begins[vi]; ei < skin_blend_shape_begins[vi + 1]; ++ei) {
+				T w = W[skin_blend_shape_indices[ei]];
+				const T* o = &skin_blend_shape_offsets[3 * size_t(ei)];
+				p[0] += w * o[0];
+				p[1] += w * o[1];
+				p[2] += w * o[2];
+			}
+			if (store_intermediate)
+				intermediate_positions[vi] = vec3(p[0], p[1], p[2]);
+			if (!apply_skinning) {
+				this->positions[vi] = vec3(p[0], p[1], p[2]);
+				continue;
+			}
+			T M[12] = { 0 };
+			const uint32_t* joints = &skin_joints[size_t(vi) * skin_nr_slots];
+			const T* weights = &skin_weights[size_t(vi) * skin_nr_slots];
+			for (uint32_t si = 0; si < skin_nr_slots; ++si) {
+				const T* Jk = &J[12 * size_t(joints[si])];
+				T w = weights[si];
+				for (int i = 0; i < 12; ++i)
+					M[i] += w * Jk[i];
+			}
+			this->positions[vi] = vec3(
+				M[0] * p[0] + M[1] * p[1] + M[2] * p[2] + M[3],
+				M[4] * p[0] + M[5] * p[1] + M[6] * p[2] + M[7],
+				M[8] * p[0] + M[9] * p[1] + M[10] * p[2] + M[11]);
+		}
+	}
+}
+
 template class dynamic_mesh<float>;
 template class dynamic_mesh<double>;
 
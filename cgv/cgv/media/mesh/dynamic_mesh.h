@@ -90,6 +90,22 @@ protected:
 	std::vector<uint32_t> vertex_weight_indices;
 	/// for each vertex the first index in vertex_weight_data and vertex_weight_indices
 	std::vector<uint32_t> vertex_weight_index_begins;
+
+	/**@name structure of arrays layout used by skin() */
+	//@{
+	/// x, y and z coordinates of the source positions in separate arrays
+	std::vector<T> skin_source[3];
+	/// number of weight slots per vertex, which is the maximum number of nonzero weights of a vertex
+	uint32_t skin_nr_slots = 0;
+	/// per vertex skin_nr_slots joint indices and weights, where unused slots have weight zero
+	std::vector<uint32_t> skin_joints;
+	std::vector<T> skin_weights;
+	/// per vertex the first entry of its blend shape offsets, which are stored in vertex major order
+	std::vector<uint32_t> skin_blend_shape_begins;
+	/// per blend shape entry the blend shape index and the three coordinates of the offset vector
+	std::vector<uint32_t> skin_blend_shape_indices;
+	std::vector<T> skin_blend_shape_offsets;
+	//@}
 public:
 	/**@name additional positional attributes */
 	//@{
@@ -180,6 +196,28 @@ public:
 	/*! the joint matrices define per joint the transformation from reference positions or intermediate positions.*/
 	void lbs(const std::vector<mat4>& joint_matrices, lbs_source_mode mode);
 	//@}
+
+	/**@name fused blend shapes and skinning */
+	//@{
+	/// @brief Convert source positions, blend shapes and vertex weights into the layout used by skin().
+	/// The source positions are stored as separate coordinate arrays, the blend shapes are transposed to a per vertex
+	/// list of nonzero offsets and the vertex weights are padded to a fixed number of slots per vertex. Call again
+	/// after any of them changed.
+	/// @param[in] mode which positions are used as source, where reference falls back to the current positions if no reference positions are stored
+	void prepare_skinning(lbs_source_mode mode = lbs_source_mode::reference);
+	/// @brief Check whether prepare_skinning() has been called.
+	bool is_skinning_prepared() const { return !skin_blend_shape_begins.empty(); }
+	/// @brief Apply blend shapes and linear blend skinning in one parallel pass over the layout built by prepare_skinning().
+	/// Per vertex the blend shape offsets are added to the source position, the joint matrices are blended with the
+	/// vertex weights and the blended matrix transforms the position. The result is the same as apply_blend_shapes()
+	/// followed by lbs() on the intermediate positions.
+	/// @param[in] blend_shape_weights weights of the blend shapes starting at blend_shape_offset, all other blend shapes have weight zero
+	/// @param[in] joint_matrices per joint transformation, if empty only the blend shapes are applied
+	/// @param[in] blend_shape_offset index of the blend shape that corresponds to the first weight
+	/// @param[in] store_intermediate whether to also store the positions after applying the blend shapes in the intermediate positions
+	void skin(const std::vector<T>& blend_shape_weights, const std::vector<mat4>& joint_matrices,
+		idx_type blend_shape_offset = 0, bool store_intermediate = false);
+	//@}
 };
 		}
 	}
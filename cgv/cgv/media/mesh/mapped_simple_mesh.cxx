@@ -0,0 +1,389 @@
+#include "mapped_simple_mesh.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+#ifdef WIN32
+#pragma warning(disable:4996)
+#endif
+
+using namespace cgv::type;
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+namespace {
+	/// helper to write zero bytes up to the next multiple of the alignment
+	bool pad_to(FILE* fp, uint64_type& pos, uint64_type alignment)
+	{
+		static const char zeros[4096] = { 0 };
+		uint64_type n = (alignment - pos % alignment) % alignment;
+		pos += n;
+		while (n > 0) {
+			size_t m = size_t(n < sizeof(zeros) ? n : sizeof(zeros));
+			if (fwrite(zeros, 1, m, fp) != m)
+				return false;
+			n -= m;
+		}
+		return true;
+	}
+	/// checksum over the header with the checksum field set to zero
+	uint64_type compute_header_checksum(const msm_header& h)
+	{
+		msm_header tmp = h;
+		tmp.header_checksum = 0;
+		return mapped_simple_mesh::compute_checksum(&tmp, sizeof(msm_header));
+	}
+	/// append plain old data to byte stream
+	template <typename T>
+	void put(std::vector<char>& bytes, const T& value)
+	{
+		const char* p = reinterpret_cast<const char*>(&value);
+		bytes.insert(bytes.end(), p, p + sizeof(T));
+	}
+	/// append length prefixed string to byte stream
+	void put_string(std::vector<char>& bytes, const std::string& s)
+	{
+		put(bytes, uint32_type(s.size()));
+		bytes.insert(bytes.end(), s.begin(), s.end());
+	}
+	/// sequential reader of a byte stream that stops at the end of the stream
+	struct byte_reader
+	{
+		const char* ptr;
+		const char* end;
+		byte_reader(const void* data, size_t size) : ptr(static_cast<const char*>(data)), end(ptr + size) {}
+		template <typename T>
+		T get() {
+			T value = T();
+			if (end - ptr >= ptrdiff_t(sizeof(T))) {
+				std::memcpy(&value, ptr, sizeof(T));
+				ptr += sizeof(T);
+			}
+			return value;
+		}
+		std::string get_string() {
+			size_t n = get<uint32_type>();
+			if (ptrdiff_t(n) > end - ptr)
+				n = size_t(end - ptr);
+			std::string s(ptr, n);
+			ptr += n;
+			return s;
+		}
+	};
+	typedef illum::surface_material::color_type color_type;
+	void put_color(std::vector<char>& bytes, const color_type& c)
+	{
+		for (unsigned i = 0; i < 3; ++i)
+			put(bytes, c[i]);
+	}
+	color_type get_color(byte_reader& r)
+	{
+		color_type c;
+		for (unsigned i = 0; i < 3; ++i)
+			c[i] = r.get<float>();
+		return c;
+	}
+}
+
+mapped_simple_mesh::mapped_simple_mesh() : header(0)
+{
+}
+
+mapped_simple_mesh::mapped_simple_mesh(const std::string& file_name) : header(0)
+{
+	open(file_name);
+}
+
+bool mapped_simple_mesh::open(const std::string& file_name)
+{
+	close();
+	if (!file.open(file_name))
+		return false;
+	if (file.get_size() < sizeof(msm_header)) {
+		std::cerr << "mapped_simple_mesh::open(" << file_name << "): file too small" << std::endl;
+		file.close();
+		return false;
+	}
+	const msm_header* h = file.get_pointer<msm_header>(0);
+	if (h->magic != MSM_MAGIC || h->version != MSM_VERSION || h->header_size != sizeof(msm_header) ||
+		h->alignment == 0 || h->header_checksum != compute_header_checksum(*h)) {
+		std::cerr << "mapped_simple_mesh::open(" << file_name << "): invalid header or unsupported version" << std::endl;
+		file.close();
+		return false;
+	}
+	// validate that all sections lie inside of the file, where the sums and products of the 64 bit header
+	// fields are only formed after checking that they cannot overflow
+	uint64_type file_size = file.get_size();
+	for (unsigned si = 0; si < MSM_NR_SECTION_TYPES; ++si) {
+		const msm_section& s = h->sections[si];
+		if (s.count == 0)
+			continue;
+		bool valid = s.offset <= file_size && s.size <= file_size - s.offset && s.offset % h->alignment == 0;
+		if (si == MSM_GROUP_NAMES || si == MSM_MATERIALS)
+			// each entry starts with the 32 bit length of its name
+			valid = valid && s.count <= s.size / sizeof(uint32_type);
+		else
+			valid = valid && s.element_size != 0 && s.count <= s.size / s.element_size && s.size == s.count * s.element_size;
+		if (!valid) {
+			std::cerr << "mapped_simple_mesh::open(" << file_name << "): section " << si << " out of file bounds" << std::endl;
+			file.close();
+			return false;
+		}
+	}
+	header = h;
+	return true;
+}
+
+void mapped_simple_mesh::close()
+{
+	header = 0;
+	file.close();
+}
+
+const msm_section* mapped_simple_mesh::get_section(MSMSectionType st) const
+{
+	if (!header || st >= MSM_NR_SECTION_TYPES)
+		return 0;
+	const msm_section& s = header->sections[st];
+	return s.count > 0 ? &s : 0;
+}
+
+const void* mapped_simple_mesh::get_section_data(MSMSectionType st) const
+{
+	const msm_section* s = get_section(st);
+	return s ? file.get_data() + s->offset : 0;
+}
+
+void mapped_simple_mesh::advise(MSMSectionType st, cgv::utils::mapped_file::AccessHint hint) const
+{
+	const msm_section* s = get_section(st);
+	if (s)
+		file.advise(hint, size_t(s->offset), size_t(s->size));
+}
+
+bool mapped_simple_mesh::verify() const
+{
+	if (!header)
+		return false;
+	int nr_failures = 0;
+#pragma omp parallel for reduction(+:nr_failures)
+	for (int si = 0; si < int(MSM_NR_SECTION_TYPES); ++si) {
+		const msm_section* s = get_section(MSMSectionType(si));
+		if (s && compute_checksum(file.get_data() + s->offset, size_t(s->size)) != s->checksum)
+			++nr_failures;
+	}
+	return nr_failures == 0;
+}
+
+void mapped_simple_mesh::extract_group_names(std::vector<std::string>& group_names) const
+{
+	group_names.clear();
+	const msm_section* s = get_section(MSM_GROUP_NAMES);
+	if (!s)
+		return;
+	byte_reader r(get_section_data(MSM_GROUP_NAMES), size_t(s->size));
+	for (uint64_type i = 0; i < s->count; ++i)
+		group_names.push_back(r.get_string());
+}
+
+void mapped_simple_mesh::extract_materials(std::vector<mat_type>& materials) const
+{
+	materials.clear();
+	const msm_section* s = get_section(MSM_MATERIALS);
+	if (!s)
+		return;
+	byte_reader r(get_section_data(MSM_MATERIALS), size_t(s->size));
+	for (uint64_type i = 0; i < s->count; ++i) {
+		mat_type m;
+		m.set_name(r.get_string());
+		m.set_brdf_type(illum::BrdfType(r.get<int32_type>()));
+		m.set_diffuse_reflectance(get_color(r));
+		m.set_roughness(r.get<float>());
+		m.set_metalness(r.get<float>());
+		m.set_ambient_occlusion(r.get<float>());
+		m.set_emission(get_color(r));
+		m.set_transparency(r.get<float>());
+		float re = r.get<float>();
+		m.set_propagation_slow_down(std::complex<float>(re, r.get<float>()));
+		m.set_roughness_anisotropy(r.get<float>());
+		m.set_roughness_orientation(r.get<float>());
+		m.set_specular_reflectance(get_color(r));
+		m.set_sRGBA_textures(r.get<uint8_type>() != 0);
+		uint32_type nr_images = r.get<uint32_type>();
+		for (uint32_type j = 0; j < nr_images; ++j)
+			m.add_image_file(r.get_string());
+		m.set_diffuse_index(r.get<int32_type>());
+		m.set_roughness_index(r.get<int32_type>());
+		m.set_metalness_index(r.get<int32_type>());
+		m.set_ambient_index(r.get<int32_type>());
+		m.set_emission_index(r.get<int32_type>());
+		m.set_transparency_index(r.get<int32_type>());
+		m.set_specular_index(r.get<int32_type>());
+		m.set_normal_index(r.get<int32_type>());
+		m.set_bump_index(r.get<int32_type>());
+		m.set_bump_scale(r.get<float>());
+		materials.push_back(m);
+	}
+}
+
+void mapped_simple_mesh::encode_octahedral(const float n[3], int16_type q[2])
+{
+	float l1 = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+	float x = 0, y = 0;
+	if (l1 > 0) {
+		x = n[0] / l1;
+		y = n[1] / l1;
+		// fold lower hemisphere over the diagonals
+		if (n[2] < 0) {
+			float fx = (1 - std::abs(y)) * (x < 0 ? -1.0f : 1.0f);
+			float fy = (1 - std::abs(x)) * (y < 0 ? -1.0f : 1.0f);
+			x = fx;
+			y = fy;
+		}
+	}
+	q[0] = int16_type(std::floor(x * 32767.0f + 0.5f));
+	q[1] = int16_type(std::floor(y * 32767.0f + 0.5f));
+}
+
+void mapped_simple_mesh::decode_octahedral(const int16_type q[2], float n[3])
+{
+	float x = std::max(-1.0f, q[0] / 32767.0f);
+	float y = std::max(-1.0f, q[1] / 32767.0f);
+	float z = 1 - std::abs(x) - std::abs(y);
+	if (z < 0) {
+		float fx = (1 - std::abs(y)) * (x < 0 ? -1.0f : 1.0f);
+		float fy = (1 - std::abs(x)) * (y < 0 ? -1.0f : 1.0f);
+		x = fx;
+		y = fy;
+	}
+	float l = std::sqrt(x * x + y * y + z * z);
+	n[0] = x / l;
+	n[1] = y / l;
+	n[2] = z / l;
+}
+
+uint64_type mapped_simple_mesh::compute_checksum(const void* data, size_t size)
+{
+	// FNV-1a variant that consumes 64 bit words with an additional shift to mix high bits back
+	const uint64_type prime = 0x100000001b3ULL;
+	uint64_type h = 0xcbf29ce484222325ULL ^ size;
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	size_t n = size / 8;
+	for (size_t i = 0; i < n; ++i) {
+		uint64_type w;
+		std::memcpy(&w, p + 8 * i, 8);
+		h = (h ^ w) * prime;
+		h ^= h >> 32;
+	}
+	for (size_t i = 8 * n; i < size; ++i)
+		h = (h ^ p[i]) * prime;
+	return h;
+}
+
+void mapped_simple_mesh::encode_group_names(const std::vector<std::string>& group_names, std::vector<char>& bytes)
+{
+	bytes.clear();
+	for (const auto& name : group_names)
+		put_string(bytes, name);
+}
+
+void mapped_simple_mesh::encode_materials(const std::vector<mat_type>& materials, std::vector<char>& bytes)
+{
+	bytes.clear();
+	for (const auto& m : materials) {
+		put_string(bytes, m.get_name());
+		put(bytes, int32_type(m.get_brdf_type()));
+		put_color(bytes, m.get_diffuse_reflectance());
+		put(bytes, m.get_roughness());
+		put(bytes, m.get_metalness());
+		put(bytes, m.get_ambient_occlusion());
+		put_color(bytes, m.get_emission());
+		put(bytes, m.get_transparency());
+		put(bytes, m.get_propagation_slow_down().real());
+		put(bytes, m.get_propagation_slow_down().imag());
+		put(bytes, m.get_roughness_anisotropy());
+		put(bytes, m.get_roughness_orientation());
+		put_color(bytes, m.get_specular_reflectance());
+		put(bytes, uint8_type(m.get_sRGBA_textures() ? 1 : 0));
+		put(bytes, uint32_type(m.get_nr_image_files()));
+		for (unsigned j = 0; j < m.get_nr_image_files(); ++j)
+			put_string(bytes, m.get_image_file_name(j));
+		put(bytes, int32_type(m.get_diffuse_index()));
+		put(bytes, int32_type(m.get_roughness_index()));
+		put(bytes, int32_type(m.get_metalness_index()));
+		put(bytes, int32_type(m.get_ambient_index()));
+		put(bytes, int32_type(m.get_emission_index()));
+		put(bytes, int32_type(m.get_transparency_index()));
+		put(bytes, int32_type(m.get_specular_index()));
+		put(bytes, int32_type(m.get_normal_index()));
+		put(bytes, int32_type(m.get_bump_index()));
+		put(bytes, m.get_bump_scale());
+	}
+}
+
+bool mapped_simple_mesh::write(const std::string& file_name, msm_header& h, const void* const data[MSM_NR_SECTION_TYPES])
+{
+	// layout header and sections
+	h.magic = MSM_MAGIC;
+	h.version = MSM_VERSION;
+	h.header_size = sizeof(msm_header);
+	h.alignment = MSM_SECTION_ALIGNMENT;
+	uint64_type offset = MSM_SECTION_ALIGNMENT;
+	for (unsigned si = 0; si < MSM_NR_SECTION_TYPES; ++si) {
+		msm_section& s = h.sections[si];
+		if (!data[si])
+			s.count = 0;
+		// the byte streams of names and materials count entries and provide their size in bytes
+		if (si == MSM_GROUP_NAMES || si == MSM_MATERIALS) {
+			s.element_size = 1;
+			if (s.count == 0)
+				s.size = 0;
+		}
+		else
+			s.size = s.count * s.element_size;
+		s.offset = s.count > 0 ? offset : 0;
+		offset += s.size;
+		offset += (MSM_SECTION_ALIGNMENT - offset % MSM_SECTION_ALIGNMENT) % MSM_SECTION_ALIGNMENT;
+	}
+#pragma omp parallel for
+	for (int si = 0; si < int(MSM_NR_SECTION_TYPES); ++si) {
+		msm_section& s = h.sections[si];
+		s.checksum = s.count > 0 ? compute_checksum(data[si], size_t(s.size)) : 0;
+	}
+	h.header_checksum = compute_header_checksum(h);
+
+	// write header and sections in order of increasing offset
+	FILE* fp = fopen(file_name.c_str(), "wb");
+	if (!fp)
+		return false;
+	uint64_type pos = sizeof(msm_header);
+	bool success = fwrite(&h, sizeof(msm_header), 1, fp) == 1;
+	for (unsigned si = 0; success && si < MSM_NR_SECTION_TYPES; ++si) {
+		const msm_section& s = h.sections[si];
+		if (s.count == 0)
+			continue;
+		success = pad_to(fp, pos, MSM_SECTION_ALIGNMENT);
+		// write in blocks to stay below the size_t limits of 32 bit fwrite implementations
+		const char* ptr = static_cast<const char*>(data[si]);
+		uint64_type remaining = s.size;
+		while (success && remaining > 0) {
+			size_t m = size_t(remaining < (uint64_type(1) << 30) ? remaining : (uint64_type(1) << 30));
+			success = fwrite(ptr, 1, m, fp) == m;
+			ptr += m;
+			remaining -= m;
+		}
+		pos += s.size;
+	}
+	success = fclose(fp) == 0 && success;
+	if (!success)
+		std::remove(file_name.c_str());
+	return success;
+}
+
+		}
+	}
+}
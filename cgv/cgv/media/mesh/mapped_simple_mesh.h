@@ -0,0 +1,177 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cgv/type/standard_types.h>
+#include <cgv/utils/mapped_file.h>
+#include <cgv/media/illum/textured_surface_material.h>
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+/**@name mapped simple mesh format (*.msm) */
+//@{
+/// identifiers of the independently addressable sections of a mapped simple mesh file
+enum MSMSectionType
+{
+	MSM_POSITIONS,
+	MSM_NORMALS,
+	MSM_TANGENTS,
+	MSM_TEX_COORDS,
+	MSM_COLORS,
+	MSM_POSITION_INDICES,
+	MSM_NORMAL_INDICES,
+	MSM_TANGENT_INDICES,
+	MSM_TEX_COORD_INDICES,
+	MSM_FACES,
+	MSM_GROUP_INDICES,
+	MSM_MATERIAL_INDICES,
+	MSM_GROUP_NAMES,
+	MSM_MATERIALS,
+	MSM_QUANTIZED_POSITIONS,
+	MSM_QUANTIZED_NORMALS,
+	MSM_UNIQUE_TUPLES,
+	MSM_TRIANGLES,
+	MSM_EDGES,
+	MSM_MATERIAL_GROUP_STARTS,
+	MSM_NR_SECTION_TYPES
+};
+
+/// flags of the unique tuple section telling which attributes have been merged into the vertices of the element buffers
+enum MSMTupleFlags
+{
+	MSM_TUPLES_INCLUDE_TEX_COORDS = 1,
+	MSM_TUPLES_INCLUDE_NORMALS = 2,
+	MSM_TUPLES_INCLUDE_TANGENTS = 4
+};
+
+/// flags of the triangle section
+enum MSMTriangleFlags
+{
+	/// triangles and unique tuples have been reordered with simple_mesh_base::optimize_element_buffers()
+	MSM_TRIANGLES_VERTEX_CACHE_OPTIMIZED = 1
+};
+
+/// magic number "MSM\0" at the beginning of each mapped simple mesh file
+const cgv::type::uint32_type MSM_MAGIC = 0x004D534D;
+/// current version of the mapped simple mesh format
+const cgv::type::uint32_type MSM_VERSION = 1;
+/// alignment of the sections in bytes, which is a multiple of the page size on all supported platforms
+const cgv::type::uint32_type MSM_SECTION_ALIGNMENT = 4096;
+
+/// description of one section, an empty section has count zero
+struct msm_section
+{
+	/// size of one element in bytes
+	cgv::type::uint32_type element_size;
+	/// per section flags, color type for colors, MSMTupleFlags for unique tuples and MSMTriangleFlags for triangles
+	cgv::type::uint32_type flags;
+	/// byte offset of the section from the beginning of the file, multiple of the header alignment
+	cgv::type::uint64_type offset;
+	/// number of elements
+	cgv::type::uint64_type count;
+	/// size in bytes of the section data
+	cgv::type::uint64_type size;
+	/// checksum of the section data as computed by mapped_simple_mesh::compute_checksum
+	cgv::type::uint64_type checksum;
+};
+
+/// fixed size header at the beginning of each mapped simple mesh file
+struct msm_header
+{
+	cgv::type::uint32_type magic;
+	cgv::type::uint32_type version;
+	cgv::type::uint32_type header_size;
+	cgv::type::uint32_type alignment;
+	/// size and last write time of the file the mesh has been created from or zero, used to validate caches
+	cgv::type::uint64_type source_size;
+	cgv::type::int64_type  source_write_time;
+	/// number of groups and materials stored in the name and material sections
+	cgv::type::uint32_type nr_groups;
+	cgv::type::uint32_type nr_materials;
+	/// minimum and maximum point of the box used to quantize positions
+	float quantization_box[6];
+	/// checksum over the header with this field set to zero
+	cgv::type::uint64_type header_checksum;
+	msm_section sections[MSM_NR_SECTION_TYPES];
+};
+//@}
+
+/** read-only view onto a simple mesh stored in the mapped simple mesh format (*.msm).
+
+	Opening a file only maps it and validates the header and its checksum, such that
+	opening returns immediately independent of the mesh size. All sections are aligned
+	to MSM_SECTION_ALIGNMENT and can be accessed or uploaded to the GPU directly from the
+	mapping. Besides the attribute and index arrays of simple_mesh, the file can contain
+	16 bit quantized positions, octahedral encoded normals and the element buffers that
+	mesh_render_info would compute from the mesh. The section checksums are only tested
+	in verify() to keep opening fast. Files are written with simple_mesh::write(*.msm),
+	which is also used by simple_mesh::read(*.obj) to cache obj files on request. */
+class CGV_API mapped_simple_mesh
+{
+public:
+	/// material type of simple_mesh
+	typedef illum::textured_surface_material mat_type;
+protected:
+	cgv::utils::mapped_file file;
+	const msm_header* header;
+public:
+	/// construct without file
+	mapped_simple_mesh();
+	/// construct and open file
+	mapped_simple_mesh(const std::string& file_name);
+	/// map file and validate header and section table
+	bool open(const std::string& file_name);
+	/// unmap file
+	void close();
+	/// check whether a file is mapped
+	bool is_open() const { return header != 0; }
+	/// return the header of the mapped file or null if no file is open
+	const msm_header* get_header() const { return header; }
+	/// return section descriptor or null if section is not present
+	const msm_section* get_section(MSMSectionType st) const;
+	/// return pointer to the raw bytes of a section or null if section is not present
+	const void* get_section_data(MSMSectionType st) const;
+	/// return typed pointer to section or null if section is not present or element size does not match
+	template <typename T>
+	const T* get_section_pointer(MSMSectionType st) const {
+		const msm_section* s = get_section(st);
+		if (!s || s->element_size != sizeof(T))
+			return 0;
+		return file.get_pointer<T>(size_t(s->offset));
+	}
+	/// give the operating system a hint how a section will be accessed
+	void advise(MSMSectionType st, cgv::utils::mapped_file::AccessHint hint) const;
+	/// recompute the checksums of all sections in parallel and compare them to the stored ones
+	bool verify() const;
+	/// decode the group names section
+	void extract_group_names(std::vector<std::string>& group_names) const;
+	/// decode the materials section
+	void extract_materials(std::vector<mat_type>& materials) const;
+
+	/// encode unit normal in octahedral mapping with 16 bit signed normalized coordinates
+	static void encode_octahedral(const float n[3], cgv::type::int16_type q[2]);
+	/// decode normal from octahedral mapping
+	static void decode_octahedral(const cgv::type::int16_type q[2], float n[3]);
+	/// 64 bit checksum of a byte range
+	static cgv::type::uint64_type compute_checksum(const void* data, size_t size);
+	/// serialize group names into a byte stream
+	static void encode_group_names(const std::vector<std::string>& group_names, std::vector<char>& bytes);
+	/// serialize materials into a byte stream
+	static void encode_materials(const std::vector<mat_type>& materials, std::vector<char>& bytes);
+	/** write a mapped simple mesh file. The header must provide source information, group and material counts
+	    and the quantization box. For each section, element_size, flags and count must be set and data points
+		to the section content, empty sections have count zero or a null pointer. For the byte streams of group
+		names and materials count is the number of entries and size the number of bytes. All other sizes,
+		offsets and checksums are computed. */
+	static bool write(const std::string& file_name, msm_header& header, const void* const data[MSM_NR_SECTION_TYPES]);
+};
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
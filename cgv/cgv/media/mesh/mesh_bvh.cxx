@@ -0,0 +1,615 @@
+#include "mesh_bvh.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+namespace {
+	/// depth from which nodes are split at the median to bound the depth of the hierarchy
+	const unsigned max_sah_depth = 64;
+	/// size of the traversal stacks, which covers max_sah_depth plus the depth of median splits
+	const unsigned stack_size = 128;
+	/// maximal number of bins per axis
+	const unsigned max_nr_bins = 64;
+	/// number of triangles from which bounds and bins of a node are computed in parallel in chunks of this size
+	const uint32_t parallel_threshold = 1 << 14;
+
+	/// extend bounds of triangles and triangle centers by the triangles in the range [begin,end) of prims
+	template <typename T>
+	void accumulate_bounds(const uint32_t* prims, uint32_t begin, uint32_t end, const cgv::math::fvec<T, 3>* box_mins, const cgv::math::fvec<T, 3>* box_maxs, 
+		const cgv::math::fvec<T, 3>* centers, cgv::math::fvec<T, 3>* bounds)
+	{
+		for (uint32_t i = begin; i < end; ++i) {
+			uint32_t ti = prims[i];
+			for (int a = 0; a < 3; ++a) {
+				bounds[0][a] = std::min(bounds[0][a], box_mins[ti][a]);
+				bounds[1][a] = std::max(bounds[1][a], box_maxs[ti][a]);
+				bounds[2][a] = std::min(bounds[2][a], centers[ti][a]);
+				bounds[3][a] = std::max(bounds[3][a], centers[ti][a]);
+			}
+		}
+	}
+	/// sort the triangles in the range [begin,end) of prims into B bins per axis with non zero extent of the centers
+	template <typename T>
+	void accumulate_bins(const uint32_t* prims, uint32_t begin, uint32_t end, const cgv::math::fvec<T, 3>* box_mins, const cgv::math::fvec<T, 3>* box_maxs,
+		const cgv::math::fvec<T, 3>* centers, const cgv::math::fvec<T, 3>& cmn, const cgv::math::fvec<T, 3>& ext, unsigned B, 
+		uint32_t* bin_counts, cgv::math::fvec<T, 3>* bin_mins, cgv::math::fvec<T, 3>* bin_maxs)
+	{
+		for (uint32_t i = begin; i < end; ++i) {
+			uint32_t ti = prims[i];
+			for (int a = 0; a < 3; ++a) {
+				if (ext[a] <= 0)
+					continue;
+				unsigned bi = a * B + std::min(B - 1, unsigned((centers[ti][a] - cmn[a]) * B / ext[a]));
+				++bin_counts[bi];
+				for (int c = 0; c < 3; ++c) {
+					bin_mins[bi][c] = std::min(bin_mins[bi][c], box_mins[ti][c]);
+					bin_maxs[bi][c] = std::max(bin_maxs[bi][c], box_maxs[ti][c]);
+				}
+			}
+		}
+	}
+
+	template <typename T>
+	T box_area(const cgv::math::fvec<T, 3>& mn, const cgv::math::fvec<T, 3>& mx)
+	{
+		cgv::math::fvec<T, 3> e = mx - mn;
+		return e[0] < 0 ? T(0) : T(2) * (e[0] * e[1] + e[1] * e[2] + e[2] * e[0]);
+	}
+	/// return entry parameter of ray into box or infinity if the ray misses the box within [t_min,t_max]
+	template <typename T>
+	T box_entry(const typename mesh_bvh<T>::node& n, const cgv::math::fvec<T, 3>& o, const cgv::math::fvec<T, 3>& inv_d, T t_min, T t_max)
+	{
+		for (int a = 0; a < 3; ++a) {
+			T t0 = (n.box_min[a] - o[a]) * inv_d[a];
+			T t1 = (n.box_max[a] - o[a]) * inv_d[a];
+			if (t0 > t1)
+				std::swap(t0, t1);
+			t_min = std::max(t_min, t0);
+			t_max = std::min(t_max, t1);
+		}
+		return t_min <= t_max ? t_min : std::numeric_limits<T>::infinity();
+	}
+	/// invert direction such that zero components result in large values of the correct sign
+	template <typename T>
+	cgv::math::fvec<T, 3> invert_direction(const cgv::math::fvec<T, 3>& d)
+	{
+		cgv::math::fvec<T, 3> inv_d;
+		for (int a = 0; a < 3; ++a)
+			inv_d[a] = d[a] != 0 ? T(1) / d[a] : (std::signbit(d[a]) ? -std::numeric_limits<T>::max() : std::numeric_limits<T>::max());
+		return inv_d;
+	}
+}
+
+template <typename T>
+mesh_bvh<T>::mesh_bvh() : nr_bins(16), max_leaf_size(8), traversal_cost(1)
+{
+}
+
+template <typename T>
+void mesh_bvh<T>::clear()
+{
+	nodes.clear();
+	triangle_indices.clear();
+	triangle_faces.clear();
+	leaf_triangles.clear();
+	triangle_data.clear();
+}
+
+template <typename T>
+void mesh_bvh<T>::build(const simple_mesh<T>& mesh)
+{
+	std::vector<idx_type> tris, faces;
+	for (idx_type fi = 0; fi < mesh.get_nr_faces(); ++fi) {
+		idx_type c0 = mesh.begin_corner(fi);
+		for (idx_type ci = c0 + 1; ci + 1 < mesh.end_corner(fi); ++ci) {
+			tris.push_back(mesh.c2p(c0));
+			tris.push_back(mesh.c2p(ci));
+			tris.push_back(mesh.c2p(ci + 1));
+			faces.push_back(fi);
+		}
+	}
+	build(mesh.get_positions(), tris, &faces);
+}
+
+template <typename T>
+void mesh_bvh<T>::build(const std::vector<vec3>& positions, const std::vector<idx_type>& _triangle_indices, const std::vector<idx_type>* face_indices)
+{
+	clear();
+	uint32_t n = uint32_t(_triangle_indices.size() / 3);
+	if (n == 0)
+		return;
+	triangle_indices = _triangle_indices;
+	triangle_faces.resize(n);
+	std::vector<vec3> box_mins(n), box_maxs(n), centers(n);
+#pragma omp parallel for
+	for (int ti = 0; ti < int(n); ++ti) {
+		const vec3& p0 = positions[triangle_indices[3 * ti]];
+		const vec3& p1 = positions[triangle_indices[3 * ti + 1]];
+		const vec3& p2 = positions[triangle_indices[3 * ti + 2]];
+		for (int a = 0; a < 3; ++a) {
+			box_mins[ti][a] = std::min(p0[a], std::min(p1[a], p2[a]));
+			box_maxs[ti][a] = std::max(p0[a], std::max(p1[a], p2[a]));
+		}
+		centers[ti] = T(0.5) * (box_mins[ti] + box_maxs[ti]);
+		triangle_faces[ti] = face_indices ? (*face_indices)[ti] : idx_type(ti);
+	}
+	std::vector<uint32_t> prims(n);
+	for (uint32_t ti = 0; ti < n; ++ti)
+		prims[ti] = ti;
+	nodes.reserve(2 * n);
+	nodes.push_back(node());
+	build_node(0, 0, 0, n, prims, box_mins, box_maxs, centers);
+	leaf_triangles.assign(prims.begin(), prims.end());
+	update_triangle_data(positions);
+}
+
+template <typename T>
+void mesh_bvh<T>::build_node(uint32_t ni, unsigned depth, uint32_t begin, uint32_t end, std::vector<uint32_t>& prims,
+	const std::vector<vec3>& box_mins, const std::vector<vec3>& box_maxs, const std::vector<vec3>& centers)
+{
+	// compute bounds of triangles and of their centers
+	const T inf = std::numeric_limits<T>::max();
+	// bounds of triangles and of their centers
+	vec3 bounds[4] = { vec3(inf), vec3(-inf), vec3(inf), vec3(-inf) };
+	uint32_t count = end - begin;
+	int nr_chunks = int((count + parallel_threshold - 1) / parallel_threshold);
+	if (nr_chunks == 1)
+		accumulate_bounds(&prims[0], begin, end, &box_mins[0], &box_maxs[0], &centers[0], bounds);
+	else {
+#pragma omp parallel for
+		for (int k = 0; k < nr_chunks; ++k) {
+			vec3 l_bounds[4] = { vec3(inf), vec3(-inf), vec3(inf), vec3(-inf) };
+			accumulate_bounds(&prims[0], begin + k * parallel_threshold, std::min(end, begin + (k + 1) * parallel_threshold), &box_mins[0], &box_maxs[0], &centers[0], l_bounds);
+#pragma omp critical
+			for (int a = 0; a < 3; ++a) {
+				bounds[0][a] = std::min(bounds[0][a], l_bounds[0][a]);
+				bounds[1][a] = std::max(bounds[1][a], l_bounds[1][a]);
+				bounds[2][a] = std::min(bounds[2][a], l_bounds[2][a]);
+				bounds[3][a] = std::max(bounds[3][a], l_bounds[3][a]);
+			}
+		}
+	}
+	const vec3 &mn = bounds[0], &mx = bounds[1], &cmn = bounds[2], &cmx = bounds[3];
+	for (int a = 0; a < 3; ++a) {
+		nodes[ni].box_min[a] = mn[a];
+		nodes[ni].box_max[a] = mx[a];
+	}
+	nodes[ni].offset = begin;
+	nodes[ni].count = count;
+	if (count == 1)
+		return;
+
+	// find split with minimal surface area heuristic among the bin boundaries of all axes
+	uint32_t mid = begin;
+	vec3 ext = cmx - cmn;
+	int best_axis = -1;
+	unsigned best_split = 0;
+	T best_cost = T(count);
+	if (depth < max_sah_depth && (ext[0] > 0 || ext[1] > 0 || ext[2] > 0)) {
+		unsigned B = std::max(std::min(nr_bins, max_nr_bins), 2u);
+		uint32_t bin_counts[3 * max_nr_bins] = { 0 };
+		vec3 bin_mins[3 * max_nr_bins], bin_maxs[3 * max_nr_bins];
+		std::fill(bin_mins, bin_mins + 3 * B, vec3(inf));
+		std::fill(bin_maxs, bin_maxs + 3 * B, vec3(-inf));
+		if (nr_chunks == 1)
+			accumulate_bins(&prims[0], begin, end, &box_mins[0], &box_maxs[0], &centers[0], cmn, ext, B, bin_counts, bin_mins, bin_maxs);
+		else {
+#pragma omp parallel for
+			for (int k = 0; k < nr_chunks; ++k) {
+				uint32_t l_counts[3 * max_nr_bins] = { 0 };
+				vec3 l_mins[3 * max_nr_bins], l_maxs[3 * max_nr_bins];
+				std::fill(l_mins, l_mins + 3 * B, vec3(inf));
+				std::fill(l_maxs, l_maxs + 3 * B, vec3(-inf));
+				accumulate_bins(&prims[0], begin + k * parallel_threshold, std::min(end, begin + (k + 1) * parallel_threshold), 
+					&box_mins[0], &box_maxs[0], &centers[0], cmn, ext, B, l_counts, l_mins, l_maxs);
+#pragma omp critical
+				for (unsigned bi = 0; bi < 3 * B; ++bi) {
+					bin_counts[bi] += l_counts[bi];
+					for (int c = 0; c < 3; ++c) {
+						bin_mins[bi][c] = std::min(bin_mins[bi][c], l_mins[bi][c]);
+						bin_maxs[bi][c] = std::max(bin_maxs[bi][c], l_maxs[bi][c]);
+					}
+				}
+			}
+		}
+		T inv_area = T(1) / std::max(box_area(mn, mx), std::numeric_limits<T>::min());
+		T right_costs[max_nr_bins];
+		for (int a = 0; a < 3; ++a) {
+			if (ext[a] <= 0)
+				continue;
+			// sweep from the right to store area times count of the right side of each boundary
+			vec3 r_mn(inf), r_mx(-inf);
+			uint32_t r_count = 0;
+			for (unsigned b = B - 1; b > 0; --b) {
+				unsigned bi = a * B + b;
+				r_count += bin_counts[bi];
+				for (int c = 0; c < 3; ++c) {
+					r_mn[c] = std::min(r_mn[c], bin_mins[bi][c]);
+					r_mx[c] = std::max(r_mx[c], bin_maxs[bi][c]);
+				}
+				right_costs[b] = r_count * box_area(r_mn, r_mx);
+			}
+			vec3 l_mn(inf), l_mx(-inf);
+			uint32_t l_count = 0;
+			for (unsigned b = 1; b < B; ++b) {
+				unsigned bi = a * B + b - 1;
+				l_count += bin_counts[bi];
+				for (int c = 0; c < 3; ++c) {
+					l_mn[c] = std::min(l_mn[c], bin_mins[bi][c]);
+					l_mx[c] = std::max(l_mx[c], bin_maxs[bi][c]);
+				}
+				if (l_count == 0 || l_count == count)
+					continue;
+				T cost = traversal_cost + (l_count * box_area(l_mn, l_mx) + right_costs[b]) * inv_area;
+				if (cost < best_cost) {
+					best_cost = cost;
+					best_axis = a;
+					best_split = b;
+				}
+			}
+		}
+	}
+	if (best_axis == -1 && count <= max_leaf_size)
+		return;
+	if (best_axis != -1) {
+		unsigned B = std::max(std::min(nr_bins, max_nr_bins), 2u);
+		T c0 = cmn[best_axis], e = ext[best_axis];
+		mid = uint32_t(std::partition(prims.begin() + begin, prims.begin() + end, [&](uint32_t ti) {
+			return std::min(B - 1, unsigned((centers[ti][best_axis] - c0) * B / e)) < best_split;
+		}) - prims.begin());
+	}
+	if (mid == begin || mid == end) {
+		// split identical centers or too large leaves at the median along the axis of largest extent
+		int a = ext[0] >= ext[1] ? (ext[0] >= ext[2] ? 0 : 2) : (ext[1] >= ext[2] ? 1 : 2);
+		mid = begin + count / 2;
+		std::nth_element(prims.begin() + begin, prims.begin() + mid, prims.begin() + end,
+			[&](uint32_t t0, uint32_t t1) { return centers[t0][a] < centers[t1][a]; });
+	}
+	uint32_t left = uint32_t(nodes.size());
+	nodes.push_back(node());
+	build_node(left, depth + 1, begin, mid, prims, box_mins, box_maxs, centers);
+	uint32_t right = uint32_t(nodes.size());
+	nodes.push_back(node());
+	build_node(right, depth + 1, mid, end, prims, box_mins, box_maxs, centers);
+	nodes[ni].offset = right;
+	nodes[ni].count = 0;
+}
+
+template <typename T>
+void mesh_bvh<T>::update_triangle_data(const std::vector<vec3>& positions)
+{
+	size_t n = leaf_triangles.size();
+	triangle_data.resize(3 * n);
+#pragma omp parallel for
+	for (int i = 0; i < int(n); ++i) {
+		idx_type ti = leaf_triangles[i];
+		const vec3& p0 = positions[triangle_indices[3 * ti]];
+		triangle_data[3 * i] = p0;
+		triangle_data[3 * i + 1] = positions[triangle_indices[3 * ti + 1]] - p0;
+		triangle_data[3 * i + 2] = positions[triangle_indices[3 * ti + 2]] - p0;
+	}
+}
+
+template <typename T>
+void mesh_bvh<T>::refit(const simple_mesh<T>& mesh)
+{
+	refit(mesh.get_positions());
+}
+
+template <typename T>
+void mesh_bvh<T>::refit(const std::vector<vec3>& positions)
+{
+	if (nodes.empty())
+		return;
+	update_triangle_data(positions);
+	const T inf = std::numeric_limits<T>::max();
+#pragma omp parallel for
+	for (int ni = 0; ni < int(nodes.size()); ++ni) {
+		node& n = nodes[ni];
+		if (n.count == 0)
+			continue;
+		for (int a = 0; a < 3; ++a) {
+			n.box_min[a] = inf;
+			n.box_max[a] = -inf;
+		}
+		for (uint32_t i = n.offset; i < n.offset + n.count; ++i) {
+			const vec3& p0 = triangle_data[3 * i];
+			vec3 p1 = p0 + triangle_data[3 * i + 1], p2 = p0 + triangle_data[3 * i + 2];
+			for (int a = 0; a < 3; ++a) {
+				n.box_min[a] = std::min(n.box_min[a], std::min(p0[a], std::min(p1[a], p2[a])));
+				n.box_max[a] = std::max(n.box_max[a], std::max(p0[a], std::max(p1[a], p2[a])));
+			}
+		}
+	}
+	// children follow their parents, such that a reverse sweep visits children first
+	for (size_t ni = nodes.size(); ni > 0; ) {
+		node& n = nodes[--ni];
+		if (n.count != 0)
+			continue;
+		const node& l = nodes[ni + 1];
+		const node& r = nodes[n.offset];
+		for (int a = 0; a < 3; ++a) {
+			n.box_min[a] = std::min(l.box_min[a], r.box_min[a]);
+			n.box_max[a] = std::max(l.box_max[a], r.box_max[a]);
+		}
+	}
+}
+
+template <typename T>
+unsigned mesh_bvh<T>::get_depth() const
+{
+	if (nodes.empty())
+		return 0;
+	unsigned max_depth = 0;
+	std::vector<std::pair<uint32_t, unsigned> > stack(1, std::make_pair(0u, 0u));
+	while (!stack.empty()) {
+		std::pair<uint32_t, unsigned> e = stack.back();
+		stack.pop_back();
+		max_depth = std::max(max_depth, e.second);
+		const node& n = nodes[e.first];
+		if (n.count == 0) {
+			stack.push_back(std::make_pair(e.first + 1, e.second + 1));
+			stack.push_back(std::make_pair(n.offset, e.second + 1));
+		}
+	}
+	return max_depth;
+}
+
+template <typename T>
+bool mesh_bvh<T>::intersect_leaf(const node& n, const vec3& o, const vec3& d, T t_min, T& t_max, hit_info* hit) const
+{
+	bool found = false;
+	for (uint32_t i = n.offset; i < n.offset + n.count; ++i) {
+		// Moeller Trumbore test
+		const vec3& p0 = triangle_data[3 * i];
+		const vec3& e1 = triangle_data[3 * i + 1];
+		const vec3& e2 = triangle_data[3 * i + 2];
+		vec3 p = cross(d, e2);
+		T det = dot(e1, p);
+		if (det == 0)
+			continue;
+		T inv_det = T(1) / det;
+		vec3 s = o - p0;
+		T u = dot(s, p) * inv_det;
+		if (u < 0 || u > 1)
+			continue;
+		vec3 q = cross(s, e1);
+		T v = dot(d, q) * inv_det;
+		if (v < 0 || u + v > 1)
+			continue;
+		T t = dot(e2, q) * inv_det;
+		if (t < t_min || t > t_max)
+			continue;
+		t_max = t;
+		found = true;
+		if (!hit)
+			return true;
+		hit->t = t;
+		hit->u = u;
+		hit->v = v;
+		hit->triangle_index = leaf_triangles[i];
+	}
+	return found;
+}
+
+template <typename T>
+bool mesh_bvh<T>::closest_hit(const ray_type& r, hit_info& hit, T t_min, T t_max) const
+{
+	hit = hit_info();
+	if (nodes.empty())
+		return false;
+	vec3 inv_d = invert_direction(r.direction);
+	uint32_t stack[stack_size];
+	T entries[stack_size];
+	unsigned sp = 0;
+	if (box_entry<T>(nodes[0], r.origin, inv_d, t_min, t_max) == std::numeric_limits<T>::infinity())
+		return false;
+	uint32_t ni = 0;
+	for (;;) {
+		const node& n = nodes[ni];
+		if (n.count > 0)
+			intersect_leaf(n, r.origin, r.direction, t_min, t_max, &hit);
+		else {
+			// visit nearer child first and push the farther one
+			uint32_t c0 = ni + 1, c1 = n.offset;
+			T t0 = box_entry<T>(nodes[c0], r.origin, inv_d, t_min, t_max);
+			T t1 = box_entry<T>(nodes[c1], r.origin, inv_d, t_min, t_max);
+			if (t1 < t0) {
+				std::swap(t0, t1);
+				std::swap(c0, c1);
+			}
+			if (t0 != std::numeric_limits<T>::infinity()) {
+				if (t1 != std::numeric_limits<T>::infinity()) {
+					stack[sp] = c1;
+					entries[sp++] = t1;
+				}
+				ni = c0;
+				continue;
+			}
+		}
+		// pop next node that can still contain a closer hit
+		for (;;) {
+			if (sp == 0) {
+				if (hit.valid())
+					hit.face_index = triangle_faces[hit.triangle_index];
+				return hit.valid();
+			}
+			--sp;
+			if (entries[sp] <= t_max) {
+				ni = stack[sp];
+				break;
+			}
+		}
+	}
+}
+
+template <typename T>
+bool mesh_bvh<T>::any_hit(const ray_type& r, T t_min, T t_max) const
+{
+	if (nodes.empty())
+		return false;
+	vec3 inv_d = invert_direction(r.direction);
+	uint32_t stack[stack_size];
+	unsigned sp = 0;
+	stack[sp++] = 0;
+	while (sp > 0) {
+		const node& n = nodes[stack[--sp]];
+		if (box_entry<T>(n, r.origin, inv_d, t_min, t_max) == std::numeric_limits<T>::infinity())
+			continue;
+		if (n.count > 0) {
+			if (intersect_leaf(n, r.origin, r.direction, t_min, t_max, 0))
+				return true;
+		}
+		else {
+			stack[sp++] = n.offset;
+			stack[sp++] = uint32_t(&n - &nodes[0]) + 1;
+		}
+	}
+	return false;
+}
+
+template <typename T>
+void mesh_bvh<T>::traverse_packet(const std::vector<ray_type>& rays, size_t ri, size_t nr, T t_min, T t_max, hit_info* hits, char* any) const
+{
+	const unsigned P = packet_size;
+	const T inf = std::numeric_limits<T>::infinity();
+	// structure of arrays layout of the packet, where unused slots never hit
+	T ox[P], oy[P], oz[P], dx[P], dy[P], dz[P], ix[P], iy[P], iz[P], tmax[P], hu[P], hv[P];
+	idx_type ht[P];
+	for (unsigned r = 0; r < P; ++r) {
+		const ray_type& R = rays[ri + std::min(size_t(r), nr - 1)];
+		vec3 inv_d = invert_direction(R.direction);
+		ox[r] = R.origin[0]; oy[r] = R.origin[1]; oz[r] = R.origin[2];
+		dx[r] = R.direction[0]; dy[r] = R.direction[1]; dz[r] = R.direction[2];
+		ix[r] = inv_d[0]; iy[r] = inv_d[1]; iz[r] = inv_d[2];
+		tmax[r] = r < nr ? t_max : -inf;
+		hu[r] = hv[r] = 0;
+		ht[r] = idx_type(-1);
+	}
+	uint32_t stack[stack_size];
+	unsigned sp = 0;
+	stack[sp++] = 0;
+	while (sp > 0) {
+		uint32_t ni = stack[--sp];
+		const node& n = nodes[ni];
+		bool active = false;
+		for (unsigned r = 0; r < P; ++r) {
+			T tx0 = (n.box_min[0] - ox[r]) * ix[r], tx1 = (n.box_max[0] - ox[r]) * ix[r];
+			T ty0 = (n.box_min[1] - oy[r]) * iy[r], ty1 = (n.box_max[1] - oy[r]) * iy[r];
+			T tz0 = (n.box_min[2] - oz[r]) * iz[r], tz1 = (n.box_max[2] - oz[r]) * iz[r];
+			T t_near = std::max(std::max(t_min, std::min(tx0, tx1)), std::max(std::min(ty0, ty1), std::min(tz0, tz1)));
+			T t_far = std::min(std::min(tmax[r], std::max(tx0, tx1)), std::min(std::max(ty0, ty1), std::max(tz0, tz1)));
+			active |= t_near <= t_far;
+		}
+		if (!active)
+			continue;
+		if (n.count == 0) {
+			// push the child farther along the direction of the first ray first
+			uint32_t c0 = ni + 1, c1 = n.offset;
+			const node& n0 = nodes[c0];
+			const node& n1 = nodes[c1];
+			int a = 0;
+			T best = -1;
+			for (int b = 0; b < 3; ++b) {
+				T diff = std::abs(n1.box_min[b] + n1.box_max[b] - n0.box_min[b] - n0.box_max[b]);
+				if (diff > best) {
+					best = diff;
+					a = b;
+				}
+			}
+			T d0 = a == 0 ? dx[0] : (a == 1 ? dy[0] : dz[0]);
+			if ((n1.box_min[a] + n1.box_max[a] - n0.box_min[a] - n0.box_max[a]) * d0 < 0)
+				std::swap(c0, c1);
+			stack[sp++] = c1;
+			stack[sp++] = c0;
+			continue;
+		}
+		for (uint32_t i = n.offset; i < n.offset + n.count; ++i) {
+			const vec3& p0 = triangle_data[3 * i];
+			const vec3& e1 = triangle_data[3 * i + 1];
+			const vec3& e2 = triangle_data[3 * i + 2];
+			for (unsigned r = 0; r < P; ++r) {
+				T px = dy[r] * e2[2] - dz[r] * e2[1], py = dz[r] * e2[0] - dx[r] * e2[2], pz = dx[r] * e2[1] - dy[r] * e2[0];
+				T det = e1[0] * px + e1[1] * py + e1[2] * pz;
+				T inv_det = det != 0 ? T(1) / det : T(0);
+				T sx = ox[r] - p0[0], sy = oy[r] - p0[1], sz = oz[r] - p0[2];
+				T u = (sx * px + sy * py + sz * pz) * inv_det;
+				T qx = sy * e1[2] - sz * e1[1], qy = sz * e1[0] - sx * e1[2], qz = sx * e1[1] - sy * e1[0];
+				T v = (dx[r] * qx + dy[r] * qy + dz[r] * qz) * inv_det;
+				T t = (e2[0] * qx + e2[1] * qy + e2[2] * qz) * inv_det;
+				bool h = det != 0 && u >= 0 && v >= 0 && u + v <= 1 && t >= t_min && t <= tmax[r];
+				tmax[r] = h ? t : tmax[r];
+				hu[r] = h ? u : hu[r];
+				hv[r] = h ? v : hv[r];
+				ht[r] = h ? leaf_triangles[i] : ht[r];
+			}
+		}
+		if (any) {
+			// rays with a hit are finished
+			bool all_done = true;
+			for (unsigned r = 0; r < nr; ++r) {
+				if (ht[r] != idx_type(-1))
+					tmax[r] = -inf;
+				else
+					all_done = false;
+			}
+			if (all_done)
+				break;
+		}
+	}
+	for (unsigned r = 0; r < nr; ++r) {
+		if (any) {
+			any[r] = ht[r] != idx_type(-1) ? 1 : 0;
+			continue;
+		}
+		hit_info& hit = hits[r];
+		hit = hit_info();
+		if (ht[r] == idx_type(-1))
+			continue;
+		hit.t = tmax[r];
+		hit.u = hu[r];
+		hit.v = hv[r];
+		hit.triangle_index = ht[r];
+		hit.face_index = triangle_faces[ht[r]];
+	}
+}
+
+template <typename T>
+void mesh_bvh<T>::closest_hits(const std::vector<ray_type>& rays, std::vector<hit_info>& hits, T t_min, T t_max) const
+{
+	hits.resize(rays.size());
+	if (nodes.empty()) {
+		std::fill(hits.begin(), hits.end(), hit_info());
+		return;
+	}
+	int nr_packets = int((rays.size() + packet_size - 1) / packet_size);
+#pragma omp parallel for schedule(dynamic, 16)
+	for (int pi = 0; pi < nr_packets; ++pi) {
+		size_t ri = size_t(pi) * packet_size;
+		traverse_packet(rays, ri, std::min(size_t(packet_size), rays.size() - ri), t_min, t_max, &hits[ri], 0);
+	}
+}
+
+template <typename T>
+void mesh_bvh<T>::any_hits(const std::vector<ray_type>& rays, std::vector<char>& hits, T t_min, T t_max) const
+{
+	hits.assign(rays.size(), 0);
+	if (nodes.empty())
+		return;
+	int nr_packets = int((rays.size() + packet_size - 1) / packet_size);
+#pragma omp parallel for schedule(dynamic, 16)
+	for (int pi = 0; pi < nr_packets; ++pi) {
+		size_t ri = size_t(pi) * packet_size;
+		traverse_packet(rays, ri, std::min(size_t(packet_size), rays.size() - ri), t_min, t_max, 0, &hits[ri]);
+	}
+}
+
+template class mesh_bvh<float>;
+template class mesh_bvh<double>;
+
+		}
+	}
+}
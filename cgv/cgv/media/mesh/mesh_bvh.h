@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cgv/math/ray.h>
+#include "simple_mesh.h"
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+/** bounding volume hierarchy over the triangles of a mesh for ray queries on the CPU.
+
+	The hierarchy is built top down with the surface area heuristic evaluated on nr_bins bins per axis.
+	Bounds and bins of large nodes are computed in parallel. Nodes are stored flattened in depth first
+	order, such that the first child of an inner node directly follows it. Triangle corners are copied
+	into leaf order, which keeps them close to their nodes in memory. After the mesh deforms without
+	changing its connectivity, for example by dynamic_mesh::skin(), refit() updates the triangles and
+	node bounds without rebuilding.
+
+	Single rays are traversed front to back. The batch queries split rays into packets of
+	packet_size rays, which share traversal and test node bounds and triangles for all rays of the
+	packet in loops the compiler can vectorize. Packets work best for coherent rays like camera rays
+	of adjacent pixels. */
+template <typename T>
+class CGV_API mesh_bvh
+{
+public:
+	/// index type
+	typedef simple_mesh_base::idx_type idx_type;
+	/// type of points and vectors
+	typedef cgv::math::fvec<T, 3> vec3;
+	/// type of rays
+	typedef cgv::math::ray<T, 3> ray_type;
+	/// number of rays traversed together by the batch queries
+	static const unsigned packet_size = 8;
+	/// result of a closest hit query
+	struct hit_info
+	{
+		/// ray parameter of hit
+		T t;
+		/// barycentric coordinates of the second and third triangle corner
+		T u, v;
+		/// index of hit triangle in the order of construction or -1 if there is no hit
+		idx_type triangle_index;
+		/// index of the face of the triangle, which is the triangle index if no faces were given
+		idx_type face_index;
+		/// construct invalid hit
+		hit_info() : t(std::numeric_limits<T>::max()), u(0), v(0), triangle_index(idx_type(-1)), face_index(idx_type(-1)) {}
+		/// check whether a triangle has been hit
+		bool valid() const { return triangle_index != idx_type(-1); }
+	};
+	/// node of the flattened hierarchy
+	struct node
+	{
+		/// bounding box
+		T box_min[3], box_max[3];
+		/// index of first triangle for leaves and index of second child for inner nodes
+		uint32_t offset;
+		/// number of triangles for leaves or 0 for inner nodes
+		uint32_t count;
+	};
+	/// number of bins per axis used to evaluate the surface area heuristic (default 16, at most 64)
+	unsigned nr_bins;
+	/// maximal number of triangles in leaves (default 8)
+	unsigned max_leaf_size;
+	/// cost of a node traversal relative to a triangle intersection (default 1)
+	T traversal_cost;
+protected:
+	/// flattened nodes with the root at index 0
+	std::vector<node> nodes;
+	/// position indices of the triangle corners in construction order
+	std::vector<idx_type> triangle_indices;
+	/// face index per triangle
+	std::vector<idx_type> triangle_faces;
+	/// triangle index in construction order per triangle in leaf order
+	std::vector<idx_type> leaf_triangles;
+	/// first corner and two edge vectors per triangle in leaf order
+	std::vector<vec3> triangle_data;
+	/// recursively build the subtree of a node at the given depth
+	void build_node(uint32_t ni, unsigned depth, uint32_t begin, uint32_t end, std::vector<uint32_t>& prims,
+		const std::vector<vec3>& box_mins, const std::vector<vec3>& box_maxs, const std::vector<vec3>& centers);
+	/// copy triangle corners into leaf order
+	void update_triangle_data(const std::vector<vec3>& positions);
+	/// intersect one ray with the triangles of a leaf
+	bool intersect_leaf(const node& n, const vec3& o, const vec3& d, T t_min, T& t_max, hit_info* hit) const;
+	/// traverse the hierarchy for a packet of up to packet_size rays starting at ray index ri
+	void traverse_packet(const std::vector<ray_type>& rays, size_t ri, size_t n, T t_min, T t_max, hit_info* hits, char* any) const;
+public:
+	/// construct empty hierarchy
+	mesh_bvh();
+	/// build from the faces of a simple mesh, where polygons are triangulated as fans
+	void build(const simple_mesh<T>& mesh);
+	/// build from positions and three position indices per triangle with an optional face index per triangle
+	void build(const std::vector<vec3>& positions, const std::vector<idx_type>& triangle_indices, const std::vector<idx_type>* face_indices = 0);
+	/// update triangles and bounds after the positions of the mesh used to build the hierarchy changed
+	void refit(const simple_mesh<T>& mesh);
+	/// update triangles and bounds after the positions used to build the hierarchy changed
+	void refit(const std::vector<vec3>& positions);
+	/// remove all nodes and triangles
+	void clear();
+	/// return whether the hierarchy contains no triangles
+	bool empty() const { return nodes.empty(); }
+	/// return the number of nodes
+	size_t get_nr_nodes() const { return nodes.size(); }
+	/// return the number of triangles
+	size_t get_nr_triangles() const { return triangle_faces.size(); }
+	/// return the flattened nodes
+	const std::vector<node>& get_nodes() const { return nodes; }
+	/// return the maximal depth of a leaf, where the root has depth 0
+	unsigned get_depth() const;
+	/// find the closest hit with ray parameter in [t_min,t_max], return false if there is none
+	bool closest_hit(const ray_type& r, hit_info& hit, T t_min = 0, T t_max = std::numeric_limits<T>::max()) const;
+	/// check whether the ray hits any triangle with ray parameter in [t_min,t_max], used for occlusion tests
+	bool any_hit(const ray_type& r, T t_min = 0, T t_max = std::numeric_limits<T>::max()) const;
+	/// compute closest hits of all rays with packet traversal, where packets are processed in parallel
+	void closest_hits(const std::vector<ray_type>& rays, std::vector<hit_info>& hits, T t_min = 0, T t_max = std::numeric_limits<T>::max()) const;
+	/// compute for each ray whether it hits any triangle with packet traversal, where packets are processed in parallel
+	void any_hits(const std::vector<ray_type>& rays, std::vector<char>& hits, T t_min = 0, T t_max = std::numeric_limits<T>::max()) const;
+};
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
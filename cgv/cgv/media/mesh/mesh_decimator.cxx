@@ -0,0 +1,499 @@
+#include "mesh_decimator.h"
+#include <cgv/math/fvec.h>
+#include <algorithm>
+#include <queue>
+#include <thread>
+#include <cmath>
+#include <limits>
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+namespace {
+	typedef cgv::math::fvec<double, 3> dvec3;
+	typedef simple_mesh_base::idx_type idx_type;
+
+	/// fixed size quadric with the coefficient layout of cgv::math::qem: scalar part, vector part and upper triangle of matrix part
+	struct quadric
+	{
+		double q[10];
+		quadric() { std::fill(q, q + 10, 0.0); }
+		/// add the weighted quadric of the plane dot(n,p)+d=0 with unit normal n
+		void add_plane(const dvec3& n, double d, double w)
+		{
+			q[0] += w * d * d;
+			q[1] += w * d * n[0]; q[2] += w * d * n[1]; q[3] += w * d * n[2];
+			q[4] += w * n[0] * n[0]; q[5] += w * n[0] * n[1]; q[6] += w * n[0] * n[2];
+			q[7] += w * n[1] * n[1]; q[8] += w * n[1] * n[2];
+			q[9] += w * n[2] * n[2];
+		}
+		quadric& operator += (const quadric& o)
+		{
+			for (int i = 0; i < 10; ++i)
+				q[i] += o.q[i];
+			return *this;
+		}
+		/// evaluate p^T A p + 2 b^T p + c
+		double evaluate(const dvec3& p) const
+		{
+			return q[4] * p[0] * p[0] + q[7] * p[1] * p[1] + q[9] * p[2] * p[2] +
+				2 * (q[5] * p[0] * p[1] + q[6] * p[0] * p[2] + q[8] * p[1] * p[2]) +
+				2 * (q[1] * p[0] + q[2] * p[1] + q[3] * p[2]) + q[0];
+		}
+		/// compute minimizer by solving A p = -b with the adjugate of A, return false if A is close to singular
+		bool minimize(dvec3& p) const
+		{
+			double a00 = q[4], a01 = q[5], a02 = q[6], a11 = q[7], a12 = q[8], a22 = q[9];
+			double c00 = a11 * a22 - a12 * a12, c01 = a02 * a12 - a01 * a22, c02 = a01 * a12 - a02 * a11;
+			double det = a00 * c00 + a01 * c01 + a02 * c02;
+			double scale = a00 + a11 + a22;
+			if (!(std::abs(det) > 1e-9 * scale * scale * scale))
+				return false;
+			double c11 = a00 * a22 - a02 * a02, c12 = a01 * a02 - a00 * a12, c22 = a00 * a11 - a01 * a01;
+			double b0 = -q[1], b1 = -q[2], b2 = -q[3];
+			p[0] = (c00 * b0 + c01 * b1 + c02 * b2) / det;
+			p[1] = (c01 * b0 + c11 * b1 + c12 * b2) / det;
+			p[2] = (c02 * b0 + c12 * b1 + c22 * b2) / det;
+			return true;
+		}
+	};
+
+	/// edge collapse of vertex u into vertex v at position p, valid as long as the versions of u and v did not change
+	struct collapse_candidate
+	{
+		double cost;
+		idx_type u, v;
+		idx_type version_u, version_v;
+		dvec3 p;
+		/// reverse order to make std::priority_queue a min heap
+		bool operator < (const collapse_candidate& c) const { return cost > c.cost; }
+	};
+
+	/// connectivity, quadrics and partitioning of a mesh during decimation
+	struct decimation_state
+	{
+		std::vector<dvec3> P;
+		std::vector<quadric> Q;
+		/// per triangle corner vertex and texture coordinate indices and per triangle the source face
+		std::vector<idx_type> tri, tri_tc, tri_face;
+		std::vector<char> tri_alive;
+		/// per vertex list of triangles, which can contain dead triangles
+		std::vector<std::vector<idx_type> > vt;
+		std::vector<idx_type> version;
+		std::vector<char> vertex_alive;
+		std::vector<char> border;
+		/// per vertex partition or -1 if vertex is locked
+		std::vector<int> cell;
+		double min_normal_cosine;
+		double max_error;
+
+		template <typename T>
+		void init(const simple_mesh<T>& M, double border_weight)
+		{
+			idx_type n = M.get_nr_positions();
+			P.resize(n);
+			for (idx_type i = 0; i < n; ++i)
+				P[i] = dvec3(M.position(i));
+			// fan triangulate faces
+			bool has_tc = M.has_tex_coord_indices();
+			for (idx_type fi = 0; fi < M.get_nr_faces(); ++fi) {
+				idx_type c0 = M.begin_corner(fi);
+				for (idx_type ci = c0 + 2; ci < M.end_corner(fi); ++ci) {
+					idx_type C[3] = { c0, ci - 1, ci };
+					for (int j = 0; j < 3; ++j) {
+						tri.push_back(M.c2p(C[j]));
+						if (has_tc)
+							tri_tc.push_back(M.c2t(C[j]));
+					}
+					tri_face.push_back(fi);
+				}
+			}
+			idx_type nr_triangles = idx_type(tri_face.size());
+			tri_alive.resize(nr_triangles);
+			for (idx_type t = 0; t < nr_triangles; ++t) {
+				const idx_type* V = &tri[3 * t];
+				tri_alive[t] = V[0] != V[1] && V[1] != V[2] && V[2] != V[0];
+			}
+			vt.resize(n);
+			for (idx_type t = 0; t < nr_triangles; ++t)
+				if (tri_alive[t])
+					for (int j = 0; j < 3; ++j)
+						vt[tri[3 * t + j]].push_back(t);
+			version.resize(n, 0);
+			vertex_alive.resize(n);
+			for (idx_type i = 0; i < n; ++i)
+				vertex_alive[i] = vt[i].empty() ? 0 : 1;
+			cell.resize(n, 0);
+
+			// area weighted face quadrics
+			Q.resize(n);
+			for (idx_type t = 0; t < nr_triangles; ++t) {
+				if (!tri_alive[t])
+					continue;
+				const idx_type* V = &tri[3 * t];
+				dvec3 nml = cross(P[V[1]] - P[V[0]], P[V[2]] - P[V[0]]);
+				double l = nml.length();
+				if (l == 0)
+					continue;
+				nml /= l;
+				for (int j = 0; j < 3; ++j)
+					Q[V[j]].add_plane(nml, -dot(nml, P[V[0]]), 0.5 * l);
+			}
+			// constraint quadrics along border edges, which are edges of only one triangle
+			std::vector<std::pair<uint64_t, idx_type> > edges;
+			edges.reserve(tri.size());
+			for (idx_type t = 0; t < nr_triangles; ++t)
+				if (tri_alive[t])
+					for (int j = 0; j < 3; ++j) {
+						idx_type a = tri[3 * t + j], b = tri[3 * t + (j + 1) % 3];
+						edges.push_back(std::make_pair((uint64_t(std::min(a, b)) << 32) | std::max(a, b), t));
+					}
+			std::sort(edges.begin(), edges.end());
+			border.resize(n, 0);
+			for (size_t i = 0; i < edges.size(); ) {
+				size_t j = i + 1;
+				while (j < edges.size() && edges[j].first == edges[i].first)
+					++j;
+				if (j == i + 1) {
+					idx_type a = idx_type(edges[i].first >> 32), b = idx_type(edges[i].first & 0xffffffff);
+					const idx_type* V = &tri[3 * edges[i].second];
+					dvec3 e = P[b] - P[a];
+					dvec3 cn = cross(e, cross(P[V[1]] - P[V[0]], P[V[2]] - P[V[0]]));
+					double l = cn.length();
+					if (l > 0) {
+						cn /= l;
+						double w = border_weight * e.sqr_length();
+						Q[a].add_plane(cn, -dot(cn, P[a]), w);
+						Q[b].add_plane(cn, -dot(cn, P[a]), w);
+					}
+					border[a] = border[b] = 1;
+				}
+				i = j;
+			}
+		}
+		/// compute position and cost of merging u and v, where the optimal position is only used if it is close to the edge
+		void compute_candidate(idx_type u, idx_type v, collapse_candidate& c) const
+		{
+			quadric q = Q[u];
+			q += Q[v];
+			c.u = u;
+			c.v = v;
+			c.version_u = version[u];
+			c.version_v = version[v];
+			dvec3 mid = 0.5 * (P[u] + P[v]);
+			c.p = mid;
+			c.cost = q.evaluate(mid);
+			dvec3 p;
+			if (q.minimize(p) && (p - mid).sqr_length() <= (P[u] - P[v]).sqr_length()) {
+				double cost = q.evaluate(p);
+				if (cost < c.cost) {
+					c.p = p;
+					c.cost = cost;
+				}
+			}
+			for (idx_type w : { u, v }) {
+				double cost = q.evaluate(P[w]);
+				if (cost < c.cost) {
+					c.p = P[w];
+					c.cost = cost;
+				}
+			}
+			c.cost = std::max(0.0, c.cost);
+		}
+		/// collect the sorted neighbors of a vertex from its alive triangles
+		void collect_neighbors(idx_type v, std::vector<idx_type>& N) const
+		{
+			N.clear();
+			for (idx_type t : vt[v])
+				if (tri_alive[t])
+					for (int j = 0; j < 3; ++j)
+						if (tri[3 * t + j] != v)
+							N.push_back(tri[3 * t + j]);
+			std::sort(N.begin(), N.end());
+			N.erase(std::unique(N.begin(), N.end()), N.end());
+		}
+		/// check that collapse keeps the mesh manifold and does not flip triangles
+		bool is_valid(const collapse_candidate& c, std::vector<idx_type>& Nu, std::vector<idx_type>& Nv, std::vector<idx_type>& Nuv) const
+		{
+			idx_type u = c.u, v = c.v;
+			collect_neighbors(u, Nu);
+			collect_neighbors(v, Nv);
+			Nuv.clear();
+			std::set_intersection(Nu.begin(), Nu.end(), Nv.begin(), Nv.end(), std::back_inserter(Nuv));
+			size_t nr_shared_triangles = 0;
+			for (idx_type t : vt[u])
+				if (tri_alive[t] && (tri[3 * t] == v || tri[3 * t + 1] == v || tri[3 * t + 2] == v))
+					++nr_shared_triangles;
+			// link condition
+			if (nr_shared_triangles == 0 || Nuv.size() != nr_shared_triangles)
+				return false;
+			// do not pinch the mesh by collapsing an inner edge between two border vertices
+			if (nr_shared_triangles == 2 && border[u] && border[v])
+				return false;
+			// merged vertex needs at least three neighbors
+			if (Nu.size() + Nv.size() - Nuv.size() < 5)
+				return false;
+			// fold overs
+			for (idx_type x : { u, v })
+				for (idx_type t : vt[x]) {
+					if (!tri_alive[t])
+						continue;
+					const idx_type* V = &tri[3 * t];
+					if (V[0] == (x == u ? v : u) || V[1] == (x == u ? v : u) || V[2] == (x == u ? v : u))
+						continue;
+					dvec3 p[3] = { P[V[0]], P[V[1]], P[V[2]] };
+					dvec3 n0 = cross(p[1] - p[0], p[2] - p[0]);
+					for (int j = 0; j < 3; ++j)
+						if (V[j] == x)
+							p[j] = c.p;
+					dvec3 n1 = cross(p[1] - p[0], p[2] - p[0]);
+					double l0 = n0.length(), l1 = n1.length();
+					if (l1 == 0 || dot(n0, n1) < min_normal_cosine * l0 * l1)
+						return false;
+				}
+			return true;
+		}
+		/// collapse u into v and return number of removed triangles
+		size_t collapse(const collapse_candidate& c)
+		{
+			idx_type u = c.u, v = c.v;
+			size_t nr_removed = 0;
+			P[v] = c.p;
+			Q[v] += Q[u];
+			for (idx_type t : vt[u]) {
+				if (!tri_alive[t])
+					continue;
+				idx_type* V = &tri[3 * t];
+				if (V[0] == v || V[1] == v || V[2] == v) {
+					tri_alive[t] = 0;
+					++nr_removed;
+				}
+				else {
+					for (int j = 0; j < 3; ++j)
+						if (V[j] == u)
+							V[j] = v;
+					vt[v].push_back(t);
+				}
+			}
+			std::vector<idx_type>& L = vt[v];
+			L.erase(std::remove_if(L.begin(), L.end(), [this](idx_type t) { return !tri_alive[t]; }), L.end());
+			std::vector<idx_type>().swap(vt[u]);
+			vertex_alive[u] = 0;
+			border[v] |= border[u];
+			++version[u];
+			++version[v];
+			return nr_removed;
+		}
+		/// push collapse candidates of all edges of v to unlocked neighbors in the same partition
+		void push_candidates(idx_type v, int cell_index, std::vector<idx_type>& N, std::priority_queue<collapse_candidate>& heap) const
+		{
+			collect_neighbors(v, N);
+			collapse_candidate c;
+			for (idx_type w : N)
+				if (cell[w] == cell_index) {
+					compute_candidate(w, v, c);
+					heap.push(c);
+				}
+		}
+		/** decimate the triangles of one partition until only target_nr_triangles are alive or the error bound is
+		    reached. Only edges between unlocked vertices of the given partition are collapsed. */
+		void decimate_partition(const std::vector<idx_type>& triangles, int cell_index, size_t target_nr_triangles,
+			size_t& nr_collapses, double& max_collapse_error)
+		{
+			size_t nr_alive = 0;
+			std::vector<uint64_t> edges;
+			for (idx_type t : triangles) {
+				if (!tri_alive[t])
+					continue;
+				++nr_alive;
+				for (int j = 0; j < 3; ++j) {
+					idx_type a = tri[3 * t + j], b = tri[3 * t + (j + 1) % 3];
+					if (cell[a] == cell_index && cell[b] == cell_index)
+						edges.push_back((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+			std::vector<collapse_candidate> candidates(edges.size());
+			for (size_t i = 0; i < edges.size(); ++i)
+				compute_candidate(idx_type(edges[i] >> 32), idx_type(edges[i] & 0xffffffff), candidates[i]);
+			std::priority_queue<collapse_candidate> heap(std::less<collapse_candidate>(), std::move(candidates));
+			std::vector<idx_type> Nu, Nv, Nuv;
+			while (!heap.empty() && nr_alive > target_nr_triangles) {
+				collapse_candidate c = heap.top();
+				heap.pop();
+				if (!vertex_alive[c.u] || !vertex_alive[c.v] || version[c.u] != c.version_u || version[c.v] != c.version_v)
+					continue;
+				if (max_error >= 0 && c.cost > max_error)
+					break;
+				if (!is_valid(c, Nu, Nv, Nuv))
+					continue;
+				nr_alive -= collapse(c);
+				++nr_collapses;
+				max_collapse_error = std::max(max_collapse_error, c.cost);
+				push_candidates(c.v, cell_index, Nu, heap);
+			}
+		}
+		/// count alive triangles
+		size_t get_nr_alive_triangles() const
+		{
+			return size_t(std::count(tri_alive.begin(), tri_alive.end(), char(1)));
+		}
+		/// decimate in parallel over a grid of n^3 partitions with locked borders followed by a serial pass
+		void decimate(unsigned n, size_t target_nr_triangles, size_t& nr_collapses, double& max_collapse_error)
+		{
+			size_t nr_alive = get_nr_alive_triangles();
+			if (n > 1 && nr_alive > target_nr_triangles) {
+				// assign alive vertices to the cells of a regular grid over their bounding box
+				dvec3 box_min(std::numeric_limits<double>::max()), box_max(-std::numeric_limits<double>::max());
+				for (size_t i = 0; i < P.size(); ++i)
+					if (vertex_alive[i])
+						for (int c = 0; c < 3; ++c) {
+							box_min[c] = std::min(box_min[c], P[i][c]);
+							box_max[c] = std::max(box_max[c], P[i][c]);
+						}
+				for (size_t i = 0; i < P.size(); ++i) {
+					int ci = 0;
+					for (int c = 3; c > 0; ) {
+						--c;
+						double extent = box_max[c] - box_min[c];
+						int k = extent > 0 ? int(n * (P[i][c] - box_min[c]) / extent) : 0;
+						ci = int(n) * ci + std::max(0, std::min(int(n) - 1, k));
+					}
+					cell[i] = ci;
+				}
+				// triangles with all vertices in one cell belong to that cell, the vertices of all other triangles are locked
+				std::vector<std::vector<idx_type> > cell_triangles(n * n * n);
+				std::vector<char> locked(P.size(), 0);
+				for (idx_type t = 0; t < idx_type(tri_alive.size()); ++t) {
+					if (!tri_alive[t])
+						continue;
+					const idx_type* V = &tri[3 * t];
+					if (cell[V[0]] == cell[V[1]] && cell[V[1]] == cell[V[2]])
+						cell_triangles[cell[V[0]]].push_back(t);
+					else
+						locked[V[0]] = locked[V[1]] = locked[V[2]] = 1;
+				}
+				for (size_t i = 0; i < P.size(); ++i)
+					if (locked[i])
+						cell[i] = -1;
+				// partitions only decimate to the square root of the reduction ratio, such that the serial pass can
+				// still distribute the remaining collapses by their global error order across dense and sparse regions
+				double ratio = std::sqrt(double(target_nr_triangles) / nr_alive);
+				std::vector<size_t> cell_collapses(cell_triangles.size(), 0);
+				std::vector<double> cell_errors(cell_triangles.size(), 0.0);
+				int nr_cells = int(cell_triangles.size());
+#pragma omp parallel for schedule(dynamic)
+				for (int ci = 0; ci < nr_cells; ++ci)
+					decimate_partition(cell_triangles[ci], ci, size_t(ratio * cell_triangles[ci].size()),
+						cell_collapses[ci], cell_errors[ci]);
+				for (int ci = 0; ci < nr_cells; ++ci) {
+					nr_collapses += cell_collapses[ci];
+					max_collapse_error = std::max(max_collapse_error, cell_errors[ci]);
+				}
+			}
+			// serial pass over the whole mesh that also collapses the partition borders
+			std::fill(cell.begin(), cell.end(), 0);
+			std::vector<idx_type> triangles;
+			for (idx_type t = 0; t < idx_type(tri_alive.size()); ++t)
+				if (tri_alive[t])
+					triangles.push_back(t);
+			decimate_partition(triangles, 0, target_nr_triangles, nr_collapses, max_collapse_error);
+		}
+		/// extract the alive triangles into a simple mesh with the texture coordinates, groups and materials of the input
+		template <typename T>
+		void extract(const simple_mesh<T>& input, simple_mesh<T>& output) const
+		{
+			typedef typename simple_mesh<T>::vec3 vec3;
+			output.clear();
+			for (size_t gi = 0; gi < input.get_nr_groups(); ++gi)
+				output.new_group(input.group_name(gi));
+			for (size_t mi = 0; mi < input.get_nr_materials(); ++mi)
+				output.ref_material(output.new_material()) = input.get_material(mi);
+			if (!tri_tc.empty())
+				for (idx_type ti = 0; ti < input.get_nr_tex_coords(); ++ti)
+					output.new_tex_coord(input.tex_coord(ti));
+			std::vector<idx_type> vertex_map(P.size(), idx_type(-1));
+			for (idx_type t = 0; t < idx_type(tri_alive.size()); ++t) {
+				if (!tri_alive[t])
+					continue;
+				idx_type fi = output.start_face();
+				for (int j = 0; j < 3; ++j) {
+					idx_type& vi = vertex_map[tri[3 * t + j]];
+					if (vi == idx_type(-1)) {
+						const dvec3& p = P[tri[3 * t + j]];
+						vi = output.new_position(vec3(T(p[0]), T(p[1]), T(p[2])));
+					}
+					output.new_corner(vi, -1, tri_tc.empty() ? -1 : tri_tc[3 * t + j]);
+				}
+				if (output.get_nr_groups() > 0)
+					output.group_index(fi) = input.group_index(tri_face[t]);
+				if (output.get_nr_materials() > 0)
+					output.material_index(fi) = input.material_index(tri_face[t]);
+			}
+			if (input.has_normals())
+				output.compute_vertex_normals();
+		}
+	};
+	/// choose number of partitions per axis such that there are about twice as many partitions as threads
+	unsigned default_nr_partitions_per_axis(size_t nr_triangles)
+	{
+		if (nr_triangles < 20000)
+			return 1;
+		unsigned nr_threads = std::max(1u, std::thread::hardware_concurrency());
+		unsigned n = 1;
+		while (n * n * n < 2 * nr_threads)
+			++n;
+		return n;
+	}
+}
+
+template <typename T>
+mesh_decimator<T>::mesh_decimator()
+{
+	target_nr_triangles = 0;
+	max_error = -1;
+	border_weight = 1000;
+	nr_partitions_per_axis = 0;
+	min_normal_cosine = 0.2;
+	nr_collapses = 0;
+	max_collapse_error = 0;
+}
+
+template <typename T>
+bool mesh_decimator<T>::decimate(const mesh_type& input, mesh_type& output)
+{
+	std::vector<mesh_type> levels;
+	if (!decimate_progressive(input, { target_nr_triangles }, levels))
+		return false;
+	output = std::move(levels.front());
+	return true;
+}
+
+template <typename T>
+bool mesh_decimator<T>::decimate_progressive(const mesh_type& input, const std::vector<std::size_t>& target_nr_triangles_per_level, std::vector<mesh_type>& levels)
+{
+	nr_collapses = 0;
+	max_collapse_error = 0;
+	if (input.get_nr_faces() == 0)
+		return false;
+	decimation_state S;
+	S.min_normal_cosine = min_normal_cosine;
+	S.max_error = max_error;
+	S.init(input, border_weight);
+	unsigned n = nr_partitions_per_axis > 0 ? nr_partitions_per_axis : default_nr_partitions_per_axis(S.get_nr_alive_triangles());
+	levels.resize(target_nr_triangles_per_level.size());
+	for (size_t li = 0; li < levels.size(); ++li) {
+		S.decimate(n, target_nr_triangles_per_level[li], nr_collapses, max_collapse_error);
+		S.extract(input, levels[li]);
+	}
+	return true;
+}
+
+template class mesh_decimator<float>;
+template class mesh_decimator<double>;
+
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "simple_mesh.h"
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+/** quadric error metric based decimation of simple meshes by iterative edge collapses.
+
+	Faces are fan triangulated and each vertex accumulates the area weighted plane quadrics of its
+	triangles in the coefficient layout of cgv::math::qem. Open borders are preserved with constraint
+	quadrics of planes orthogonal to the border triangles. Collapses are ordered by the error of the
+	optimal position of the merged vertex and rejected if they would make the mesh non manifold or
+	fold over triangles.
+
+	For parallel decimation the bounding box is split into a regular grid of partitions. All triangles
+	with all vertices in one partition are decimated in parallel by the partition, while vertices with
+	triangles in several partitions are locked. Afterwards a serial pass over the whole mesh collapses
+	the remaining edges including the partition borders until the target is reached. Texture coordinates,
+	groups and materials of the surviving corners and faces are kept, normals are recomputed per vertex
+	if the input mesh has normals. */
+template <typename T>
+class CGV_API mesh_decimator
+{
+public:
+	/// type of decimated meshes
+	typedef simple_mesh<T> mesh_type;
+	/// index type
+	typedef simple_mesh_base::idx_type idx_type;
+	/// number of triangles at which decimation stops, 0 to only use the error bound (default)
+	std::size_t target_nr_triangles;
+	/// maximum quadric error of a collapse or negative to not bound the error (default)
+	double max_error;
+	/// weight of the constraint quadrics that preserve open borders relative to the face quadrics (default 1000)
+	double border_weight;
+	/// number of partitions along each axis in the parallel phase, 0 selects it from the number of hardware threads (default) and 1 decimates serially
+	unsigned nr_partitions_per_axis;
+	/// minimal cosine between a triangle normal before and after a collapse, which prevents fold overs (default 0.2)
+	double min_normal_cosine;
+protected:
+	/// number of collapses and maximal collapse error of last decimation
+	std::size_t nr_collapses;
+	double max_collapse_error;
+public:
+	/// construct decimator with default parameters
+	mesh_decimator();
+	/// decimate the input mesh to target_nr_triangles or max_error and store result in output mesh, return false if input has no faces
+	bool decimate(const mesh_type& input, mesh_type& output);
+	/** compute a sequence of levels of detail for decreasing triangle counts, where each level continues the
+	    collapses of the previous one. The error bound max_error applies to all levels and target_nr_triangles is
+		ignored. Returns false if input has no faces. */
+	bool decimate_progressive(const mesh_type& input, const std::vector<std::size_t>& target_nr_triangles_per_level, std::vector<mesh_type>& levels);
+	/// return the number of edge collapses performed by the last decimation
+	std::size_t get_nr_collapses() const { return nr_collapses; }
+	/// return the largest quadric error of a collapse performed by the last decimation
+	double get_max_collapse_error() const { return max_collapse_error; }
+};
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
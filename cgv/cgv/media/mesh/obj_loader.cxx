@@ -33,6 +33,12 @@ namespace cgv {
 			{
 			}
 
+template <typename T>
+obj_loader_generic<T>::obj_loader_generic()
+{
+	this->record_file_order = false;
+}
+
 			/// overide this function to process a vertex
 template <typename T>
 void obj_loader_generic<T>::process_vertex(const v3d_type& p)
@@ -124,33 +130,54 @@ void obj_loader_generic<T>::process_material(const obj_material& mtl, unsigned i
 		materials[idx] = mtl;
 }
 
+/// append the result of the parallel parser directly to the stored arrays
 template <typename T>
-const char* get_bin_extension()
-{
-	return  ".bin_obj";
-}
-
-template <>
-const char* get_bin_extension<float>()
+void obj_loader_generic<T>::process_bulk(obj_bulk_data<T>& data)
 {
-	return  ".bin_objf";
+	unsigned vi_off = (unsigned)vertex_indices.size();
+	int ni_off = (int)normal_indices.size(), ti_off = (int)texcoord_indices.size();
+	size_t f0 = faces.size(), l0 = lines.size();
+	if (vertices.empty() && vertex_indices.empty()) {
+		vertices.swap(data.vertices);
+		normals.swap(data.normals);
+		texcoords.swap(data.texcoords);
+		vertex_indices.swap(data.vertex_indices);
+		normal_indices.swap(data.normal_indices);
+		texcoord_indices.swap(data.texcoord_indices);
+	}
+	else {
+		vertices.insert(vertices.end(), data.vertices.begin(), data.vertices.end());
+		normals.insert(normals.end(), data.normals.begin(), data.normals.end());
+		texcoords.insert(texcoords.end(), data.texcoords.begin(), data.texcoords.end());
+		vertex_indices.insert(vertex_indices.end(), data.vertex_indices.begin(), data.vertex_indices.end());
+		normal_indices.insert(normal_indices.end(), data.normal_indices.begin(), data.normal_indices.end());
+		texcoord_indices.insert(texcoord_indices.end(), data.texcoord_indices.begin(), data.texcoord_indices.end());
+	}
+	colors.insert(colors.end(), data.colors.begin(), data.colors.end());
+	faces.insert(faces.end(), data.faces.begin(), data.faces.end());
+	lines.insert(lines.end(), data.lines.begin(), data.lines.end());
+	if (vi_off == 0 && ni_off == 0 && ti_off == 0)
+		return;
+	for (size_t i = f0; i < faces.size(); ++i) {
+		faces[i].first_vertex_index += vi_off;
+		if (faces[i].first_normal_index != -1)
+			faces[i].first_normal_index += ni_off;
+		if (faces[i].first_texcoord_index != -1)
+			faces[i].first_texcoord_index += ti_off;
+	}
+	for (size_t i = l0; i < lines.size(); ++i) {
+		lines[i].first_vertex_index += vi_off;
+		if (lines[i].first_normal_index != -1)
+			lines[i].first_normal_index += ni_off;
+		if (lines[i].first_texcoord_index != -1)
+			lines[i].first_texcoord_index += ti_off;
+	}
 }
 
-/// overloads reading to support binary file format
+/// overloads reading to clear previous data and to correct 8 bit colors
 template <typename T>
 bool obj_loader_generic<T>::read_obj(const std::string& file_name)
 {
-	// check if binary file exists
-	std::string bin_fn = drop_extension(file_name) + get_bin_extension<T>();
-	if (exists(bin_fn) &&
-		get_last_write_time(bin_fn) > get_last_write_time(file_name) &&
-		read_obj_bin(bin_fn)) {
-			this->path_name = get_path(file_name);
-			if (!this->path_name.empty())
-				this->path_name += "/";
-			return true;
-	}
-	
 	vertices.clear();
 	normals.clear();
 	texcoords.clear(); 
@@ -174,7 +201,6 @@ bool obj_loader_generic<T>::read_obj(const std::string& file_name)
 			colors[i] *= 1.0f/255;
 		}
 	}
-	write_obj_bin(bin_fn);
 	return true;
 }
 
@@ -11,43 +11,6 @@ namespace cgv {
 	namespace media {
 		namespace mesh {
 
-/** simple structure to describe a face */
-struct CGV_API face_info
-{
-	/// degree of face
-	unsigned degree;
-	/// index into vertex index array
-	unsigned first_vertex_index;
-	/// index into texcoord index array or -1 if not specified
-	int first_texcoord_index;
-	/// index into normal index array or -1 if not specified
-	int first_normal_index;
-	/// index of group to which the face belongs
-	int      group_index;
-	/// material index to which the face belongs
-	int      material_index;
-	/// construct face info
-	face_info(unsigned _nr = 0, unsigned _vi0 = 0, int _ti0 = -1, int _ni0 = -1, unsigned gi=-1, unsigned mi=-1); 
-};
-
-/** simple structure to describe a line */
-struct CGV_API line_info
-{
-	/// length of line strip
-	unsigned length;
-	/// index into vertex index array
-	unsigned first_vertex_index;
-	/// index into texcoord index array or -1 if not specified
-	int first_texcoord_index;
-	/// index into normal index array or -1 if not specified
-	int first_normal_index;
-	/// index of group to which the face belongs
-	int      group_index;
-	/// construct face info
-	line_info(unsigned _nr = 0, unsigned _vi0 = 0, int _ti0 = -1, int _ni0 = -1, unsigned gi = -1);
-};
-
-
 /** simple structure to describe a group*/
 struct group_info
 {
@@ -58,8 +21,10 @@ struct group_info
 };
 
 /** implements the virtual interface of the obj_reader and stores all 
-	read information. The read information is automatically stored in 
-	binary form to accelerate the second loading of the same obj file. */
+	read information. The read information can be stored in binary form
+	with write_obj_bin and read back with read_obj_bin. Meshes that are
+	loaded through simple_mesh are cached in the mapped simple mesh format
+	instead (see simple_mesh::read). */
 template <typename T>
 class CGV_API obj_loader_generic : public obj_reader_generic<T>
 {
@@ -101,9 +66,13 @@ protected:
 	void process_group(const std::string& name, const std::string& parameters);
 	/// process a material definition
 	void process_material(const cgv::media::illum::obj_material& mtl, unsigned idx);
+	/// append the result of the parallel parser directly to the stored arrays
+	void process_bulk(obj_bulk_data<T>& data);
 	//@}
 public:
-	/// overloads reading to support binary file format
+	/// construct loader that takes the arrays of the parallel parser without recording the file order
+	obj_loader_generic();
+	/// overloads reading to clear previous data and to correct 8 bit colors
 	bool read_obj(const std::string& file_name);
 	/// read a binary version of an obj file
 	bool read_obj_bin(const std::string& file_name);
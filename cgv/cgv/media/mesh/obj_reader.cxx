@@ -4,7 +4,10 @@
 #include <cgv/type/standard_types.h>
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/utils/tokenizer.h>
+#include <cgv/utils/mapped_file.h>
 #include <cgv/base/import.h>
+#include <cstring>
+#include <algorithm>
 
 using namespace cgv::math;
 using namespace cgv::type;
@@ -86,6 +89,8 @@ unsigned obj_reader_base::get_current_material() const
 
 obj_reader_base::obj_reader_base()
 {
+	use_parallel_parser = true;
+	deferred_callbacks = 0;
 	clear();
 }
 
@@ -104,6 +109,7 @@ void obj_reader_base::clear()
 template <typename T>
 obj_reader_generic<T>::obj_reader_generic()
 {
+	record_file_order = true;
 }
 
 /// overide this function to process a comment
@@ -173,6 +179,33 @@ void obj_reader_base::process_material(const cgv::media::illum::obj_material& mt
 {
 }
 
+void obj_reader_base::call_process_group(const std::string& name, const std::string& parameters)
+{
+	if (!deferred_callbacks) {
+		process_group(name, parameters);
+		return;
+	}
+	obj_deferred_callback cb;
+	cb.is_group = true;
+	cb.name = name;
+	cb.parameters = parameters;
+	cb.index = 0;
+	deferred_callbacks->push_back(cb);
+}
+
+void obj_reader_base::call_process_material(const cgv::media::illum::obj_material& mtl, unsigned idx)
+{
+	if (!deferred_callbacks) {
+		process_material(mtl, idx);
+		return;
+	}
+	obj_deferred_callback cb;
+	cb.is_group = false;
+	cb.material = mtl;
+	cb.index = idx;
+	deferred_callbacks->push_back(cb);
+}
+
 ///
 template <typename T>
 void obj_reader_generic<T>::parse_and_process_vertex(const std::vector<cgv::utils::token>& tokens)
@@ -214,7 +247,7 @@ bool obj_reader_base::parse_obj(const std::string & content, const std::string p
 	group_index = -1;
 	nr_groups = 0;
 	nr_normals = nr_texcoords = 0;
-	std::map<std::string,unsigned> group_index_lut;
+	group_index_lut.clear();
 	std::vector<token> tokens;
 	for (unsigned li=0; li<lines.size(); ++li) {
 		if(li % 1000 == 0)
@@ -248,51 +281,15 @@ bool obj_reader_base::parse_obj(const std::string & content, const std::string p
 			}
 			break;
 		case 'f' :
-			if (group_index == -1) {
-				group_index = 0;
-				nr_groups = 1;
-				process_group("main","");
-				group_index_lut["main"] = group_index;
-			}
-			if (material_index == -1) {
-				obj_material m;
-				m.set_name("default");
-				material_index = 0;
-				nr_materials = 1;
-				process_material(m, 0);
-				material_index_lut[m.get_name()] = material_index;
-				have_default_material = true;
-			}
+			ensure_default_group_and_material(true);
 			parse_face(tokens); 
 			break;
 		case 'l':
-			if (group_index == -1) {
-				group_index = 0;
-				nr_groups = 1;
-				process_group("main", "");
-				group_index_lut["main"] = group_index;
-			}
+			ensure_default_group_and_material(false);
 			parse_face(tokens, true);
 			break;
 		case 'g' :
-			if (tokens.size() > 1) {
-				std::string name = to_string(tokens[1]);
-				std::string parameters;
-				if (tokens.size() > 2)
-					parameters.assign(tokens[2].begin, tokens.back().end - tokens[2].begin);
-
-				std::map<std::string,unsigned>::iterator it = 
-					group_index_lut.find(name);
-
-				if (it != group_index_lut.end())
-					group_index = it->second;
-				else {
-					group_index = nr_groups;
-					++nr_groups;
-					process_group(name, parameters);
-					group_index_lut[name] = group_index;
-				}
-			}
+			parse_group(tokens);
 			break;
 		default:
 			if (to_string(tokens[0]) == "usemtl")
@@ -342,12 +339,12 @@ bool obj_reader_base::read_mtl(const std::string& file_name)
 				// check if material name is new
 				if (material_index_lut.find(mtl.get_name()) == material_index_lut.end()) {
 					material_index_lut[mtl.get_name()] = nr_materials;
-					process_material(mtl, nr_materials);
+					call_process_material(mtl, nr_materials);
 					++nr_materials;
 				}
 				// if not overwrite old definition
 				else 
-					process_material(mtl, material_index_lut[mtl.get_name()]);
+					call_process_material(mtl, material_index_lut[mtl.get_name()]);
 			}
 			in_mtl = true;
 			mtl = obj_material();
@@ -394,12 +391,12 @@ bool obj_reader_base::read_mtl(const std::string& file_name)
 		// check if material name is new
 		if (material_index_lut.find(mtl.get_name()) == material_index_lut.end()) {
 			material_index_lut[mtl.get_name()] = nr_materials;
-			process_material(mtl, nr_materials);
+			call_process_material(mtl, nr_materials);
 			++nr_materials;
 		}
 		// if not overwrite old definition
 		else 
-			process_material(mtl, material_index_lut[mtl.get_name()]);
+			call_process_material(mtl, material_index_lut[mtl.get_name()]);
 	}
 	return true;
 }
@@ -416,6 +413,47 @@ void obj_reader_base::parse_material(const std::vector<token>& tokens)
 		material_index = it->second;
 }
 
+void obj_reader_base::ensure_default_group_and_material(bool is_face)
+{
+	if (group_index == unsigned(-1)) {
+		group_index = 0;
+		nr_groups = 1;
+		call_process_group("main", "");
+		group_index_lut["main"] = group_index;
+	}
+	if (is_face && material_index == unsigned(-1)) {
+		obj_material m;
+		m.set_name("default");
+		material_index = 0;
+		nr_materials = 1;
+		call_process_material(m, 0);
+		material_index_lut[m.get_name()] = material_index;
+		have_default_material = true;
+	}
+}
+
+void obj_reader_base::parse_group(const std::vector<token>& tokens)
+{
+	if (tokens.size() < 2)
+		return;
+	std::string name = to_string(tokens[1]);
+	std::string parameters;
+	if (tokens.size() > 2)
+		parameters.assign(tokens[2].begin, tokens.back().end - tokens[2].begin);
+
+	std::map<std::string, unsigned>::iterator it =
+		group_index_lut.find(name);
+
+	if (it != group_index_lut.end())
+		group_index = it->second;
+	else {
+		group_index = nr_groups;
+		++nr_groups;
+		call_process_group(name, parameters);
+		group_index_lut[name] = group_index;
+	}
+}
+
 void obj_reader_base::parse_face(const std::vector<token>& tokens, bool is_line)
 {
 	std::vector<int> vertex_indices;
@@ -470,6 +508,537 @@ void obj_reader_base::parse_face(const std::vector<token>& tokens, bool is_line)
 }
 
 
+namespace {
+	/// type of an obj line determined from its first token in the same way as in obj_reader_base::parse_obj
+	enum ObjLineType { OLT_OTHER, OLT_VERTEX, OLT_NORMAL, OLT_TEXCOORD, OLT_COLOR, OLT_FACE, OLT_LINE, OLT_GROUP, OLT_USEMTL, OLT_MTLLIB };
+	/// return the pointer behind the current line starting at p and set line_end to the end of the line without trailing spaces
+	inline const char* find_obj_line_end(const char* p, const char* end, const char*& line_end)
+	{
+		const char* q = (const char*)memchr(p, '\n', end - p);
+		if (!q)
+			q = end;
+		line_end = q;
+		while (line_end > p && is_space(line_end[-1]))
+			--line_end;
+		return q == end ? end : q + 1;
+	}
+	/// split a line at blanks and tabs into tokens, which is equivalent to the default tokenizer on a line
+	inline void split_obj_line(const char* p, const char* end, std::vector<token>& tokens)
+	{
+		tokens.clear();
+		while (true) {
+			while (p < end && (*p == ' ' || *p == '\t'))
+				++p;
+			if (p == end)
+				break;
+			const char* b = p;
+			while (p < end && *p != ' ' && *p != '\t')
+				++p;
+			tokens.push_back(token(b, p));
+		}
+	}
+	/// classify line by the first of its tokens
+	inline ObjLineType classify_obj_line(const char* p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t'))
+			++p;
+		if (p == end)
+			return OLT_OTHER;
+		const char* b = p;
+		while (p < end && *p != ' ' && *p != '\t')
+			++p;
+		switch (*b) {
+		case 'v':
+			if (p - b == 1)
+				return OLT_VERTEX;
+			switch (b[1]) {
+			case 'n': return OLT_NORMAL;
+			case 't': return OLT_TEXCOORD;
+			case 'c': return OLT_COLOR;
+			}
+			return OLT_OTHER;
+		case 'f': return OLT_FACE;
+		case 'l': return OLT_LINE;
+		case 'g': return OLT_GROUP;
+		}
+		if (p - b == 6 && strncmp(b, "usemtl", 6) == 0)
+			return OLT_USEMTL;
+		if (p - b == 6 && strncmp(b, "mtllib", 6) == 0)
+			return OLT_MTLLIB;
+		return OLT_OTHER;
+	}
+	/// same result as atoi on the token
+	inline int obj_atoi(const char* p, const char* end)
+	{
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+		int value = 0;
+		while (p < end && *p >= '0' && *p <= '9')
+			value = 10 * value + (*p++ - '0');
+		return negative ? -value : value;
+	}
+	/** split a face corner at slashes equivalently to tokenizer(corner).set_sep("/"), where each slash is a token of its own.
+	    The first five subtokens are stored in sub and the total number is returned. */
+	inline unsigned split_obj_corner(const char* p, const char* end, token* sub)
+	{
+		unsigned n = 0;
+		while (p < end) {
+			const char* b = p;
+			if (*p == '/')
+				++p;
+			else
+				while (p < end && *p != '/')
+					++p;
+			if (n < 5)
+				sub[n] = token(b, p);
+			++n;
+		}
+		return n;
+	}
+	/// line of the rare state changing type or first face or line strip after a state change
+	struct obj_state_item
+	{
+		ObjLineType type;
+		const char* begin;
+		const char* end;
+		/// group and material index after processing the item
+		unsigned group_index, material_index;
+		/// range of deferred callbacks issued by the item
+		size_t first_callback, end_callback;
+	};
+	/// line aligned chunk of the content parsed in parallel
+	struct obj_chunk
+	{
+		const char* begin;
+		const char* end;
+		/// number of vertex, normal and texcoord lines and the corresponding offsets
+		size_t nr_vertices, nr_normals, nr_texcoords;
+		size_t vertex_offset, normal_offset, texcoord_offset;
+		/// state items in line order
+		std::vector<obj_state_item> items;
+		/// group and material index at chunk begin
+		unsigned group_index, material_index;
+	};
+	/// target number of bytes per chunk
+	const size_t obj_chunk_size = size_t(1) << 20;
+}
+
+template <typename T>
+bool obj_reader_generic<T>::parse_obj_parallel(const char* begin, const char* end)
+{
+	minus = 1;
+	material_index = -1;
+	group_index = -1;
+	nr_groups = 0;
+	nr_normals = nr_texcoords = 0;
+	group_index_lut.clear();
+
+	// split into line aligned chunks whose number only depends on the content size
+	size_t size = end - begin;
+	int nr_chunks = int(std::max(size_t(1), std::min(size_t(1024), size / obj_chunk_size)));
+	std::vector<obj_chunk> chunks(nr_chunks);
+	const char* p = begin;
+	for (int c = 0; c < nr_chunks; ++c) {
+		chunks[c].begin = p;
+		if (c + 1 == nr_chunks)
+			p = end;
+		else {
+			const char* q = std::max(p, begin + size * (c + 1) / nr_chunks);
+			if (q > begin && q < end && q[-1] != '\n') {
+				q = (const char*)memchr(q, '\n', end - q);
+				q = q ? q + 1 : end;
+			}
+			p = q;
+		}
+		chunks[c].end = p;
+	}
+	// first pass: count attribute lines and collect state items
+#pragma omp parallel for schedule(dynamic)
+	for (int c = 0; c < nr_chunks; ++c) {
+		obj_chunk& C = chunks[c];
+		C.nr_vertices = C.nr_normals = C.nr_texcoords = 0;
+		bool face_marker = true, line_marker = true;
+		const char* le;
+		for (const char* lp = C.begin; lp < C.end; ) {
+			const char* next = find_obj_line_end(lp, C.end, le);
+			ObjLineType type = classify_obj_line(lp, le);
+			switch (type) {
+			case OLT_VERTEX: ++C.nr_vertices; break;
+			case OLT_NORMAL: ++C.nr_normals; break;
+			case OLT_TEXCOORD: ++C.nr_texcoords; break;
+			case OLT_FACE:
+			case OLT_LINE: {
+				bool& marker = type == OLT_FACE ? face_marker : line_marker;
+				if (marker) {
+					obj_state_item item = { type, lp, le, unsigned(-1), unsigned(-1), 0, 0 };
+					C.items.push_back(item);
+					marker = false;
+				}
+				break;
+			}
+			case OLT_GROUP:
+			case OLT_USEMTL:
+			case OLT_MTLLIB: {
+				obj_state_item item = { type, lp, le, unsigned(-1), unsigned(-1), 0, 0 };
+				C.items.push_back(item);
+				face_marker = line_marker = true;
+				break;
+			}
+			default: break;
+			}
+			lp = next;
+		}
+	}
+	// serial pass over state items, which processes groups and materials in file order. If the file order is
+	// recorded, the group and material callbacks are deferred to the replay in process_bulk
+	obj_bulk_data<T> data;
+	if (record_file_order)
+		deferred_callbacks = &data.callbacks;
+	size_t nr_v = 0, nr_n = 0, nr_t = 0;
+	std::vector<token> tokens;
+	for (int c = 0; c < nr_chunks; ++c) {
+		obj_chunk& C = chunks[c];
+		C.vertex_offset = nr_v;
+		C.normal_offset = nr_n;
+		C.texcoord_offset = nr_t;
+		nr_v += C.nr_vertices;
+		nr_n += C.nr_normals;
+		nr_t += C.nr_texcoords;
+		C.group_index = group_index;
+		C.material_index = material_index;
+		for (auto& item : C.items) {
+			item.first_callback = data.callbacks.size();
+			switch (item.type) {
+			case OLT_FACE:
+			case OLT_LINE:
+				ensure_default_group_and_material(item.type == OLT_FACE);
+				break;
+			case OLT_GROUP:
+				split_obj_line(item.begin, item.end, tokens);
+				parse_group(tokens);
+				break;
+			case OLT_USEMTL:
+				split_obj_line(item.begin, item.end, tokens);
+				parse_material(tokens);
+				break;
+			default:
+				split_obj_line(item.begin, item.end, tokens);
+				if (tokens.size() > 1)
+					read_mtl(to_string(tokens[1]));
+				break;
+			}
+			item.group_index = group_index;
+			item.material_index = material_index;
+			item.end_callback = data.callbacks.size();
+			if (record_file_order)
+				data.states.push_back(std::make_pair(group_index, material_index));
+		}
+	}
+	deferred_callbacks = 0;
+	// second pass: parse chunks with known attribute offsets
+	std::vector<obj_bulk_data<T> > chunk_data(nr_chunks);
+#pragma omp parallel for schedule(dynamic)
+	for (int c = 0; c < nr_chunks; ++c) {
+		const obj_chunk& C = chunks[c];
+		obj_bulk_data<T>& D = chunk_data[c];
+		D.vertices.reserve(C.nr_vertices);
+		D.normals.reserve(C.nr_normals);
+		D.texcoords.reserve(C.nr_texcoords);
+		unsigned gi = C.group_index, mi = C.material_index;
+		size_t next_item = 0;
+		std::vector<token> line_tokens;
+		std::vector<int> vis, tis, nis;
+		token sub[5];
+		const char* le;
+		for (const char* lp = C.begin; lp < C.end; ) {
+			const char* next = find_obj_line_end(lp, C.end, le);
+			ObjLineType type = classify_obj_line(lp, le);
+			// state lines and the first face or line strip after a state change are items of the serial pass
+			if (type >= OLT_FACE && next_item < C.items.size() && C.items[next_item].begin == lp) {
+				const obj_state_item& item = C.items[next_item++];
+				gi = item.group_index;
+				mi = item.material_index;
+				if (record_file_order) {
+					D.element_types.insert(D.element_types.end(), item.end_callback - item.first_callback, (unsigned char)OET_CALLBACK);
+					D.element_types.push_back(OET_STATE);
+				}
+			}
+			switch (type) {
+			case OLT_VERTEX:
+				split_obj_line(lp, le, line_tokens);
+				D.vertices.push_back(parse_v3d(line_tokens));
+				if (line_tokens.size() >= 7)
+					D.colors.push_back(parse_color(line_tokens, 3));
+				if (record_file_order)
+					D.element_types.push_back(line_tokens.size() >= 7 ? OET_VERTEX_WITH_COLOR : OET_VERTEX);
+				break;
+			case OLT_NORMAL:
+				split_obj_line(lp, le, line_tokens);
+				D.normals.push_back(parse_v3d(line_tokens));
+				if (record_file_order)
+					D.element_types.push_back(OET_NORMAL);
+				break;
+			case OLT_TEXCOORD:
+				split_obj_line(lp, le, line_tokens);
+				D.texcoords.push_back(parse_v2d(line_tokens));
+				if (record_file_order)
+					D.element_types.push_back(OET_TEXCOORD);
+				break;
+			case OLT_COLOR:
+				split_obj_line(lp, le, line_tokens);
+				D.colors.push_back(parse_color(line_tokens));
+				if (record_file_order)
+					D.element_types.push_back(OET_COLOR);
+				break;
+			case OLT_FACE:
+			case OLT_LINE: {
+				// replicate obj_reader_base::parse_face with the attribute counts at the current line
+				int nv = int(C.vertex_offset + D.vertices.size());
+				int nn = int(C.normal_offset + D.normals.size());
+				int nt = int(C.texcoord_offset + D.texcoords.size());
+				split_obj_line(lp, le, line_tokens);
+				vis.clear(); tis.clear(); nis.clear();
+				for (size_t i = 1; i < line_tokens.size(); ++i) {
+					unsigned n = split_obj_corner(line_tokens[i].begin, line_tokens[i].end, sub);
+					if (n < 1)
+						continue;
+					int vi = obj_atoi(sub[0].begin, sub[0].end);
+					if (vi > 0)
+						vi -= minus;
+					vis.push_back(vi);
+					if (n == 1) {
+						if (nn > vi)
+							nis.push_back(vi);
+						if (nt > vi)
+							tis.push_back(vi);
+						continue;
+					}
+					if (n < 3)
+						continue;
+					unsigned j = 2;
+					if (sub[j] != "/") {
+						int ti = obj_atoi(sub[j].begin, sub[j].end);
+						if (ti > 0)
+							ti -= minus;
+						if (nt > ti)
+							tis.push_back(ti);
+						++j;
+					}
+					if (n < j + 2)
+						continue;
+					int ni = obj_atoi(sub[j + 1].begin, sub[j + 1].end);
+					if (ni > 0)
+						ni -= minus;
+					if (nn > ni)
+						nis.push_back(ni);
+				}
+				if (vis.empty())
+					break;
+				bool has_tex = tis.size() == vis.size();
+				bool has_nml = nis.size() == vis.size();
+				unsigned vi0 = unsigned(D.vertex_indices.size());
+				int ti0 = has_tex ? int(D.texcoord_indices.size()) : -1;
+				int ni0 = has_nml ? int(D.normal_indices.size()) : -1;
+				for (size_t i = 0; i < vis.size(); ++i) {
+					D.vertex_indices.push_back(unsigned(vis[i] < 0 ? vis[i] + nv : vis[i]));
+					if (has_tex)
+						D.texcoord_indices.push_back(unsigned(tis[i] < 0 ? tis[i] + nt : tis[i]));
+					if (has_nml)
+						D.normal_indices.push_back(unsigned(nis[i] < 0 ? nis[i] + nn : nis[i]));
+				}
+				// the serial pass has selected the default group and material for the first element after a state change
+				if (type == OLT_FACE)
+					D.faces.push_back(face_info(unsigned(vis.size()), vi0, ti0, ni0, gi, mi));
+				else
+					D.lines.push_back(line_info(unsigned(vis.size()), vi0, ti0, ni0, gi));
+				if (record_file_order)
+					D.element_types.push_back(type == OLT_FACE ? OET_FACE : OET_LINE);
+				break;
+			}
+			default: break;
+			}
+			lp = next;
+		}
+	}
+	// merge chunk results with prefix summed offsets
+	std::vector<size_t> offsets(10 * (nr_chunks + 1), 0);
+	for (int c = 0; c < nr_chunks; ++c) {
+		const obj_bulk_data<T>& D = chunk_data[c];
+		size_t sizes[10] = { D.vertices.size(), D.normals.size(), D.texcoords.size(), D.colors.size(),
+			D.vertex_indices.size(), D.normal_indices.size(), D.texcoord_indices.size(), D.lines.size(), D.faces.size(), D.element_types.size() };
+		for (int k = 0; k < 10; ++k)
+			offsets[10 * (c + 1) + k] = offsets[10 * c + k] + sizes[k];
+	}
+	const size_t* total = &offsets[10 * nr_chunks];
+	data.vertices.resize(total[0]);
+	data.normals.resize(total[1]);
+	data.texcoords.resize(total[2]);
+	data.colors.resize(total[3]);
+	data.vertex_indices.resize(total[4]);
+	data.normal_indices.resize(total[5]);
+	data.texcoord_indices.resize(total[6]);
+	data.lines.resize(total[7]);
+	data.faces.resize(total[8]);
+	data.element_types.resize(total[9]);
+#pragma omp parallel for schedule(dynamic)
+	for (int c = 0; c < nr_chunks; ++c) {
+		obj_bulk_data<T>& D = chunk_data[c];
+		const size_t* o = &offsets[10 * c];
+		std::copy(D.vertices.begin(), D.vertices.end(), data.vertices.begin() + o[0]);
+		std::copy(D.normals.begin(), D.normals.end(), data.normals.begin() + o[1]);
+		std::copy(D.texcoords.begin(), D.texcoords.end(), data.texcoords.begin() + o[2]);
+		std::copy(D.colors.begin(), D.colors.end(), data.colors.begin() + o[3]);
+		std::copy(D.vertex_indices.begin(), D.vertex_indices.end(), data.vertex_indices.begin() + o[4]);
+		std::copy(D.normal_indices.begin(), D.normal_indices.end(), data.normal_indices.begin() + o[5]);
+		std::copy(D.texcoord_indices.begin(), D.texcoord_indices.end(), data.texcoord_indices.begin() + o[6]);
+		std::copy(D.element_types.begin(), D.element_types.end(), data.element_types.begin() + o[9]);
+		for (size_t i = 0; i < D.lines.size(); ++i) {
+			line_info& L = data.lines[o[7] + i] = D.lines[i];
+			L.first_vertex_index += unsigned(o[4]);
+			if (L.first_normal_index != -1)
+				L.first_normal_index += int(o[5]);
+			if (L.first_texcoord_index != -1)
+				L.first_texcoord_index += int(o[6]);
+		}
+		for (size_t i = 0; i < D.faces.size(); ++i) {
+			face_info& F = data.faces[o[8] + i] = D.faces[i];
+			F.first_vertex_index += unsigned(o[4]);
+			if (F.first_normal_index != -1)
+				F.first_normal_index += int(o[5]);
+			if (F.first_texcoord_index != -1)
+				F.first_texcoord_index += int(o[6]);
+		}
+		D = obj_bulk_data<T>();
+	}
+	chunk_data.clear();
+	nr_normals = unsigned(nr_n);
+	nr_texcoords = unsigned(nr_t);
+	process_bulk(data);
+	return true;
+}
+
+template <typename T>
+void obj_reader_generic<T>::process_bulk(obj_bulk_data<T>& data)
+{
+	// element indices are already positive, such that convert_to_positive does not change them
+	unsigned gi = group_index, mi = material_index;
+	std::vector<int> buffer;
+	auto process_element = [&](bool is_face, unsigned nr, unsigned vi0, int ti0, int ni0) {
+		buffer.resize(3 * nr);
+		int* vis = &buffer[0];
+		int* tis = ti0 == -1 ? 0 : vis + nr;
+		int* nis = ni0 == -1 ? 0 : vis + 2 * nr;
+		for (unsigned i = 0; i < nr; ++i) {
+			vis[i] = int(data.vertex_indices[vi0 + i]);
+			if (tis)
+				tis[i] = int(data.texcoord_indices[ti0 + i]);
+			if (nis)
+				nis[i] = int(data.normal_indices[ni0 + i]);
+		}
+		if (is_face)
+			process_face(nr, vis, tis, nis);
+		else
+			process_line(nr, vis, tis, nis);
+	};
+	if (data.element_types.empty()) {
+		for (const auto& p : data.vertices)
+			process_vertex(p);
+		for (const auto& t : data.texcoords)
+			process_texcoord(t);
+		for (const auto& n : data.normals)
+			process_normal(n);
+		for (const auto& c : data.colors)
+			process_color(c);
+		for (const auto& F : data.faces) {
+			group_index = F.group_index;
+			material_index = F.material_index;
+			process_element(true, F.degree, F.first_vertex_index, F.first_texcoord_index, F.first_normal_index);
+		}
+		for (const auto& L : data.lines) {
+			group_index = L.group_index;
+			process_element(false, L.length, L.first_vertex_index, L.first_texcoord_index, L.first_normal_index);
+		}
+	}
+	else {
+		// replay in file order, where the group and material index change as in the serial parser
+		group_index = material_index = unsigned(-1);
+		size_t vi = 0, ni = 0, ti = 0, ci = 0, fi = 0, li = 0, cbi = 0, si = 0;
+		for (unsigned char et : data.element_types) {
+			switch (et) {
+			case OET_VERTEX:
+				process_vertex(data.vertices[vi++]);
+				break;
+			case OET_VERTEX_WITH_COLOR:
+				process_vertex(data.vertices[vi++]);
+				process_color(data.colors[ci++]);
+				break;
+			case OET_NORMAL:
+				process_normal(data.normals[ni++]);
+				break;
+			case OET_TEXCOORD:
+				process_texcoord(data.texcoords[ti++]);
+				break;
+			case OET_COLOR:
+				process_color(data.colors[ci++]);
+				break;
+			case OET_FACE: {
+				const face_info& F = data.faces[fi++];
+				group_index = F.group_index;
+				material_index = F.material_index;
+				process_element(true, F.degree, F.first_vertex_index, F.first_texcoord_index, F.first_normal_index);
+				break;
+			}
+			case OET_LINE: {
+				const line_info& L = data.lines[li++];
+				group_index = L.group_index;
+				process_element(false, L.length, L.first_vertex_index, L.first_texcoord_index, L.first_normal_index);
+				break;
+			}
+			case OET_CALLBACK: {
+				const obj_deferred_callback& cb = data.callbacks[cbi++];
+				if (cb.is_group)
+					process_group(cb.name, cb.parameters);
+				else
+					process_material(cb.material, cb.index);
+				break;
+			}
+			case OET_STATE:
+				group_index = data.states[si].first;
+				material_index = data.states[si].second;
+				++si;
+				break;
+			}
+		}
+	}
+	group_index = gi;
+	material_index = mi;
+}
+
+template <typename T>
+bool obj_reader_generic<T>::parse_obj(const std::string& content, const std::string path_name)
+{
+	if (!use_parallel_parser)
+		return obj_reader_base::parse_obj(content, path_name);
+	return parse_obj_parallel(content.data(), content.data() + content.size());
+}
+
+template <typename T>
+bool obj_reader_generic<T>::read_obj(const std::string& file_name)
+{
+	// resource and string files are not mapped but read by the base implementation, which calls parse_obj
+	if (!use_parallel_parser || file_name.substr(0, 6) == "str://" || file_name.substr(0, 6) == "res://")
+		return obj_reader_base::read_obj(file_name);
+	cgv::utils::mapped_file mf;
+	if (!mf.open(file_name))
+		return obj_reader_base::read_obj(file_name);
+	mf.advise(cgv::utils::mapped_file::AH_SEQUENTIAL);
+	path_name = file::get_path(file_name);
+	if (!path_name.empty())
+		path_name += "/";
+	return parse_obj_parallel(mf.get_data(), mf.get_data() + mf.get_size());
+}
+
 template class obj_reader_generic < float >;
 template class obj_reader_generic < double >;
 
@@ -14,6 +14,91 @@ namespace cgv {
 	namespace media {
 		namespace mesh {
 
+/** simple structure to describe a face */
+struct CGV_API face_info
+{
+	/// degree of face
+	unsigned degree;
+	/// index into vertex index array
+	unsigned first_vertex_index;
+	/// index into texcoord index array or -1 if not specified
+	int first_texcoord_index;
+	/// index into normal index array or -1 if not specified
+	int first_normal_index;
+	/// index of group to which the face belongs
+	int      group_index;
+	/// material index to which the face belongs
+	int      material_index;
+	/// construct face info
+	face_info(unsigned _nr = 0, unsigned _vi0 = 0, int _ti0 = -1, int _ni0 = -1, unsigned gi=-1, unsigned mi=-1); 
+};
+
+/** simple structure to describe a line */
+struct CGV_API line_info
+{
+	/// length of line strip
+	unsigned length;
+	/// index into vertex index array
+	unsigned first_vertex_index;
+	/// index into texcoord index array or -1 if not specified
+	int first_texcoord_index;
+	/// index into normal index array or -1 if not specified
+	int first_normal_index;
+	/// index of group to which the face belongs
+	int      group_index;
+	/// construct face info
+	line_info(unsigned _nr = 0, unsigned _vi0 = 0, int _ti0 = -1, int _ni0 = -1, unsigned gi = -1);
+};
+
+
+/** group or material callback of the parallel obj parser, which is deferred till the elements are replayed in file order */
+struct CGV_API obj_deferred_callback
+{
+	/// whether process_group or process_material is called
+	bool is_group;
+	/// name and parameters of group
+	std::string name, parameters;
+	/// material and its index
+	illum::obj_material material;
+	unsigned index;
+};
+
+/// element types of obj_bulk_data::element_types in file order
+enum ObjElementType
+{
+	OET_VERTEX,
+	OET_VERTEX_WITH_COLOR,
+	OET_NORMAL,
+	OET_TEXCOORD,
+	OET_COLOR,
+	OET_FACE,
+	OET_LINE,
+	OET_CALLBACK,
+	OET_STATE
+};
+
+/** bulk result of the parallel obj parser in the layout of obj_loader_generic, where all
+    indices start with 0 and negative indices have been resolved */
+template <typename T>
+struct obj_bulk_data
+{
+	std::vector<cgv::math::fvec<T,3> > vertices;
+	std::vector<cgv::math::fvec<T,3> > normals;
+	std::vector<cgv::math::fvec<T,2> > texcoords;
+	std::vector<illum::obj_material::color_type> colors;
+	std::vector<unsigned> vertex_indices;
+	std::vector<unsigned> normal_indices;
+	std::vector<unsigned> texcoord_indices;
+	std::vector<line_info> lines;
+	std::vector<face_info> faces;
+	/// if the file order is recorded, one ObjElementType per element in file order
+	std::vector<unsigned char> element_types;
+	/// if the file order is recorded, the group and material callbacks that have been deferred to the replay
+	std::vector<obj_deferred_callback> callbacks;
+	/// if the file order is recorded, the group and material index after each group, material or library line
+	std::vector<std::pair<unsigned, unsigned> > states;
+};
+
 /** base class for obj reader with implementation that is independent of coordinate type.*/
 class CGV_API obj_reader_base
 {
@@ -50,6 +135,18 @@ protected:
 	//@{
 	/// store the path name
 	std::string path_name;
+	/// mapping from group names to group indices of the file currently parsed
+	std::map<std::string, unsigned> group_index_lut;
+	/// select group from a g-line in the same way as parse_obj, if group is new call process_group
+	void parse_group(const std::vector<cgv::utils::token>& tokens);
+	/// ensure that a group is selected and for faces also that a material is selected before an element is processed
+	void ensure_default_group_and_material(bool is_face);
+	/// if not null, group and material callbacks are appended here instead of being called
+	std::vector<obj_deferred_callback>* deferred_callbacks;
+	/// call process_group or defer the call
+	void call_process_group(const std::string& name, const std::string& parameters);
+	/// call process_material or defer the call
+	void call_process_material(const cgv::media::illum::obj_material& mtl, unsigned idx);
 	/// return the index of the currently selected group or -1 if no group is defined
 	unsigned get_current_group() const;
 	/// return the index of the currently selected material or -1 if no material is defined
@@ -77,6 +174,8 @@ protected:
 	virtual void process_material(const cgv::media::illum::obj_material& mtl, unsigned idx);
 	//@}
 public:
+	/// whether read_obj and parse_obj use the chunk parallel parser of obj_reader_generic (default), otherwise the serial line by line parser is used
+	bool use_parallel_parser;
 	///
 	obj_reader_base();
 	/// parse the content of an obj file already read to memory, where path_name is used to find material files
@@ -128,10 +227,28 @@ protected:
 	virtual void process_texcoord(const v2d_type& t);
 	/// overide this function to process a normal
 	virtual void process_normal(const v3d_type& n);
+	/** overide this function to process the complete content of a file parsed with the parallel parser at once. The
+	    default implementation is the compatibility path that replays all callbacks in file order, such that a reader
+		sees the same callback sequence as with the serial parser. This requires record_file_order to be set. Otherwise
+		process_group and process_material have been called before process_bulk and the per element callbacks are
+		replayed grouped by type with the group and material of each element selected. */
+	virtual void process_bulk(obj_bulk_data<T>& data);
 	//@}
+	/** whether the parallel parser records the file order of all elements and defers the group and material callbacks
+	    for the replay in process_bulk (default). Readers that override process_bulk and only use the arrays should
+		clear this flag. */
+	bool record_file_order;
+	/** parse obj content in parallel: the content is split into line aligned chunks whose vertex attribute lines
+	    are counted in parallel. After a serial pass over the rare group and material lines, all chunks are parsed
+		in parallel with the known attribute offsets and merged with prefix summed offsets before process_bulk is called. */
+	bool parse_obj_parallel(const char* begin, const char* end);
 public:
 	/// default constructor
 	obj_reader_generic();
+	/// parse the content of an obj file with the parallel parser if use_parallel_parser is set
+	bool parse_obj(const std::string& content, const std::string path_name = "");
+	/// read an obj file, which is memory mapped if the parallel parser is used
+	bool read_obj(const std::string& file_name);
 };
 
 typedef obj_reader_generic<float>  obj_readerf;
@@ -1,11 +1,16 @@
 #include "simple_mesh.h"
 #include "stl_reader.h"
 #include "obj_loader.h"
+#include "mapped_simple_mesh.h"
+#include "vertex_cache_optimizer.h"
 #include <cgv/math/inv.h>
 #include <cgv/utils/scan.h>
 #include <cgv/media/mesh/obj_reader.h>
 #include <cgv/math/bucket_sort.h>
+#include <cgv/math/radix_sort.h>
 #include <fstream>
+#include <cstring>
+#include <atomic>
 
 namespace cgv {
 	namespace media {
@@ -26,7 +31,8 @@ simple_mesh_base::simple_mesh_base(const simple_mesh_base& smb) :
 	group_indices(smb.group_indices),
 	group_names(smb.group_names),
 	material_indices(smb.material_indices),
-	materials(smb.materials)
+	materials(smb.materials),
+	stored_element_buffers(smb.stored_element_buffers)
 {
 }
 /// move constructor
@@ -39,7 +45,8 @@ simple_mesh_base::simple_mesh_base(simple_mesh_base&& smb) :
 	group_indices(std::move(smb.group_indices)),
 	group_names(std::move(smb.group_names)),
 	material_indices(std::move(smb.material_indices)),
-	materials(std::move(smb.materials))
+	materials(std::move(smb.materials)),
+	stored_element_buffers(std::move(smb.stored_element_buffers))
 {
 }
 
@@ -55,6 +62,7 @@ simple_mesh_base& simple_mesh_base::operator=(const simple_mesh_base& smb)
 	group_names=smb.group_names;
 	material_indices=smb.material_indices;
 	materials = smb.materials;
+	stored_element_buffers = smb.stored_element_buffers;
 	return *this;
 }
 
@@ -70,9 +78,51 @@ simple_mesh_base& simple_mesh_base::operator=(simple_mesh_base&& smb)
 	group_names=std::move(smb.group_names);
 	material_indices=std::move(smb.material_indices);
 	materials = std::move(smb.materials);
+	stored_element_buffers = std::move(smb.stored_element_buffers);
 	return *this;
 }
 
+/// compute a checksum over the index arrays and the group and material counts
+cgv::type::uint64_type simple_mesh_base::compute_connectivity_checksum() const
+{
+	const std::vector<idx_type>* index_arrays[] = { &position_indices, &normal_indices, &tangent_indices,
+		&tex_coord_indices, &faces, &group_indices, &material_indices };
+	cgv::type::uint64_type counts[] = { group_names.size(), materials.size() };
+	cgv::type::uint64_type checksum = mapped_simple_mesh::compute_checksum(counts, sizeof(counts));
+	for (const auto* I : index_arrays) {
+		cgv::type::uint64_type c[2] = { checksum, I->size() };
+		if (!I->empty())
+			c[1] ^= mapped_simple_mesh::compute_checksum(&I->front(), I->size() * sizeof(idx_type));
+		checksum = mapped_simple_mesh::compute_checksum(c, sizeof(c));
+	}
+	return checksum;
+}
+
+/// return the element buffers restored from an msm file if the connectivity has not been changed
+const simple_mesh_base::element_buffers* simple_mesh_base::get_stored_element_buffers() const
+{
+	if (stored_element_buffers.triangle_element_buffer.empty() ||
+		stored_element_buffers.connectivity_checksum != compute_connectivity_checksum())
+		return 0;
+	return &stored_element_buffers;
+}
+
+namespace {
+	std::atomic<bool> msm_cache_enabled(false);
+}
+
+/// set whether simple_mesh::read(file_name) caches obj files in msm files next to them
+void simple_mesh_base::set_msm_cache_enabled(bool enabled)
+{
+	msm_cache_enabled = enabled;
+}
+
+/// return whether simple_mesh::read(file_name) caches obj files in msm files
+bool simple_mesh_base::is_msm_cache_enabled()
+{
+	return msm_cache_enabled;
+}
+
 simple_mesh_base::idx_type simple_mesh_base::start_face()
 {
 	faces.push_back((cgv::type::uint32_type)position_indices.size());
@@ -141,27 +191,60 @@ void simple_mesh_base::merge_indices(std::vector<idx_type>& indices, std::vector
 	if(include_tangents_ptr)
 		*include_tangents_ptr = include_tangents = (tangent_indices.size() > 0) && *include_tangents_ptr;
 
-	std::map<std::tuple<idx_type, idx_type, idx_type, idx_type>, idx_type> corner_to_index;
-	for (idx_type ci = 0; ci < position_indices.size(); ++ci) {
-		// construct corner
-		vec4i c(position_indices[ci], 
-			    (include_tex_coords && ci < tex_coord_indices.size()) ? tex_coord_indices[ci] : 0, 
-			    (include_normals && ci < normal_indices.size()) ? normal_indices[ci] : 0,
-			    (include_tangents && ci < tangent_indices.size()) ? tangent_indices[ci] : 0);
-		std::tuple<idx_type, idx_type, idx_type, idx_type> quadruple(c(0),c(1),c(2),c(3));
-		// look corner up in map
-		auto iter = corner_to_index.find(quadruple);
-		// determine vertex index
-		idx_type vi;
-		if (iter == corner_to_index.end()) {
-			vi = idx_type(unique_quadruples.size());
-			corner_to_index[quadruple] = vi;
-			unique_quadruples.push_back(c);
+	// collect the attribute index vectors that take part in the merge with the most significant first
+	idx_type nr_corners = idx_type(position_indices.size());
+	std::vector<const std::vector<idx_type>*> corner_attributes(4, 0);
+	std::vector<std::vector<idx_type> > padded_attributes(4);
+	const std::vector<idx_type>* attribute_indices[4] = { &position_indices, &tex_coord_indices, &normal_indices, &tangent_indices };
+	bool included[4] = { true, include_tex_coords, include_normals, include_tangents };
+	std::vector<const std::vector<uint32_t>*> keys;
+	std::vector<uint32_t> max_keys;
+	for (int ai = 0; ai < 4; ++ai) {
+		if (!included[ai])
+			continue;
+		const std::vector<idx_type>* A = attribute_indices[ai];
+		// missing trailing indices are treated as 0 like in the corner construction
+		if (A->size() < nr_corners) {
+			padded_attributes[ai] = *A;
+			padded_attributes[ai].resize(nr_corners, 0);
+			A = &padded_attributes[ai];
+		}
+		corner_attributes[ai] = A;
+		keys.push_back(A);
+		max_keys.push_back(nr_corners > 0 ? *std::max_element(A->begin(), A->begin() + nr_corners) : 0);
+	}
+	// sort corners by their attribute index tuple, where equal corners stay in increasing order
+	std::vector<idx_type> perm;
+	cgv::math::radix_sort_lexicographic(nr_corners, keys, max_keys, perm);
+	// per corner store first corner with the same tuple
+	std::vector<idx_type> first_corner(nr_corners);
+	for (idx_type i = 0; i < nr_corners; ) {
+		idx_type j = i + 1;
+		while (j < nr_corners) {
+			bool equal = true;
+			for (size_t k = 0; equal && k < keys.size(); ++k)
+				equal = (*keys[k])[perm[i]] == (*keys[k])[perm[j]];
+			if (!equal)
+				break;
+			++j;
+		}
+		for (idx_type k = i; k < j; ++k)
+			first_corner[perm[k]] = perm[i];
+		i = j;
+	}
+	// number unique corners in the order of their first occurrence
+	size_t ci0 = indices.size();
+	indices.resize(ci0 + nr_corners);
+	for (idx_type ci = 0; ci < nr_corners; ++ci) {
+		if (first_corner[ci] == ci) {
+			indices[ci0 + ci] = idx_type(unique_quadruples.size());
+			unique_quadruples.push_back(vec4i(position_indices[ci],
+				corner_attributes[1] ? corner_attributes[1]->at(ci) : 0,
+				corner_attributes[2] ? corner_attributes[2]->at(ci) : 0,
+				corner_attributes[3] ? corner_attributes[3]->at(ci) : 0));
 		}
 		else
-			vi = iter->second;
-
-		indices.push_back(vi);
+			indices[ci0 + ci] = indices[ci0 + first_corner[ci]];
 	}
 }
 
@@ -196,34 +279,76 @@ void simple_mesh_base::extract_triangle_element_buffer(
 	}
 }
 
+/// optimize element buffers for the vertex cache and sequential vertex fetches
+void simple_mesh_base::optimize_element_buffers(std::vector<idx_type>& vertex_indices, std::vector<vec4i>& unique_tuples,
+	std::vector<idx_type>& triangle_element_buffer, const std::vector<vec3i>* material_group_start_ptr,
+	double* acmr_before_ptr, double* acmr_after_ptr, unsigned cache_size) const
+{
+	if (acmr_before_ptr)
+		*acmr_before_ptr = compute_acmr(triangle_element_buffer, cache_size);
+	// reorder triangles independently per material group range, which is the unit of draw calls
+	std::vector<size_t> range_starts;
+	if (material_group_start_ptr)
+		for (const auto& mgs : *material_group_start_ptr)
+			range_starts.push_back(mgs[2]);
+	if (range_starts.empty() || range_starts.front() != 0)
+		range_starts.insert(range_starts.begin(), 0);
+	range_starts.push_back(triangle_element_buffer.size());
+	int nr_ranges = int(range_starts.size()) - 1;
+#pragma omp parallel for schedule(dynamic)
+	for (int ri = 0; ri < nr_ranges; ++ri)
+		optimize_vertex_cache(triangle_element_buffer, range_starts[ri], range_starts[ri + 1], cache_size);
+	// renumber vertices in order of first use
+	std::vector<idx_type> old_to_new;
+	compute_vertex_fetch_order(triangle_element_buffer, idx_type(unique_tuples.size()), old_to_new);
+	std::vector<vec4i> new_tuples(unique_tuples.size());
+	for (size_t vi = 0; vi < unique_tuples.size(); ++vi)
+		new_tuples[old_to_new[vi]] = unique_tuples[vi];
+	unique_tuples.swap(new_tuples);
+	for (auto& vi : triangle_element_buffer)
+		vi = old_to_new[vi];
+	for (auto& vi : vertex_indices)
+		vi = old_to_new[vi];
+	if (acmr_after_ptr)
+		*acmr_after_ptr = compute_acmr(triangle_element_buffer, cache_size);
+}
+
 /// extract element array buffers for edges in wireframe
 void simple_mesh_base::extract_wireframe_element_buffer(const std::vector<idx_type>& vertex_indices, std::vector<idx_type>& edge_element_buffer) const
 {
-	// map stores for each halfedge the number of times it has been seen before
-	std::map<std::tuple<idx_type, idx_type>, idx_type> halfedge_to_count;
-	for (idx_type fi = 0; fi < faces.size(); ++fi) {
+	// per corner store the edge from the previous corner's vertex with sorted vertex indices
+	idx_type nr_corners = idx_type(get_nr_corners());
+	std::vector<uint32_t> edge_min(nr_corners), edge_max(nr_corners);
+	std::vector<idx_type> prev_vertex(nr_corners);
+	int nr_faces = int(faces.size());
+#pragma omp parallel for
+	for (int fi = 0; fi < nr_faces; ++fi) {
 		idx_type last_vi = vertex_indices.at(end_corner(fi) - 1);
 		for (idx_type ci = begin_corner(fi); ci < end_corner(fi); ++ci) {
-			// construct halfedge with sorted vertex indices
 			idx_type vi = vertex_indices.at(ci);
-			std::tuple<idx_type, idx_type> halfedge(last_vi, vi);
-			if (vi < last_vi)
-				std::swap(std::get<0>(halfedge), std::get<1>(halfedge));
-
-			// lookup corner in map
-			auto iter = halfedge_to_count.find(halfedge);
-
-			// determine vertex index
-			if (iter == halfedge_to_count.end()) {
-				halfedge_to_count[halfedge] = 1;
-				edge_element_buffer.push_back(last_vi);
-				edge_element_buffer.push_back(vi);
-			}
-			else
-				++halfedge_to_count[halfedge];
+			prev_vertex[ci] = last_vi;
+			edge_min[ci] = std::min(last_vi, vi);
+			edge_max[ci] = std::max(last_vi, vi);
 			last_vi = vi;
 		}
 	}
+	// sort edges such that equal edges are consecutive and in increasing corner order
+	std::vector<idx_type> perm;
+	uint32_t max_vi = nr_corners > 0 ? *std::max_element(edge_max.begin(), edge_max.end()) : 0;
+	cgv::math::radix_sort_lexicographic(nr_corners, { &edge_min, &edge_max }, { max_vi, max_vi }, perm);
+	std::vector<bool> is_first(nr_corners, false);
+	for (idx_type i = 0; i < nr_corners; ++i)
+		if (i == 0 || edge_min[perm[i]] != edge_min[perm[i - 1]] || edge_max[perm[i]] != edge_max[perm[i - 1]])
+			is_first[perm[i]] = true;
+	// output the first occurrence of each edge in traversal order
+	for (idx_type fi = 0; fi < faces.size(); ++fi) {
+		for (idx_type ci = begin_corner(fi); ci < end_corner(fi); ++ci) {
+			if (is_first[ci]) {
+				edge_element_buffer.push_back(prev_vertex[ci]);
+				edge_element_buffer.push_back(vertex_indices.at(ci));
+			}
+		}
+	}
 }
 
 /// compute a index vector storing the inv corners per corner and optionally index vectors with per position corner index, per corner next and or prev corner index (implementation assumes closed manifold connectivity)
@@ -237,7 +362,8 @@ void simple_mesh_base::compute_inv(std::vector<uint32_t>& inv, std::vector<uint3
 	if (prev_ptr)
 		prev_ptr->resize(get_nr_corners());
 	inv.resize(get_nr_corners(), uint32_t(-1));
-	std::map<std::pair<uint32_t, uint32_t>, uint32_t> pipj2ci;
+	uint32_t nr_corners = get_nr_corners();
+	std::vector<uint32_t> edge_min(nr_corners), edge_max(nr_corners);
 	for (fi = 0; fi < get_nr_faces(); ++fi) {
 		uint32_t prev_ci = end_corner(fi) - 1;
 		for (uint32_t ci = begin_corner(fi); ci < end_corner(fi); ++ci) {
@@ -251,15 +377,20 @@ void simple_mesh_base::compute_inv(std::vector<uint32_t>& inv, std::vector<uint3
 				prev_ptr->at(ci) = prev_ci;
 			prev_ci = ci;
 			uint32_t pj = c2p(next_ci);
-			std::pair<uint32_t, uint32_t> pipj(std::min(pi, pj), std::max(pi, pj));
-			if (pipj2ci.find(pipj) == pipj2ci.end())
-				pipj2ci[pipj] = ci;
-			else {
-				uint32_t inv_ci = pipj2ci[pipj];
-				inv[ci] = inv_ci;
-				inv[inv_ci] = ci;
-				pipj2ci.erase(pipj2ci.find(pipj));
-			}
+			edge_min[ci] = std::min(pi, pj);
+			edge_max[ci] = std::max(pi, pj);
+		}
+	}
+	// sort corners by their edge and match successive corners of the same edge in increasing corner order
+	std::vector<uint32_t> perm;
+	uint32_t max_pi = get_nr_positions() > 0 ? get_nr_positions() - 1 : 0;
+	cgv::math::radix_sort_lexicographic(nr_corners, { &edge_min, &edge_max }, { max_pi, max_pi }, perm);
+	for (uint32_t i = 0; i + 1 < nr_corners; ++i) {
+		uint32_t ci = perm[i], cj = perm[i + 1];
+		if (edge_min[ci] == edge_min[cj] && edge_max[ci] == edge_max[cj]) {
+			inv[ci] = cj;
+			inv[cj] = ci;
+			++i;
 		}
 	}
 }
@@ -342,7 +473,7 @@ public:
 protected:
 	simple_mesh<T> &mesh;
 public:
-	simple_mesh_obj_reader(simple_mesh<T>& _mesh) : mesh(_mesh) {}
+	simple_mesh_obj_reader(simple_mesh<T>& _mesh) : mesh(_mesh) { this->record_file_order = false; }
 	/// overide this function to process a vertex
 	void process_vertex(const v3d_type& p) { mesh.positions.push_back(p); }
 	/// overide this function to process a texcoord
@@ -376,6 +507,39 @@ public:
 				mesh.normal_indices.push_back(idx_type(normals[i]));
 		}
 	}
+	/// append faces of the parallel parser directly, where lines are ignored as in the serial path
+	void process_bulk(obj_bulk_data<T>& data)
+	{
+		mesh.positions.insert(mesh.positions.end(), data.vertices.begin(), data.vertices.end());
+		mesh.normals.insert(mesh.normals.end(), data.normals.begin(), data.normals.end());
+		mesh.tex_coords.insert(mesh.tex_coords.end(), data.texcoords.begin(), data.texcoords.end());
+		if (!data.colors.empty()) {
+			idx_type c0 = idx_type(mesh.get_nr_colors());
+			mesh.resize_colors(c0 + data.colors.size());
+			for (size_t i = 0; i < data.colors.size(); ++i)
+				mesh.set_color(c0 + idx_type(i), data.colors[i]);
+		}
+		mesh.faces.reserve(mesh.faces.size() + data.faces.size());
+		mesh.group_indices.reserve(mesh.group_indices.size() + data.faces.size());
+		mesh.material_indices.reserve(mesh.material_indices.size() + data.faces.size());
+		mesh.position_indices.reserve(mesh.position_indices.size() + data.vertex_indices.size());
+		for (const auto& F : data.faces) {
+			mesh.faces.push_back(idx_type(mesh.position_indices.size()));
+			mesh.group_indices.push_back(F.group_index);
+			mesh.material_indices.push_back(F.material_index);
+			if (F.first_texcoord_index != -1 && mesh.tex_coord_indices.size() < mesh.position_indices.size())
+				mesh.tex_coord_indices.resize(mesh.position_indices.size(), 0);
+			if (F.first_normal_index != -1 && mesh.normal_indices.size() < mesh.position_indices.size())
+				mesh.normal_indices.resize(mesh.position_indices.size(), 0);
+			for (unsigned i = 0; i < F.degree; ++i) {
+				mesh.position_indices.push_back(data.vertex_indices[F.first_vertex_index + i]);
+				if (F.first_texcoord_index != -1)
+					mesh.tex_coord_indices.push_back(data.texcoord_indices[F.first_texcoord_index + i]);
+				if (F.first_normal_index != -1)
+					mesh.normal_indices.push_back(data.normal_indices[F.first_normal_index + i]);
+			}
+		}
+	}
 	/// overide this function to process a group given by name and parameter string
 	void process_group(const std::string& name, const std::string& parameters)
 	{
@@ -451,12 +615,33 @@ void simple_mesh<T>::clear()
 
 /// read simple mesh from file
 template <typename T>
-bool simple_mesh<T>::read(const std::string& file_name)
+bool simple_mesh<T>::read(const std::string& file_name, bool use_cache)
 { 
 	std::string ext = cgv::utils::to_lower(cgv::utils::file::get_extension(file_name));
 	if (ext == "obj") {
+		// map cache if it has been created from the current version of the obj file with the same coordinate type
+		std::string cache_file_name = cgv::utils::file::drop_extension(file_name) + ".msm";
+		if (use_cache && cgv::utils::file::exists(cache_file_name)) {
+			mapped_simple_mesh msm;
+			if (msm.open(cache_file_name)) {
+				const msm_section* s = msm.get_section(MSM_POSITIONS);
+				if (msm.get_header()->source_size == cgv::utils::file::size(file_name) &&
+					msm.get_header()->source_write_time == cgv::utils::file::get_last_write_time(file_name) &&
+					(!s || s->element_size == sizeof(vec3)) && read_msm(msm))
+					return true;
+			}
+		}
 		simple_mesh_obj_reader<T> reader(*this);
-		return reader.read_obj(file_name);
+		if (!reader.read_obj(file_name))
+			return false;
+		// failing to write the cache, for example in read only directories, is not an error
+		if (use_cache)
+			write_msm(cache_file_name, false, false, true, file_name);
+		return true;
+	}
+	if (ext == "msm") {
+		mapped_simple_mesh msm;
+		return msm.open(file_name) && read_msm(msm);
 	}
 	if (ext == "stl") {
 		try {
@@ -486,10 +671,12 @@ bool simple_mesh<T>::read(const std::string& file_name)
 	return false;
 }
 
-/// write simple mesh to file (currently only obj is supported)
+/// write simple mesh to file (currently obj and msm are supported)
 template <typename T>
 bool simple_mesh<T>::write(const std::string& file_name) const
 {
+	if (cgv::utils::to_lower(cgv::utils::file::get_extension(file_name)) == "msm")
+		return write_msm(file_name);
 	std::ofstream os(file_name);
 	if (os.fail())
 		return false;
@@ -520,6 +707,261 @@ bool simple_mesh<T>::write(const std::string& file_name) const
 	return true;
 }
 
+namespace {
+	/// copy a vector section stored in float or double precision into a vector of fvecs
+	template <typename T, cgv::type::uint32_type N>
+	bool copy_vector_section(const mapped_simple_mesh& msm, MSMSectionType st, std::vector<cgv::math::fvec<T, N> >& V)
+	{
+		V.clear();
+		const msm_section* s = msm.get_section(st);
+		if (!s)
+			return true;
+		V.resize(size_t(s->count));
+		const void* data = msm.get_section_data(st);
+		if (s->element_size == N * sizeof(float)) {
+			const float* src = static_cast<const float*>(data);
+			for (size_t i = 0; i < V.size(); ++i)
+				for (unsigned c = 0; c < N; ++c)
+					V[i][c] = T(src[N * i + c]);
+			return true;
+		}
+		if (s->element_size == N * sizeof(double)) {
+			const double* src = static_cast<const double*>(data);
+			for (size_t i = 0; i < V.size(); ++i)
+				for (unsigned c = 0; c < N; ++c)
+					V[i][c] = T(src[N * i + c]);
+			return true;
+		}
+		return false;
+	}
+	/// copy a section of index tuples
+	template <cgv::type::uint32_type N>
+	bool copy_tuple_section(const mapped_simple_mesh& msm, MSMSectionType st, std::vector<cgv::math::fvec<simple_mesh_base::idx_type, N> >& V)
+	{
+		V.clear();
+		const msm_section* s = msm.get_section(st);
+		if (!s)
+			return true;
+		if (s->element_size != N * sizeof(simple_mesh_base::idx_type))
+			return false;
+		V.resize(size_t(s->count));
+		const simple_mesh_base::idx_type* src = static_cast<const simple_mesh_base::idx_type*>(msm.get_section_data(st));
+		for (size_t i = 0; i < V.size(); ++i)
+			for (unsigned c = 0; c < N; ++c)
+				V[i][c] = src[N * i + c];
+		return true;
+	}
+	/// copy an index section
+	bool copy_index_section(const mapped_simple_mesh& msm, MSMSectionType st, std::vector<simple_mesh_base::idx_type>& I)
+	{
+		I.clear();
+		const msm_section* s = msm.get_section(st);
+		if (!s)
+			return true;
+		if (s->element_size != sizeof(simple_mesh_base::idx_type))
+			return false;
+		I.resize(size_t(s->count));
+		std::memcpy(&I[0], msm.get_section_data(st), size_t(s->size));
+		return true;
+	}
+	/// set element size, flags and count of a section and return data pointer or null for empty vectors
+	template <typename V>
+	const void* describe_section(msm_section& s, const std::vector<V>& data, cgv::type::uint32_type flags = 0)
+	{
+		s.element_size = sizeof(V);
+		s.flags = flags;
+		s.count = data.size();
+		return data.empty() ? 0 : &data[0];
+	}
+}
+
+/// copy mesh from an opened mapped simple mesh file
+template <typename T>
+bool simple_mesh<T>::read_msm(const mapped_simple_mesh& msm)
+{
+	if (!msm.is_open())
+		return false;
+	clear();
+	tangent_indices.clear();
+	clear_stored_element_buffers();
+	for (int st = 0; st < MSM_NR_SECTION_TYPES; ++st)
+		msm.advise(MSMSectionType(st), cgv::utils::mapped_file::AH_SEQUENTIAL);
+	bool success =
+		copy_vector_section(msm, MSM_POSITIONS, positions) &&
+		copy_vector_section(msm, MSM_NORMALS, normals) &&
+		copy_vector_section(msm, MSM_TANGENTS, tangents) &&
+		copy_vector_section(msm, MSM_TEX_COORDS, tex_coords) &&
+		copy_index_section(msm, MSM_POSITION_INDICES, position_indices) &&
+		copy_index_section(msm, MSM_NORMAL_INDICES, normal_indices) &&
+		copy_index_section(msm, MSM_TANGENT_INDICES, tangent_indices) &&
+		copy_index_section(msm, MSM_TEX_COORD_INDICES, tex_coord_indices) &&
+		copy_index_section(msm, MSM_FACES, faces) &&
+		copy_index_section(msm, MSM_GROUP_INDICES, group_indices) &&
+		copy_index_section(msm, MSM_MATERIAL_INDICES, material_indices);
+	if (!success) {
+		clear();
+		return false;
+	}
+	// dequantize positions and normals if no full precision version is stored
+	const msm_section* s = msm.get_section(MSM_QUANTIZED_POSITIONS);
+	if (positions.empty() && s && s->element_size == 4 * sizeof(cgv::type::uint16_type)) {
+		const float* box = msm.get_header()->quantization_box;
+		const cgv::type::uint16_type* Q = static_cast<const cgv::type::uint16_type*>(msm.get_section_data(MSM_QUANTIZED_POSITIONS));
+		positions.resize(size_t(s->count));
+		for (size_t i = 0; i < positions.size(); ++i)
+			for (unsigned c = 0; c < 3; ++c)
+				positions[i][c] = T(box[c] + (box[c + 3] - box[c]) * (Q[4 * i + c] / 65535.0f));
+	}
+	s = msm.get_section(MSM_QUANTIZED_NORMALS);
+	if (normals.empty() && s && s->element_size == 2 * sizeof(cgv::type::int16_type)) {
+		const cgv::type::int16_type* Q = static_cast<const cgv::type::int16_type*>(msm.get_section_data(MSM_QUANTIZED_NORMALS));
+		normals.resize(size_t(s->count));
+		for (size_t i = 0; i < normals.size(); ++i) {
+			float n[3];
+			mapped_simple_mesh::decode_octahedral(Q + 2 * i, n);
+			normals[i] = vec3(T(n[0]), T(n[1]), T(n[2]));
+		}
+	}
+	s = msm.get_section(MSM_COLORS);
+	if (s) {
+		ensure_colors(ColorType(s->flags), size_t(s->count));
+		if (get_color_size() == s->element_size) {
+			const char* C = static_cast<const char*>(msm.get_section_data(MSM_COLORS));
+			for (size_t i = 0; i < size_t(s->count); ++i)
+				set_color(i, C + i * s->element_size);
+		}
+		else
+			destruct_colors();
+	}
+	msm.extract_group_names(group_names);
+	msm.extract_materials(materials);
+
+	// restore element buffers, which are only used as long as the connectivity is unchanged
+	element_buffers& eb = stored_element_buffers;
+	s = msm.get_section(MSM_UNIQUE_TUPLES);
+	if (s && msm.get_section(MSM_TRIANGLES) &&
+		copy_tuple_section(msm, MSM_UNIQUE_TUPLES, eb.unique_tuples) &&
+		copy_index_section(msm, MSM_TRIANGLES, eb.triangle_element_buffer) &&
+		copy_index_section(msm, MSM_EDGES, eb.edge_element_buffer) &&
+		copy_tuple_section(msm, MSM_MATERIAL_GROUP_STARTS, eb.material_group_start)) {
+		eb.include_tex_coords = (s->flags & MSM_TUPLES_INCLUDE_TEX_COORDS) != 0;
+		eb.include_normals = (s->flags & MSM_TUPLES_INCLUDE_NORMALS) != 0;
+		eb.include_tangents = (s->flags & MSM_TUPLES_INCLUDE_TANGENTS) != 0;
+		eb.vertex_cache_optimized = (msm.get_section(MSM_TRIANGLES)->flags & MSM_TRIANGLES_VERTEX_CACHE_OPTIMIZED) != 0;
+		eb.connectivity_checksum = compute_connectivity_checksum();
+	}
+	else
+		clear_stored_element_buffers();
+	return true;
+}
+
+/// write mesh in mapped simple mesh format
+template <typename T>
+bool simple_mesh<T>::write_msm(const std::string& file_name, bool quantize_positions, bool quantize_normals,
+	bool store_element_buffers, const std::string& source_file_name) const
+{
+	msm_header h;
+	std::memset(&h, 0, sizeof(msm_header));
+	if (!source_file_name.empty()) {
+		h.source_size = cgv::utils::file::size(source_file_name);
+		h.source_write_time = cgv::utils::file::get_last_write_time(source_file_name);
+	}
+	h.nr_groups = cgv::type::uint32_type(group_names.size());
+	h.nr_materials = cgv::type::uint32_type(materials.size());
+	const void* data[MSM_NR_SECTION_TYPES] = { 0 };
+	msm_section* S = h.sections;
+
+	// attribute and index arrays
+	if (!quantize_positions)
+		data[MSM_POSITIONS] = describe_section(S[MSM_POSITIONS], positions);
+	if (!quantize_normals)
+		data[MSM_NORMALS] = describe_section(S[MSM_NORMALS], normals);
+	data[MSM_TANGENTS] = describe_section(S[MSM_TANGENTS], tangents);
+	data[MSM_TEX_COORDS] = describe_section(S[MSM_TEX_COORDS], tex_coords);
+	data[MSM_POSITION_INDICES] = describe_section(S[MSM_POSITION_INDICES], position_indices);
+	data[MSM_NORMAL_INDICES] = describe_section(S[MSM_NORMAL_INDICES], normal_indices);
+	data[MSM_TANGENT_INDICES] = describe_section(S[MSM_TANGENT_INDICES], tangent_indices);
+	data[MSM_TEX_COORD_INDICES] = describe_section(S[MSM_TEX_COORD_INDICES], tex_coord_indices);
+	data[MSM_FACES] = describe_section(S[MSM_FACES], faces);
+	data[MSM_GROUP_INDICES] = describe_section(S[MSM_GROUP_INDICES], group_indices);
+	data[MSM_MATERIAL_INDICES] = describe_section(S[MSM_MATERIAL_INDICES], material_indices);
+	if (has_colors() && get_nr_colors() > 0) {
+		S[MSM_COLORS].element_size = cgv::type::uint32_type(get_color_size());
+		S[MSM_COLORS].flags = cgv::type::uint32_type(get_color_storage_type());
+		S[MSM_COLORS].count = get_nr_colors();
+		data[MSM_COLORS] = get_color_data_ptr();
+	}
+	std::vector<char> group_bytes, material_bytes;
+	mapped_simple_mesh::encode_group_names(group_names, group_bytes);
+	data[MSM_GROUP_NAMES] = describe_section(S[MSM_GROUP_NAMES], group_bytes);
+	S[MSM_GROUP_NAMES].count = group_names.size();
+	S[MSM_GROUP_NAMES].size = group_bytes.size();
+	mapped_simple_mesh::encode_materials(materials, material_bytes);
+	data[MSM_MATERIALS] = describe_section(S[MSM_MATERIALS], material_bytes);
+	S[MSM_MATERIALS].count = materials.size();
+	S[MSM_MATERIALS].size = material_bytes.size();
+
+	// quantized positions and normals
+	std::vector<cgv::type::uint16_type> quantized_positions;
+	if (quantize_positions && !positions.empty()) {
+		box_type box = compute_box();
+		for (unsigned c = 0; c < 3; ++c) {
+			h.quantization_box[c] = float(box.get_min_pnt()[c]);
+			h.quantization_box[c + 3] = float(box.get_max_pnt()[c]);
+		}
+		quantized_positions.resize(4 * positions.size(), 0);
+		int n = int(positions.size());
+#pragma omp parallel for
+		for (int i = 0; i < n; ++i)
+			for (unsigned c = 0; c < 3; ++c) {
+				float extent = h.quantization_box[c + 3] - h.quantization_box[c];
+				float t = extent > 0 ? (float(positions[i][c]) - h.quantization_box[c]) / extent : 0.0f;
+				quantized_positions[4 * i + c] = cgv::type::uint16_type(std::floor(std::min(1.0f, std::max(0.0f, t)) * 65535.0f + 0.5f));
+			}
+		S[MSM_QUANTIZED_POSITIONS].element_size = 4 * sizeof(cgv::type::uint16_type);
+		S[MSM_QUANTIZED_POSITIONS].count = positions.size();
+		data[MSM_QUANTIZED_POSITIONS] = &quantized_positions[0];
+	}
+	std::vector<cgv::type::int16_type> quantized_normals;
+	if (quantize_normals && !normals.empty()) {
+		quantized_normals.resize(2 * normals.size());
+		int n = int(normals.size());
+#pragma omp parallel for
+		for (int i = 0; i < n; ++i) {
+			float nml[3] = { float(normals[i][0]), float(normals[i][1]), float(normals[i][2]) };
+			mapped_simple_mesh::encode_octahedral(nml, &quantized_normals[2 * i]);
+		}
+		S[MSM_QUANTIZED_NORMALS].element_size = 2 * sizeof(cgv::type::int16_type);
+		S[MSM_QUANTIZED_NORMALS].count = normals.size();
+		data[MSM_QUANTIZED_NORMALS] = &quantized_normals[0];
+	}
+
+	// element buffers computed in the same way as in mesh_render_info::construct_vbos_base
+	std::vector<idx_type> vertex_indices, triangle_element_buffer, edge_element_buffer;
+	std::vector<vec4i> unique_quadruples;
+	std::vector<vec3i> material_group_start;
+	if (store_element_buffers && !faces.empty()) {
+		std::vector<idx_type> perm;
+		bool sort_by_groups = get_nr_groups() > 0;
+		bool sort_by_materials = get_nr_materials() > 0;
+		if (sort_by_groups || sort_by_materials)
+			sort_faces(perm, sort_by_groups, sort_by_materials);
+		bool include_tex_coords = true, include_normals = true, include_tangents = true;
+		merge_indices(vertex_indices, unique_quadruples, &include_tex_coords, &include_normals, &include_tangents);
+		extract_triangle_element_buffer(vertex_indices, triangle_element_buffer, perm.empty() ? 0 : &perm,
+			sort_by_materials ? &material_group_start : 0);
+		optimize_element_buffers(vertex_indices, unique_quadruples, triangle_element_buffer, &material_group_start);
+		extract_wireframe_element_buffer(vertex_indices, edge_element_buffer);
+		cgv::type::uint32_type tuple_flags = (include_tex_coords ? MSM_TUPLES_INCLUDE_TEX_COORDS : 0) |
+			(include_normals ? MSM_TUPLES_INCLUDE_NORMALS : 0) | (include_tangents ? MSM_TUPLES_INCLUDE_TANGENTS : 0);
+		data[MSM_UNIQUE_TUPLES] = describe_section(S[MSM_UNIQUE_TUPLES], unique_quadruples, tuple_flags);
+		data[MSM_TRIANGLES] = describe_section(S[MSM_TRIANGLES], triangle_element_buffer, MSM_TRIANGLES_VERTEX_CACHE_OPTIMIZED);
+		data[MSM_EDGES] = describe_section(S[MSM_EDGES], edge_element_buffer);
+		data[MSM_MATERIAL_GROUP_STARTS] = describe_section(S[MSM_MATERIAL_GROUP_STARTS], material_group_start);
+	}
+	return mapped_simple_mesh::write(file_name, h, data);
+}
+
 /// compute the axis aligned bounding box
 template <typename T>
 typename simple_mesh<T>::box_type simple_mesh<T>::compute_box() const
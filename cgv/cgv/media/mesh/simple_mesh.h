@@ -22,6 +22,8 @@ class simple_mesh_obj_reader;
 template <typename T>
 class CGV_API obj_loader_generic;
 
+class CGV_API mapped_simple_mesh;
+
 /** coordinate type independent base class of simple mesh data structure that handles indices and colors. */
 class CGV_API simple_mesh_base : public colored_model
 {
@@ -36,6 +38,24 @@ public:
 	typedef cgv::math::fvec<idx_type, 4> vec4i;
 	/// define material type
 	typedef illum::textured_surface_material mat_type;
+	/// element buffers as computed in mesh_render_info, which are stored in and restored from msm files
+	struct element_buffers
+	{
+		/// unique tuples of attribute indices that define the vertices
+		std::vector<vec4i> unique_tuples;
+		/// triangle element buffer indexing the unique tuples
+		std::vector<idx_type> triangle_element_buffer;
+		/// edge element buffer indexing the unique tuples
+		std::vector<idx_type> edge_element_buffer;
+		/// material and group start triples of the triangle element buffer
+		std::vector<vec3i> material_group_start;
+		/// which attributes have been included into the unique tuples
+		bool include_tex_coords = false, include_normals = false, include_tangents = false;
+		/// whether the triangle element buffer has been optimized for the vertex cache
+		bool vertex_cache_optimized = false;
+		/// checksum of the connectivity from which the buffers have been computed
+		cgv::type::uint64_type connectivity_checksum = 0;
+	};
 protected:
 	std::vector<idx_type> position_indices;
 	std::vector<idx_type> normal_indices;
@@ -46,6 +66,10 @@ protected:
 	std::vector<std::string> group_names;
 	std::vector<idx_type> material_indices;
 	std::vector<mat_type> materials;
+	/// element buffers restored by simple_mesh::read_msm
+	element_buffers stored_element_buffers;
+	/// compute a checksum over the index arrays and the group and material counts
+	cgv::type::uint64_type compute_connectivity_checksum() const;
 public:
 	/// default constructor
 	simple_mesh_base();
@@ -150,6 +174,10 @@ public:
 	 * 
 	 * See https://www.opengl-tutorial.org/intermediate-tutorials/tutorial-9-vbo-indexing/ for further details.
 	 *
+	 * Equal tuples are found with the stable radix sort cgv::math::radix_sort_lexicographic(), such that the
+	 * tuples are numbered in the order of their first occurrence. The sort only runs in parallel in builds
+	 * with OpenMP enabled.
+	 *
 	 * \param [out] vertex_indices will be filled with indicies into the unique tuple list.
 	 * \param [out] unique_tuples will be filled with all the unique n-tuples.
 	 * \param [in,out] include_tex_coords_ptr if nullptr then texture coordinates won't be included in the n-tuples.
@@ -182,6 +210,10 @@ public:
 	/**
 	 * Extract element array buffers for edges in wireframe.
 	 * 
+	 * Each edge is output once in the order of its first occurrence. The per corner edge keys are computed
+	 * in parallel over the faces and the edges are grouped with a radix sort, but both steps only run in
+	 * parallel in builds with OpenMP enabled and serially otherwise.
+	 *
 	 * \param [in] vertex_indices Contains indices into a list of vertices.
 	 * \param [out] edge_element_buffer Stores the vertex indices which make up a wireframed mesh.
 	 * 
@@ -189,12 +221,47 @@ public:
 	 */
 	void extract_wireframe_element_buffer(const std::vector<idx_type>& vertex_indices,
 										  std::vector<idx_type>& edge_element_buffer) const;
+	/**
+	 * Optimize extracted element buffers for the post transform vertex cache and for sequential vertex fetches.
+	 *
+	 * The triangles within each range of the material group starts are reordered with the vertex cache
+	 * optimization in cgv::media::mesh::optimize_vertex_cache(). Afterwards the unique tuples are sorted
+	 * by their first use in the triangle element buffer and the vertex indices and the triangle element
+	 * buffer are renumbered. Call this before simple_mesh::extract_wireframe_element_buffer() such that
+	 * the edges refer to the new vertex numbering.
+	 *
+	 * \param [in,out] vertex_indices Per corner index into the unique tuples, which is renumbered.
+	 * \param [in,out] unique_tuples The unique tuples, which are permuted.
+	 * \param [in,out] triangle_element_buffer The triangle element buffer, which is reordered and renumbered.
+	 * \param [in] material_group_start_ptr If not nullptr, triangles are only reordered within the given ranges.
+	 * \param [out] acmr_before_ptr If not nullptr, set to the average cache miss ratio before the optimization.
+	 * \param [out] acmr_after_ptr If not nullptr, set to the average cache miss ratio after the optimization.
+	 * \param [in] cache_size Size of the simulated vertex cache.
+	 *
+	 * \see cgv::media::mesh::compute_acmr()
+	 */
+	void optimize_element_buffers(std::vector<idx_type>& vertex_indices, std::vector<vec4i>& unique_tuples,
+								  std::vector<idx_type>& triangle_element_buffer,
+								  const std::vector<vec3i>* material_group_start_ptr = 0,
+								  double* acmr_before_ptr = 0, double* acmr_after_ptr = 0, unsigned cache_size = 32) const;
 	/// compute a index vector storing the inv corners per corner and optionally index vectors with per position corner index, per corner next and or prev corner index (implementation assumes closed manifold connectivity)
+	/// corners are matched by sorting them by their edge with a radix sort, which only runs in parallel in builds with OpenMP enabled
 	void compute_inv(std::vector<uint32_t>& inv, std::vector<uint32_t>* p2c_ptr = 0, std::vector<uint32_t>* next_ptr = 0, std::vector<uint32_t>* prev_ptr = 0) const;
 	/// given the inv corners compute index vector per corner its edge index and optionally per edge its corner index and return edge count (implementation assumes closed manifold connectivity)
 	uint32_t compute_c2e(const std::vector<uint32_t>& inv, std::vector<uint32_t>& c2e, std::vector<uint32_t>* e2c_ptr = 0) const;
 	/// compute index vector with per corner its face index
 	void compute_c2f(std::vector<uint32_t>& c2f) const;
+	/** return the element buffers restored from an msm file if the connectivity of the mesh has not been changed
+	    since reading the file, or nullptr otherwise. The faces are sorted by group if the mesh has groups and by
+	    material if it has materials. */
+	const element_buffers* get_stored_element_buffers() const;
+	/// discard the element buffers restored from an msm file
+	void clear_stored_element_buffers() { stored_element_buffers = element_buffers(); }
+	/** set whether simple_mesh::read(file_name) caches obj files in msm files next to them. The cache is disabled
+	    by default, such that libraries do not write files unexpectedly, and mesh viewers enable it on construction. */
+	static void set_msm_cache_enabled(bool enabled);
+	/// return whether simple_mesh::read(file_name) caches obj files in msm files
+	static bool is_msm_cache_enabled();
 };
 
 /// the simple_mesh class is templated over the coordinate type that defaults to float
@@ -305,10 +372,23 @@ public:
 	void compute_vertex_normals();
 	/// construct from obj loader
 	void construct(const obj_loader_generic<T>& loader, bool copy_grp_info, bool copy_material_info);
-	/// read simple mesh from file (currently only obj and stl are supported)
-	bool read(const std::string& file_name);
-	/// write simple mesh to file (currently only obj is supported)
+	/** read simple mesh from file (currently obj, stl and msm are supported). If use_cache is set, an obj file is
+	    cached in an msm file next to it, which is mapped instead of parsing the obj file as long as the obj file is unchanged. */
+	bool read(const std::string& file_name, bool use_cache);
+	/// read simple mesh from file and cache obj files if enabled with simple_mesh_base::set_msm_cache_enabled()
+	bool read(const std::string& file_name) { return read(file_name, is_msm_cache_enabled()); }
+	/// write simple mesh to file (currently obj and msm are supported)
 	bool write(const std::string& file_name) const;
+	/** copy mesh from an opened mapped simple mesh file, where quantized positions and normals are dequantized if no
+	    full precision version is stored. Stored element buffers are kept for get_stored_element_buffers(). */
+	bool read_msm(const mapped_simple_mesh& msm);
+	/** write mesh in mapped simple mesh format. Positions can be quantized to 16 bit per coordinate relative to the
+	    bounding box and normals to 32 bit octahedral encoding, which replace the full precision sections. With
+		store_element_buffers the vertex, triangle and edge element buffers of mesh_render_info are precomputed
+		and optimized for the vertex cache, such that the costly optimization is done only once per mesh.
+		If a source file name is given, its size and write time are stored to validate caches. */
+	bool write_msm(const std::string& file_name, bool quantize_positions = false, bool quantize_normals = false,
+		bool store_element_buffers = true, const std::string& source_file_name = "") const;
 	/**
 	 * Extract vertex attribute array and element array buffers for triangulation and edges in wireframe.
 	 * 
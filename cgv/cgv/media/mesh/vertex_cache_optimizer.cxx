@@ -0,0 +1,193 @@
+#include "vertex_cache_optimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+typedef cgv::type::uint32_type uint32;
+
+double compute_acmr(const uint32* triangle_indices, size_t nr_indices, unsigned cache_size)
+{
+	size_t nr_triangles = nr_indices / 3;
+	if (nr_triangles == 0)
+		return 0.0;
+	uint32 max_index = 0;
+	for (size_t i = 0; i < nr_indices; ++i)
+		max_index = std::max(max_index, triangle_indices[i]);
+	// a vertex is in the FIFO cache if it has been inserted less than cache_size misses ago
+	std::vector<size_t> insert_time(size_t(max_index) + 1, size_t(-1));
+	size_t nr_misses = 0;
+	for (size_t i = 0; i < 3 * nr_triangles; ++i) {
+		size_t& t = insert_time[triangle_indices[i]];
+		if (t == size_t(-1) || nr_misses - t >= cache_size)
+			t = nr_misses++;
+	}
+	return double(nr_misses) / nr_triangles;
+}
+
+namespace {
+	/// maximum size of the simulated LRU cache, the scoring is only tuned for caches up to this size
+	const unsigned max_cache_size = 64;
+	/// valences from which on the valence boost is looked up in the last table entry
+	const unsigned max_valence = 32;
+	/// tabulated vertex scores for cache positions and numbers of not yet emitted triangles
+	struct score_table
+	{
+		float cache_score[max_cache_size + 1];
+		float valence_score[max_valence + 1];
+		score_table(unsigned cache_size)
+		{
+			// index 0 is used for vertices outside of the cache
+			cache_score[0] = 0.0f;
+			for (unsigned p = 0; p < max_cache_size; ++p) {
+				// the last triangle's vertices get a fixed score to avoid that they are preferred over all others
+				if (p < 3)
+					cache_score[p + 1] = 0.75f;
+				else if (p < cache_size)
+					cache_score[p + 1] = std::pow(1.0f - float(p - 3) / float(cache_size - 3), 1.5f);
+				else
+					cache_score[p + 1] = 0.0f;
+			}
+			// boost vertices with few remaining triangles to finish them off early
+			valence_score[0] = 0.0f;
+			for (unsigned v = 1; v <= max_valence; ++v)
+				valence_score[v] = 2.0f / std::sqrt(float(v));
+		}
+		/// score of a vertex from its position in the LRU cache or -1 and the number of its not yet emitted triangles
+		float operator () (int cache_position, unsigned nr_remaining) const
+		{
+			if (nr_remaining == 0)
+				return -1.0f;
+			return cache_score[cache_position + 1] + valence_score[std::min(nr_remaining, max_valence)];
+		}
+	};
+}
+
+void optimize_vertex_cache(std::vector<uint32>& triangle_element_buffer, size_t begin, size_t end, unsigned cache_size)
+{
+	end = std::min(end, triangle_element_buffer.size());
+	if (end <= begin + 3)
+		return;
+	cache_size = std::max(4u, std::min(cache_size, max_cache_size));
+	score_table vertex_score(cache_size);
+	size_t nr_triangles = (end - begin) / 3;
+	uint32* T = &triangle_element_buffer[begin];
+
+	// compact vertex indices of the range to keep all tables proportional to the range size
+	std::vector<uint32> vertices(T, T + 3 * nr_triangles);
+	std::sort(vertices.begin(), vertices.end());
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+	size_t nr_vertices = vertices.size();
+	std::vector<uint32> local(3 * nr_triangles);
+	for (size_t i = 0; i < local.size(); ++i)
+		local[i] = uint32(std::lower_bound(vertices.begin(), vertices.end(), T[i]) - vertices.begin());
+
+	// vertex to triangle adjacency in compressed row format
+	std::vector<uint32> adjacency_start(nr_vertices + 1, 0);
+	for (size_t i = 0; i < local.size(); ++i)
+		++adjacency_start[local[i] + 1];
+	for (size_t v = 0; v < nr_vertices; ++v)
+		adjacency_start[v + 1] += adjacency_start[v];
+	std::vector<uint32> adjacency(local.size());
+	std::vector<uint32> fill(adjacency_start.begin(), adjacency_start.end() - 1);
+	for (size_t i = 0; i < local.size(); ++i)
+		adjacency[fill[local[i]]++] = uint32(i / 3);
+	// number of not yet emitted triangles per vertex, the first entries of a vertex's adjacency list are the remaining triangles
+	std::vector<uint32> nr_remaining(nr_vertices);
+	for (size_t v = 0; v < nr_vertices; ++v)
+		nr_remaining[v] = adjacency_start[v + 1] - adjacency_start[v];
+
+	std::vector<float> score(nr_vertices);
+	for (size_t v = 0; v < nr_vertices; ++v)
+		score[v] = vertex_score(-1, nr_remaining[v]);
+	std::vector<float> triangle_score(nr_triangles);
+	for (size_t t = 0; t < nr_triangles; ++t)
+		triangle_score[t] = score[local[3 * t]] + score[local[3 * t + 1]] + score[local[3 * t + 2]];
+	std::vector<bool> emitted(nr_triangles, false);
+
+	// LRU cache with room for the three vertices of the emitted triangle
+	uint32 cache[max_cache_size + 3];
+	uint32 new_cache[max_cache_size + 3];
+	unsigned cache_fill = 0;
+	std::vector<uint32> result;
+	result.reserve(3 * nr_triangles);
+	size_t input_cursor = 0;
+	int best_triangle = 0;
+	for (size_t nr_emitted = 0; nr_emitted < nr_triangles; ++nr_emitted) {
+		// dead end, restart with the next not emitted triangle in input order
+		if (best_triangle < 0) {
+			while (emitted[input_cursor])
+				++input_cursor;
+			best_triangle = int(input_cursor);
+		}
+		const uint32* tri = &local[3 * best_triangle];
+		for (int j = 0; j < 3; ++j)
+			result.push_back(T[3 * best_triangle + j]);
+		emitted[best_triangle] = true;
+
+		// remove triangle from the remaining part of the adjacency lists
+		for (int j = 0; j < 3; ++j) {
+			uint32 v = tri[j];
+			uint32* a = &adjacency[adjacency_start[v]];
+			uint32 n = nr_remaining[v];
+			for (uint32 k = 0; k < n; ++k)
+				if (a[k] == uint32(best_triangle)) {
+					std::swap(a[k], a[n - 1]);
+					break;
+				}
+			--nr_remaining[v];
+		}
+		// move triangle vertices to the front of the cache
+		unsigned new_fill = 0;
+		for (int j = 0; j < 3; ++j)
+			new_cache[new_fill++] = tri[j];
+		for (unsigned i = 0; i < cache_fill; ++i) {
+			uint32 v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				new_cache[new_fill++] = v;
+		}
+		// update scores of all vertices in the enlarged cache, evicted vertices fall back to their uncached score
+		for (unsigned i = 0; i < new_fill; ++i) {
+			uint32 v = new_cache[i];
+			float new_score = vertex_score(i < cache_size ? int(i) : -1, nr_remaining[v]);
+			float delta = new_score - score[v];
+			score[v] = new_score;
+			for (uint32 k = 0; k < nr_remaining[v]; ++k)
+				triangle_score[adjacency[adjacency_start[v] + k]] += delta;
+		}
+		cache_fill = std::min(new_fill, cache_size);
+		std::copy(new_cache, new_cache + cache_fill, cache);
+		// next triangle is the best one adjacent to a cached vertex
+		best_triangle = -1;
+		float best_score = -1.0f;
+		for (unsigned i = 0; i < cache_fill; ++i) {
+			uint32 v = cache[i];
+			for (uint32 k = 0; k < nr_remaining[v]; ++k) {
+				uint32 t = adjacency[adjacency_start[v] + k];
+				if (triangle_score[t] > best_score) {
+					best_score = triangle_score[t];
+					best_triangle = int(t);
+				}
+			}
+		}
+	}
+	std::copy(result.begin(), result.end(), T);
+}
+
+void compute_vertex_fetch_order(const std::vector<uint32>& triangle_element_buffer, uint32 nr_vertices, std::vector<uint32>& old_to_new)
+{
+	old_to_new.assign(nr_vertices, uint32(-1));
+	uint32 next = 0;
+	for (uint32 vi : triangle_element_buffer)
+		if (old_to_new[vi] == uint32(-1))
+			old_to_new[vi] = next++;
+	for (uint32 vi = 0; vi < nr_vertices; ++vi)
+		if (old_to_new[vi] == uint32(-1))
+			old_to_new[vi] = next++;
+}
+
+		}
+	}
+}
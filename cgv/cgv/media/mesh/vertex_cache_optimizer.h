@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cgv/type/standard_types.h>
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+/**@name post transform vertex cache optimization of triangle element buffers*/
+//@{
+/// simulate a FIFO post transform vertex cache of the given size and return the average number of cache misses per triangle (ACMR)
+extern CGV_API double compute_acmr(const cgv::type::uint32_type* triangle_indices, std::size_t nr_indices, unsigned cache_size = 32);
+/// convenience version of compute_acmr for a complete triangle element buffer
+inline double compute_acmr(const std::vector<cgv::type::uint32_type>& triangle_element_buffer, unsigned cache_size = 32) {
+	return triangle_element_buffer.empty() ? 0.0 : compute_acmr(&triangle_element_buffer[0], triangle_element_buffer.size(), cache_size);
+}
+/** reorder the triangles in the index range [begin, end) of the triangle element buffer with the linear speed vertex
+    cache optimization of Tom Forsyth, which greedily emits the triangle with the highest score derived from the
+	positions of its vertices in a simulated LRU cache and the number of their remaining triangles. Triangles are
+	never moved across range boundaries, such that material and group ranges stay valid. The vertex order within a
+	triangle is preserved. */
+extern CGV_API void optimize_vertex_cache(std::vector<cgv::type::uint32_type>& triangle_element_buffer, std::size_t begin = 0,
+	std::size_t end = std::size_t(-1), unsigned cache_size = 32);
+/** compute a vertex permutation that sorts vertices by their first reference in the triangle element buffer, such that
+    vertex fetches become sequential. Unreferenced vertices are appended in their original order. For each old vertex
+	index, the new index is stored in old_to_new. */
+extern CGV_API void compute_vertex_fetch_order(const std::vector<cgv::type::uint32_type>& triangle_element_buffer,
+	cgv::type::uint32_type nr_vertices, std::vector<cgv::type::uint32_type>& old_to_new);
+//@}
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -0,0 +1,205 @@
+#include "slice_stack_reader.h"
+#include <cgv/media/image/image_reader.h>
+#include <cgv/data/data_view.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+
+namespace cgv {
+	namespace media {
+		namespace volume {
+
+			double slice_stack_statistics::get_slices_per_second() const
+			{
+				return seconds > 0 ? nr_slices / seconds : 0.0;
+			}
+
+			double slice_stack_statistics::get_mega_bytes_per_second() const
+			{
+				return seconds > 0 ? nr_bytes / (1024.0 * 1024.0 * seconds) : 0.0;
+			}
+
+			void slice_stack_statistics::print(std::ostream& os) const
+			{
+				os << "decoded " << nr_slices << " slices (" << nr_bytes / (1024 * 1024) << " MB) with "
+					<< nr_workers << " threads in " << seconds << " s: " << get_slices_per_second() << " slices/s, "
+					<< get_mega_bytes_per_second() << " MB/s";
+				if (seconds > 0)
+					os << ", " << decode_seconds / seconds << " decoders busy on average";
+				os << std::endl;
+			}
+
+			slice_stack_reader::slice_stack_reader(unsigned _nr_workers, size_t _max_nr_pending_slices)
+			{
+				nr_workers = _nr_workers;
+				if (nr_workers == 0)
+					nr_workers = std::max(1u, std::thread::hardware_concurrency());
+				max_nr_pending_slices = _max_nr_pending_slices;
+				if (max_nr_pending_slices == 0)
+					max_nr_pending_slices = 2 * nr_workers;
+			}
+
+			void slice_stack_reader::add_slice_files(const std::vector<std::string>& _file_names)
+			{
+				file_names.insert(file_names.end(), _file_names.begin(), _file_names.end());
+				image_indices.resize(file_names.size(), 0);
+			}
+
+			bool slice_stack_reader::add_multi_image_file(const std::string& file_name)
+			{
+				cgv::data::data_format df;
+				cgv::media::image::image_reader ir(df);
+				if (!ir.open(file_name)) {
+					last_error = "could not open image file " + file_name;
+					return false;
+				}
+				unsigned n = ir.get_nr_images();
+				ir.close();
+				format = df;
+				for (unsigned i = 0; i < n; ++i) {
+					file_names.push_back(file_name);
+					image_indices.push_back(i);
+				}
+				return true;
+			}
+
+			bool slice_stack_reader::determine_format()
+			{
+				if (format.get_width() > 0)
+					return true;
+				if (file_names.empty()) {
+					last_error = "no slices to determine format from";
+					return false;
+				}
+				cgv::media::image::image_reader ir(format);
+				if (!ir.open(file_names.front())) {
+					last_error = "could not open first slice " + file_names.front();
+					return false;
+				}
+				ir.close();
+				return true;
+			}
+
+			bool slice_stack_reader::read(void* data_ptr, slice_callback on_slice, void* user_data)
+			{
+				typedef std::chrono::steady_clock clock;
+				clock::time_point start = clock::now();
+				if (!determine_format())
+					return false;
+
+				size_t n = file_names.size();
+				size_t slice_size = format.get_nr_bytes();
+				size_t window = std::max(size_t(1), max_nr_pending_slices);
+				unsigned nr_threads = (unsigned)std::min(size_t(nr_workers), std::min(n, window));
+				statistics = slice_stack_statistics();
+				statistics.nr_workers = nr_threads;
+
+				// without destination slices are decoded into a ring of buffers, slot i % window holds slice i
+				std::vector<cgv::type::uint8_type> buffers;
+				if (!data_ptr)
+					buffers.resize(window * slice_size);
+				auto get_slice_ptr = [&](size_t i) -> cgv::type::uint8_type* {
+					return data_ptr ? static_cast<cgv::type::uint8_type*>(data_ptr) + i * slice_size : &buffers[(i % window) * slice_size];
+				};
+
+				std::mutex mtx;
+				std::condition_variable space_cv, done_cv;
+				std::vector<char> done(window, 0);
+				size_t next_slice = 0, nr_delivered = 0;
+				bool failed = false;
+				last_error.clear();
+				auto fail = [&](const std::string& error) {
+					if (!failed) {
+						failed = true;
+						last_error = error;
+					}
+				};
+
+				auto work = [&]() {
+					cgv::data::data_format df;
+					cgv::media::image::image_reader ir(df);
+					std::string open_file_name;
+					while (true) {
+						size_t i;
+						{
+							std::unique_lock<std::mutex> lock(mtx);
+							space_cv.wait(lock, [&]() { return failed || next_slice >= n || next_slice < nr_delivered + window; });
+							if (failed || next_slice >= n)
+								break;
+							i = next_slice++;
+						}
+						clock::time_point decode_start = clock::now();
+						std::string error;
+						// keep multi image files open and only seek to the requested image
+						if (file_names[i] != open_file_name) {
+							if (!open_file_name.empty())
+								ir.close();
+							open_file_name.clear();
+							if (ir.open(file_names[i]))
+								open_file_name = file_names[i];
+							else
+								error = "could not open slice file " + file_names[i];
+						}
+						if (error.empty() && ir.get_current_image() != image_indices[i] && !ir.seek_image(image_indices[i]))
+							error = "could not seek image " + std::to_string(image_indices[i]) + " in file " + file_names[i];
+						if (error.empty() && (df.get_width() != format.get_width() || df.get_height() != format.get_height() ||
+							df.get_entry_size() != format.get_entry_size()))
+							error = "format of slice " + std::to_string(i) + " in file " + file_names[i] + " differs from first slice";
+						if (error.empty()) {
+							cgv::data::data_view dv(&df, get_slice_ptr(i));
+							if (!ir.read_image(dv))
+								error = "could not read slice " + std::to_string(i) + " from file " + file_names[i];
+						}
+						double decode_seconds = std::chrono::duration<double>(clock::now() - decode_start).count();
+						{
+							std::lock_guard<std::mutex> lock(mtx);
+							statistics.decode_seconds += decode_seconds;
+							if (error.empty())
+								done[i % window] = 1;
+							else
+								fail(error);
+						}
+						done_cv.notify_all();
+					}
+					if (!open_file_name.empty())
+						ir.close();
+				};
+
+				std::vector<std::thread> workers;
+				for (unsigned w = 0; w < nr_threads; ++w)
+					workers.push_back(std::thread(work));
+
+				// hand out decoded slices in order and release their slots to the workers
+				for (size_t i = 0; i < n; ++i) {
+					{
+						std::unique_lock<std::mutex> lock(mtx);
+						done_cv.wait(lock, [&]() { return failed || done[i % window] != 0; });
+						if (failed)
+							break;
+					}
+					if (on_slice && !on_slice(i, get_slice_ptr(i), user_data)) {
+						std::lock_guard<std::mutex> lock(mtx);
+						fail("reading aborted in slice callback");
+						break;
+					}
+					{
+						std::lock_guard<std::mutex> lock(mtx);
+						done[i % window] = 0;
+						nr_delivered = i + 1;
+					}
+					space_cv.notify_all();
+				}
+				space_cv.notify_all();
+				for (auto& t : workers)
+					t.join();
+
+				statistics.nr_slices = nr_delivered;
+				statistics.nr_bytes = nr_delivered * slice_size;
+				statistics.seconds = std::chrono::duration<double>(clock::now() - start).count();
+				return !failed;
+			}
+		}
+	}
+}
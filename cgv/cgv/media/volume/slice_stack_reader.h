@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cgv/data/data_format.h>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace volume {
+
+			/// throughput report of reading a slice stack
+			struct CGV_API slice_stack_statistics
+			{
+				/// number of decoded slices
+				size_t nr_slices = 0;
+				/// number of decoded bytes
+				size_t nr_bytes = 0;
+				/// number of decoding threads
+				unsigned nr_workers = 0;
+				/// wall clock time of reading in seconds
+				double seconds = 0;
+				/// accumulated time all workers spent in decoding in seconds
+				double decode_seconds = 0;
+				/// return number of decoded slices per second
+				double get_slices_per_second() const;
+				/// return number of decoded mega bytes per second
+				double get_mega_bytes_per_second() const;
+				/// print one line report
+				void print(std::ostream& os) const;
+			};
+
+			/** reads a stack of slices that are stored either in one image file per slice or as images of a multi image
+			    file like a multi page tiff. The slices are decoded concurrently by a pool of worker threads, each of
+				which uses its own image_reader. Slices are decoded directly into a contiguous destination or, if no
+				destination is given, into a ring of intermediate slice buffers. At most max_nr_pending_slices slices
+				are decoded ahead of the slice that was last passed to the completion callback, which is called on the
+				calling thread in slice order. This bounds the memory of the intermediate buffers. */
+			class CGV_API slice_stack_reader
+			{
+			public:
+				/// callback that is called in slice order with the decoded slice, return false to abort reading
+				typedef bool (*slice_callback)(size_t slice_index, const void* slice_ptr, void* user_data);
+			protected:
+				/// per slice file name and index of image in file
+				std::vector<std::string> file_names;
+				std::vector<unsigned> image_indices;
+				/// format of all slices
+				cgv::data::data_format format;
+				unsigned nr_workers;
+				size_t max_nr_pending_slices;
+				std::string last_error;
+				slice_stack_statistics statistics;
+			public:
+				/// construct reader, where nr_workers defaults to the number of hardware threads and max_nr_pending_slices to twice the number of workers
+				slice_stack_reader(unsigned _nr_workers = 0, size_t _max_nr_pending_slices = 0);
+				/// append one slice per image file
+				void add_slice_files(const std::vector<std::string>& _file_names);
+				/// append all images of a multi image file as slices and set the slice format from the file, return false if the file cannot be opened
+				bool add_multi_image_file(const std::string& file_name);
+				/// return number of slices
+				size_t get_nr_slices() const { return file_names.size(); }
+				/// determine slice format from first slice if not done before or set with set_format
+				bool determine_format();
+				/// set format expected for all slices, slices of different width, height or entry size cause an error
+				void set_format(const cgv::data::data_format& df) { format = df; }
+				/// return slice format
+				const cgv::data::data_format& get_format() const { return format; }
+				/** decode all slices. If data_ptr is given, slice i is decoded to data_ptr plus i times the slice size,
+				    otherwise into intermediate buffers that are only valid during the call to on_slice. */
+				bool read(void* data_ptr, slice_callback on_slice = 0, void* user_data = 0);
+				/// return throughput report of last read
+				const slice_stack_statistics& get_statistics() const { return statistics; }
+				/// return error of last failed operation
+				const std::string& get_last_error() const { return last_error; }
+			};
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
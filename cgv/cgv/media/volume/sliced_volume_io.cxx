@@ -3,6 +3,7 @@
 #endif
 
 #include "sliced_volume_io.h"
+#include "slice_stack_reader.h"
 #include <cgv/utils/scan.h>
 #include <cgv/utils/file.h>
 #include <cgv/utils/advanced_scan.h>
@@ -173,7 +174,7 @@ namespace cgv {
 					on_progress_update(V.get_dimensions()(2) + 1, user_data);
 				return true;
 			}
-			bool read_from_sliced_volume(const std::string& file_name, volume& V)
+			bool read_from_sliced_volume(const std::string& file_name, volume& V, slice_stack_statistics* statistics_ptr)
 			{
 				ooc_sliced_volume svol;
 				if (!svol.open_read(file_name)) {
@@ -272,6 +273,41 @@ namespace cgv {
 				V.resize(dims);
 				V.ref_extent() = svol.get_extent();
 
+				// decode image slices concurrently, raw binary slices without extension and video frames are read sequentially
+				if (st != ST_VIDEO) {
+					std::vector<std::string> file_names;
+					for (int i = 0; i < (int)dims(2); ++i) {
+						if (st == ST_INDEX)
+							file_names.push_back(svol.get_slice_file_name(i));
+						else {
+							unsigned j = i + svol.offset;
+							if (j >= slice_file_names.size()) {
+								std::cerr << "could not read slice " << i << " from with filename with index " << j << " as only " << slice_file_names.size() << " match pattern." << std::endl;
+								return false;
+							}
+							file_names.push_back(file_path + slice_file_names[j]);
+						}
+					}
+					if (!file_names.empty() && !cgv::utils::file::get_extension(file_names.front()).empty()) {
+						cgv::data::data_format slice_format;
+						slice_format.set_nr_dimensions(2);
+						slice_format.set_width(dims(0));
+						slice_format.set_height(dims(1));
+						slice_format.set_component_format(V.get_format().get_component_format());
+						cgv::media::volume::slice_stack_reader ssr;
+						ssr.add_slice_files(file_names);
+						ssr.set_format(slice_format);
+						if (!ssr.read(V.get_data_ptr<void>())) {
+							std::cerr << ssr.get_last_error() << std::endl;
+							return false;
+						}
+						if (statistics_ptr)
+							*statistics_ptr = ssr.get_statistics();
+						svol.close();
+						return true;
+					}
+				}
+
 				std::size_t slize_size = V.get_voxel_size() * V.get_format().get_width() * V.get_format().get_height();
 				cgv::type::uint8_type* dst_ptr = V.get_data_ptr<cgv::type::uint8_type>();
 
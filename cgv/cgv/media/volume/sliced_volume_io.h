@@ -1,6 +1,7 @@
 #pragma once
 
 #include "sliced_volume.h"
+#include "slice_stack_reader.h"
 
 #include "../lib_begin.h"
 
@@ -36,8 +37,9 @@ namespace cgv {
 			/// </summary>
 			/// <param name="file_name">name of svx file</param>
 			/// <param name="V">volume into which slices are read</param>
+			/// <param name="statistics_ptr">if given, receives the throughput of concurrently decoded image slices and is left untouched for raw binary slices and videos</param>
 			/// <returns></returns>
-			extern CGV_API bool read_from_sliced_volume(const std::string& file_name, volume& V);
+			extern CGV_API bool read_from_sliced_volume(const std::string& file_name, volume& V, slice_stack_statistics* statistics_ptr = 0);
 
 			extern CGV_API bool write_as_sliced_volume(const std::string& file_name, const std::string& file_name_pattern, const volume& V);
 		}
@@ -0,0 +1,74 @@
+#include "volume_distance_transform.h"
+#include <cgv/math/distance_transform.h>
+#include <cgv/type/standard_types.h>
+#include <limits>
+#include <cmath>
+
+namespace cgv {
+	namespace media {
+		namespace volume {
+
+			namespace {
+				/// classify voxels given by the first component of nr_components interleaved components
+				template <typename T>
+				void classify(const T* data, unsigned nr_components, size_t n, double threshold, std::vector<unsigned char>& inside)
+				{
+#pragma omp parallel for
+					for (long long i = 0; i < (long long)n; ++i)
+						inside[i] = double(data[i * nr_components]) > threshold ? 1 : 0;
+				}
+				/// initialize squared distances with zero for sites and infinity otherwise and transform them
+				void transform(const std::vector<unsigned char>& inside, unsigned char site_value, float* d,
+					const volume::dimension_type& dims, const volume::extent_type& spacing)
+				{
+					const float INF = std::numeric_limits<float>::infinity();
+#pragma omp parallel for
+					for (long long i = 0; i < (long long)inside.size(); ++i)
+						d[i] = inside[i] == site_value ? 0.0f : INF;
+					cgv::math::sqrdist_transf_3d(d, size_t(dims(0)), size_t(dims(1)), size_t(dims(2)), spacing(0), spacing(1), spacing(2));
+				}
+			}
+
+			bool compute_distance_field(const volume& V, volume& D, bool signed_distance, double threshold)
+			{
+				if (V.empty())
+					return false;
+				size_t n = V.get_nr_voxels();
+				unsigned nc = V.get_nr_components();
+				std::vector<unsigned char> inside(n);
+				switch (V.get_component_type()) {
+				case cgv::type::info::TI_INT8: classify(V.get_data_ptr<cgv::type::int8_type>(), nc, n, threshold, inside); break;
+				case cgv::type::info::TI_UINT8: classify(V.get_data_ptr<cgv::type::uint8_type>(), nc, n, threshold, inside); break;
+				case cgv::type::info::TI_INT16: classify(V.get_data_ptr<cgv::type::int16_type>(), nc, n, threshold, inside); break;
+				case cgv::type::info::TI_UINT16: classify(V.get_data_ptr<cgv::type::uint16_type>(), nc, n, threshold, inside); break;
+				case cgv::type::info::TI_INT32: classify(V.get_data_ptr<cgv::type::int32_type>(), nc, n, threshold, inside); break;
+				case cgv::type::info::TI_UINT32: classify(V.get_data_ptr<cgv::type::uint32_type>(), nc, n, threshold, inside); break;
+				case cgv::type::info::TI_FLT32: classify(V.get_data_ptr<cgv::type::flt32_type>(), nc, n, threshold, inside); break;
+				case cgv::type::info::TI_FLT64: classify(V.get_data_ptr<cgv::type::flt64_type>(), nc, n, threshold, inside); break;
+				default:
+					for (size_t i = 0; i < n; ++i)
+						inside[i] = V.get_format().get<double>(0, V.get_data_ptr<cgv::type::uint8_type>() + i * V.get_voxel_size()) > threshold ? 1 : 0;
+				}
+				volume::dimension_type dims = V.get_dimensions();
+				volume::extent_type spacing = V.get_spacing();
+				D.set_component_format("flt32[L]");
+				D.resize(dims);
+				D.ref_extent() = V.get_extent();
+				float* d = D.get_data_ptr<cgv::type::flt32_type>();
+				transform(inside, 1, d, dims, spacing);
+				if (!signed_distance) {
+#pragma omp parallel for
+					for (long long i = 0; i < (long long)n; ++i)
+						d[i] = std::sqrt(d[i]);
+					return true;
+				}
+				std::vector<float> d_inside(n);
+				transform(inside, 0, &d_inside[0], dims, spacing);
+#pragma omp parallel for
+				for (long long i = 0; i < (long long)n; ++i)
+					d[i] = inside[i] ? -std::sqrt(d_inside[i]) : std::sqrt(d[i]);
+				return true;
+			}
+		}
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "volume.h"
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace volume {
+
+			/** compute the euclidean distance field of a segmented volume with the separable 3d distance transform
+			    of cgv/math/distance_transform.h. Voxels whose first component is larger than threshold are inside.
+				The result D is a single component float volume of the same dimensions and extent, where distances
+				are measured between voxel centers in units of the voxel spacing get_spacing(). Without signed_distance
+				D holds the distance to the closest inside voxel. With signed_distance D holds the distance to the closest
+				inside voxel for outside voxels and the negated distance to the closest outside voxel for inside voxels,
+				which needs a second float buffer of the volume size. Infinite distances result if there is no inside
+				or no outside voxel. Returns false for empty volumes. */
+			extern CGV_API bool compute_distance_field(const volume& V, volume& D, bool signed_distance = true, double threshold = 0.5);
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
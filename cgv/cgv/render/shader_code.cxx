@@ -8,6 +8,8 @@
 #include <cgv/utils/dir.h>
 #include <cgv/utils/file.h>
 #include <cgv/type/variant.h>
+#include <chrono>
+#include <cstdio>
 
 #ifdef WIN32
 #pragma warning(disable:4996)
@@ -26,6 +28,96 @@ std::map<std::string, std::string> shader_code::shader_file_name_map;
 
 bool shader_code::shader_file_name_map_initialized = false;
 
+bool shader_code::shader_file_name_map_from_index = false;
+
+/// 64 bit FNV-1a hash of a string
+static uint64_t hash_string(const std::string& s)
+{
+	uint64_t h = 14695981039346656037ull;
+	for (char c : s) {
+		h ^= (unsigned char)c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+static std::string hash_to_hex(uint64_t h)
+{
+	char buffer[17];
+	snprintf(buffer, 17, "%016llx", (unsigned long long)h);
+	return buffer;
+}
+
+/// cache entries are sequences of fields, each stored as decimal length, colon and content
+static void append_cache_field(std::string& entry, const std::string& field)
+{
+	entry += std::to_string(field.size());
+	entry += ':';
+	entry += field;
+}
+
+static bool read_cache_field(const std::string& entry, size_t& pos, std::string& field)
+{
+	size_t colon_pos = entry.find(':', pos);
+	if (colon_pos == std::string::npos)
+		return false;
+	char* p_end;
+	unsigned long long length = std::strtoull(entry.c_str() + pos, &p_end, 10);
+	if (p_end != entry.c_str() + colon_pos || length > entry.size() - colon_pos - 1)
+		return false;
+	field = entry.substr(colon_pos + 1, (size_t)length);
+	pos = colon_pos + 1 + (size_t)length;
+	return true;
+}
+
+/// files processed with the ph_processor can insert files that are not tracked and are therefore never cached
+static bool is_cacheable_shader_file(const std::string& file_name)
+{
+	std::string ext = file::get_extension(file_name);
+	return ext.empty() || ext[0] != 'p';
+}
+
+/// return size and last write time of the file found for the given shader file name or empty string for resources and missing files
+static std::string get_file_stamp(const std::string& file_name)
+{
+	std::string fn = shader_code::find_file(file_name);
+	if (fn.empty() || fn.substr(0, 6) == "str://" || fn.substr(0, 6) == "res://")
+		return "";
+	size_t size = file::size(fn);
+	long long time = file::get_last_write_time(fn);
+	if (size == size_t(-1) || time == -1)
+		return "";
+	return std::to_string(size) + ' ' + std::to_string(time);
+}
+
+static std::string get_source_cache_key(const std::string& file_name, const shader_define_map& defines)
+{
+	std::string key = file_name;
+	for (const auto& entry : defines)
+		key += '\n' + entry.first + '=' + entry.second;
+	return key;
+}
+
+/// write to a temporary file that is renamed afterwards, such that concurrently started programs never read partial files
+static bool write_cache_file(const std::string& file_name, const std::string& content)
+{
+	std::string path = file::get_path(file_name);
+	if (!dir::exists(path) && !dir::mkdir(path))
+		return false;
+	std::string tmp_file_name = file_name + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+	if (!file::write(tmp_file_name, content.data(), content.size())) {
+		file::remove(tmp_file_name);
+		return false;
+	}
+	if (file::exists(file_name))
+		file::remove(file_name);
+	if (::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+		file::remove(tmp_file_name);
+		return false;
+	}
+	return true;
+}
+
 shader_config::shader_config()
 {
 	trace_file_names = false;
@@ -42,7 +134,8 @@ bool shader_config::self_reflect(cgv::reflect::reflection_handler& rh)
 {
 	return 
 		rh.reflect_member("shader_path", shader_path) &&
-		rh.reflect_member("show_file_paths", show_file_paths);
+		rh.reflect_member("show_file_paths", show_file_paths) &&
+		rh.reflect_member("shader_cache_path", cache_path);
 }
 
 /// return a reference to the current shader configuration
@@ -62,6 +155,8 @@ shader_config_ptr get_shader_config()
 				std::string(getenv("CGV_DIR")) + "/libs/cgv_gpgpu/glsl;" +
 				std::string(getenv("CGV_DIR")) + "/libs/holo_disp;" +
 				std::string(getenv("CGV_DIR")) + "/plugins/examples";
+		if (getenv("CGV_SHADER_CACHE_PATH"))
+			config->cache_path = getenv("CGV_SHADER_CACHE_PATH");
 	}
 	return config;
 }
@@ -211,9 +306,53 @@ std::string shader_code::find_file(const std::string& file_name, bool search_exh
 		return "";
 	}
 
-	if(!shader_file_name_map_initialized) {
-		std::string path_list = get_shader_config()->shader_path;
+	if(!shader_file_name_map_initialized)
+		init_shader_file_name_map(false);
+
+	std::map<std::string, std::string>::const_iterator file_name_map_it = shader_file_name_map.find(file_name);
+	// files added or moved after the index had been persisted are found by globbing once per process when a lookup fails
+	if(shader_file_name_map_from_index && (file_name_map_it == shader_file_name_map.end() || !file::exists(file_name_map_it->second))) {
+		init_shader_file_name_map(true);
+		file_name_map_it = shader_file_name_map.find(file_name);
+	}
+	if(file_name_map_it != shader_file_name_map.end()) {
+		try_name = file_name_map_it->second;
+		if(file::exists(try_name))
+		   return try_name;
+	} else if(!search_exhaustive) {
+		return "";
+	}
+
+	return file::find_in_paths(file_name, get_shader_config()->shader_path, true);
+}
+
+void shader_code::init_shader_file_name_map(bool force_glob)
+{
+	const std::string& path_list = get_shader_config()->shader_path;
+	std::string index_file_name;
+	if (!get_shader_config()->cache_path.empty())
+		index_file_name = get_shader_config()->cache_path + "/shader_file_index.txt";
+
+	shader_file_name_map.clear();
+	shader_file_name_map_from_index = false;
+
+	// the index stores the shader path in its first line and is only used if the shader path did not change
+	std::string content;
+	if(!force_glob && !index_file_name.empty() && file::read(index_file_name, content, true)) {
+		std::vector<line> lines;
+		split_to_lines(content, lines);
+		if(!lines.empty() && to_string(lines[0]) == path_list) {
+			for(size_t i = 1; i < lines.size(); ++i) {
+				std::string l = to_string(lines[i]);
+				size_t tab_pos = l.find('\t');
+				if(tab_pos != std::string::npos)
+					shader_file_name_map.emplace(l.substr(0, tab_pos), l.substr(tab_pos + 1));
+			}
+			shader_file_name_map_from_index = true;
+		}
+	}
 
+	if(!shader_file_name_map_from_index) {
 		size_t pos = 0;
 		do {
 			size_t end_pos = path_list.find_first_of(';', pos);
@@ -239,19 +378,86 @@ std::string shader_code::find_file(const std::string& file_name, bool search_exh
 			}
 		} while(pos < path_list.length());
 
-		shader_file_name_map_initialized = true;
+		if(!index_file_name.empty()) {
+			content = path_list + '\n';
+			for(const auto& entry : shader_file_name_map)
+				content += entry.first + '\t' + entry.second + '\n';
+			write_cache_file(index_file_name, content);
+		}
 	}
 
-	std::map<std::string, std::string>::const_iterator file_name_map_it = shader_file_name_map.find(file_name);
-	if(file_name_map_it != shader_file_name_map.end()) {
-		try_name = file_name_map_it->second;
-		if(file::exists(try_name))
-		   return try_name;
-	} else if(!search_exhaustive) {
+	shader_file_name_map_initialized = true;
+}
+
+std::string shader_code::get_source_cache_file_name(const std::string& key)
+{
+	const std::string& cache_path = get_shader_config()->cache_path;
+	if (cache_path.empty())
 		return "";
+	return cache_path + "/" + hash_to_hex(hash_string(key)) + ".glsl_cache";
+}
+
+bool shader_code::read_cached_source(const std::string& file_name, const shader_define_map& defines, bool use_cache, std::string& source)
+{
+	if (!is_cacheable_shader_file(file_name))
+		return false;
+	std::string key = get_source_cache_key(file_name, defines);
+	std::string cache_file_name = get_source_cache_file_name(key);
+	std::string entry;
+	if (cache_file_name.empty() || !file::read(cache_file_name, entry))
+		return false;
+
+	// entry consists of version, key, number of files, per file its name, size and write time stamp and content hash and the preprocessed source
+	size_t pos = 0;
+	std::string field;
+	if (!read_cache_field(entry, pos, field) || field != "cgv_shader_cache_2")
+		return false;
+	if (!read_cache_field(entry, pos, field) || field != key)
+		return false;
+	if (!read_cache_field(entry, pos, field))
+		return false;
+	size_t nr_files = std::strtoul(field.c_str(), 0, 10);
+	for (size_t i = 0; i < nr_files; ++i) {
+		std::string stamp, hash;
+		if (!read_cache_field(entry, pos, field) || !read_cache_field(entry, pos, stamp) || !read_cache_field(entry, pos, hash))
+			return false;
+		// only rehash files whose size or write time changed
+		if (!stamp.empty() && get_file_stamp(field) == stamp)
+			continue;
+		if (hash_to_hex(hash_string(retrieve_code(field, use_cache, 0))) != hash)
+			return false;
 	}
+	if (!read_cache_field(entry, pos, source))
+		return false;
+	if (get_shader_config()->show_file_paths)
+		std::cout << "read cached shader code <" << file_name << ">" << std::endl;
+	return true;
+}
 
-	return file::find_in_paths(file_name, get_shader_config()->shader_path, true);
+void shader_code::write_cached_source(const std::string& file_name, const shader_define_map& defines, bool use_cache, const std::set<std::string>& included_file_names, const std::string& source)
+{
+	std::string key = get_source_cache_key(file_name, defines);
+	std::string cache_file_name = get_source_cache_file_name(key);
+	if (cache_file_name.empty() || !is_cacheable_shader_file(file_name))
+		return;
+	for (const auto& included_file_name : included_file_names)
+		if (!is_cacheable_shader_file(included_file_name))
+			return;
+
+	std::string entry;
+	append_cache_field(entry, "cgv_shader_cache_2");
+	append_cache_field(entry, key);
+	append_cache_field(entry, std::to_string(included_file_names.size() + 1));
+	append_cache_field(entry, file_name);
+	append_cache_field(entry, get_file_stamp(file_name));
+	append_cache_field(entry, hash_to_hex(hash_string(retrieve_code(file_name, use_cache, 0))));
+	for (const auto& included_file_name : included_file_names) {
+		append_cache_field(entry, included_file_name);
+		append_cache_field(entry, get_file_stamp(included_file_name));
+		append_cache_field(entry, hash_to_hex(hash_string(retrieve_code(included_file_name, use_cache, 0))));
+	}
+	append_cache_field(entry, source);
+	write_cache_file(cache_file_name, entry);
 }
 
 std::string shader_code::retrieve_code(const std::string& file_name, bool use_cache, std::string* _last_error) {
@@ -394,14 +600,22 @@ bool shader_code::read_code(const context& ctx, const std::string &file_name, Sh
 	if (st == ST_DETECT)
 		st = detect_shader_type(file_name);
 
-	// get source code from cache or read file
-	std::string source = retrieve_code(file_name, ctx.is_shader_file_cache_enabled(), &last_error);
+	bool use_cache = ctx.is_shader_file_cache_enabled();
+	std::string source;
+	if (!read_cached_source(file_name, defines, use_cache, source)) {
+		// get source code from cache or read file
+		source = retrieve_code(file_name, use_cache, &last_error);
 
-	source = resolve_includes(source, ctx.is_shader_file_cache_enabled());
+		std::set<std::string> included_file_names;
+		source = resolve_includes(source, use_cache, included_file_names);
+
+		if(!defines.empty())
+			set_defines(source, defines);
+
+		if (!source.empty())
+			write_cached_source(file_name, defines, use_cache, included_file_names, source);
+	}
 
-	if(!defines.empty())
-		set_defines(source, defines);
-	
 	if (st == ST_VERTEX && ctx.get_gpu_vendor_id() == GPUVendorID::GPU_VENDOR_AMD)
 		set_vertex_attrib_locations(source);
 
@@ -21,6 +21,11 @@ namespace cgv {
 
 	 To set the shader path at runtime, query the shader_config with the
 	 get_shader_config() function.
+
+	 If the cache_path member is set, either through the environment variable
+	 CGV_SHADER_CACHE_PATH or the member shader_cache_path, the index of shader
+	 files found in the shader path and the preprocessed shader sources are
+	 persisted in this directory to speed up subsequent program starts.
 */
 struct CGV_API shader_config : public cgv::base::base
 {
@@ -30,6 +35,8 @@ struct CGV_API shader_config : public cgv::base::base
 	bool trace_file_names;
 	/// whether to output full paths of read shaders
 	bool show_file_paths;
+	/// directory of the persistent shader cache or empty if disabled
+	std::string cache_path;
 	/// mapping of shader index to file name
 	std::vector<std::string> shader_file_names;
 	/// mapping of shader index to inserted files name
@@ -94,6 +101,18 @@ protected:
 	static bool shader_file_name_map_initialized;
 	/// map that caches shader file contents indexed by their file name
 	static std::map<std::string, std::string> code_cache;
+	/// whether the shader file name map was read from the persistent shader file index instead of globbing the shader path, which is cleared by the first re-glob of the process
+	static bool shader_file_name_map_from_index;
+	/// initialize shader file name map from the persistent shader file index or by globbing the shader path if force_glob is true or the index is outdated
+	static void init_shader_file_name_map(bool force_glob);
+	/// return file name of the persistent cache entry for the given shader file and defines or empty string if caching is disabled
+	static std::string get_source_cache_file_name(const std::string& key);
+	/** read preprocessed shader source from the persistent cache. The entry is only used if the contents of the
+	    shader file and of all included files hash to the values stored in the entry, where files are only rehashed
+		if their size or last write time differ from the ones stored in the entry. */
+	static bool read_cached_source(const std::string& file_name, const shader_define_map& defines, bool use_cache, std::string& source);
+	/// store preprocessed shader source in the persistent cache together with size, last write time and content hash of the shader file and all included files
+	static void write_cached_source(const std::string& file_name, const shader_define_map& defines, bool use_cache, const std::set<std::string>& included_file_names, const std::string& source);
 
 	/// store the shader type
 	ShaderType st;
@@ -114,7 +133,10 @@ public:
 	/// shader_path is accessed by the get_shader_config() method. This path is initialized
 	/// to the environment variable CGV_SHADER_PATH or empty if that is not defined. If
 	/// search_exhaustive is true and the file has not been found yet, search recursively
-	/// in the shader_path.
+	/// in the shader_path. If the map was read from the persistent shader file index, the
+	/// shader path is globbed again and the index rewritten when a lookup misses the index or
+	/// an indexed file does not exist anymore, such that files added or moved after the index
+	/// had been written are found. This happens at most once per process.
 	/// 
 	/// @param file_name The shader file_name to search.
 	/// @param search_exhaustive If true, a full recursive search through the given shader_path will be performed if all other attempts have failed.
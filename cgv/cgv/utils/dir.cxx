@@ -48,7 +48,7 @@ bool mkdir(const std::string& dir_name)
 #ifdef _WIN32
 	return _mkdir(dir_name.c_str()) == 0;
 #else
-	return ::mkdir(dir_name.c_str(),S_IRWXU|S_IRWXG|S_IRWXO);
+	return ::mkdir(dir_name.c_str(),S_IRWXU|S_IRWXG|S_IRWXO) == 0;
 //	std::cerr << "Not Implemented\n" << std::endl;
 #endif
 }
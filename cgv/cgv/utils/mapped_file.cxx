@@ -0,0 +1,173 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace cgv {
+	namespace utils {
+
+mapped_file::mapped_file() : data(0), file_size(0), file_handle(0), mapping_handle(0)
+{
+}
+
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool mapped_file::open(const std::string& _file_name)
+{
+	close();
+	HANDLE fh = CreateFileA(_file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fh == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(fh, &size) || size.QuadPart == 0) {
+		CloseHandle(fh);
+		return false;
+	}
+	HANDLE mh = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mh == NULL) {
+		CloseHandle(fh);
+		return false;
+	}
+	void* ptr = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+	if (ptr == NULL) {
+		CloseHandle(mh);
+		CloseHandle(fh);
+		return false;
+	}
+	file_handle = fh;
+	mapping_handle = mh;
+	data = static_cast<const char*>(ptr);
+	file_size = size_t(size.QuadPart);
+	file_name = _file_name;
+	return true;
+}
+
+void mapped_file::close()
+{
+	if (data)
+		UnmapViewOfFile(data);
+	if (mapping_handle)
+		CloseHandle((HANDLE)mapping_handle);
+	if (file_handle)
+		CloseHandle((HANDLE)file_handle);
+	data = 0;
+	file_size = 0;
+	file_handle = 0;
+	mapping_handle = 0;
+	file_name.clear();
+}
+
+void mapped_file::advise(AccessHint hint, size_t offset, size_t length) const
+{
+}
+
+void mapped_file::prefetch(size_t offset, size_t length) const
+{
+	if (!data || offset >= file_size)
+		return;
+	if (length > file_size - offset)
+		length = file_size - offset;
+	// touch one byte per page to trigger paging
+	size_t page_size = get_page_size();
+	volatile char sink = 0;
+	for (size_t i = offset; i < offset + length; i += page_size)
+		sink += data[i];
+}
+
+size_t mapped_file::get_page_size()
+{
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return size_t(si.dwAllocationGranularity);
+}
+
+#else
+
+bool mapped_file::open(const std::string& _file_name)
+{
+	close();
+	int fd = ::open(_file_name.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void* ptr = mmap(0, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	// the mapping keeps its own reference to the file
+	::close(fd);
+	if (ptr == MAP_FAILED)
+		return false;
+	data = static_cast<const char*>(ptr);
+	file_size = size_t(st.st_size);
+	file_name = _file_name;
+	return true;
+}
+
+void mapped_file::close()
+{
+	if (data)
+		munmap(const_cast<char*>(data), file_size);
+	data = 0;
+	file_size = 0;
+	file_name.clear();
+}
+
+/// round the byte range outwards to page boundaries as required by madvise
+static bool page_range(size_t file_size, size_t& offset, size_t& length)
+{
+	if (offset >= file_size)
+		return false;
+	if (length > file_size - offset)
+		length = file_size - offset;
+	size_t page_size = mapped_file::get_page_size();
+	size_t begin = offset - offset % page_size;
+	length += offset - begin;
+	offset = begin;
+	return true;
+}
+
+void mapped_file::advise(AccessHint hint, size_t offset, size_t length) const
+{
+	if (!data || !page_range(file_size, offset, length))
+		return;
+	int advice = MADV_NORMAL;
+	switch (hint) {
+	case AH_SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+	case AH_RANDOM: advice = MADV_RANDOM; break;
+	default: break;
+	}
+	madvise(const_cast<char*>(data + offset), length, advice);
+}
+
+void mapped_file::prefetch(size_t offset, size_t length) const
+{
+	if (!data || !page_range(file_size, offset, length))
+		return;
+	madvise(const_cast<char*>(data + offset), length, MADV_WILLNEED);
+}
+
+size_t mapped_file::get_page_size()
+{
+	return size_t(sysconf(_SC_PAGESIZE));
+}
+
+#endif
+
+	}
+}
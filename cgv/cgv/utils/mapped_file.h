@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+
+/**
+* read-only memory mapping of a complete file that hides the win32 and posix api calls.
+*
+* Opening a mapped file does not read any data. Pages are loaded by the operating system
+* on first access such that only the touched parts of a file occupy physical memory.
+*
+* Example:
+*
+* mapped_file mf;
+* if (mf.open("points.mpc")) {
+*	const char* data = mf.get_data();
+*	...
+* }
+*/
+class CGV_API mapped_file
+{
+public:
+	/// access pattern hints forwarded to the operating system
+	enum AccessHint { AH_NORMAL, AH_SEQUENTIAL, AH_RANDOM };
+private:
+	std::string file_name;
+	const char* data;
+	size_t file_size;
+	void* file_handle;
+	void* mapping_handle;
+	/// non copyable
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator = (const mapped_file&) = delete;
+public:
+	/// construct unmapped instance
+	mapped_file();
+	/// unmap file if still mapped
+	~mapped_file();
+	/// map the given file read-only, return false if file cannot be opened or is empty
+	bool open(const std::string& _file_name);
+	/// unmap the file
+	void close();
+	/// return whether a file is mapped
+	bool is_open() const { return data != 0; }
+	/// return name of mapped file
+	const std::string& get_file_name() const { return file_name; }
+	/// return pointer to first byte of the mapped file
+	const char* get_data() const { return data; }
+	/// return size of mapped file in bytes
+	size_t get_size() const { return file_size; }
+	/// return pointer to the typed data at the given byte offset
+	template <typename T>
+	const T* get_pointer(size_t offset) const { return reinterpret_cast<const T*>(data + offset); }
+	/// give the operating system a hint how the given byte range will be accessed
+	void advise(AccessHint hint, size_t offset = 0, size_t length = size_t(-1)) const;
+	/// ask the operating system to prefetch the given byte range
+	void prefetch(size_t offset, size_t length) const;
+	/// return the granularity in bytes at which mappings are paged, i.e. the page size
+	static size_t get_page_size();
+};
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
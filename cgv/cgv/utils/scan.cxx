@@ -1,8 +1,12 @@
 #include "scan.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <cmath>
+#include <limits>
 #include <algorithm>
-#if __cplusplus >= 201703L
+#if __cplusplus >= 201703L || _MSVC_LANG >= 201703L
 #include <charconv>
 #endif
 
@@ -353,69 +357,311 @@ int get_element_index(const std::string& e, const std::string& s, char sep)
 	return -1;
 }
 
-#if __cplusplus >= 201703L
-	// We will be using std::from_chars below for parsing, this provides the whitespace check we need there
-	inline const bool char_is_zero_or_whitespace (const char ch) {
+namespace {
+	/// check for the characters that may terminate a number in is_integer and is_double
+	inline bool char_is_zero_or_whitespace(char ch) {
 		return ch == 0 || ch == '\r' || ch == '\n' || ch == ' ' || ch == '\t';
 	}
-	// This is the logic we're using to test whether a from_chars conversion was successful
-	inline const bool from_chars_success (const std::from_chars_result &r, const char *end_char) {
-		return r.ec == std::errc() && (r.ptr == end_char || char_is_zero_or_whitespace(*r.ptr));
+	/// check for the characters separating numbers within a line in parse_columns
+	inline bool is_blank(char ch) {
+		return ch == ' ' || ch == '\t' || ch == '\r';
 	}
-#endif
-
-bool is_integer(const char* begin, const char* end, int& value)
-{
-	if (begin == end)
-		return false;
-
-#if __cplusplus >= 201703L
-	return from_chars_success(std::from_chars(begin, end, value), end);
-#else
-	// skip trailing spaces
-	while (begin < end && *begin == ' ')
-		++begin;
-	// check for hexadecimal case
-	if (end-begin>2 && begin[0] == '0' && to_upper(begin[1]) == 'X') {
-		int new_value = 0, b = 1;
-		const char* p;
-		for (p = end; p>begin+2; b *= 16) {
-			--p;
-			if (is_digit(*p))
-				new_value += (int)(*p - '0')*b;
+	/// powers of ten that are exactly representable in double precision
+	const double exact_powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	/// powers of ten that are exactly representable in single precision
+	const float exact_float_powers_of_ten[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+	/// decimal number given by up to 19 significant digits and a power of ten
+	struct decimal_number
+	{
+		uint64_t mantissa;
+		int exponent;
+		bool negative;
+		/// whether non zero digits beyond the 19 stored ones were dropped
+		bool truncated;
+		/// whether a special value is not a number instead of infinity
+		bool is_nan;
+	};
+	/// case insensitive check whether [p,end( starts with the lower case string s
+	bool starts_with_lower(const char* p, const char* end, const char* s)
+	{
+		for (; *s; ++s, ++p)
+			if (p == end || to_lower(*p) != *s)
+				return false;
+		return true;
+	}
+	/** scan the syntax of std::from_chars in general format, i.e. an optional minus sign followed by digits with an
+		optional fraction and an optional exponent. Return the end of the number or begin if there is none. 
+		Infinity and nan are reported by setting special to their end and returning begin. */
+	const char* scan_decimal(const char* begin, const char* end, decimal_number& d, const char*& special)
+	{
+		const char* p = begin;
+		d.mantissa = 0;
+		d.exponent = 0;
+		d.negative = false;
+		d.truncated = false;
+		d.is_nan = false;
+		special = 0;
+		if (p < end && *p == '-') {
+			d.negative = true;
+			++p;
+		}
+		if (p < end && !is_digit(*p) && *p != '.') {
+			if (starts_with_lower(p, end, "infinity"))
+				special = p + 8;
+			else if (starts_with_lower(p, end, "inf"))
+				special = p + 3;
+			else if (starts_with_lower(p, end, "nan")) {
+				d.is_nan = true;
+				special = p + 3;
+				// optional sequence of letters, digits and underscores in parentheses
+				if (special < end && *special == '(') {
+					const char* q = special + 1;
+					while (q < end && (is_digit(*q) || is_letter(*q) || *q == '_'))
+						++q;
+					if (q < end && *q == ')')
+						special = q + 1;
+				}
+			}
+			return begin;
+		}
+		unsigned nr_significant = 0;
+		bool found_digit = false;
+		for (; p < end && is_digit(*p); ++p) {
+			found_digit = true;
+			if (nr_significant < 19) {
+				d.mantissa = 10 * d.mantissa + (*p - '0');
+				if (d.mantissa > 0)
+					++nr_significant;
+			}
 			else {
-				char c = to_upper(*p);
-				if (c >= 'A' && c <= 'F')
-					new_value += (int)(c - 'A' + 10)*b;
+				d.truncated |= *p != '0';
+				++d.exponent;
+			}
+		}
+		if (p < end && *p == '.') {
+			for (++p; p < end && is_digit(*p); ++p) {
+				found_digit = true;
+				if (nr_significant < 19) {
+					d.mantissa = 10 * d.mantissa + (*p - '0');
+					if (d.mantissa > 0)
+						++nr_significant;
+					--d.exponent;
+				}
 				else
-					return false;
+					d.truncated |= *p != '0';
 			}
 		}
-		value = new_value;
-		return true;
+		if (!found_digit)
+			return begin;
+		// an exponent is only consumed if at least one digit follows
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const char* q = p + 1;
+			bool negative_exponent = false;
+			if (q < end && (*q == '+' || *q == '-'))
+				negative_exponent = *q++ == '-';
+			if (q < end && is_digit(*q)) {
+				int e = 0;
+				for (; q < end && is_digit(*q); ++q)
+					if (e < 100000)
+						e = 10 * e + (*q - '0');
+				d.exponent += negative_exponent ? -e : e;
+				p = q;
+			}
+		}
+		return p;
 	}
-	int new_value = 0, b = 1;
-	const char* p;
-	for (p = end; p>begin; b *= 10) {
-		--p;
-		if (is_digit(*p))
-			new_value += (int)(*p - '0')*b;
+	/// convert the number in [begin,end( that did not qualify for the exact fast path
+	template <typename T>
+	const char* scan_floating_point_slow(const char* begin, const char* end, T& value)
+	{
+#ifdef __cpp_lib_to_chars
+		std::from_chars_result r = std::from_chars(begin, end, value);
+		return r.ec == std::errc() && r.ptr == end ? end : begin;
+#else
+		// copy to a zero terminated buffer on the stack for all but extremely long numbers
+		char buffer[128];
+		std::string long_number;
+		const char* str = buffer;
+		if (end - begin < 128) {
+			std::copy(begin, end, buffer);
+			buffer[end - begin] = 0;
+		}
 		else {
-			if (*p == '-') {
-				new_value = -new_value;
-				break;
+			long_number.assign(begin, end);
+			str = long_number.c_str();
+		}
+		errno = 0;
+		char* str_end;
+		double v = strtod(str, &str_end);
+		if (errno == ERANGE || str_end != str + (end - begin) || std::abs(v) > std::numeric_limits<T>::max())
+			return begin;
+		value = T(v);
+		return end;
+#endif
+	}
+	/// scan a floating point number with exact fast path for mantissas and exponents that are exactly representable in T
+	template <typename T>
+	const char* scan_floating_point(const char* begin, const char* end, T& value, const T* exact_powers, int max_exact_power, uint64_t max_exact_mantissa)
+	{
+		decimal_number d;
+		const char* special;
+		const char* p = scan_decimal(begin, end, d, special);
+		if (special) {
+			T v = d.is_nan ? std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::infinity();
+			value = d.negative ? -v : v;
+			return special;
+		}
+		if (p == begin)
+			return begin;
+		if (d.mantissa == 0) {
+			value = d.negative ? -T(0) : T(0);
+			return p;
+		}
+		if (!d.truncated && d.mantissa <= max_exact_mantissa && d.exponent >= -max_exact_power && d.exponent <= max_exact_power) {
+			// mantissa and power of ten are exact, such that a single correctly rounded operation follows
+			T v = T(d.mantissa);
+			v = d.exponent < 0 ? v / exact_powers[-d.exponent] : v * exact_powers[d.exponent];
+			value = d.negative ? -v : v;
+			return p;
+		}
+		return scan_floating_point_slow(begin, p, value);
+	}
+	/// scan an optional minus sign followed by decimal digits into a signed integer type
+	template <typename T>
+	const char* scan_signed_integer(const char* begin, const char* end, T& value)
+	{
+		const char* p = begin;
+		bool negative = p < end && *p == '-';
+		if (negative)
+			++p;
+		const char* digits_begin = p;
+		uint64_t limit = negative ? uint64_t(std::numeric_limits<T>::max()) + 1 : uint64_t(std::numeric_limits<T>::max());
+		uint64_t v = 0;
+		for (; p < end && is_digit(*p); ++p) {
+			unsigned digit = *p - '0';
+			if (v > (limit - digit) / 10)
+				return begin;
+			v = 10 * v + digit;
+		}
+		if (p == digits_begin)
+			return begin;
+		value = negative ? T(0 - v) : T(v);
+		return p;
+	}
+	/// dispatch to the scan function of a value type
+	inline const char* scan_value(const char* begin, const char* end, float& value) { return scan_float(begin, end, value); }
+	inline const char* scan_value(const char* begin, const char* end, double& value) { return scan_double(begin, end, value); }
+	inline const char* scan_value(const char* begin, const char* end, int& value) { return scan_integer(begin, end, value); }
+	/// parse complete lines of the range [begin,end( with the conventions of parse_columns
+	template <typename T>
+	void parse_column_lines(const char* begin, const char* end, unsigned nr_columns, std::vector<T>& values, char comment_char, size_t& nr_invalid_lines)
+	{
+		const char* p = begin;
+		while (p < end) {
+			const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+			if (!line_end)
+				line_end = end;
+			while (p < line_end && is_blank(*p))
+				++p;
+			if (p < line_end && *p != comment_char) {
+				size_t row_begin = values.size();
+				unsigned c;
+				for (c = 0; c < nr_columns; ++c) {
+					while (p < line_end && is_blank(*p))
+						++p;
+					T v;
+					const char* q = scan_value(p, line_end, v);
+					if (q == p || (q < line_end && !is_blank(*q)))
+						break;
+					values.push_back(v);
+					p = q;
+				}
+				if (c < nr_columns) {
+					values.resize(row_begin);
+					++nr_invalid_lines;
+				}
 			}
-			if (*p != '+')
-				return false;
-			break;
+			p = line_end + 1;
 		}
 	}
-	if (p == begin) {
-		value = new_value;
-		return true;
+	/// split the range into chunks at line boundaries that are parsed in parallel and appended in order
+	template <typename T>
+	size_t parse_columns_impl(const char* begin, const char* end, unsigned nr_columns, std::vector<T>& values, char comment_char, size_t* nr_invalid_lines)
+	{
+		if (nr_columns == 0)
+			return 0;
+		const size_t chunk_size = 1 << 20;
+		std::vector<const char*> bounds(1, begin);
+		while (bounds.back() < end) {
+			const char* p = bounds.back() + std::min(chunk_size, size_t(end - bounds.back()));
+			if (p < end) {
+				const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+				p = line_end ? line_end + 1 : end;
+			}
+			bounds.push_back(p);
+		}
+		int n = int(bounds.size()) - 1;
+		std::vector<std::vector<T> > chunk_values(n);
+		std::vector<size_t> chunk_invalid(n, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+		for (int k = 0; k < n; ++k)
+			parse_column_lines(bounds[k], bounds[k + 1], nr_columns, chunk_values[k], comment_char, chunk_invalid[k]);
+		size_t old_size = values.size(), total = old_size, invalid = 0;
+		for (int k = 0; k < n; ++k) {
+			total += chunk_values[k].size();
+			invalid += chunk_invalid[k];
+		}
+		values.reserve(total);
+		for (int k = 0; k < n; ++k)
+			values.insert(values.end(), chunk_values[k].begin(), chunk_values[k].end());
+		if (nr_invalid_lines)
+			*nr_invalid_lines = invalid;
+		return (total - old_size) / nr_columns;
 	}
-	return false;
-#endif
+}
+
+const char* scan_integer(const char* begin, const char* end, int& value)
+{
+	return scan_signed_integer(begin, end, value);
+}
+
+const char* scan_integer(const char* begin, const char* end, int64_t& value)
+{
+	return scan_signed_integer(begin, end, value);
+}
+
+const char* scan_double(const char* begin, const char* end, double& value)
+{
+	return scan_floating_point(begin, end, value, exact_powers_of_ten, 22, uint64_t(1) << 53);
+}
+
+const char* scan_float(const char* begin, const char* end, float& value)
+{
+	return scan_floating_point(begin, end, value, exact_float_powers_of_ten, 10, uint64_t(1) << 24);
+}
+
+size_t parse_columns(const char* begin, const char* end, unsigned nr_columns, std::vector<float>& values, char comment_char, size_t* nr_invalid_lines)
+{
+	return parse_columns_impl(begin, end, nr_columns, values, comment_char, nr_invalid_lines);
+}
+
+size_t parse_columns(const char* begin, const char* end, unsigned nr_columns, std::vector<double>& values, char comment_char, size_t* nr_invalid_lines)
+{
+	return parse_columns_impl(begin, end, nr_columns, values, comment_char, nr_invalid_lines);
+}
+
+size_t parse_columns(const char* begin, const char* end, unsigned nr_columns, std::vector<int>& values, char comment_char, size_t* nr_invalid_lines)
+{
+	return parse_columns_impl(begin, end, nr_columns, values, comment_char, nr_invalid_lines);
+}
+
+bool is_integer(const char* begin, const char* end, int& value)
+{
+	const char* p = scan_integer(begin, end, value);
+	return p != begin && (p == end || char_is_zero_or_whitespace(*p));
 }
 
 bool is_integer(const std::string& s, int& value)
@@ -425,60 +671,8 @@ bool is_integer(const std::string& s, int& value)
 
 bool is_double(const char* begin, const char* end, double& value)
 {
-	if (begin == end)
-		return false;
-
-#if __cplusplus >= 201703L
-	return from_chars_success(std::from_chars(begin, end, value), end);
-#else
-	bool found_digit = false;
-	int nr_dots = 0;
-	int nr_exp = 0;
-	bool sign_may_follow = true;
-	const char* p = begin;
-	while (p < end && *p == ' ')
-		++p;
-	for (; p<end; ++p) {
-		switch (*p) {
-		case '0' :
-		case '1' :
-		case '2' :
-		case '3' :
-		case '4' :
-		case '5' :
-		case '6' :
-		case '7' :
-		case '8' :
-		case '9' :
-			found_digit = true;
-			sign_may_follow = false;
-			break;
-		case '+' :
-		case '-' :
-			if (!sign_may_follow)
-				return false;
-			sign_may_follow = false;
-			break;
-		case '.' :
-			if (++nr_dots > 1)
-				return false;
-			sign_may_follow = false;
-			break;
-		case 'e' :
-		case 'E' :
-			if (++nr_exp > 1)
-				return false;
-			sign_may_follow = true;
-			break;
-		default:
-			return false;
-		}
-	}
-	if (!found_digit)
-		return false;
-	value = atof(std::string(begin,end-begin).c_str());
-	return true; 
-#endif
+	const char* p = scan_double(begin, end, value);
+	return p != begin && (p == end || char_is_zero_or_whitespace(*p));
 }
 
 bool is_double(const std::string& s, double& value)
@@ -85,6 +85,31 @@ extern CGV_API bool is_element(const std::string& e, const std::string& s, char
 extern CGV_API int get_element_index(const std::string& e, const std::string& s, char sep = ';');
 /** interpret s as a list separated by sep and return the element with the given element index. If index is out of range, return empty string. */
 extern CGV_API std::string get_element(const std::string& s, int element_index, char sep = ';');
+/** scan an integer at the start of the text range (begin,end( without skipping spaces. The syntax is that of std::from_chars, 
+	i.e. an optional minus sign followed by decimal digits. Scanning is locale independent and does not allocate memory. 
+	Return the pointer behind the number or begin if there is no number or it does not fit into value, which is only 
+	written on success. */
+extern CGV_API const char* scan_integer(const char* begin, const char* end, int& value);
+/// scan a 64 bit integer at the start of the text range (begin,end( as described for the int version
+extern CGV_API const char* scan_integer(const char* begin, const char* end, int64_t& value);
+/** scan a floating point number at the start of the text range (begin,end( without skipping spaces. The syntax is that of
+	std::from_chars in general format, i.e. an optional minus sign, digits with optional fraction and exponent as well as
+	inf, infinity and nan in any case. Numbers whose digits form an integer of at most 2^53 with a decimal exponent of 
+	at most 22 in magnitude are converted exactly without library calls, all others by std::from_chars where available. Return the pointer behind the number or begin
+	if there is no number or it is out of range. */
+extern CGV_API const char* scan_double(const char* begin, const char* end, double& value);
+/// scan a single precision floating point number at the start of the text range (begin,end( as described for scan_double
+extern CGV_API const char* scan_float(const char* begin, const char* end, float& value);
+/** parse rows of nr_columns numbers separated by spaces or tabs from the text range (begin,end( and append them row by row
+	to values. Empty lines and lines starting with comment_char are skipped. Numbers follow the syntax of scan_double, such
+	that a leading plus sign is rejected as in is_double, and numbers beyond nr_columns are ignored. Lines with fewer or invalid numbers are skipped and counted in nr_invalid_lines if given.
+	Line ends are found with memchr, which the C library vectorizes, and large texts are split at line ends into chunks 
+	parsed in parallel. Return the number of appended rows. */
+extern CGV_API size_t parse_columns(const char* begin, const char* end, unsigned nr_columns, std::vector<float>& values, char comment_char = '#', size_t* nr_invalid_lines = 0);
+/// parse rows of nr_columns numbers into double values as described for the float version
+extern CGV_API size_t parse_columns(const char* begin, const char* end, unsigned nr_columns, std::vector<double>& values, char comment_char = '#', size_t* nr_invalid_lines = 0);
+/// parse rows of nr_columns integers as described for the float version
+extern CGV_API size_t parse_columns(const char* begin, const char* end, unsigned nr_columns, std::vector<int>& values, char comment_char = '#', size_t* nr_invalid_lines = 0);
 /// check if the text range (begin,end( defines an integer value. If yes, store the value in the passed reference.
 extern CGV_API bool is_integer(const char* begin, const char* end, int& value);
 /// check if the passed string defines an integer value. If yes, store the value in the passed reference.
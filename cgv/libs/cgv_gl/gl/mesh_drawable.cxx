@@ -10,6 +10,8 @@ namespace cgv {
 mesh_drawable::mesh_drawable()
 {
 	rebuild_mesh_info = false;
+	// map obj files from their msm cache when they are loaded again
+	cgv::media::mesh::simple_mesh_base::set_msm_cache_enabled(true);
 }
 
 /// init textures
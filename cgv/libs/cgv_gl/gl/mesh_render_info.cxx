@@ -3,6 +3,7 @@
 #include <memory>
 
 #include <cgv/base/base.h>
+#include <cgv/media/mesh/vertex_cache_optimizer.h>
 
 namespace cgv {
 	namespace render {
@@ -13,6 +14,9 @@ mesh_render_info::mesh_render_info() :
 {
 	nr_triangle_elements = 0;
 	nr_edge_elements = 0;
+	optimize_vertex_cache = false;
+	acmr_computation = false;
+	acmr_before_optimization = acmr = -1;
 }
 ///
 void mesh_render_info::destruct(cgv::render::context& ctx)
@@ -36,6 +40,28 @@ void mesh_render_info::construct_vbos_base(cgv::render::context& ctx, const cgv:
 		ref_materials().back()->ensure_textures(ctx);
 	}
 
+	acmr_before_optimization = acmr = -1;
+	ct = mesh.get_color_storage_type();
+
+	// use element buffers stored in an msm file if they have been computed in the same way
+	const auto* stored = mesh.get_stored_element_buffers();
+	if (stored && (stored->vertex_cache_optimized || !optimize_vertex_cache)) {
+		include_tex_coords = stored->include_tex_coords;
+		include_normals = stored->include_normals;
+		include_tangents = stored->include_tangents;
+		vertex_indices.clear();
+		unique_quadruples = stored->unique_tuples;
+		triangle_element_buffer = stored->triangle_element_buffer;
+		edge_element_buffer = stored->edge_element_buffer;
+		material_primitive_start = stored->material_group_start;
+		nr_vertices = unique_quadruples.size();
+		nr_triangle_elements = triangle_element_buffer.size();
+		nr_edge_elements = edge_element_buffer.size();
+		if (acmr_computation)
+			acmr = cgv::media::mesh::compute_acmr(triangle_element_buffer);
+		return;
+	}
+
 	std::unique_ptr<std::vector<idx_type>> permutation;
 	bool sort_by_groups = mesh.get_nr_groups() > 0;
 	bool sort_by_materials = mesh.get_nr_materials() > 0;
@@ -47,11 +73,14 @@ void mesh_render_info::construct_vbos_base(cgv::render::context& ctx, const cgv:
 	nr_vertices = unique_quadruples.size();
 	mesh.extract_triangle_element_buffer(vertex_indices, triangle_element_buffer, permutation.get(),
 										 mesh.get_nr_materials() > 0 ? &material_primitive_start : 0);
-	
+	if (optimize_vertex_cache)
+		mesh.optimize_element_buffers(vertex_indices, unique_quadruples, triangle_element_buffer, &material_primitive_start,
+									  acmr_computation ? &acmr_before_optimization : 0, acmr_computation ? &acmr : 0);
+	else if (acmr_computation)
+		acmr = acmr_before_optimization = cgv::media::mesh::compute_acmr(triangle_element_buffer);
 	nr_triangle_elements = triangle_element_buffer.size();
 	mesh.extract_wireframe_element_buffer(vertex_indices, edge_element_buffer);
 	nr_edge_elements = edge_element_buffer.size();
-	ct = mesh.get_color_storage_type();
 }
 
 void mesh_render_info::finish_construct_vbos_base(cgv::render::context& ctx,
@@ -53,9 +53,18 @@ protected:
 	size_t color_increment;
 	/// color type
 	cgv::media::ColorType ct;
+	/// whether element buffers are optimized for the post transform vertex cache during construction
+	bool optimize_vertex_cache;
+	/// whether the average cache miss ratios are computed during construction
+	bool acmr_computation;
+	/// average cache miss ratios per triangle of the triangle element buffer before and after the optimization, or -1 if not computed
+	double acmr_before_optimization, acmr;
 	/**
 	 * Transform the given mesh into vectors which are suitable for upload into a VBO/EBO.
 	 * 
+	 * If the mesh has been read from an msm file with stored element buffers and its connectivity is unchanged,
+	 * the stored buffers are used and vertex_indices is left empty.
+	 *
 	 * \param [in] c The CGV drawing context.
 	 * \param [in] mesh The mesh which shall be transformed.
 	 * \param [out] vertex_indices the list of indices into the unique n-tuples.
@@ -133,6 +142,18 @@ public:
 		finish_construct_vbos_base(ctx, triangle_element_buffer, edge_element_buffer);
 		construct_draw_calls(ctx);
 	}
+	/// enable or disable the vertex cache optimization of the element buffers in subsequent constructions
+	void set_vertex_cache_optimization(bool enable) { optimize_vertex_cache = enable; }
+	/// check whether the vertex cache optimization is enabled
+	bool get_vertex_cache_optimization() const { return optimize_vertex_cache; }
+	/// enable or disable the computation of the average cache miss ratios in subsequent constructions
+	void set_acmr_computation(bool enable) { acmr_computation = enable; }
+	/// check whether the average cache miss ratios are computed
+	bool get_acmr_computation() const { return acmr_computation; }
+	/// return the average cache miss ratio per triangle of the constructed triangle element buffer or -1 if not computed
+	double get_acmr() const { return acmr; }
+	/// return the average cache miss ratio per triangle before the vertex cache optimization or -1 if not computed
+	double get_acmr_before_optimization() const { return acmr_before_optimization; }
 	/// set the number of to be drawn instances - in case of 0, instanced drawing is turned off
 	void set_nr_instances(unsigned nr);
 	/// return number of mesh primitives
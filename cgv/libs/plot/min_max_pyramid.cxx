@@ -0,0 +1,180 @@
+#include "min_max_pyramid.h"
+#include <algorithm>
+
+namespace cgv {
+	namespace plot {
+
+namespace {
+	/// extend block by sample, where nan values never replace minimum or maximum
+	void add_sample(min_max_pyramid::block& b, const vec2& s)
+	{
+		if (s[1] < b.min_sample[1] || b.min_sample[1] != b.min_sample[1])
+			b.min_sample = s;
+		if (s[1] > b.max_sample[1] || b.max_sample[1] != b.max_sample[1])
+			b.max_sample = s;
+	}
+	/// accumulates first, minimum, maximum and last sample of one pixel column and emits them in x-order
+	struct column_accumulator
+	{
+		std::vector<vec2>& result;
+		float x_min, scale;
+		int nr_columns;
+		int column;
+		vec2 first, last;
+		min_max_pyramid::block extremes;
+		column_accumulator(std::vector<vec2>& _result, float _x_min, float _x_max, unsigned _nr_columns)
+			: result(_result), x_min(_x_min), nr_columns(int(_nr_columns)), column(-2)
+		{
+			scale = _x_max > _x_min ? _nr_columns / (_x_max - _x_min) : 0.0f;
+		}
+		void emit(const vec2& s)
+		{
+			if (result.empty() || result.back() != s)
+				result.push_back(s);
+		}
+		void flush()
+		{
+			if (column == -2)
+				return;
+			emit(first);
+			if (extremes.min_sample[0] <= extremes.max_sample[0]) {
+				emit(extremes.min_sample);
+				emit(extremes.max_sample);
+			}
+			else {
+				emit(extremes.max_sample);
+				emit(extremes.min_sample);
+			}
+			emit(last);
+		}
+		/// add samples ranging from first to last sample with given extremes
+		void add(const vec2& _first, const min_max_pyramid::block& b, const vec2& _last)
+		{
+			float c = (_first[0] - x_min) * scale;
+			int ci = c < 0 ? -1 : (c >= nr_columns ? nr_columns : int(c));
+			if (ci != column) {
+				flush();
+				column = ci;
+				first = _first;
+				extremes = b;
+			}
+			else {
+				add_sample(extremes, b.min_sample);
+				add_sample(extremes, b.max_sample);
+			}
+			last = _last;
+		}
+	};
+}
+
+min_max_pyramid::min_max_pyramid()
+{
+	clear();
+}
+
+void min_max_pyramid::clear()
+{
+	levels.clear();
+	nr_samples = 0;
+	sorted = true;
+}
+
+void min_max_pyramid::update(const std::vector<vec2>& samples)
+{
+	if (samples.size() < nr_samples)
+		clear();
+	size_t n = samples.size();
+	if (n == nr_samples)
+		return;
+	for (size_t k = std::max(nr_samples, size_t(1)); k < n; ++k)
+		if (samples[k][0] < samples[k - 1][0])
+			sorted = false;
+	// recompute the blocks touched by the new samples level by level
+	size_t block_size = branching;
+	for (unsigned l = 0; block_size < n; ++l, block_size *= branching) {
+		size_t b0 = nr_samples / block_size;
+		if (l == levels.size()) {
+			levels.push_back(std::vector<block>());
+			b0 = 0;
+		}
+		std::vector<block>& level = levels[l];
+		size_t nr_blocks = (n + block_size - 1) / block_size;
+		level.resize(nr_blocks);
+		for (size_t b = b0; b < nr_blocks; ++b) {
+			block& bl = level[b];
+			if (l == 0) {
+				size_t k_end = std::min((b + 1) * branching, n);
+				bl.min_sample = bl.max_sample = samples[b * branching];
+				for (size_t k = b * branching + 1; k < k_end; ++k)
+					add_sample(bl, samples[k]);
+			}
+			else {
+				const std::vector<block>& children = levels[l - 1];
+				size_t c_end = std::min((b + 1) * branching, children.size());
+				bl = children[b * branching];
+				for (size_t c = b * branching + 1; c < c_end; ++c) {
+					add_sample(bl, children[c].min_sample);
+					add_sample(bl, children[c].max_sample);
+				}
+			}
+		}
+	}
+	nr_samples = n;
+}
+
+unsigned min_max_pyramid::extract(const std::vector<vec2>& samples, float x_min, float x_max, unsigned nr_columns, std::vector<vec2>& result) const
+{
+	result.clear();
+	size_t n = std::min(nr_samples, samples.size());
+	if (!sorted) {
+		result.assign(samples.begin(), samples.begin() + n);
+		return 0;
+	}
+	// find range of visible samples extended by one sample on each side
+	auto begin = samples.begin(), end = samples.begin() + n;
+	size_t i0 = std::lower_bound(begin, end, x_min, [](const vec2& s, float x) { return s[0] < x; }) - begin;
+	size_t i1 = std::upper_bound(begin, end, x_max, [](float x, const vec2& s) { return x < s[0]; }) - begin;
+	if (i0 > 0)
+		--i0;
+	if (i1 < n)
+		++i1;
+	if (i1 <= i0)
+		return 0;
+	size_t count = i1 - i0;
+	if (nr_columns == 0 || count <= 4 * size_t(nr_columns)) {
+		result.assign(begin + i0, begin + i1);
+		return 0;
+	}
+	result.reserve(4 * nr_columns + 8);
+	column_accumulator ca(result, x_min, x_max, nr_columns);
+	// choose number of levels such that blocks are not wider than a column on average
+	unsigned nr_levels = 0;
+	size_t block_size = branching;
+	while (nr_levels < levels.size() && count / block_size >= nr_columns) {
+		block_size *= branching;
+		++nr_levels;
+	}
+	// decompose sample range into largest aligned blocks, such that blocks at the interval boundaries are
+	// refined down to samples and extremes close to the boundaries are not lost
+	size_t k = i0;
+	while (k < i1) {
+		unsigned m = 0;
+		size_t size = 1;
+		while (m < nr_levels && k % (size * branching) == 0 && k + size * branching <= i1) {
+			size *= branching;
+			++m;
+		}
+		if (m == 0) {
+			block b = { samples[k], samples[k] };
+			ca.add(samples[k], b, samples[k]);
+		}
+		else
+			ca.add(samples[k], levels[m - 1][k / size], samples[k + size - 1]);
+		k += size;
+	}
+	ca.flush();
+	return nr_levels;
+}
+
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cgv/math/fvec.h>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace plot {
+
+/** hierarchical min/max summary of a 2d sample sequence with non decreasing x coordinates, such as a time series.
+    The pyramid is updated incrementally when samples are appended and allows to extract an M4 representation
+	of a visible x-interval, i.e. first, minimum, maximum and last sample per pixel column. The extraction costs
+	are proportional to the number of pixel columns and not to the number of samples, while spikes stay visible.
+	Level l of the pyramid summarizes blocks of branching^(l+1) consecutive samples by their samples of minimum
+	and maximum y-coordinate. First and last samples of blocks are looked up in the sample container itself. */
+class CGV_API min_max_pyramid
+{
+public:
+	/// number of blocks of a level summarized by one block of the next level
+	static const unsigned branching = 8;
+	/// summary of a block of samples
+	struct block
+	{
+		/// sample with minimum y-coordinate
+		vec2 min_sample;
+		/// sample with maximum y-coordinate
+		vec2 max_sample;
+	};
+protected:
+	/// blocks per level
+	std::vector<std::vector<block>> levels;
+	/// number of samples incorporated into the pyramid
+	size_t nr_samples;
+	/// whether incorporated samples have non decreasing x-coordinates
+	bool sorted;
+public:
+	/// construct empty pyramid
+	min_max_pyramid();
+	/// remove all levels
+	void clear();
+	/// return number of samples incorporated into the pyramid
+	size_t get_nr_samples() const { return nr_samples; }
+	/// return number of levels
+	unsigned get_nr_levels() const { return unsigned(levels.size()); }
+	/// return whether x-coordinates of incorporated samples are non decreasing, otherwise extract() cannot be used
+	bool is_sorted() const { return sorted; }
+	/// incorporate samples appended since the last update, if the container shrank the pyramid is rebuilt
+	void update(const std::vector<vec2>& samples);
+	/** extract a representation of the samples in the x-interval [x_min, x_max] for drawing into nr_columns pixel
+	    columns. One sample before and after the interval is included to continue lines to the boundaries.
+		If the interval contains not more than four samples per column, the samples are copied unchanged,
+		otherwise up to four samples per column are generated. Returns the number of pyramid levels used for
+		extraction, which is 0 if samples were processed directly. */
+	unsigned extract(const std::vector<vec2>& samples, float x_min, float x_max, unsigned nr_columns, std::vector<vec2>& result) const;
+};
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -11,6 +11,7 @@ namespace cgv {
 plot2d_config::plot2d_config(const std::string& _name) : plot_base_config(_name, 2)
 {
 	configure_chart(CT_LINE_CHART);
+	use_min_max_pyramid = false;
 };
 
 /// configure the sub plot to a specific chart type
@@ -81,6 +82,7 @@ unsigned plot2d::add_sub_plot(const std::string& name)
 	// create new point container
 	samples.push_back(std::vector<vec2>());
 	strips.push_back(std::vector<unsigned>());
+	decimations.push_back(decimation_info());
 	attribute_source_arrays.push_back(attribute_source_array());
 	attribute_source_arrays.back().attribute_sources.push_back(attribute_source(i, 0, 0, 2 * sizeof(float)));
 	attribute_source_arrays.back().attribute_sources.push_back(attribute_source(i, 1, 0, 2 * sizeof(float)));
@@ -95,6 +97,7 @@ void plot2d::delete_sub_plot(unsigned i)
 	configs.erase(configs.begin() + i);
 	samples.erase(samples.begin() + i);
 	strips.erase(strips.begin() + i);
+	decimations.erase(decimations.begin() + i);
 }
 
 /// return a reference to the plot base configuration of the i-th plot
@@ -108,6 +111,65 @@ std::vector<vec2>& plot2d::ref_sub_plot_samples(unsigned i)
 	return samples[i];
 }
 
+void plot2d::set_samples_out_of_date(unsigned i)
+{
+	plot_base::set_samples_out_of_date(i);
+	decimations[i].pyramid.clear();
+}
+
+size_t plot2d::decimated_sample_access::size(unsigned i) const
+{
+	const decimation_info& d = plot.decimations[i];
+	return d.active ? d.samples.size() : plot.samples[i].size();
+}
+
+float plot2d::decimated_sample_access::operator() (unsigned i, unsigned k, unsigned o) const
+{
+	const decimation_info& d = plot.decimations[i];
+	return d.active ? d.samples[k][o] : plot.samples[i][k][o];
+}
+
+void plot2d::update_decimations(cgv::render::context& ctx)
+{
+	const axis_config& ac = get_domain_config_ptr()->axis_configs[0];
+	unsigned nr_columns = ctx.get_width();
+	for (unsigned i = 0; i < get_nr_sub_plots(); ++i) {
+		decimation_info& d = decimations[i];
+		// decimation is only possible if all attributes are defined by the own sample container and neither strips
+		// nor sample ranges are used
+		const plot2d_config& spc = ref_sub_plot2d_config(i);
+		bool use = spc.use_min_max_pyramid && strips[i].empty() && spc.begin_sample == 0 && spc.end_sample == size_t(-1) &&
+			samples[i].size() > 4 * size_t(nr_columns);
+		for (const auto& as : attribute_source_arrays[i].attribute_sources)
+			if (as.source != AS_SAMPLE_CONTAINER || (as.sub_plot_index != -1 && as.sub_plot_index != int(i)))
+				use = false;
+		if (use) {
+			d.pyramid.update(samples[i]);
+			use = d.pyramid.is_sorted();
+		}
+		// samples need to be uploaded only if decimation is switched, the sub plot samples changed, or the visible 
+		// interval changed such that samples are extracted again
+		auto& asa = attribute_source_arrays[i];
+		if (use) {
+			float x_min = ac.get_attribute_min(), x_max = ac.get_attribute_max();
+			if (!d.active || asa.samples_out_of_date || x_min != d.x_min || x_max != d.x_max || nr_columns != d.nr_columns) {
+				d.pyramid.extract(samples[i], x_min, x_max, nr_columns, d.samples);
+				d.x_min = x_min;
+				d.x_max = x_max;
+				d.nr_columns = nr_columns;
+				asa.samples_out_of_date = true;
+			}
+		}
+		else {
+			if (d.active)
+				asa.samples_out_of_date = true;
+			d.pyramid.clear();
+			d.samples.clear();
+		}
+		d.active = use;
+	}
+}
+
 /// return the strip definition of the i-th sub plot
 std::vector<unsigned>& plot2d::ref_sub_plot_strips(unsigned i)
 {
@@ -154,7 +216,7 @@ bool plot2d::draw_point_plot(cgv::render::context& ctx, int i, int layer_idx)
 	// skip unvisible and empty sub plots
 	if (!ref_sub_plot2d_config(i).show_plot)
 		return false;
-	GLsizei count = (GLsizei)enable_attributes(ctx, i, samples);
+	GLsizei count = (GLsizei)enable_attributes(ctx, i, decimated_sample_access(*this));
 	bool result = false;
 	if (count > 0) {
 		const plot2d_config& spc = ref_sub_plot2d_config(i);
@@ -193,7 +255,7 @@ bool plot2d::draw_line_plot(cgv::render::context& ctx, int i, int layer_idx)
 	// skip unvisible and empty sub plots
 	if (!ref_sub_plot2d_config(i).show_plot)
 		return false;
-	GLsizei count = (GLsizei)enable_attributes(ctx, i, samples);
+	GLsizei count = (GLsizei)enable_attributes(ctx, i, decimated_sample_access(*this));
 	bool result = false;
 	if (count > 0) {
 		const plot2d_config& spc = ref_sub_plot2d_config(i);
@@ -242,7 +304,7 @@ bool plot2d::draw_stick_plot(cgv::render::context& ctx, int i, int layer_idx)
 	// skip unvisible and empty sub plots
 	if (!ref_sub_plot2d_config(i).show_plot)
 		return false;
-	GLsizei count = (GLsizei)enable_attributes(ctx, i, samples);
+	GLsizei count = (GLsizei)enable_attributes(ctx, i, decimated_sample_access(*this));
 	bool result = false;
 	if (count > 0) {
 		const plot2d_config& spc = ref_sub_plot2d_config(i);
@@ -295,7 +357,7 @@ bool plot2d::draw_bar_plot(cgv::render::context& ctx, int i, int layer_idx)
 	if (!ref_sub_plot2d_config(i).show_plot)
 		return false;
 	bool result = false;
-	GLsizei count = (GLsizei)enable_attributes(ctx, i, samples);
+	GLsizei count = (GLsizei)enable_attributes(ctx, i, decimated_sample_access(*this));
 	if (count > 0) {
 		const plot2d_config& spc = ref_sub_plot2d_config(i);
 		if (spc.show_bars && rectangle_prog.is_linked()) {
@@ -555,6 +617,8 @@ void plot2d::draw(cgv::render::context& ctx)
 
 	// configure bar prog only once
 	configure_bar_plot(ctx);
+	// replace large sample sets by extracts at the resolution of the viewport
+	update_decimations(ctx);
 	// draw all subplots jointly in one plane
 	if (sub_plot_delta[2] == 0.0f) {
 		if (get_domain_config_ptr()->show_domain)
@@ -666,6 +730,7 @@ void plot2d::create_bar_config_gui(cgv::base::base* bp, cgv::gui::provider& p, p
 void plot2d::create_config_gui(cgv::base::base* bp, cgv::gui::provider& p, unsigned i)
 {
 	plot_base::create_config_gui(bp, p, i);
+	p.add_member_control(bp, "Min/Max Pyramid", ref_sub_plot2d_config(i).use_min_max_pyramid, "check");
 }
 
 void plot2d::create_gui(cgv::base::base* bp, cgv::gui::provider& p)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "plot_base.h"
+#include "min_max_pyramid.h"
 //#include "mark2d_provider.h"
 #include <cgv/render/shader_program.h>
 
@@ -17,6 +18,9 @@ struct CGV_API plot2d_config : public plot_base_config
 	plot2d_config(const std::string& _name);
 	/// configure the sub plot to a specific chart type
 	void configure_chart(ChartType chart_type);
+	/** whether to draw large sample sets with non decreasing x-coordinates through a min/max pyramid at the
+	    resolution of the viewport, defaults to false. The pyramid is rebuilt after set_samples_out_of_date(). */
+	bool use_min_max_pyramid;
 	/// list of styles for provider based marks
 	//std::vector<std::pair<mark2d_provider*, mark_style*>> marks;
 };
@@ -49,6 +53,30 @@ protected:
 	std::vector <std::vector<unsigned> > strips;
 	/// attribute managers for domain rectangles and domain tick labels
 	cgv::render::attribute_array_manager aam_domain, aam_domain_tick_labels;
+	/// per sub plot decimation of large sample sets
+	struct decimation_info
+	{
+		/// incrementally updated summary of the sub plot samples
+		min_max_pyramid pyramid;
+		/// samples extracted for the visible x-interval
+		std::vector<vec2> samples;
+		/// whether extracted samples are drawn instead of the sub plot samples
+		bool active = false;
+		/// visible x-interval and number of columns of the extracted samples
+		float x_min = 0, x_max = 0;
+		unsigned nr_columns = 0;
+	};
+	std::vector<decimation_info> decimations;
+	/// update pyramids and extract samples of visible x-interval for sub plots with large sample sets
+	void update_decimations(cgv::render::context& ctx);
+	/// sample access that replaces samples of sub plots with active decimation by the extracted samples
+	struct decimated_sample_access : public sample_access
+	{
+		const plot2d& plot;
+		decimated_sample_access(const plot2d& _plot) : plot(_plot) {}
+		size_t size(unsigned i) const;
+		float operator() (unsigned i, unsigned k, unsigned o) const;
+	};
 public:
 	bool disable_depth_mask;
 	/// whether to manage separate axes for each sub plot
@@ -74,6 +102,8 @@ public:
 	std::vector<vec2>& ref_sub_plot_samples(unsigned i = 0);
 	/// return the strip definition of the i-th sub plot
 	std::vector<unsigned>& ref_sub_plot_strips(unsigned i = 0);
+	/// notify plot that samples of given subplot are out of date, which also rebuilds its min/max pyramid
+	void set_samples_out_of_date(unsigned i);
 	//@}
 
 	/// construct shader programs
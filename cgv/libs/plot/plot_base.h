@@ -441,9 +441,6 @@ protected:
 	void set_plot_uniforms(cgv::render::context& ctx, cgv::render::shader_program& prog);
 	/// set the uniforms for defining the mappings to visual variables
 	void set_mapping_uniforms(cgv::render::context& ctx, cgv::render::shader_program& prog);
-private:
-	/// dimension independent implementation of attribute enabling
-	size_t enable_attributes(cgv::render::context& ctx, int i, const sample_access& sa);
 protected:
 	/// render style of rectangles
 	cgv::render::rectangle_render_style rrs, font_rrs;
@@ -569,7 +566,7 @@ public:
 	/// return a reference to the plot base configuration of the i-th plot
 	plot_base_config& ref_sub_plot_config(unsigned i);
 	/// notify plot that samples of given subplot are out of date
-	void set_samples_out_of_date(unsigned i);
+	virtual void set_samples_out_of_date(unsigned i);
 	/// set the colors for all plot features of the i-th sub plot as variation of the given color
 	void set_sub_plot_colors(unsigned i, const rgb& base_color);
 	/// define a sub plot attribute ai from coordinate aj of the i-th internal sample container
@@ -578,6 +575,8 @@ public:
 	void set_sub_plot_attribute(unsigned i, unsigned ai, const float* _pointer, size_t count, size_t stride);
 	/// define a sub plot attribute from a vbo (attribute must be stored in float type in vbo)
 	void set_sub_plot_attribute(unsigned i, unsigned ai, const cgv::render::vertex_buffer* _vbo_ptr, size_t _offset, size_t _count, size_t _stride);
+	/// dimension independent implementation of attribute enabling, where sample container attributes are read through sa
+	size_t enable_attributes(cgv::render::context& ctx, int i, const sample_access& sa);
 	//@}
 
 	/// build legend prog and create aab
@@ -2,6 +2,9 @@
 #include <algorithm>
 #include <random>
 #include <fstream>
+#include <cstring>
+#include <cgv/utils/stopwatch.h>
+#include "concurrency.h"
 #include "ICP.h"
 
 namespace cgv {
@@ -15,6 +18,12 @@ namespace cgv {
 			this->maxIterations = 400;
 			this->numRandomSamples = 400;
 			this->eps = 1e-8;
+			use_point_to_plane = true;
+			max_correspondence_distance = 0;
+			convergence_rotation_eps = 1e-5f;
+			convergence_translation_eps = 1e-6f;
+			report_timing = false;
+			random_seed = 0;
 		}
 
 		ICP::~ICP() {
@@ -35,6 +44,7 @@ namespace cgv {
 		void ICP::clear()
 		{
 			tree = nullptr;
+			kd_tree = nullptr;
 		}
 
 		void ICP::set_source_cloud(const point_cloud& inputCloud) {
@@ -43,6 +53,7 @@ namespace cgv {
 
 		void ICP::set_target_cloud(const point_cloud& inputCloud, std::shared_ptr<ann_tree> precomputed_tree) {
 			targetCloud = &inputCloud;
+			kd_tree = nullptr;
 			if (precomputed_tree)
 				tree = precomputed_tree;
 		}
@@ -172,6 +183,204 @@ namespace cgv {
 			//print_translation(translation_vec);
 		}
 
+		namespace {
+			/// partial sums of the normal equations accumulated over a range of correspondences
+			struct icp_accumulator
+			{
+				double ATA[6][6], ATb[6];
+				double sum_p[3], sum_q[3], sum_qp[3][3];
+				double sqr_error;
+				size_t nr_correspondences;
+				icp_accumulator() { std::memset(this, 0, sizeof(icp_accumulator)); }
+				void add(const icp_accumulator& a) {
+					for (int i = 0; i < 6; ++i) {
+						for (int j = 0; j < 6; ++j)
+							ATA[i][j] += a.ATA[i][j];
+						ATb[i] += a.ATb[i];
+					}
+					for (int i = 0; i < 3; ++i) {
+						sum_p[i] += a.sum_p[i];
+						sum_q[i] += a.sum_q[i];
+						for (int j = 0; j < 3; ++j)
+							sum_qp[i][j] += a.sum_qp[i][j];
+					}
+					sqr_error += a.sqr_error;
+					nr_correspondences += a.nr_correspondences;
+				}
+			};
+			/// solve symmetric 6x6 system with gaussian elimination and partial pivoting, return false if singular
+			bool solve_6x6(double A[6][6], double b[6], double x[6])
+			{
+				for (int c = 0; c < 6; ++c) {
+					int pivot = c;
+					for (int r = c + 1; r < 6; ++r)
+						if (std::abs(A[r][c]) > std::abs(A[pivot][c]))
+							pivot = r;
+					if (std::abs(A[pivot][c]) < 1e-12)
+						return false;
+					if (pivot != c) {
+						std::swap_ranges(A[c], A[c] + 6, A[pivot]);
+						std::swap(b[c], b[pivot]);
+					}
+					for (int r = c + 1; r < 6; ++r) {
+						double f = A[r][c] / A[c][c];
+						for (int k = c; k < 6; ++k)
+							A[r][k] -= f * A[c][k];
+						b[r] -= f * b[c];
+					}
+				}
+				for (int r = 5; r >= 0; --r) {
+					double s = b[r];
+					for (int k = r + 1; k < 6; ++k)
+						s -= A[r][k] * x[k];
+					x[r] = s / A[r][r];
+				}
+				return true;
+			}
+		}
+
+		void ICP::reg_icp_accelerated(Mat& rotation_mat, Dir& translation_vec, std::vector<iteration_info>* infos)
+		{
+			if (!(sourceCloud && targetCloud) || sourceCloud->get_nr_points() == 0 || targetCloud->get_nr_points() == 0) {
+				std::cerr << "ICP::reg_icp_accelerated: source or target cloud not set!\n";
+				return;
+			}
+			bool point_to_plane = use_point_to_plane;
+			if (point_to_plane && !targetCloud->has_normals()) {
+				std::cerr << "ICP::reg_icp_accelerated: target cloud has no normals, falling back to point to point\n";
+				point_to_plane = false;
+			}
+			if (!kd_tree) {
+				cgv::utils::stopwatch watch(true);
+				kd_tree = std::make_shared<point_kd_tree>(*targetCloud);
+				if (report_timing)
+					std::cout << "ICP: built kd-tree over " << targetCloud->get_nr_points() << " points in " << watch.get_elapsed_time() << "s" << std::endl;
+			}
+			if (infos)
+				infos->clear();
+
+			// nested random subsets of the source cloud for the coarse-to-fine schedule
+			size_t num_source_points = sourceCloud->get_nr_points();
+			std::vector<Idx> sample_indices(num_source_points);
+			for (size_t i = 0; i < num_source_points; ++i)
+				sample_indices[i] = Idx(i);
+			std::shuffle(sample_indices.begin(), sample_indices.end(), std::default_random_engine(random_seed));
+			std::vector<int> schedule = subsampling_schedule;
+			if (schedule.empty())
+				schedule.push_back(numRandomSamples);
+
+			Crd max_sqr_dist = max_correspondence_distance > 0 ? max_correspondence_distance * max_correspondence_distance : std::numeric_limits<Crd>::max();
+			auto& scheduler = cgv::pointcloud::utility::TaskScheduler::ref_shared();
+
+			for (int level = 0; level < (int)schedule.size(); ++level) {
+				size_t nr_samples = (schedule[level] > 0 && (size_t)schedule[level] < num_source_points) ? (size_t)schedule[level] : num_source_points;
+				float last_rms = std::numeric_limits<float>::infinity();
+				for (int iter = 0; iter < maxIterations; iter++) {
+					cgv::utils::stopwatch watch(true);
+					// find correspondences in parallel with one partial sum per block of samples
+					const int64_t block_size = 4096;
+					std::vector<icp_accumulator> block_accs((nr_samples + block_size - 1) / block_size);
+					scheduler.parallel_for(0, block_accs.size(), 1, [&](int64_t begin, int64_t end) {
+						for (int64_t bi = begin; bi < end; ++bi) {
+							icp_accumulator& local = block_accs[bi];
+							int64_t sample_end = std::min(int64_t(nr_samples), (bi + 1) * block_size);
+							for (int64_t si = bi * block_size; si < sample_end; ++si) {
+								Pnt p = rotation_mat * sourceCloud->pnt(sample_indices[si]) + translation_vec;
+								Crd sqr_dist;
+								Idx qi = kd_tree->find_closest(p, max_sqr_dist, &sqr_dist);
+								if (qi < 0)
+									continue;
+								const Pnt& q = targetCloud->pnt(qi);
+								++local.nr_correspondences;
+								if (point_to_plane) {
+									const Nml& n = targetCloud->nml(qi);
+									Dir c = cross(p, n);
+									double a[6] = { c[0], c[1], c[2], n[0], n[1], n[2] };
+									double b = dot(n, q - p);
+									for (int i = 0; i < 6; ++i) {
+										for (int j = i; j < 6; ++j)
+											local.ATA[i][j] += a[i] * a[j];
+										local.ATb[i] += a[i] * b;
+									}
+									local.sqr_error += b * b;
+								}
+								else {
+									for (int i = 0; i < 3; ++i) {
+										local.sum_p[i] += p[i];
+										local.sum_q[i] += q[i];
+										for (int j = 0; j < 3; ++j)
+											local.sum_qp[i][j] += double(q[i]) * p[j];
+									}
+									local.sqr_error += sqr_dist;
+								}
+							}
+						}
+					});
+					// reduce partial sums in block order such that the result does not depend on the scheduling
+					icp_accumulator acc;
+					for (const auto& block_acc : block_accs)
+						acc.add(block_acc);
+					double correspondence_time = watch.restart();
+					if (acc.nr_correspondences < 6) {
+						std::cerr << "ICP::reg_icp_accelerated: too few correspondences\n";
+						return;
+					}
+					// solve for the incremental transformation
+					Mat rotation_update_mat;
+					Dir translation_update_vec;
+					double n = double(acc.nr_correspondences);
+					if (point_to_plane) {
+						for (int i = 0; i < 6; ++i)
+							for (int j = 0; j < i; ++j)
+								acc.ATA[i][j] = acc.ATA[j][i];
+						double x[6];
+						if (!solve_6x6(acc.ATA, acc.ATb, x))
+							break;
+						// exact rotation from the linearized angles around x, y and z
+						double ca = cos(x[0]), sa = sin(x[0]), cb = cos(x[1]), sb = sin(x[1]), cg = cos(x[2]), sg = sin(x[2]);
+						rotation_update_mat(0, 0) = Crd(cg * cb); rotation_update_mat(0, 1) = Crd(cg * sb * sa - sg * ca); rotation_update_mat(0, 2) = Crd(cg * sb * ca + sg * sa);
+						rotation_update_mat(1, 0) = Crd(sg * cb); rotation_update_mat(1, 1) = Crd(sg * sb * sa + cg * ca); rotation_update_mat(1, 2) = Crd(sg * sb * ca - cg * sa);
+						rotation_update_mat(2, 0) = Crd(-sb);     rotation_update_mat(2, 1) = Crd(cb * sa);                rotation_update_mat(2, 2) = Crd(cb * ca);
+						translation_update_vec = Dir(Crd(x[3]), Crd(x[4]), Crd(x[5]));
+					}
+					else {
+						Pnt source_center(Crd(acc.sum_p[0] / n), Crd(acc.sum_p[1] / n), Crd(acc.sum_p[2] / n));
+						Pnt target_center(Crd(acc.sum_q[0] / n), Crd(acc.sum_q[1] / n), Crd(acc.sum_q[2] / n));
+						Mat fA;
+						for (int i = 0; i < 3; ++i)
+							for (int j = 0; j < 3; ++j)
+								fA(i, j) = Crd(acc.sum_qp[i][j] - n * target_center[i] * source_center[j]);
+						cgv::math::mat<float> A(3, 3, &fA(0, 0)), U, V;
+						cgv::math::diag_mat<float> Sigma;
+						cgv::math::svd(A, U, Sigma, V, false);
+						Mat fU(3, 3, &U(0, 0)), fV(3, 3, &V(0, 0)), m;
+						m.identity();
+						m(2, 2) = cgv::math::det(fU * cgv::math::transpose(fV));
+						rotation_update_mat = fU * m * cgv::math::transpose(fV);
+						translation_update_vec = target_center - rotation_update_mat * source_center;
+					}
+					rotation_mat = rotation_update_mat * rotation_mat;
+					translation_vec = rotation_update_mat * translation_vec + translation_update_vec;
+					double solve_time = watch.restart();
+
+					float rms = float(sqrt(acc.sqr_error / n));
+					if (infos)
+						infos->push_back({ level, iter, nr_samples, acc.nr_correspondences, rms, correspondence_time, solve_time });
+					if (report_timing)
+						std::cout << "ICP level " << level << " iteration " << iter << ": " << acc.nr_correspondences << "/" << nr_samples
+						          << " correspondences, rms " << rms << ", search " << 1000 * correspondence_time << "ms, solve " << 1000 * solve_time << "ms" << std::endl;
+
+					// early termination on small updates or stagnating error
+					Crd trace = rotation_update_mat(0, 0) + rotation_update_mat(1, 1) + rotation_update_mat(2, 2);
+					Crd angle = acos(std::max(Crd(-1), std::min(Crd(1), (trace - 1) / 2)));
+					if ((angle < convergence_rotation_eps && translation_update_vec.length() < convergence_translation_eps) ||
+						std::abs(last_rms - rms) <= eps)
+						break;
+					last_rms = rms;
+				}
+			}
+		}
+
 		void ICP::get_center_point(const point_cloud& input, Pnt& center_point) {
 			center_point.zeros();
 			for (unsigned int i = 0; i < input.get_nr_points(); i++)
@@ -3,6 +3,7 @@
 #include <vector>
 #include "point_cloud.h"
 #include "ann_tree.h"
+#include "point_kd_tree.h"
 #include <random>
 #include <ctime>
 #include <cgv/math/svd.h> 
@@ -29,6 +30,37 @@ namespace cgv {
 			point_cloud* crspd_source;
 			point_cloud* crspd_target;
 
+			/**@name settings of reg_icp_accelerated */
+			//@{
+			/// minimize point to plane distances with the normals of the target cloud instead of point to point distances
+			bool use_point_to_plane;
+			/// number of source samples per level of the coarse-to-fine schedule; empty schedule uses numRandomSamples on a single level, 0 denotes all points
+			std::vector<int> subsampling_schedule;
+			/// correspondences with a larger distance are rejected, 0 disables rejection
+			float max_correspondence_distance;
+			/// a level is converged if the rotation angle update in radians and the translation update length fall below these thresholds
+			float convergence_rotation_eps;
+			float convergence_translation_eps;
+			/// print per-iteration timing to std::cout
+			bool report_timing;
+			/// seed of the random subsets of the source cloud, registrations with equal seed and input yield equal results
+			unsigned random_seed;
+			//@}
+
+			/// statistics of one iteration of reg_icp_accelerated
+			struct iteration_info {
+				int level;
+				int iteration;
+				size_t nr_samples;
+				size_t nr_correspondences;
+				/// root mean square point to point or point to plane distance of the correspondences before the update
+				float rms_error;
+				/// time in seconds spent for the correspondence search
+				double correspondence_time;
+				/// time in seconds spent to reduce and solve the linear system
+				double solve_time;
+			};
+
 			ICP();
 			~ICP();
 
@@ -40,6 +72,12 @@ namespace cgv {
 			void set_num_random(int NR);
 			void set_eps(float e);
 			void reg_icp(Mat& rotation_m, Dir& translation_v);
+			//! high-throughput registration with parallel correspondence search on a thread safe kd-tree
+			/*! Samples of the source cloud are processed in parallel with the shared TaskScheduler. Depending on use_point_to_plane,
+			    each iteration solves the linearized point to plane problem with the target normals or the point to point problem
+				with an SVD. Levels of the subsampling_schedule are processed from coarse to fine and a level is left as soon as
+				the update converged. If infos is given, it is filled with one entry per iteration. */
+			void reg_icp_accelerated(Mat& rotation_m, Dir& translation_v, std::vector<iteration_info>* infos = 0);
 			void get_center_point(const point_cloud& input, Pnt& mid_point);
 			float error(Pnt& ps, Pnt& pd, Mat& r, Dir& t);
 			void get_crspd(Mat& rotation_m, Dir& translation_v, point_cloud& pc1, point_cloud& pc2);
@@ -50,6 +88,7 @@ namespace cgv {
 			float dis_pts(const Pnt& source_p, const Pnt& target_p);
 		private:
 			std::shared_ptr<ann_tree> tree;
+			std::shared_ptr<point_kd_tree> kd_tree;
 		};
 	}
 }
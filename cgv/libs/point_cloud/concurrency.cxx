@@ -1,5 +1,7 @@
 #include "concurrency.h"
 
+#include <cassert>
+
 namespace cgv {
 namespace pointcloud {
 namespace utility {
@@ -73,6 +75,158 @@ namespace utility {
 		}
 	}
 
+	namespace {
+		// identifies the scheduler and queue of pool threads
+		thread_local const TaskScheduler* current_scheduler = nullptr;
+		thread_local int current_queue_index = -1;
+	}
+
+	TaskScheduler::TaskScheduler(unsigned num_workers)
+	{
+		for (unsigned i = 0; i <= num_workers; ++i)
+			queues.push_back(std::make_unique<TaskQueue>());
+		for (unsigned i = 0; i < num_workers; ++i)
+			threads.emplace_back(&TaskScheduler::worker_kernel, this, (int)i);
+	}
+
+	TaskScheduler::~TaskScheduler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			stop_request = true;
+		}
+		sleep_condition.notify_all();
+		for (auto& thread : threads)
+			thread.join();
+		threads.clear();
+	}
+
+	int TaskScheduler::own_queue_index() const
+	{
+		if (current_scheduler == this)
+			return current_queue_index;
+		return (int)queues.size() - 1;
+	}
+
+	void TaskScheduler::notify(bool all)
+	{
+		// locking the mutex ensures that a thread evaluating the sleep predicate does not miss the notification
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+		}
+		if (all)
+			sleep_condition.notify_all();
+		else
+			sleep_condition.notify_one();
+	}
+
+	void TaskScheduler::spawn(TaskGroup& group, Task task)
+	{
+		group.pending.fetch_add(1);
+		TaskQueue& queue = *queues[own_queue_index()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mtx);
+			queue.tasks.push_back({ std::move(task), &group });
+		}
+		num_queued.fetch_add(1);
+		notify(false);
+	}
+
+	bool TaskScheduler::try_pop(int queue_index, QueuedTask& queued_task)
+	{
+		if (num_queued.load() == 0)
+			return false;
+		int num_queues = (int)queues.size();
+		// newest task of own queue first to keep working on hot data
+		{
+			TaskQueue& queue = *queues[queue_index];
+			std::lock_guard<std::mutex> lock(queue.mtx);
+			if (!queue.tasks.empty()) {
+				queued_task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+				num_queued.fetch_sub(1);
+				return true;
+			}
+		}
+		// steal oldest task, which usually represents the largest amount of work
+		for (int i = 1; i < num_queues; ++i) {
+			TaskQueue& queue = *queues[(queue_index + i) % num_queues];
+			std::lock_guard<std::mutex> lock(queue.mtx);
+			if (!queue.tasks.empty()) {
+				queued_task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				num_queued.fetch_sub(1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool TaskScheduler::try_execute(int queue_index)
+	{
+		QueuedTask queued_task;
+		if (!try_pop(queue_index, queued_task))
+			return false;
+		// exceptions must not escape a worker and the group has to be completed in any case
+		if (!queued_task.group->failed.load()) {
+			try {
+				queued_task.task();
+			}
+			catch (...) {
+				queued_task.group->set_error(std::current_exception());
+			}
+		}
+		if (queued_task.group->pending.fetch_sub(1) == 1)
+			notify(true);
+		return true;
+	}
+
+	void TaskScheduler::wait(TaskGroup& group)
+	{
+		int queue_index = own_queue_index();
+		while (group.pending.load() > 0) {
+			if (try_execute(queue_index))
+				continue;
+			// remaining tasks of the group are executed by other threads, sleep until something changes
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			sleep_condition.wait(lock, [this, &group]() {
+				return group.pending.load() == 0 || num_queued.load() > 0;
+			});
+		}
+		if (group.failed.load()) {
+			// reset the group such that it can be reused after the exception has been handled
+			std::exception_ptr error;
+			{
+				std::lock_guard<std::mutex> lock(group.error_mtx);
+				std::swap(error, group.error);
+				group.failed = false;
+			}
+			std::rethrow_exception(error);
+		}
+	}
+
+	void TaskScheduler::worker_kernel(int worker_index)
+	{
+		current_scheduler = this;
+		current_queue_index = worker_index;
+		while (true) {
+			if (try_execute(worker_index))
+				continue;
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			sleep_condition.wait(lock, [this]() {
+				return stop_request || num_queued.load() > 0;
+			});
+			if (stop_request && num_queued.load() == 0)
+				return;
+		}
+	}
+
+	TaskScheduler& TaskScheduler::ref_shared()
+	{
+		static TaskScheduler scheduler(std::max(1u, std::thread::hardware_concurrency()) - 1);
+		return scheduler;
+	}
+
 } // namespace utility
 } // namespace pointcloud
 } // namespace cgv
\ No newline at end of file
@@ -6,6 +6,11 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <exception>
 
 #include "lib_begin.h"
 
@@ -133,6 +138,8 @@ class CGV_API SenseReversingBarrier
 		void construct_threads(unsigned i);
 	};
 
+	/// pool of tasks that are processed by all threads calling operator(), where the first exception thrown by a task
+	/// is recorded and stops the processing of further tasks, such that it can be rethrown on the calling thread after run()
 	template <typename TASK>
 	struct TaskPool {
 		std::vector<TASK> pool;
@@ -140,8 +147,12 @@ class CGV_API SenseReversingBarrier
 
 		std::function<void(TASK*)> func;
 
+		std::atomic_bool failed = false;
+		std::mutex error_mtx;
+		std::exception_ptr error;
+
 		void operator()() {
-			while (true) {
+			while (!failed.load()) {
 				TASK* task;
 				//get task
 				{
@@ -150,12 +161,153 @@ class CGV_API SenseReversingBarrier
 						return;
 					task = &pool[task_id];
 				}
-				func(task);
+				try {
+					func(task);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock(error_mtx);
+					if (!error)
+						error = std::current_exception();
+					failed = true;
+				}
 			}
 		}
+		/// rethrow the first exception thrown by a task, only call after all threads returned from operator()
+		void rethrow_error() const {
+			if (error)
+				std::rethrow_exception(error);
+		}
 	};
 
 
+	/// work-stealing task scheduler with one task deque per worker thread
+	/// Tasks are spawned into a TaskGroup and wait() executes pending tasks until the group is completed, such that
+	/// tasks can spawn and wait for nested tasks. Workers without work steal from the other deques and sleep on a
+	/// condition variable if no task is queued at all. Use ref_shared() to share one scheduler between algorithms
+	/// without oversubscribing the cores.
+	class CGV_API TaskScheduler
+	{
+	public:
+		typedef std::function<void()> Task;
+
+		/// counts the unfinished tasks spawned into the group and records the first exception thrown by one of them
+		struct TaskGroup {
+			std::atomic_int pending = 0;
+			std::atomic_bool failed = false;
+			std::mutex error_mtx;
+			std::exception_ptr error;
+			/// store the exception if it is the first one of the group, remaining queued tasks of the group are skipped
+			void set_error(std::exception_ptr e) {
+				std::lock_guard<std::mutex> lock(error_mtx);
+				if (!error)
+					error = e;
+				failed = true;
+			}
+		};
+
+	private:
+		struct QueuedTask {
+			Task task;
+			TaskGroup* group;
+		};
+		struct TaskQueue {
+			std::mutex mtx;
+			std::deque<QueuedTask> tasks;
+		};
+		// one queue per worker, the last queue receives tasks spawned by threads outside of the pool
+		std::vector<std::unique_ptr<TaskQueue>> queues;
+		std::vector<std::thread> threads;
+
+		std::mutex sleep_mutex;
+		std::condition_variable sleep_condition;
+		std::atomic_int num_queued = 0;
+		bool stop_request = false;
+
+		// index of queue owned by the calling thread or the index of the shared queue
+		int own_queue_index() const;
+		// pop a task from the own queue or steal one from another queue
+		bool try_pop(int queue_index, QueuedTask& queued_task);
+		// execute one task if available
+		bool try_execute(int queue_index);
+		// wake up sleeping threads
+		void notify(bool all);
+		void worker_kernel(int worker_index);
+
+		template <typename F>
+		void parallel_for_range(TaskGroup& group, int64_t begin, int64_t end, int64_t grain_size, const F& func);
+
+	public:
+		/// construct scheduler with the given number of worker threads, the threads calling wait() participate in the work
+		TaskScheduler(unsigned num_workers);
+		/// finishes queued tasks and joins all workers
+		~TaskScheduler();
+		/// return number of threads that execute tasks including the calling thread
+		unsigned get_num_threads() const {
+			return (unsigned)threads.size() + 1;
+		}
+		/// enqueue a task into the given group
+		void spawn(TaskGroup& group, Task task);
+		/// execute pending tasks until all tasks of the group are completed and rethrow the first exception thrown by a task of the group
+		void wait(TaskGroup& group);
+		/// call func(first, last) in parallel on subranges of [begin, end) with at most grain_size elements; grain_size <= 0 selects an automatic size
+		template <typename F>
+		void parallel_for(int64_t begin, int64_t end, int64_t grain_size, const F& func);
+		/// call func(thread_id) once for each thread id in [0, get_num_threads()) and wait for completion, compatible to WorkerPool::run
+		template <typename F>
+		void run(F func);
+
+		/// return reference to a scheduler with one worker per hardware thread except the calling thread, which is shared by all algorithms
+		static TaskScheduler& ref_shared();
+	};
+
+	template <typename F>
+	void TaskScheduler::parallel_for_range(TaskGroup& group, int64_t begin, int64_t end, int64_t grain_size, const F& func)
+	{
+		// split off upper halves as tasks that can be stolen and process the remaining part locally
+		while (end - begin > grain_size) {
+			int64_t mid = begin + (end - begin) / 2;
+			spawn(group, [this, &group, mid, end, grain_size, &func]() {
+				parallel_for_range(group, mid, end, grain_size, func);
+			});
+			end = mid;
+		}
+		func(begin, end);
+	}
+
+	template <typename F>
+	void TaskScheduler::parallel_for(int64_t begin, int64_t end, int64_t grain_size, const F& func)
+	{
+		if (end <= begin)
+			return;
+		if (grain_size <= 0)
+			grain_size = std::max<int64_t>(1, (end - begin) / (8 * (int64_t)get_num_threads()));
+		TaskGroup group;
+		// the spawned tasks reference the group, so an exception of the local part is only rethrown by wait
+		try {
+			parallel_for_range(group, begin, end, grain_size, func);
+		}
+		catch (...) {
+			group.set_error(std::current_exception());
+		}
+		wait(group);
+	}
+
+	template <typename F>
+	void TaskScheduler::run(F func)
+	{
+		TaskGroup group;
+		int num_threads = (int)get_num_threads();
+		for (int thread_id = 1; thread_id < num_threads; ++thread_id)
+			spawn(group, [&func, thread_id]() { func(thread_id); });
+		try {
+			func(0);
+		}
+		catch (...) {
+			group.set_error(std::current_exception());
+		}
+		wait(group);
+	}
+
 	// template definitions
 	template <typename F>
 	void WorkerPool::run(F func)
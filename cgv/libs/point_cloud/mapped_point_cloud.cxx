@@ -0,0 +1,214 @@
+#include "mapped_point_cloud.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#pragma warning(disable:4996)
+
+mapped_point_cloud::mapped_point_cloud() : header(0)
+{
+}
+
+mapped_point_cloud::mapped_point_cloud(const std::string& file_name) : header(0)
+{
+	open(file_name);
+}
+
+bool mapped_point_cloud::open(const std::string& file_name)
+{
+	close();
+	if (!file.open(file_name))
+		return false;
+	if (file.get_size() < sizeof(mpc_header)) {
+		std::cerr << "mapped_point_cloud::open(" << file_name << "): file too small" << std::endl;
+		file.close();
+		return false;
+	}
+	const mpc_header* h = file.get_pointer<mpc_header>(0);
+	if (h->magic != MPC_MAGIC || h->version > MPC_VERSION || h->header_size < sizeof(mpc_header) || h->alignment == 0) {
+		std::cerr << "mapped_point_cloud::open(" << file_name << "): invalid header or unsupported version" << std::endl;
+		file.close();
+		return false;
+	}
+	// validate that all sections lie inside of the file and hold one element per point or component
+	for (unsigned si = 0; si < MPC_NR_SECTION_TYPES; ++si) {
+		const mpc_section& s = h->sections[si];
+		if (s.count == 0)
+			continue;
+		if (s.offset > file.get_size() || s.size > file.get_size() - s.offset || s.offset % h->alignment != 0 ||
+			s.element_size == 0 || s.count > s.size / s.element_size) {
+			std::cerr << "mapped_point_cloud::open(" << file_name << "): section " << si << " out of file bounds" << std::endl;
+			file.close();
+			return false;
+		}
+		if (s.count != (si == MPC_COMPONENTS ? h->nr_components : h->nr_points)) {
+			std::cerr << "mapped_point_cloud::open(" << file_name << "): section " << si << " has wrong number of elements" << std::endl;
+			file.close();
+			return false;
+		}
+	}
+	// validate point ranges and name ranges of components
+	if (h->nr_components > 0) {
+		const mpc_section& s = h->sections[MPC_COMPONENTS];
+		if (s.count == 0 || s.element_size != sizeof(mpc_component_entry)) {
+			std::cerr << "mapped_point_cloud::open(" << file_name << "): missing component table" << std::endl;
+			file.close();
+			return false;
+		}
+		const mpc_component_entry* E = file.get_pointer<mpc_component_entry>(size_t(s.offset));
+		for (cgv::type::uint64_type ci = 0; ci < s.count; ++ci) {
+			if (E[ci].index_of_first_point > h->nr_points || E[ci].nr_points > h->nr_points - E[ci].index_of_first_point ||
+				E[ci].name_offset > s.size || E[ci].name_length > s.size - E[ci].name_offset) {
+				std::cerr << "mapped_point_cloud::open(" << file_name << "): component " << ci << " out of bounds" << std::endl;
+				file.close();
+				return false;
+			}
+		}
+	}
+	header = h;
+	return true;
+}
+
+void mapped_point_cloud::close()
+{
+	header = 0;
+	file.close();
+}
+
+const mpc_section* mapped_point_cloud::get_section(MPCSectionType st) const
+{
+	if (!header || st >= MPC_NR_SECTION_TYPES)
+		return 0;
+	const mpc_section& s = header->sections[st];
+	return s.count > 0 ? &s : 0;
+}
+
+const void* mapped_point_cloud::get_section_data(MPCSectionType st) const
+{
+	const mpc_section* s = get_section(st);
+	return s ? file.get_data() + s->offset : 0;
+}
+
+void mapped_point_cloud::advise(MPCSectionType st, cgv::utils::mapped_file::AccessHint hint) const
+{
+	const mpc_section* s = get_section(st);
+	if (s)
+		file.advise(hint, size_t(s->offset), size_t(s->size));
+}
+
+void mapped_point_cloud::prefetch(MPCSectionType st, size_t first_point, size_t nr_points) const
+{
+	const mpc_section* s = get_section(st);
+	if (!s || st == MPC_COMPONENTS || first_point >= s->count)
+		return;
+	if (nr_points > s->count - first_point)
+		nr_points = size_t(s->count - first_point);
+	file.prefetch(size_t(s->offset + first_point * s->element_size), nr_points * s->element_size);
+}
+
+point_cloud_types::component_info mapped_point_cloud::get_component(size_t ci) const
+{
+	const mpc_component_entry* E = get_component_entries();
+	component_info info(size_t(E[ci].index_of_first_point), size_t(E[ci].nr_points));
+	const char* section_begin = static_cast<const char*>(get_section_data(MPC_COMPONENTS));
+	info.name = std::string(section_begin + E[ci].name_offset, size_t(E[ci].name_length));
+	return info;
+}
+
+namespace {
+	/// helper to write zero bytes up to the next multiple of the alignment
+	bool pad_to(FILE* fp, cgv::type::uint64_type& pos, cgv::type::uint64_type alignment)
+	{
+		static const char zeros[4096] = { 0 };
+		cgv::type::uint64_type n = (alignment - pos % alignment) % alignment;
+		pos += n;
+		while (n > 0) {
+			size_t m = size_t(n < sizeof(zeros) ? n : sizeof(zeros));
+			if (fwrite(zeros, 1, m, fp) != m)
+				return false;
+			n -= m;
+		}
+		return true;
+	}
+	/// fill in section descriptor and advance offset to the aligned end of the section
+	void layout_section(mpc_section& s, cgv::type::uint64_type& offset, cgv::type::uint32_type element_size, cgv::type::uint64_type count, cgv::type::uint64_type size)
+	{
+		s.element_size = element_size;
+		s.flags = 0;
+		s.count = count;
+		s.size = size;
+		s.offset = count > 0 ? offset : 0;
+		offset += size;
+		offset += (MPC_SECTION_ALIGNMENT - offset % MPC_SECTION_ALIGNMENT) % MPC_SECTION_ALIGNMENT;
+	}
+}
+
+bool mapped_point_cloud::write(const std::string& file_name, size_t nr_points, const Pnt* P, const Nml* N, const Clr* C,
+	const uint8_t* lods, const cgv::type::int32_type* labels, const std::vector<component_info>& components)
+{
+	typedef cgv::type::uint64_type uint64;
+	// build component table with trailing names
+	std::vector<char> component_table;
+	if (!components.empty()) {
+		std::vector<mpc_component_entry> entries(components.size());
+		uint64 name_offset = components.size() * sizeof(mpc_component_entry);
+		for (size_t ci = 0; ci < components.size(); ++ci) {
+			entries[ci].index_of_first_point = components[ci].index_of_first_point;
+			entries[ci].nr_points = components[ci].nr_points;
+			entries[ci].name_offset = name_offset;
+			entries[ci].name_length = components[ci].name.size();
+			name_offset += components[ci].name.size();
+		}
+		component_table.resize(size_t(name_offset));
+		std::memcpy(&component_table[0], &entries[0], entries.size() * sizeof(mpc_component_entry));
+		for (size_t ci = 0; ci < components.size(); ++ci)
+			if (!components[ci].name.empty())
+				std::memcpy(&component_table[size_t(entries[ci].name_offset)], components[ci].name.data(), components[ci].name.size());
+	}
+	// layout header and sections
+	mpc_header h;
+	std::memset(&h, 0, sizeof(mpc_header));
+	h.magic = MPC_MAGIC;
+	h.version = MPC_VERSION;
+	h.header_size = sizeof(mpc_header);
+	h.alignment = MPC_SECTION_ALIGNMENT;
+	h.nr_points = nr_points;
+	h.nr_components = components.size();
+	uint64 offset = MPC_SECTION_ALIGNMENT;
+	uint64 n = P ? nr_points : 0;
+	layout_section(h.sections[MPC_POSITIONS], offset, sizeof(Pnt), n, n * sizeof(Pnt));
+	n = N ? nr_points : 0;
+	layout_section(h.sections[MPC_NORMALS], offset, sizeof(Nml), n, n * sizeof(Nml));
+	n = C ? nr_points : 0;
+	layout_section(h.sections[MPC_COLORS], offset, sizeof(Clr), n, n * sizeof(Clr));
+	n = lods ? nr_points : 0;
+	layout_section(h.sections[MPC_LODS], offset, sizeof(uint8_t), n, n * sizeof(uint8_t));
+	n = labels ? nr_points : 0;
+	layout_section(h.sections[MPC_LABELS], offset, sizeof(cgv::type::int32_type), n, n * sizeof(cgv::type::int32_type));
+	layout_section(h.sections[MPC_COMPONENTS], offset, sizeof(mpc_component_entry), components.size(), component_table.size());
+
+	// write header and sections in order of increasing offset
+	FILE* fp = fopen(file_name.c_str(), "wb");
+	if (!fp)
+		return false;
+	uint64 pos = sizeof(mpc_header);
+	bool success = fwrite(&h, sizeof(mpc_header), 1, fp) == 1;
+	const void* section_data[MPC_NR_SECTION_TYPES] = { P, N, C, lods, labels, component_table.empty() ? 0 : &component_table[0] };
+	for (unsigned si = 0; success && si < MPC_NR_SECTION_TYPES; ++si) {
+		const mpc_section& s = h.sections[si];
+		if (s.count == 0)
+			continue;
+		success = pad_to(fp, pos, MPC_SECTION_ALIGNMENT);
+		// write in blocks to stay below the size_t limits of 32 bit fwrite implementations
+		const char* data = static_cast<const char*>(section_data[si]);
+		uint64 remaining = s.size;
+		while (success && remaining > 0) {
+			size_t m = size_t(remaining < (uint64(1) << 30) ? remaining : (uint64(1) << 30));
+			success = fwrite(data, 1, m, fp) == m;
+			data += m;
+			remaining -= m;
+		}
+		pos += s.size;
+	}
+	return fclose(fp) == 0 && success;
+}
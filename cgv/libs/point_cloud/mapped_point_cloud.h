@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cgv/utils/mapped_file.h>
+#include "point_cloud.h"
+
+#include "lib_begin.h"
+
+/**@name mapped point cloud format (*.mpc) */
+//@{
+/// identifiers of the independently addressable sections of a mapped point cloud file
+enum MPCSectionType
+{
+	MPC_POSITIONS,
+	MPC_NORMALS,
+	MPC_COLORS,
+	MPC_LODS,
+	MPC_LABELS,
+	MPC_COMPONENTS,
+	MPC_NR_SECTION_TYPES
+};
+
+/// magic number "MPC\0" at the beginning of each mapped point cloud file
+const cgv::type::uint32_type MPC_MAGIC = 0x0043504D;
+/// current version of the mapped point cloud format
+const cgv::type::uint32_type MPC_VERSION = 1;
+/// alignment of the sections in bytes, chosen as multiple of common page sizes such that sections never share a page
+const cgv::type::uint32_type MPC_SECTION_ALIGNMENT = 65536;
+
+/// description of one section, an empty section has count zero
+struct mpc_section
+{
+	/// size of one element in bytes
+	cgv::type::uint32_type element_size;
+	/// reserved for per section flags
+	cgv::type::uint32_type flags;
+	/// byte offset of the section from the beginning of the file, multiple of the header alignment
+	cgv::type::uint64_type offset;
+	/// number of elements
+	cgv::type::uint64_type count;
+	/// size in bytes of the section data
+	cgv::type::uint64_type size;
+};
+
+/// fixed size header at the beginning of each mapped point cloud file
+struct mpc_header
+{
+	cgv::type::uint32_type magic;
+	cgv::type::uint32_type version;
+	cgv::type::uint32_type header_size;
+	cgv::type::uint32_type alignment;
+	cgv::type::uint64_type nr_points;
+	cgv::type::uint64_type nr_components;
+	mpc_section sections[MPC_NR_SECTION_TYPES];
+};
+
+/// entry of the component table; names are stored after the table in the same section with offsets relative to the section begin
+struct mpc_component_entry
+{
+	cgv::type::uint64_type index_of_first_point;
+	cgv::type::uint64_type nr_points;
+	cgv::type::uint64_type name_offset;
+	cgv::type::uint64_type name_length;
+};
+//@}
+
+/** read-only view onto a point cloud stored in the mapped point cloud format (*.mpc).
+
+	Opening a file only maps it and validates the header, such that opening returns
+	immediately independent of the number of points. Attribute arrays are accessed
+	directly in the mapping and paged in by the operating system on first access.
+	As sections are aligned to MPC_SECTION_ALIGNMENT, tools that only touch positions
+	never load pages of normals, colors or other attributes. Files are written with
+	point_cloud::write(*.mpc) or write_mpc(). */
+class CGV_API mapped_point_cloud : public point_cloud_types
+{
+protected:
+	cgv::utils::mapped_file file;
+	const mpc_header* header;
+	/// return typed pointer to section or null if section is empty or element size does not match
+	template <typename T>
+	const T* get_section_pointer(MPCSectionType st) const {
+		const mpc_section* s = get_section(st);
+		if (!s || s->element_size != sizeof(T))
+			return 0;
+		return file.get_pointer<T>(size_t(s->offset));
+	}
+public:
+	/// construct without file
+	mapped_point_cloud();
+	/// construct and open file
+	mapped_point_cloud(const std::string& file_name);
+	/// map file and validate header, section table and component table, such that all accessors stay inside of the mapping
+	bool open(const std::string& file_name);
+	/// unmap file
+	void close();
+	/// check whether a file is mapped
+	bool is_open() const { return header != 0; }
+	/// return the number of points
+	size_t get_nr_points() const { return header ? size_t(header->nr_points) : 0; }
+	/// return the number of components
+	size_t get_nr_components() const { return header ? size_t(header->nr_components) : 0; }
+	/// return section descriptor or null if section is not present
+	const mpc_section* get_section(MPCSectionType st) const;
+	/// return pointer to the raw bytes of a section or null if section is not present
+	const void* get_section_data(MPCSectionType st) const;
+	/// give the operating system a hint how a section will be accessed
+	void advise(MPCSectionType st, cgv::utils::mapped_file::AccessHint hint) const;
+	/// ask the operating system to prefetch the pages of the given point range in the given section
+	void prefetch(MPCSectionType st, size_t first_point = 0, size_t nr_points = size_t(-1)) const;
+
+	/**@name typed access to sections, null if not present */
+	//@{
+	const Pnt* get_positions() const { return get_section_pointer<Pnt>(MPC_POSITIONS); }
+	const Nml* get_normals() const { return get_section_pointer<Nml>(MPC_NORMALS); }
+	/// return colors in the color type of point_cloud; null if stored in a different color representation
+	const Clr* get_colors() const { return get_section_pointer<Clr>(MPC_COLORS); }
+	const uint8_t* get_lods() const { return get_section_pointer<uint8_t>(MPC_LODS); }
+	const cgv::type::int32_type* get_labels() const { return get_section_pointer<cgv::type::int32_type>(MPC_LABELS); }
+	const mpc_component_entry* get_component_entries() const { return get_section_pointer<mpc_component_entry>(MPC_COMPONENTS); }
+	/// return the information of the ci-th component including its name
+	component_info get_component(size_t ci) const;
+	//@}
+
+	/// return i-th point
+	const Pnt& pnt(size_t i) const { return get_positions()[i]; }
+
+	/// write the given sections in mpc format, empty pointers and zero counts denote absent sections
+	static bool write(const std::string& file_name, size_t nr_points, const Pnt* P, const Nml* N, const Clr* C,
+		const uint8_t* lods, const cgv::type::int32_type* labels, const std::vector<component_info>& components);
+};
+
+#include <cgv/config/lib_end.h>
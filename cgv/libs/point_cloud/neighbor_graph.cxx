@@ -1,4 +1,5 @@
 #include "neighbor_graph.h"
+#include "point_kd_tree.h"
 #include <cgv/utils/progression.h>
 #include <algorithm>
 
@@ -12,6 +13,17 @@ void neighbor_graph::clear()
 	nr_half_edges = 0;
 }
 
+void neighbor_graph::build_parallel(Cnt n, Cnt k, const point_kd_tree& knn, cgv::pointcloud::utility::TaskScheduler& scheduler)
+{
+	clear();
+	resize(n);
+	scheduler.parallel_for(0, n, 4096, [this, k, &knn](int64_t begin, int64_t end) {
+		for (Idx i = (Idx)begin; i < (Idx)end; ++i)
+			knn.extract_neighbors(i, k, at(i));
+	});
+	nr_half_edges = n * k;
+}
+
 int neighbor_graph::find(Idx vi, Idx vj) const
 {
 	const vector<Idx>& Ni = at(vi);
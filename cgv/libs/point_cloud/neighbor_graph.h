@@ -4,9 +4,12 @@
 #include <iostream>
 #include <cgv/utils/statistics.h>
 #include <cgv/type/standard_types.h>
+#include "concurrency.h"
 
 #include "lib_begin.h"
 
+class point_kd_tree;
+
 /// struct representing a directed half-edge in a knn graph
 struct graph_location
 {
@@ -84,6 +87,9 @@ struct CGV_API neighbor_graph : public std::vector<std::vector<graph_location::I
 			nr_half_edges += k;
 		}
 	}
+	/// parallel variant of build that queries batches of points on the given scheduler; restricted to point_kd_tree, whose queries
+	/// are thread safe, as ann_tree relies on global state of the ANN library
+	void build_parallel(Cnt n, Cnt k, const point_kd_tree& knn, cgv::pointcloud::utility::TaskScheduler& scheduler = cgv::pointcloud::utility::TaskScheduler::ref_shared());
 	/// ensure the neighbor graph to be symmetric
 	void symmetrize();
 	//@}
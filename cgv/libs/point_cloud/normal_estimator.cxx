@@ -1,4 +1,5 @@
 #include "normal_estimator.h"
+#include "concurrency.h"
 #include <cgv/math/normal_estimation.h>
 #include <cmath>
 #include <cgv/math/functions.h>
@@ -138,16 +139,19 @@ void normal_estimator::compute_weighted_normals(bool reorient)
 		pc.create_normals();
 		reorient = false;
 	}
-	std::vector<Crd> weights;
-	std::vector<Pnt> points;
-	for (Idx vi = 0; vi < (Idx)pc.get_nr_points(); ++vi) {
-		compute_weights(vi, weights, &points);
-		Nml new_nml;
-		cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], new_nml);
-		if (reorient && (dot(new_nml,pc.nml(vi)) < 0))
-			new_nml = -new_nml;
-		pc.nml(vi) = new_nml;
-	}
+	// each point only writes its own normal, so that points can be processed in parallel
+	cgv::pointcloud::utility::TaskScheduler::ref_shared().parallel_for(0, pc.get_nr_points(), 1024, [this, reorient](int64_t begin, int64_t end) {
+		std::vector<Crd> weights;
+		std::vector<Pnt> points;
+		for (Idx vi = (Idx)begin; vi < (Idx)end; ++vi) {
+			compute_weights(vi, weights, &points);
+			Nml new_nml;
+			cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], new_nml);
+			if (reorient && (dot(new_nml, pc.nml(vi)) < 0))
+				new_nml = -new_nml;
+			pc.nml(vi) = new_nml;
+		}
+	});
 }
 
 /// recompute normals from neighbor graph and distance and normal weights
@@ -185,9 +189,6 @@ void normal_estimator::compute_bilateral_weighted_normals(bool reorient)
 	if (!pc.has_normals())
 		compute_weighted_normals(reorient);
 
-	std::vector<Crd> weights;
-	std::vector<Pnt> points;
-
 	// copy current normals
 	std::vector<Nml> NS;
 	NS.resize(pc.get_nr_points());
@@ -195,14 +196,18 @@ void normal_estimator::compute_bilateral_weighted_normals(bool reorient)
 	for (i = 0; i < n; ++i)
 		NS[i] = pc.nml(i);
 
-	for (Idx vi = 0; vi < (Idx)pc.get_nr_points(); ++vi) {
+	cgv::pointcloud::utility::TaskScheduler::ref_shared().parallel_for(0, n, 1024, [this, reorient, &NS](int64_t begin, int64_t end) {
+		std::vector<Crd> weights;
+		std::vector<Pnt> points;
+		for (Idx vi = (Idx)begin; vi < (Idx)end; ++vi) {
 
-		compute_bilateral_weights(vi, weights, &points);
+			compute_bilateral_weights(vi, weights, &points);
 
-		cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], NS[vi]);
-		if (reorient && (dot(NS[vi],pc.nml(vi)) < 0))
-			NS[vi] = -NS[vi];
-	}
+			cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], NS[vi]);
+			if (reorient && (dot(NS[vi], pc.nml(vi)) < 0))
+				NS[vi] = -NS[vi];
+		}
+	});
 	for (i = 0; i < n; ++i)
 		pc.nml(i) = NS[i];
 }
@@ -213,9 +218,6 @@ void normal_estimator::compute_plane_bilateral_weighted_normals(bool reorient)
 	if (!pc.has_normals())
 		compute_weighted_normals(reorient);
 
-	std::vector<Crd> weights;
-	std::vector<Pnt> points;
-
 	// copy current normals
 	std::vector<Nml> NS;
 	NS.resize(pc.get_nr_points());
@@ -223,33 +225,36 @@ void normal_estimator::compute_plane_bilateral_weighted_normals(bool reorient)
 	for (i = 0; i < n; ++i)
 		NS[i] = pc.nml(i);
 
-	for (Idx vi = 0; vi < (Idx)pc.get_nr_points(); ++vi) {
-		const Pnt& pi = pc.pnt(vi);
-		const Nml& nml_i = pc.nml(vi);
-		const std::vector<Idx> &Ni = ng.at(vi);
-		unsigned ni = (unsigned) Ni.size();
-		weights.resize(ni+1);
-		points.resize(ni+1);
-		weights[0] = 1;
-		points[0] = pi;
-		Crd l0 = estimate_scale(vi);
-		Crd l0_sqr = l0*l0;
-		Crd err0_sqr = l0_sqr*noise_to_sampling_ratio*noise_to_sampling_ratio;
-		for (unsigned j=0; j < ni; ++j) {
-			Idx vj = Ni[j];
-			Dir dij = pc.pnt(vj)-pc.pnt(vi);
-			Crd lij_sqr = sqr_length(dij);
-			Crd w_x = exp(-lij_sqr/l0_sqr);
-			Crd errij = dot(pc.nml(vj),dij)*dot(pc.nml(vj),dij);
-			Crd w_n = exp(-errij/err0_sqr);
-			Crd w   = w_x*w_n;
-			weights[j+1] = w;
-			points[j+1] = pc.pnt(vj);
+	cgv::pointcloud::utility::TaskScheduler::ref_shared().parallel_for(0, n, 1024, [this, reorient, &NS](int64_t begin, int64_t end) {
+		std::vector<Crd> weights;
+		std::vector<Pnt> points;
+		for (Idx vi = (Idx)begin; vi < (Idx)end; ++vi) {
+			const Pnt& pi = pc.pnt(vi);
+			const std::vector<Idx> &Ni = ng.at(vi);
+			unsigned ni = (unsigned) Ni.size();
+			weights.resize(ni+1);
+			points.resize(ni+1);
+			weights[0] = 1;
+			points[0] = pi;
+			Crd l0 = estimate_scale(vi);
+			Crd l0_sqr = l0*l0;
+			Crd err0_sqr = l0_sqr*noise_to_sampling_ratio*noise_to_sampling_ratio;
+			for (unsigned j=0; j < ni; ++j) {
+				Idx vj = Ni[j];
+				Dir dij = pc.pnt(vj)-pc.pnt(vi);
+				Crd lij_sqr = sqr_length(dij);
+				Crd w_x = exp(-lij_sqr/l0_sqr);
+				Crd errij = dot(pc.nml(vj),dij)*dot(pc.nml(vj),dij);
+				Crd w_n = exp(-errij/err0_sqr);
+				Crd w   = w_x*w_n;
+				weights[j+1] = w;
+				points[j+1] = pc.pnt(vj);
+			}
+			cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], NS[vi]);
+			if (reorient && (dot(NS[vi],pc.nml(vi)) < 0))
+				NS[vi] = -NS[vi];
 		}
-		cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], NS[vi]);
-		if (reorient && (dot(NS[vi],pc.nml(vi)) < 0))
-			NS[vi] = -NS[vi];
-	}
+	});
 	for (i = 0; i < n; ++i)
 		pc.nml(i) = NS[i];
 }
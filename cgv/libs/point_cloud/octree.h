@@ -15,8 +15,14 @@
 #include <chrono>
 #include <unordered_map>
 #include <sstream>
+#include <fstream>
 #include <exception>
 #include <typeinfo>
+#include <cstdio>
+#include <iostream>
+
+#include <cgv/utils/file.h>
+#include <cgv/utils/mapped_file.h>
 
 #include "concurrency.h"
 #include "morton.h"
@@ -138,8 +144,101 @@ namespace pointcloud {
 		}
 	};
 
+	/// temporary file holding the chunks of the out-of-core mode of the octree_lod_generator
+	/// the counting phase determines the number of points per chunk, such that each chunk owns a contiguous region of the file.
+	/// The file stays open and is accessed with positioned reads and writes through a std::fstream, whose 64 bit stream
+	/// offsets are portable in contrast to the platform specific large file seek functions.
+	template <typename point_t>
+	struct ChunkSpillFile {
+		std::string file_name;
+		std::fstream fs;
+		std::mutex mtx;
+
+		/// create a spill file in the given directory with a name that is unique among concurrently running processes
+		ChunkSpillFile(const std::string& directory) {
+			static std::atomic_int instance_count = 0;
+			std::random_device rd;
+			for (int attempt = 0; attempt < 16 && !fs.is_open(); ++attempt) {
+				std::stringstream ss;
+				ss << directory << "/lod_chunks_" << std::hex << rd() << rd() << "_" << std::dec << instance_count.fetch_add(1) << ".bin";
+				if (cgv::utils::file::exists(ss.str()))
+					continue;
+				file_name = ss.str();
+				fs.open(file_name, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+			}
+			if (!fs.is_open())
+				throw std::runtime_error("unable to create chunk file in " + directory);
+		}
+		~ChunkSpillFile() {
+			fs.close();
+			cgv::utils::file::remove(file_name);
+		}
+		//write points to the given position in a thread safe way
+		void write_points(int64_t point_index, const point_t* points, size_t size) {
+			std::lock_guard<std::mutex> lock(mtx);
+			fs.seekp(std::streamoff(point_index) * std::streamoff(sizeof(point_t)));
+			fs.write(reinterpret_cast<const char*>(points), std::streamsize(size * sizeof(point_t)));
+			if (!fs) {
+				fs.clear();
+				throw std::runtime_error("unable to write chunk file " + file_name);
+			}
+		}
+		//read points from the given position in a thread safe way
+		void read_points(int64_t point_index, point_t* points, size_t size) {
+			std::lock_guard<std::mutex> lock(mtx);
+			fs.seekg(std::streamoff(point_index) * std::streamoff(sizeof(point_t)));
+			fs.read(reinterpret_cast<char*>(points), std::streamsize(size * sizeof(point_t)));
+			if (!fs || fs.gcount() != std::streamsize(size * sizeof(point_t))) {
+				fs.clear();
+				throw std::runtime_error("unable to read chunk file " + file_name);
+			}
+		}
+	};
+
+	/// chunk data stored in a region of a ChunkSpillFile, writes are collected in a small buffer that is written whenever it is full
+	template <typename point_t>
+	struct ChunkPointFile {
+		std::shared_ptr<ChunkSpillFile<point_t>> file;
+		int64_t first_point;
+		int64_t capacity;
+		std::mutex mtx;
+		std::vector<point_t> buffer;
+		int64_t numPointsWritten = 0;
+		static constexpr size_t buffer_capacity = (256 * 1024) / sizeof(point_t) + 1;
+
+		ChunkPointFile(std::shared_ptr<ChunkSpillFile<point_t>> file, int64_t first_point, int64_t capacity) : file(file), first_point(first_point), capacity(capacity) {
+		}
+		//write points in a thread safe way
+		void write_points(const point_t* points, const int size) {
+			std::lock_guard<std::mutex> lock(mtx);
+			if (numPointsWritten + (int64_t)buffer.size() + size > capacity)
+				throw std::runtime_error("chunk exceeds the number of points determined by the counting phase");
+			buffer.insert(buffer.end(), points, points + size);
+			if (buffer.size() >= buffer_capacity)
+				flush();
+		}
+		// write buffered points behind the already written ones, the caller has to hold the lock
+		void flush() {
+			if (buffer.empty())
+				return;
+			file->write_points(first_point + numPointsWritten, buffer.data(), buffer.size());
+			numPointsWritten += buffer.size();
+			buffer.clear();
+		}
+		// read all points of the chunk into memory
+		std::shared_ptr<std::vector<point_t>> load() {
+			std::lock_guard<std::mutex> lock(mtx);
+			flush();
+			auto points = std::make_shared<std::vector<point_t>>(numPointsWritten);
+			if (numPointsWritten > 0)
+				file->read_points(first_point, points->data(), numPointsWritten);
+			return points;
+		}
+	};
+
 	/// stores chunk date created by the chunking phase
 	/// like the node struct in PotreeConverter/Converter/src/chunker_countsort_laszip.cpp except data is stored in the pc_data member instead of a file
+	/// in out-of-core mode, file_data is used instead of pc_data and the data is kept in a temporary file like in the PotreeConverter
 	template <typename point_t>
 	struct ChunkNode {
 		int level = 0;
@@ -150,6 +249,8 @@ namespace pointcloud {
 		int numPoints;
 		//point cloud data
 		std::shared_ptr<ChunkPointCloud<point_t>> pc_data;
+		//point cloud data of out-of-core mode
+		std::shared_ptr<ChunkPointFile<point_t>> file_data;
 		std::string id;
 
 		ChunkNode(std::string node_id, int numPoints) {
@@ -157,7 +258,28 @@ namespace pointcloud {
 			this->id = node_id;
 			this->pc_data = std::make_shared<ChunkPointCloud<point_t>>(numPoints);
 		}
+		// construct chunk whose points are spilled to the region of the spill file starting at first_point
+		ChunkNode(std::string node_id, int numPoints, std::shared_ptr<ChunkSpillFile<point_t>> spill_file, int64_t first_point) {
+			this->numPoints = numPoints;
+			this->id = node_id;
+			this->file_data = std::make_shared<ChunkPointFile<point_t>>(spill_file, first_point, numPoints);
+		}
 
+		//write points in a thread safe way
+		void write_points(const point_t* points, const int size) const {
+			if (file_data)
+				file_data->write_points(points, size);
+			else
+				pc_data->write_points(points, size);
+		}
+		// return points of chunk, in out-of-core mode these are read from the spill file
+		std::shared_ptr<std::vector<point_t>> load_points() {
+			if (!file_data)
+				return std::shared_ptr<std::vector<point_t>>(pc_data, &(pc_data->vertices));
+			auto points = file_data->load();
+			file_data = nullptr;
+			return points;
+		}
 	};
 	// Define an ensemble of chunks including many chunk info and min and max extents
 	template <typename point_t>
@@ -175,6 +297,105 @@ namespace pointcloud {
 		virtual void sample(std::shared_ptr<IndexNode<point_t>> node, double baseSpacing, std::function<void(IndexNode<point_t>*)> callbackNodeCompleted) = 0;
 	};
 
+	/// header of the octree files written by the out-of-core mode, the node table is stored at hierarchy_offset after the point data
+	struct OctreeFileHeader {
+		uint32_t magic = 0x4644434C; // "LCDF"
+		uint32_t version = 1;
+		uint32_t point_size = 0;
+		uint32_t reserved = 0;
+		int64_t num_nodes = 0;
+		int64_t num_points = 0;
+		int64_t hierarchy_offset = 0;
+	};
+
+	/// entry of the node table of an octree file, the points of a node are stored contiguously at offset
+	struct OctreeFileNode {
+		std::string name;
+		cgv::vec3 min;
+		cgv::vec3 max;
+		int64_t offset = 0;
+		int64_t num_points = 0;
+		int64_t level() const {
+			return name.size() - 1;
+		}
+	};
+
+	/// provides node by node access to the octree files written by octree_lod_generator::generate_lods_out_of_core
+	/// the file is memory mapped such that only the data of accessed nodes is paged in
+	template <typename point_t>
+	class octree_file_reader {
+		cgv::utils::mapped_file file;
+		std::vector<OctreeFileNode> nodes;
+		std::unordered_map<std::string, size_t> node_index;
+	public:
+		/// map file and read the node table
+		bool open(const std::string& file_name) {
+			close();
+			if (!file.open(file_name) || file.get_size() < sizeof(OctreeFileHeader))
+				return false;
+			const OctreeFileHeader& header = *file.get_pointer<OctreeFileHeader>(0);
+			if (header.magic != OctreeFileHeader().magic || header.point_size != sizeof(point_t) || header.hierarchy_offset > (int64_t)file.get_size()) {
+				file.close();
+				return false;
+			}
+			const char* ptr = file.get_data() + header.hierarchy_offset;
+			const char* end = file.get_data() + file.get_size();
+			nodes.resize(header.num_nodes);
+			for (auto& node : nodes) {
+				uint32_t name_length;
+				if (end - ptr < (ptrdiff_t)sizeof(uint32_t)) {
+					close();
+					return false;
+				}
+				memcpy(&name_length, ptr, sizeof(uint32_t));
+				ptr += sizeof(uint32_t);
+				if (end - ptr < (ptrdiff_t)(name_length + 2 * sizeof(cgv::vec3) + 2 * sizeof(int64_t))) {
+					close();
+					return false;
+				}
+				node.name = std::string(ptr, name_length);
+				ptr += name_length;
+				memcpy(&node.min[0], ptr, sizeof(cgv::vec3));
+				ptr += sizeof(cgv::vec3);
+				memcpy(&node.max[0], ptr, sizeof(cgv::vec3));
+				ptr += sizeof(cgv::vec3);
+				memcpy(&node.offset, ptr, sizeof(int64_t));
+				ptr += sizeof(int64_t);
+				memcpy(&node.num_points, ptr, sizeof(int64_t));
+				ptr += sizeof(int64_t);
+				node_index[node.name] = &node - nodes.data();
+			}
+			return true;
+		}
+		void close() {
+			nodes.clear();
+			node_index.clear();
+			file.close();
+		}
+		/// return the node table, nodes are named like in the PotreeConverter with "r" denoting the root
+		const std::vector<OctreeFileNode>& get_nodes() const {
+			return nodes;
+		}
+		/// return index of node with given name or -1 if not present
+		int64_t find_node(const std::string& name) const {
+			auto it = node_index.find(name);
+			return it == node_index.end() ? -1 : (int64_t)it->second;
+		}
+		/// return pointer to the points of the i-th node within the mapped file
+		const point_t* get_node_points(size_t i) const {
+			return file.get_pointer<point_t>(nodes[i].offset);
+		}
+		/// copy the points of the named node to the output vector, return false if the node does not exist
+		bool load_node(const std::string& name, std::vector<point_t>& points) const {
+			int64_t i = find_node(name);
+			if (i < 0)
+				return false;
+			const point_t* begin = get_node_points(i);
+			points.assign(begin, begin + nodes[i].num_points);
+			return true;
+		}
+	};
+
 /// generates octree based lods for point clouds, 
 /// @param type point_t should provide two position() and level() methods like GenericLODPoint, these are used to read the point position and write the LOD
 template <typename point_t>
@@ -223,8 +444,72 @@ class octree_lod_generator {
 				node.points = nullptr;
 			}
 		};
-		
+
+		// this indexer appends the points of each finished node to a file and records the node in a node table that is written by close()
+		struct FileIndexer : public Indexer {
+			FILE* fp = nullptr;
+			std::mutex mtx_write;
+			OctreeFileHeader header;
+			std::vector<OctreeFileNode> entries;
+
+			FileIndexer(const std::string& file_name) {
+				fp = fopen(file_name.c_str(), "wb");
+				if (!fp)
+					throw std::runtime_error("unable to create octree file " + file_name);
+				header.point_size = sizeof(point_t);
+				header.hierarchy_offset = sizeof(OctreeFileHeader);
+				write(&header, sizeof(OctreeFileHeader));
+			}
+			~FileIndexer() {
+				if (fp)
+					fclose(fp);
+			}
+			void write(const void* data, size_t size) {
+				if (size > 0 && fwrite(data, 1, size, fp) != size)
+					throw std::runtime_error("unable to write octree file");
+			}
+			// lock and append node to file, the points are released afterwards
+			void finish_node(IndexNode<point_t>& node) override {
+				assert(node.sampled);
+				std::lock_guard<std::mutex> lock(mtx_write);
+				OctreeFileNode entry;
+				entry.name = node.name;
+				entry.min = node.min;
+				entry.max = node.max;
+				entry.offset = header.hierarchy_offset;
+				if (node.points) {
+					for (auto& vert : *node.points)
+						vert.level() = node.level();
+					entry.num_points = node.points->size();
+					write(node.points->data(), node.points->size() * sizeof(point_t));
+				}
+				header.hierarchy_offset += entry.num_points * sizeof(point_t);
+				header.num_points += entry.num_points;
+				entries.push_back(entry);
+				node.points = nullptr;
+			}
+			// write node table and header
+			bool close() {
+				header.num_nodes = entries.size();
+				for (const auto& entry : entries) {
+					uint32_t name_length = (uint32_t)entry.name.size();
+					write(&name_length, sizeof(uint32_t));
+					write(entry.name.data(), name_length);
+					write(&entry.min, sizeof(cgv::vec3));
+					write(&entry.max, sizeof(cgv::vec3));
+					write(&entry.offset, sizeof(int64_t));
+					write(&entry.num_points, sizeof(int64_t));
+				}
+				bool success = fseek(fp, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(OctreeFileHeader), 1, fp) == 1;
+				success = fclose(fp) == 0 && success;
+				fp = nullptr;
+				return success;
+			}
+		};
+
 		int max_points_per_chunk = -1;
+		/// upper bound on the number of points per chunk, in out-of-core mode this bounds the memory used per worker thread during indexing
+		int64_t max_chunk_points_limit = 10'000'000ll;
 
 	protected:
 
@@ -281,6 +566,11 @@ class octree_lod_generator {
 		/// generate points with lod information out of the given vertices
 		inline std::vector<point_t> generate_lods(const std::vector<point_t>& points);
 
+		/// out-of-core variant of generate_lods for point clouds that exceed the main memory. The points can reside in a memory mapped file.
+		/// During chunking points are spilled to a temporary file in temp_directory, chunks are indexed independently on the worker pool and
+		/// the nodes of the resulting hierarchy are written one by one to output_file_name, which can be read with octree_file_reader.
+		inline bool generate_lods_out_of_core(const point_t* points, size_t num_points, const std::string& output_file_name, const std::string& temp_directory);
+
 		//creates a octree structure out of IndexNodes and returns a shared pointer to the root
 		inline std::shared_ptr<IndexNode<point_t>> build_octree(const std::vector<point_t>& points);
 		
@@ -294,9 +584,9 @@ class octree_lod_generator {
 			}
 		}
 
+		/// use the shared task scheduler such that lod generation does not oversubscribe cores used by other algorithms
 		bool init() {
-			pool_ptr =
-				  std::make_unique<cgv::pointcloud::utility::WorkerPool>((std::thread::hardware_concurrency() - 1));
+			pool_ptr = &cgv::pointcloud::utility::TaskScheduler::ref_shared();
 			return pool_ptr != nullptr;
 		}
 
@@ -308,8 +598,12 @@ class octree_lod_generator {
 		void manage_singelton(int& ref_count, int ref_count_change);
 
 	private:
-		std::unique_ptr<cgv::pointcloud::utility::WorkerPool> pool_ptr;
+		cgv::pointcloud::utility::TaskScheduler* pool_ptr = nullptr;
 		bool allow_duplicate_elimination = true;
+		/// file holding the chunks in out-of-core mode, empty in in-core mode
+		std::shared_ptr<ChunkSpillFile<point_t>> spill_file;
+		/// number of points of the spill file that are assigned to chunks
+		int64_t spill_file_points = 0;
 };
 
 //returns a reference to a singelton
@@ -570,7 +864,7 @@ struct SamplerRandom : public Sampler<point_t> {
 		// stores chunks created by the chunking phase
 		Chunks<point_t> chunks;
 
-		max_points_per_chunk = std::min<size_t>(num_points / 20, 10'000'000ll);
+		max_points_per_chunk = std::min<size_t>(num_points / 20, max_chunk_points_limit);
 
 		int64_t grid_size = select_grid_size(num_points);
 
@@ -763,12 +1057,14 @@ struct SamplerRandom : public Sampler<point_t> {
 
 			for (int i = 0; i < num_buckets; ++i) {
 				if (buckets[i].size() > 0)
-					nodes[i].pc_data->write_points(buckets[i].data(), buckets[i].size());
+					nodes[i].write_points(buckets[i].data(), buckets[i].size());
 			}
 
 		};
 
 		pool_ptr->run([&tasks](int id) {tasks(); });
+		// report write errors of the out-of-core mode on the calling thread
+		tasks.rethrow_error();
 
 		/* //single thread variant
 		for (int i = 0; i < num_points; ++i) {
@@ -870,7 +1166,12 @@ struct SamplerRandom : public Sampler<point_t> {
 
 						if (value > 0) {
 							std::string node_id = to_node_id(level_high, gridSize_high, nx, ny, nz);
-							nodes.emplace_back(node_id, value);
+							if (!spill_file)
+								nodes.emplace_back(node_id, value);
+							else {
+								nodes.emplace_back(node_id, value, spill_file, spill_file_points);
+								spill_file_points += value;
+							}
 							ChunkNode<point_t>& node = nodes.back();
 
 							node.x = nx;
@@ -960,26 +1261,7 @@ struct SamplerRandom : public Sampler<point_t> {
 			}
 		};
 
-		struct Tasks {
-			std::vector<Task> task_pool;
-			std::atomic_int next_task = 0;
-
-			std::function<void(Task*)> func;
-
-			void operator()() {
-				while (true) {
-					Task* task;
-					//get task
-					{
-						int task_id = next_task.fetch_add(1);
-						if (task_id >= task_pool.size())
-							return;
-						task = &task_pool[task_id];
-					}
-					func(task);
-				}
-			}
-		} tasks;
+		cgv::pointcloud::utility::TaskPool<Task> tasks;
 		
 		std::mutex mtx_nodes;
 		std::vector<std::shared_ptr<IndexNode<point_t>>> nodes;
@@ -994,7 +1276,10 @@ struct SamplerRandom : public Sampler<point_t> {
 
 			cgv::vec3 min(Infinity), max(-Infinity);
 
-			for (auto& v : chunk->pc_data->vertices) {
+			//alias vertices or load them from the chunk file
+			std::shared_ptr<std::vector<point_t>> points = chunk->load_points();
+
+			for (auto& v : *points) {
 				min.x() = std::min(min.x(), v.position().x());
 				min.y() = std::min(min.y(), v.position().y());
 				min.z() = std::min(min.z(), v.position().z());
@@ -1006,9 +1291,6 @@ struct SamplerRandom : public Sampler<point_t> {
 
 			auto chunk_root = std::make_shared<IndexNode<point_t>>(chunk->id, min, max);
 
-			//alias vertices
-			std::shared_ptr<std::vector<point_t>> points(chunk->pc_data, &(chunk->pc_data->vertices));
-
 			build_hierarchy(&indexer, chunk_root.get(), points, points->size());
 
 			auto onNodeCompleted = [&indexer, &chunk_root](IndexNode<point_t>* node) {
@@ -1032,10 +1314,12 @@ struct SamplerRandom : public Sampler<point_t> {
 
 		//fill task pool
 		for (auto& chunk : chunks.nodes) {
-			tasks.task_pool.emplace_back(chunk);
+			tasks.pool.emplace_back(chunk);
 		}
 
 		pool_ptr->run([&tasks](int thread_id) {tasks(); });
+		// report read and write errors of the out-of-core mode on the calling thread
+		tasks.rethrow_error();
 
 		if (chunks.nodes.size() == 1) {
 			indexer.root = nodes[0];
@@ -1354,6 +1638,63 @@ struct SamplerRandom : public Sampler<point_t> {
 	
 
 
+	template <typename point_t>
+	bool octree_lod_generator<point_t>::generate_lods_out_of_core(const point_t* points, size_t num_points, const std::string& output_file_name, const std::string& temp_directory)
+	{
+		//find min, max
+		static constexpr float Infinity = std::numeric_limits<float>::infinity();
+		cgv::vec3 min = { Infinity , Infinity , Infinity };
+		cgv::vec3 max = { -Infinity , -Infinity , -Infinity };
+
+		for (size_t i = 0; i < num_points; ++i) {
+			const cgv::vec3& p = points[i].position();
+			min.x() = std::min(min.x(), p.x());
+			min.y() = std::min(min.y(), p.y());
+			min.z() = std::min(min.z(), p.z());
+
+			max.x() = std::max(max.x(), p.x());
+			max.y() = std::max(max.y(), p.y());
+			max.z() = std::max(max.z(), p.z());
+		}
+
+		cgv::vec3 ext = max - min;
+		float cube_size = num_points > 0 ? *std::max_element(ext.begin(), ext.end()) : 0.f;
+
+		try {
+			FileIndexer indexer(output_file_name);
+			if (cube_size == 0.f) {
+				//all points have the same position, write them as root node
+				indexer.root = std::make_shared<IndexNode<point_t>>("r", min, min);
+				indexer.root->sampled = true;
+				size_t n = (allow_duplicate_elimination && num_points > 0) ? 1 : num_points;
+				indexer.root->points = std::make_shared<std::vector<point_t>>(points, points + n);
+				indexer.root->num_points = n;
+				indexer.finish_node(*indexer.root);
+			}
+			else {
+				max = min + cgv::vec3(cube_size, cube_size, cube_size);
+
+				spill_file = std::make_shared<ChunkSpillFile<point_t>>(temp_directory.empty() ? std::string(".") : temp_directory);
+				spill_file_points = 0;
+				Chunks<point_t> chunks = chunking(points, num_points, min, max, cube_size);
+				// chunks keep the spill file alive until they are indexed
+				spill_file = nullptr;
+
+				SamplerRandom<point_t> sampler;
+				indexing(chunks, indexer, sampler);
+			}
+			if (indexer.header.num_points != (int64_t)num_points) {
+				std::cout << "lod generator: some points were eliminated!\n";
+			}
+			return indexer.close();
+		}
+		catch (const std::exception& e) {
+			spill_file = nullptr;
+			std::cerr << "lod generator: " << e.what() << std::endl;
+			return false;
+		}
+	}
+
 	template <typename point_t>
 	std::shared_ptr<IndexNode<point_t>> octree_lod_generator<point_t>::build_octree(const std::vector<point_t>& points) {
 		const point_t* source_data = points.data();
@@ -1543,6 +1884,8 @@ struct SamplerRandom : public Sampler<point_t> {
 	using cgv::pointcloud::octree::SimpleLODPoint;
 	using cgv::pointcloud::octree::GenericLODPoint;
 	using cgv::pointcloud::octree::ref_octree_lod_generator;
+	using cgv::pointcloud::octree::octree_file_reader;
+	using cgv::pointcloud::octree::OctreeFileNode;
 } //pointcloud namespace
 } //cgv namespace
 
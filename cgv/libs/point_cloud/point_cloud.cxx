@@ -1,6 +1,7 @@
 #include <cgv/math/permute.h>
 #include <cgv/math/det.h>
 #include "point_cloud.h"
+#include "mapped_point_cloud.h"
 #include <cgv/utils/file.h>
 #include <cgv/utils/stopwatch.h>
 #include <cgv/utils/scan.h>
@@ -471,6 +472,8 @@ bool point_cloud::read(const string& _file_name)
 		success = read_bin(_file_name);
 	if (ext == "lpc")
 		success = read_lpc(_file_name);
+	if (ext == "mpc")
+		success = read_mpc(_file_name);
 	if (ext == "xyz")
 		success = read_xyz(_file_name);
 	if (ext == "pct")
@@ -639,6 +642,8 @@ bool point_cloud::write(const string& _file_name)
 		return write_bin(_file_name);
 	if (ext == "lpc")
 		return write_lpc(_file_name);
+	if (ext == "mpc")
+		return write_mpc(_file_name);
 	if (ext == "apc" || ext == "pnt")
 		return write_ascii(_file_name, (ext == "apc") && has_normals());
 	if (ext == "obj" || ext == "pobj")
@@ -1085,6 +1090,71 @@ bool point_cloud::write_lpc(const std::string& file_name) {
 	return fclose(fp) == 0 && success;
 }
 
+bool point_cloud::read_mpc(const std::string& file_name)
+{
+	mapped_point_cloud mpc;
+	if (!mpc.open(file_name))
+		return false;
+	clear();
+	size_t n = mpc.get_nr_points();
+	// copy sections sequentially such that the os can read ahead and drop pages behind
+	mpc.advise(MPC_POSITIONS, cgv::utils::mapped_file::AH_SEQUENTIAL);
+	const Pnt* pnts = mpc.get_positions();
+	if (!pnts)
+		return false;
+	P.assign(pnts, pnts + n);
+	if (const Nml* nmls = mpc.get_normals()) {
+		mpc.advise(MPC_NORMALS, cgv::utils::mapped_file::AH_SEQUENTIAL);
+		N.assign(nmls, nmls + n);
+	}
+	if (const mpc_section* s = mpc.get_section(MPC_COLORS)) {
+		mpc.advise(MPC_COLORS, cgv::utils::mapped_file::AH_SEQUENTIAL);
+		if (const Clr* clrs = mpc.get_colors())
+			C.assign(clrs, clrs + n);
+		else if (s->element_size == sizeof(cgv::media::color<cgv::type::uint8_type>)) {
+			const cgv::type::uint8_type* c = static_cast<const cgv::type::uint8_type*>(mpc.get_section_data(MPC_COLORS));
+			C.resize(n);
+			for (size_t i = 0; i < n; ++i, c += 3)
+				C[i] = Clr(byte_to_color_component(c[0]), byte_to_color_component(c[1]), byte_to_color_component(c[2]));
+		}
+		else if (s->element_size == sizeof(cgv::media::color<float>)) {
+			const float* c = static_cast<const float*>(mpc.get_section_data(MPC_COLORS));
+			C.resize(n);
+			for (size_t i = 0; i < n; ++i, c += 3)
+				C[i] = Clr(float_to_color_component(c[0]), float_to_color_component(c[1]), float_to_color_component(c[2]));
+		}
+		else
+			std::cerr << "point_cloud::read_mpc(" << file_name << "): unsupported color format ignored" << std::endl;
+	}
+	if (const uint8_t* l = mpc.get_lods())
+		lods.assign(l, l + n);
+	if (const cgv::type::int32_type* l = mpc.get_labels())
+		labels.assign(l, l + n);
+	if (mpc.get_nr_components() > 0) {
+		components.resize(mpc.get_nr_components());
+		for (size_t ci = 0; ci < components.size(); ++ci)
+			components[ci] = mpc.get_component(ci);
+		component_indices.resize(n);
+		for (size_t ci = 0; ci < components.size(); ++ci)
+			std::fill(component_indices.begin() + components[ci].index_of_first_point,
+				component_indices.begin() + components[ci].index_of_first_point + components[ci].nr_points, unsigned(ci));
+	}
+	return true;
+}
+
+bool point_cloud::write_mpc(const std::string& file_name) const
+{
+	size_t n = P.size();
+	if (n == 0)
+		return false;
+	return mapped_point_cloud::write(file_name, n, &P[0],
+		has_normals() && N.size() == n ? &N[0] : 0,
+		has_colors() && C.size() == n ? &C[0] : 0,
+		lods.size() == n ? &lods[0] : 0,
+		labels.size() == n ? &labels[0] : 0,
+		has_components() ? components : std::vector<component_info>());
+}
+
 bool point_cloud::read_bin(const string& file_name)
 {
 	FILE* fp = fopen(file_name.c_str(), "rb");
@@ -215,6 +215,11 @@ protected:
 		resulting from the extension of the format with colors. */
 	///
 	bool read_bin(const std::string& file_name);
+	//! read mapped point cloud format into the dynamic containers
+	/*! Positions, normals, colors, lods, labels and components are stored in separate sections
+	    aligned to MPC_SECTION_ALIGNMENT, see mapped_point_cloud.h. Use mapped_point_cloud directly
+		to access the sections without copying them into memory. */
+	bool read_mpc(const std::string& file_name);
 	//! read a ply format.
 	/*! Ignores all but the vertex elements and from the vertex elements the properties x,y,z,nx,ny,nz:Float32 and red,green,blue,alpha:Uint8.
 	    Colors are transformed to 32-bit floats in the range [0,1] and alpha components are ignored. */
@@ -227,6 +232,8 @@ protected:
 	bool write_ascii(const std::string& file_name, bool write_nmls = true) const;
 	/// write binary format, see read_bin for format description
 	bool write_bin(const std::string& file_name) const;
+	/// write mapped point cloud format, see read_mpc for format description
+	bool write_mpc(const std::string& file_name) const;
 	/// write obj format, see read_obj for format description
 	bool write_obj(const std::string& file_name) const;
 	/// write ply format, see read_ply for format description
@@ -284,6 +291,7 @@ protected:
 	/*! extension mapping:
 	    - read_ascii: *.pnt,*.apc
 		- read_bin:   *.bin
+		- read_mpc:   *.mpc
 		- read_ply:   *.ply
 		- read_obj:   *.obj
 		- read_points:*.points 
@@ -0,0 +1,180 @@
+#include "point_kd_tree.h"
+#include "concurrency.h"
+#include <algorithm>
+
+namespace {
+	/// ranges with at most this number of points are searched linearly
+	const size_t leaf_size = 8;
+	/// ranges with at least this number of points are built in parallel
+	const size_t parallel_build_size = 65536;
+}
+
+point_kd_tree::point_kd_tree()
+{
+}
+
+point_kd_tree::point_kd_tree(const point_cloud& pc)
+{
+	build(pc);
+}
+
+void point_kd_tree::clear()
+{
+	points.clear();
+	indices.clear();
+	tree_positions.clear();
+	split_axes.clear();
+}
+
+void point_kd_tree::build(const point_cloud& pc)
+{
+	if (pc.get_nr_points() == 0)
+		clear();
+	else
+		build(&pc.pnt(0), pc.get_nr_points());
+}
+
+void point_kd_tree::build(const Pnt* pnts, size_t nr_points)
+{
+	points.assign(pnts, pnts + nr_points);
+	indices.resize(nr_points);
+	for (size_t i = 0; i < nr_points; ++i)
+		indices[i] = Idx(i);
+	split_axes.resize(nr_points);
+	build_recursive(0, nr_points);
+	// permute points into tree order
+	std::vector<Pnt> sorted_points(nr_points);
+	tree_positions.resize(nr_points);
+	for (size_t i = 0; i < nr_points; ++i) {
+		sorted_points[i] = pnts[indices[i]];
+		tree_positions[indices[i]] = Idx(i);
+	}
+	points.swap(sorted_points);
+}
+
+void point_kd_tree::build_recursive(size_t begin, size_t end)
+{
+	if (end - begin <= leaf_size)
+		return;
+	// during construction points are still in original order and addressed through indices
+	Box box;
+	box.invalidate();
+	for (size_t i = begin; i < end; ++i)
+		box.add_point(points[indices[i]]);
+	uint8_t axis = uint8_t(box.get_max_extent_coord_index());
+	size_t mid = (begin + end) / 2;
+	std::nth_element(indices.begin() + begin, indices.begin() + mid, indices.begin() + end,
+		[this, axis](Idx i, Idx j) { return points[i][axis] < points[j][axis]; });
+	split_axes[mid] = axis;
+	if (end - begin >= parallel_build_size) {
+		auto& scheduler = cgv::pointcloud::utility::TaskScheduler::ref_shared();
+		cgv::pointcloud::utility::TaskScheduler::TaskGroup group;
+		scheduler.spawn(group, [this, begin, mid]() { build_recursive(begin, mid); });
+		build_recursive(mid + 1, end);
+		scheduler.wait(group);
+	}
+	else {
+		build_recursive(begin, mid);
+		build_recursive(mid + 1, end);
+	}
+}
+
+void point_kd_tree::find_closest_recursive(size_t begin, size_t end, const Pnt& p, Idx& best_index, Crd& best_sqr_dist) const
+{
+	if (end - begin <= leaf_size) {
+		for (size_t i = begin; i < end; ++i) {
+			Crd d = sqr_length(points[i] - p);
+			if (d < best_sqr_dist) {
+				best_sqr_dist = d;
+				best_index = Idx(i);
+			}
+		}
+		return;
+	}
+	size_t mid = (begin + end) / 2;
+	Crd d = sqr_length(points[mid] - p);
+	if (d < best_sqr_dist) {
+		best_sqr_dist = d;
+		best_index = Idx(mid);
+	}
+	unsigned axis = split_axes[mid];
+	Crd delta = p[axis] - points[mid][axis];
+	// descend into the side of the query point first, visit the other side only if the splitting plane is closer than the best point
+	if (delta < 0) {
+		find_closest_recursive(begin, mid, p, best_index, best_sqr_dist);
+		if (delta * delta < best_sqr_dist)
+			find_closest_recursive(mid + 1, end, p, best_index, best_sqr_dist);
+	}
+	else {
+		find_closest_recursive(mid + 1, end, p, best_index, best_sqr_dist);
+		if (delta * delta < best_sqr_dist)
+			find_closest_recursive(begin, mid, p, best_index, best_sqr_dist);
+	}
+}
+
+point_kd_tree::Idx point_kd_tree::find_closest(const Pnt& p, Crd max_sqr_dist, Crd* sqr_dist_ptr) const
+{
+	Idx best_index = -1;
+	Crd best_sqr_dist = max_sqr_dist;
+	find_closest_recursive(0, points.size(), p, best_index, best_sqr_dist);
+	if (sqr_dist_ptr)
+		*sqr_dist_ptr = best_sqr_dist;
+	return best_index == -1 ? -1 : indices[best_index];
+}
+
+void point_kd_tree::find_knn_recursive(size_t begin, size_t end, const Pnt& p, size_t k, std::vector<std::pair<Crd, Idx> >& heap) const
+{
+	auto consider = [&heap, k, &p, this](size_t i) {
+		Crd d = sqr_length(points[i] - p);
+		if (heap.size() < k) {
+			heap.push_back(std::make_pair(d, Idx(i)));
+			std::push_heap(heap.begin(), heap.end());
+		}
+		else if (d < heap.front().first) {
+			std::pop_heap(heap.begin(), heap.end());
+			heap.back() = std::make_pair(d, Idx(i));
+			std::push_heap(heap.begin(), heap.end());
+		}
+	};
+	if (end - begin <= leaf_size) {
+		for (size_t i = begin; i < end; ++i)
+			consider(i);
+		return;
+	}
+	size_t mid = (begin + end) / 2;
+	consider(mid);
+	unsigned axis = split_axes[mid];
+	Crd delta = p[axis] - points[mid][axis];
+	size_t near_begin = delta < 0 ? begin : mid + 1, near_end = delta < 0 ? mid : end;
+	size_t far_begin = delta < 0 ? mid + 1 : begin, far_end = delta < 0 ? end : mid;
+	find_knn_recursive(near_begin, near_end, p, k, heap);
+	if (heap.size() < k || delta * delta < heap.front().first)
+		find_knn_recursive(far_begin, far_end, p, k, heap);
+}
+
+void point_kd_tree::find_closest_points(const Pnt& p, Idx k, std::vector<Idx>& knn, std::vector<Crd>* sqr_dists_ptr) const
+{
+	std::vector<std::pair<Crd, Idx> > heap;
+	heap.reserve(k);
+	find_knn_recursive(0, points.size(), p, k, heap);
+	std::sort_heap(heap.begin(), heap.end());
+	knn.resize(heap.size());
+	for (size_t i = 0; i < heap.size(); ++i)
+		knn[i] = indices[heap[i].second];
+	if (sqr_dists_ptr) {
+		sqr_dists_ptr->resize(heap.size());
+		for (size_t i = 0; i < heap.size(); ++i)
+			(*sqr_dists_ptr)[i] = heap[i].first;
+	}
+}
+
+void point_kd_tree::extract_neighbors(Idx i, Idx k, std::vector<Idx>& N) const
+{
+	find_closest_points(points[tree_positions[i]], k + 1, N);
+	// remove query point, which is usually the first but can be preceded by duplicates
+	auto it = std::find(N.begin(), N.end(), i);
+	if (it != N.end())
+		N.erase(it);
+	else if (!N.empty())
+		N.pop_back();
+}
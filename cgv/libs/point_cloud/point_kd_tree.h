@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include "point_cloud.h"
+
+#include "lib_begin.h"
+
+/** balanced kd-tree over the points of a point cloud whose queries are thread safe.
+
+    In contrast to ann_tree, which relies on global state of the ANN library, all queries
+	only read the tree and can be issued concurrently, for example from a parallel_for of the
+	cgv::pointcloud::utility::TaskScheduler. The tree is stored implicitly in a permutation of
+	the point indices, where each subrange is split at its median along the axis of largest extent. */
+class CGV_API point_kd_tree : public point_cloud_types
+{
+protected:
+	/// copy of the points in tree order
+	std::vector<Pnt> points;
+	/// original point index for each point in tree order
+	std::vector<Idx> indices;
+	/// position in tree order for each original point index
+	std::vector<Idx> tree_positions;
+	/// split axis per inner node, addressed by the median position of the node's range
+	std::vector<uint8_t> split_axes;
+	/// recursively build the subtree over [begin,end)
+	void build_recursive(size_t begin, size_t end);
+	/// recursive nearest neighbor search
+	void find_closest_recursive(size_t begin, size_t end, const Pnt& p, Idx& best_index, Crd& best_sqr_dist) const;
+	/// recursive k nearest neighbor search maintaining a max heap of (sqr_dist,index) pairs
+	void find_knn_recursive(size_t begin, size_t end, const Pnt& p, size_t k, std::vector<std::pair<Crd, Idx> >& heap) const;
+public:
+	/// construct empty tree
+	point_kd_tree();
+	/// construct tree over all points of the point cloud
+	point_kd_tree(const point_cloud& pc);
+	/// build tree over all points of the point cloud
+	void build(const point_cloud& pc);
+	/// build tree over the given points
+	void build(const Pnt* pnts, size_t nr_points);
+	/// clear tree
+	void clear();
+	/// check whether tree is empty
+	bool is_empty() const { return points.empty(); }
+	/// return index of closest point or -1 if no point is closer than sqrt(max_sqr_dist); optionally return squared distance
+	Idx find_closest(const Pnt& p, Crd max_sqr_dist = std::numeric_limits<Crd>::max(), Crd* sqr_dist_ptr = 0) const;
+	/// find the indices of the k closest points sorted by increasing distance
+	void find_closest_points(const Pnt& p, Idx k, std::vector<Idx>& knn, std::vector<Crd>* sqr_dists_ptr = 0) const;
+	/// interface for neighbor_graph::build_parallel, excludes the query point itself
+	void extract_neighbors(Idx i, Idx k, std::vector<Idx>& N) const;
+};
+
+#include <cgv/config/lib_end.h>
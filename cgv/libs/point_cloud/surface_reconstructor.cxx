@@ -45,7 +45,8 @@ bool surface_reconstructor::self_reflect(cgv::reflect::reflection_handler& srh)
 		srh.reflect_member("debug_j", debug_j) &&
 		srh.reflect_member("compute_reference_length_from_delaunay_filter", compute_reference_length_from_delaunay_filter) &&
 		srh.reflect_member("debug_events", debug_events) &&
-		srh.reflect_member("valid_length_scale", valid_length_scale);
+		srh.reflect_member("valid_length_scale", valid_length_scale) &&
+		srh.reflect_member("nr_parallel_regions", nr_parallel_regions);
 }
 
 surface_reconstructor::surface_reconstructor() 
@@ -70,6 +71,7 @@ surface_reconstructor::surface_reconstructor()
 	allow_intersections_in_holes = false;
 	valid_length_scale = 2;
 	use_normal_weight = true;
+	nr_parallel_regions = 0;
 }
 
 void surface_reconstructor::analyze_holes()
@@ -104,6 +106,7 @@ void surface_reconstructor::init()
 	directed_edge_info.clear();
 	grow_events.clear();
 	first_grow_event.clear();
+	vertex_region.clear();
 	vertex_reference_length.clear();
 	secondary_normals.clear();
 	geqs.init();
@@ -243,9 +243,11 @@ struct CGV_API surface_reconstructor : public point_cloud_types
 	/// whether to print debug information on grow events
 	bool debug_events;
 	double valid_length_scale;
+	/// priority queue type used for grow events
+	typedef cgv::data::dynamic_priority_queue<grow_event> grow_event_queue;
 	/// store all grow events
-	cgv::data::dynamic_priority_queue<grow_event> grow_events;
-	/// store for each vertex the index of its first grow event or -1 if non present
+	grow_event_queue grow_events;
+	/// store for each vertex the index of its first grow event in the queue of its region or -1 if non present
 	std::vector<int> first_grow_event;
 	/// statistics over the quality of the grow event triangles
 	cgv::utils::statistics geqs;
@@ -261,17 +263,23 @@ struct CGV_API surface_reconstructor : public point_cloud_types
 	bool is_valid_corner_grow_event(const grow_event& ge, unsigned int& nr_insert, unsigned int& nr_remove) const;
 	bool is_valid_edge_grow_event(const grow_event& ge, unsigned int& nr_insert, unsigned int& nr_remove) const;
 	bool validate_event(grow_event& ge) const;
-	void add_grow_event(const grow_event& ge);
+	void add_grow_event(const grow_event& ge) { add_grow_event(ge, grow_events); }
+	void add_grow_event(const grow_event& ge, grow_event_queue& Q);
 	/// check corner grow event and insert to queue
-	bool consider_corner_grow_event(unsigned int vi,unsigned int j, unsigned int k);
+	bool consider_corner_grow_event(unsigned int vi,unsigned int j, unsigned int k) { return consider_corner_grow_event(vi, j, k, grow_events, -1); }
+	bool consider_corner_grow_event(unsigned int vi,unsigned int j, unsigned int k, grow_event_queue& Q, int region);
 	/// check edge grow event and insert to queue
-	bool consider_edge_grow_event(unsigned int vi,unsigned int j, unsigned int k, Direction dir);
+	bool consider_edge_grow_event(unsigned int vi,unsigned int j, unsigned int k, Direction dir) { return consider_edge_grow_event(vi, j, k, dir, grow_events, -1); }
+	bool consider_edge_grow_event(unsigned int vi,unsigned int j, unsigned int k, Direction dir, grow_event_queue& Q, int region);
 	/// determine all grow events of the given vi
-	void consider_grow_events(unsigned int vi);
+	void consider_grow_events(unsigned int vi) { consider_grow_events(vi, grow_events, -1); }
+	/// determine all grow events of the given vi and insert the ones that lie completely inside of the given region (-1 for no restriction) to Q
+	void consider_grow_events(unsigned int vi, grow_event_queue& Q, int region);
 	/// build priority queue of events
 	void build_grow_queue(const std::vector<unsigned int>& T);
 	/// remove the grow events of a given vertex
-	void remove_grow_events(unsigned int vi);
+	void remove_grow_events(unsigned int vi) { remove_grow_events(vi, grow_events); }
+	void remove_grow_events(unsigned int vi, grow_event_queue& Q);
 	///
 	unsigned int insert_directed_edge(unsigned int vi, unsigned int vj);
 	///
@@ -281,11 +289,38 @@ struct CGV_API surface_reconstructor : public point_cloud_types
 	/// 
 	void connect_to_fan(unsigned int vi,unsigned int vj, unsigned int vk);
 	/// perform grow event
-	void perform_next_grow_event(std::vector<unsigned int>& T);
+	void perform_next_grow_event(std::vector<unsigned int>& T) { perform_next_grow_event(T, grow_events, -1); }
+	/// perform the next grow event of Q, where all influenced vertices need to belong to the given region (-1 for no restriction)
+	void perform_next_grow_event(std::vector<unsigned int>& T, grow_event_queue& Q, int region);
 	/// perform grow events till no more events are left and add the generated triangles to T
 	unsigned int grow_all(std::vector<unsigned int>& T);
 	//@}
 
+	/**@name parallel region growing*/
+	//@{
+	/// region index of a vertex that is shared by several regions and only processed in the serial seam pass
+	static const int SEAM_REGION = -1;
+	/// number of spatial regions grown in parallel, 0 chooses eight regions per thread
+	unsigned int nr_parallel_regions;
+	/// per vertex region index or SEAM_REGION
+	std::vector<int> vertex_region;
+	/// check whether all three vertices belong to the given region, where region -1 accepts all vertices
+	bool is_region_triangle(unsigned int vi, unsigned int vj, unsigned int vk, int region) const;
+	/** partition the points with a regular grid of about nr_regions cells into regions. Vertices with a
+	    neighbor in a different cell become seam vertices, such that the neighbor graph of a region's vertices
+		only reaches into the same region or into the seam. Returns the number of regions. */
+	unsigned int partition_into_regions(unsigned int nr_regions);
+	/** color the regions such that regions whose vertices are neighbors of the same seam vertex get different
+	    colors. Regions of one color can be grown concurrently. Returns the number of colors. */
+	unsigned int color_regions(unsigned int nr_regions, std::vector<unsigned int>& region_color) const;
+	/** perform the same growing as build_grow_queue(T) followed by grow_all(T), but grow the regions of
+	    a spatial partition in parallel with one queue per region, where only regions of the same color
+		are grown concurrently. Triangles touching seam vertices are
+		deferred to a final serial pass over the global queue, such that the manifold checks at region
+		borders are the same as in the serial version. Returns the number of performed grow events. */
+	unsigned int grow_all_parallel(std::vector<unsigned int>& T);
+	//@}
+
 
 	/**@name neighbor graph filters */
 	//@{
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <set>
 #include "surface_reconstructor.h"
+#include "concurrency.h"
 #include <cgv/math/functions.h>
 #include <cgv/utils/progression.h>
 
@@ -288,43 +289,47 @@ bool surface_reconstructor::validate_event(grow_event& ge) const
 	return true;
 }
 
-void surface_reconstructor::add_grow_event(const grow_event& ge)
+void surface_reconstructor::add_grow_event(const grow_event& ge, grow_event_queue& Q)
 {
 	if (debug_events) {
 		std::cout << "add event " << ge << std::endl;
 	}
-	unsigned int gi = grow_events.insert(ge);
-	if (ge.vi != grow_events[gi].vi) {
-		std::cout << "ups add event of wrong vertex " << grow_events[gi].vi << " instead of " << ge.vi << std::endl;
+	unsigned int gi = Q.insert(ge);
+	if (ge.vi != Q[gi].vi) {
+		std::cout << "ups add event of wrong vertex " << Q[gi].vi << " instead of " << ge.vi << std::endl;
 	}
-	if (first_grow_event[ge.vi] != -1 && ge.vi != grow_events[first_grow_event[ge.vi]].vi) {
-		std::cout << "ups add event of wrong vertex " << grow_events[first_grow_event[ge.vi]].vi << " instead of " << ge.vi << std::endl;
+	if (first_grow_event[ge.vi] != -1 && ge.vi != Q[first_grow_event[ge.vi]].vi) {
+		std::cout << "ups add event of wrong vertex " << Q[first_grow_event[ge.vi]].vi << " instead of " << ge.vi << std::endl;
 	}
-	grow_events[gi].next_grow_event_of_vertex = first_grow_event[ge.vi];
+	Q[gi].next_grow_event_of_vertex = first_grow_event[ge.vi];
 	first_grow_event[ge.vi] = gi;
 }
 
 /// check corner grow event and insert to queue
 bool surface_reconstructor::consider_corner_grow_event(
-	unsigned int vi,unsigned int j, unsigned int k)
+	unsigned int vi,unsigned int j, unsigned int k, grow_event_queue& Q, int region)
 {
+	if (!is_region_triangle(vi, ng->at(vi)[j], ng->at(vi)[k], region))
+		return false;
 	grow_event ge(vi,j,k,CORNER_GROW_EVENT);
 	if (validate_event(ge))
-		add_grow_event(ge);
+		add_grow_event(ge, Q);
 	return true;
 }
 
 /// check edge grow event and insert to queue
 bool surface_reconstructor::consider_edge_grow_event(
-	unsigned int vi,unsigned int j, unsigned int k, Direction dir)
+	unsigned int vi,unsigned int j, unsigned int k, Direction dir, grow_event_queue& Q, int region)
 {
+	if (!is_region_triangle(vi, ng->at(vi)[j], ng->at(vi)[k], region))
+		return false;
 	grow_event ge(vi,j,k,EDGE_GROW_EVENT,dir);
 	if (validate_event(ge))
-		add_grow_event(ge);
+		add_grow_event(ge, Q);
 	return true;
 }
 
-void surface_reconstructor::consider_grow_events(unsigned int vi)
+void surface_reconstructor::consider_grow_events(unsigned int vi, grow_event_queue& Q, int region)
 {
 	unsigned int vj, j;
 	neighbor_graph& NG = *ng;
@@ -347,7 +352,7 @@ void surface_reconstructor::consider_grow_events(unsigned int vi)
 	do {
 		if (is_face_corner(vi,j)) {
 			if (!last_is_face_corner) {
-				consider_corner_grow_event(vi,block_end,j);
+				consider_corner_grow_event(vi,block_end,j,Q,region);
 				// check backward if we also have to consider an edge event
 				if (j != (block_end+1)%n) {
 					// check forward if we also have to consider an edge event
@@ -355,7 +360,7 @@ void surface_reconstructor::consider_grow_events(unsigned int vi)
 					unsigned int k = (j+n-1)%n;
 					int jk = NG.find(vj,Ni[k]);
 					if (jk == -1 || !is_face_corner(vj,jk))
-						consider_edge_grow_event(vi,k,j,BACKWARD);
+						consider_edge_grow_event(vi,k,j,BACKWARD,Q,region);
 				}
 			}
 			block_end = (j+1)%n;
@@ -372,7 +377,7 @@ void surface_reconstructor::consider_grow_events(unsigned int vi)
 					unsigned int nj = (unsigned int) Nj.size();
 					int jk = NG.find(vj,Ni[k]);
 					if (jk == -1 || !is_face_corner(vj,(jk+nj-1)%nj))
-						consider_edge_grow_event(vi,j,k,FORWARD);
+						consider_edge_grow_event(vi,j,k,FORWARD,Q,region);
 				}
 			}
 			last_is_face_corner = false;
@@ -413,7 +418,7 @@ void surface_reconstructor::build_grow_queue(const std::vector<unsigned int>& T)
 
 
 /// remove the grow events of a given vertex
-void surface_reconstructor::remove_grow_events(unsigned int vi)
+void surface_reconstructor::remove_grow_events(unsigned int vi, grow_event_queue& Q)
 {
 	if (debug_events)
 		std::cout << "remove " << vi << " events:";
@@ -421,14 +426,14 @@ void surface_reconstructor::remove_grow_events(unsigned int vi)
 	int nr = 0;
 	while (gi != -1) {
 		int gj = gi;
-		gi = grow_events[gi].next_grow_event_of_vertex;
-		if (vi != grow_events[gj].vi) {
-			std::cout << "ups removed event of wrong vertex " << grow_events[gj].vi << " instead of " << vi << std::endl;
+		gi = Q[gi].next_grow_event_of_vertex;
+		if (vi != Q[gj].vi) {
+			std::cout << "ups removed event of wrong vertex " << Q[gj].vi << " instead of " << vi << std::endl;
 		}
 		if (debug_events) {
-			std::cout << " " << grow_events[gj];
+			std::cout << " " << Q[gj];
 		}
-		grow_events.remove(gj);
+		Q.remove(gj);
 	}
 	if (debug_events)
 		std::cout << std::endl;
@@ -544,15 +549,17 @@ void surface_reconstructor::connect_to_fan(unsigned int vi,unsigned int vj, unsi
 }
 
 /// perform grow event
-void surface_reconstructor::perform_next_grow_event(std::vector<unsigned int>& T)
+void surface_reconstructor::perform_next_grow_event(std::vector<unsigned int>& T, grow_event_queue& Q, int region)
 {
-	if (grow_events.is_empty(grow_events.top())) {
+	if (Q.is_empty(Q.top())) {
 		std::cout << "ATTEMPT TO PERFORM EMPTY GROW EVENT" << std::endl;
 	}
 
 	while (true) {
-		grow_event& ge = grow_events[grow_events.top()];
-		if (!validate_event(ge) || 
+		grow_event& ge = Q[Q.top()];
+		// in a region the one ring of vi can only reach into the seam, which must not be touched
+		if (!is_region_triangle(ge.vi,ng->at(ge.vi)[ge.j],ng->at(ge.vi)[ge.k],region) ||
+			 !validate_event(ge) || 
 			 ( perform_intersection_tests &&
 				  !can_create_triangle_without_self_intersections(
 				  ge.vi,ng->at(ge.vi)[ge.j],ng->at(ge.vi)[ge.k]) ) ) {
@@ -561,27 +568,27 @@ void surface_reconstructor::perform_next_grow_event(std::vector<unsigned int>& T
 			int* ge_idx_ref = &first_grow_event[vi];
 			bool found = false;
 			while (*ge_idx_ref != -1) {
-				if (*ge_idx_ref == grow_events.top()) {
+				if (*ge_idx_ref == (int)Q.top()) {
 					*ge_idx_ref = ge.next_grow_event_of_vertex;
 					found = true;
 					break;
 				}
 				else {
-					ge_idx_ref = &grow_events[*ge_idx_ref].next_grow_event_of_vertex;
+					ge_idx_ref = &Q[*ge_idx_ref].next_grow_event_of_vertex;
 				}
 			}
 			if (!found) {
 				std::cout << "UPS could not find top event" << std::endl;
 			}
 			// before poping it
-			grow_events.pop();
-			if (grow_events.empty())
+			Q.pop();
+			if (Q.empty())
 				return;
 		}
 		else
 			break;
 	}
-	const grow_event& ge = grow_events[grow_events.top()];
+	const grow_event& ge = Q[Q.top()];
 	neighbor_graph& NG = *ng;
 	unsigned int vi = ge.vi;
 	const std::vector<Idx> &Ni = NG[vi];
@@ -629,11 +636,13 @@ void surface_reconstructor::perform_next_grow_event(std::vector<unsigned int>& T
 	}
 	count_triangle(vi,vj,vk);
 
-	// update priority queue
+	// update priority queue, where seam vertices are left to the seam pass
 	for (std::set<unsigned int>::const_iterator iter = VI.begin(); iter != VI.end(); ++iter) {
 		unsigned int vi = *iter;
-		remove_grow_events(vi);
-		consider_grow_events(vi);
+		if (region >= 0 && vertex_region[vi] != region)
+			continue;
+		remove_grow_events(vi, Q);
+		consider_grow_events(vi, Q, region);
 	}
 	// add new triangle
 	T.push_back(vi);
@@ -651,3 +660,162 @@ unsigned int surface_reconstructor::grow_all(std::vector<unsigned int>& T)
 	}
 	return iter;
 }
+
+bool surface_reconstructor::is_region_triangle(unsigned int vi, unsigned int vj, unsigned int vk, int region) const
+{
+	if (region < 0)
+		return true;
+	return vertex_region[vi] == region && vertex_region[vj] == region && vertex_region[vk] == region;
+}
+
+unsigned int surface_reconstructor::partition_into_regions(unsigned int nr_regions)
+{
+	neighbor_graph& NG = *ng;
+	unsigned int n = (unsigned int)NG.size();
+	// choose grid resolution by splitting the axis with the largest cell extent till the number of regions is reached
+	Box box = pc->box();
+	Dir extent = box.get_extent();
+	unsigned int res[3] = { 1, 1, 1 };
+	while (res[0] * res[1] * res[2] < nr_regions) {
+		unsigned int c = 0;
+		for (unsigned int d = 1; d < 3; ++d)
+			if (extent[d] / res[d] > extent[c] / res[c])
+				c = d;
+		++res[c];
+	}
+	vertex_region.resize(n);
+	for (unsigned int vi = 0; vi < n; ++vi) {
+		Dir rel = pc->pnt(vi) - box.get_min_pnt();
+		int ri = 0;
+		for (int d = 2; d >= 0; --d) {
+			int ci = extent[d] > 0 ? (int)(res[d] * rel[d] / extent[d]) : 0;
+			ri = ri * res[d] + std::max(0, std::min((int)res[d] - 1, ci));
+		}
+		vertex_region[vi] = ri;
+	}
+	// vertices with neighbors in other cells form the seam, where the neighbor graph can be asymmetric
+	std::vector<bool> is_seam(n, false);
+	for (unsigned int vi = 0; vi < n; ++vi) {
+		const std::vector<Idx> &Ni = NG[vi];
+		for (unsigned int j = 0; j < Ni.size(); ++j) {
+			if (vertex_region[Ni[j]] != vertex_region[vi]) {
+				is_seam[vi] = true;
+				is_seam[Ni[j]] = true;
+			}
+		}
+	}
+	for (unsigned int vi = 0; vi < n; ++vi)
+		if (is_seam[vi])
+			vertex_region[vi] = SEAM_REGION;
+	return res[0] * res[1] * res[2];
+}
+
+unsigned int surface_reconstructor::color_regions(unsigned int nr_regions, std::vector<unsigned int>& region_color) const
+{
+	const neighbor_graph& NG = *ng;
+	unsigned int n = (unsigned int)NG.size();
+	// collect for each seam vertex the regions whose vertices reach it
+	std::vector<std::vector<unsigned int> > seam_regions(n);
+	for (unsigned int vi = 0; vi < n; ++vi) {
+		if (vertex_region[vi] == SEAM_REGION)
+			continue;
+		const std::vector<Idx> &Ni = NG[vi];
+		for (unsigned int j = 0; j < Ni.size(); ++j) {
+			std::vector<unsigned int>& R = seam_regions[Ni[j]];
+			if (vertex_region[Ni[j]] == SEAM_REGION && std::find(R.begin(), R.end(), (unsigned int)vertex_region[vi]) == R.end())
+				R.push_back(vertex_region[vi]);
+		}
+	}
+	// regions sharing a seam vertex conflict
+	std::vector<std::set<unsigned int> > conflicts(nr_regions);
+	for (unsigned int vi = 0; vi < n; ++vi) {
+		const std::vector<unsigned int>& R = seam_regions[vi];
+		for (unsigned int i = 0; i < R.size(); ++i)
+			for (unsigned int j = 0; j < R.size(); ++j)
+				if (i != j)
+					conflicts[R[i]].insert(R[j]);
+	}
+	// greedy coloring in region order
+	region_color.assign(nr_regions, 0);
+	unsigned int nr_colors = nr_regions > 0 ? 1 : 0;
+	for (unsigned int ri = 0; ri < nr_regions; ++ri) {
+		std::vector<bool> used(nr_colors + 1, false);
+		for (std::set<unsigned int>::const_iterator iter = conflicts[ri].begin(); iter != conflicts[ri].end(); ++iter)
+			if (*iter < ri)
+				used[region_color[*iter]] = true;
+		unsigned int c = 0;
+		while (used[c])
+			++c;
+		region_color[ri] = c;
+		nr_colors = std::max(nr_colors, c + 1);
+	}
+	return nr_colors;
+}
+
+unsigned int surface_reconstructor::grow_all_parallel(std::vector<unsigned int>& T)
+{
+	if (directed_edge_info.empty()) {
+		std::cout << "growing only possible after construction of directed edge info" << std::endl;
+		return 0;
+	}
+	if (!ng || !pc)
+		return 0;
+	init_nr_triangles();
+	for (unsigned int i=0; i<T.size(); i+=3)
+		count_triangle(T[i],T[i+1],T[i+2]);
+	grow_events.clear();
+	first_grow_event.resize(pc->get_nr_points());
+	std::fill(first_grow_event.begin(),first_grow_event.end(),-1);
+
+	auto& scheduler = cgv::pointcloud::utility::TaskScheduler::ref_shared();
+	unsigned int nr_regions = partition_into_regions(nr_parallel_regions > 0 ? nr_parallel_regions : 8 * scheduler.get_num_threads());
+	// group vertices by region
+	unsigned int n = (unsigned int) ng->size();
+	std::vector<std::vector<unsigned int> > region_vertices(nr_regions);
+	for (unsigned int vi=0; vi<n; ++vi)
+		if (vertex_region[vi] != SEAM_REGION)
+			region_vertices[vertex_region[vi]].push_back(vi);
+
+	// All modified vertices belong to the region and all read vertices to the region or the seam. Regions
+	// that reach the same seam vertex are colored differently and never grown concurrently, such that each
+	// seam vertex is accessed by at most one region at a time.
+	std::vector<unsigned int> region_color;
+	unsigned int nr_colors = color_regions(nr_regions, region_color);
+	std::vector<std::vector<unsigned int> > region_triangles(nr_regions);
+	std::vector<unsigned int> region_iterations(nr_regions, 0);
+	for (unsigned int c = 0; c < nr_colors; ++c) {
+		std::vector<unsigned int> batch;
+		for (unsigned int ri = 0; ri < nr_regions; ++ri)
+			if (region_color[ri] == c && !region_vertices[ri].empty())
+				batch.push_back(ri);
+		scheduler.parallel_for(0, int64_t(batch.size()), 1, [&](int64_t begin, int64_t end) {
+			for (int64_t bi = begin; bi < end; ++bi) {
+				unsigned int ri = batch[bi];
+				int region = int(ri);
+				grow_event_queue Q;
+				for (unsigned int i=0; i<region_vertices[ri].size(); ++i)
+					consider_grow_events(region_vertices[ri][i], Q, region);
+				while (!Q.empty()) {
+					perform_next_grow_event(region_triangles[ri], Q, region);
+					++region_iterations[ri];
+				}
+				// event indices refer to the destroyed queue
+				for (unsigned int i=0; i<region_vertices[ri].size(); ++i)
+					first_grow_event[region_vertices[ri][i]] = -1;
+			}
+		});
+	}
+	unsigned int iter = 0;
+	for (unsigned int ri=0; ri<nr_regions; ++ri) {
+		T.insert(T.end(), region_triangles[ri].begin(), region_triangles[ri].end());
+		iter += region_iterations[ri];
+	}
+
+	// resolve the seams with the serial algorithm on the global queue
+	for (unsigned int vi=0; vi<n; ++vi)
+		consider_grow_events(vi);
+	geqs.init();
+	for (unsigned int i=0; i<grow_events.size(); ++i)
+		geqs.update(grow_events[i].quality);
+	return iter + grow_all(T);
+}
@@ -119,6 +119,52 @@ void construct_point_cloud(
 		}
 	}
 }
+size_t unproject_depth_frame(
+	const frame_type& depth_frame,
+	const std::vector<cgv::math::fvec<float, 2>>& ray_table,
+	float depth_scale,
+	float* points,
+	const frame_type* warped_color_frame,
+	cgv::media::color<uint8_t, cgv::media::RGB>* colors)
+{
+	int w = depth_frame.width, h = depth_frame.height;
+	size_t n = size_t(w) * h;
+	if (n == 0 || depth_frame.get_nr_bytes_per_pixel() != 2 || depth_frame.frame_data.size() < 2 * n || ray_table.size() < n)
+		return 0;
+	const uint16_t* depths = reinterpret_cast<const uint16_t*>(depth_frame.frame_data.data());
+	const float* rays = &ray_table.front()[0];
+	const uint8_t* color_data = 0;
+	unsigned color_stride = 0;
+	if (colors && warped_color_frame && warped_color_frame->width == w && warped_color_frame->height == h) {
+		color_stride = warped_color_frame->get_nr_bytes_per_pixel();
+		if (color_stride >= 3 && warped_color_frame->frame_data.size() >= color_stride * n)
+			color_data = reinterpret_cast<const uint8_t*>(warped_color_frame->frame_data.data());
+	}
+	long long nr_valid = 0;
+#pragma omp parallel for reduction(+:nr_valid)
+	for (int y = 0; y < h; ++y) {
+		const uint16_t* d = depths + size_t(y) * w;
+		const float* r = rays + 2 * size_t(y) * w;
+		float* p = points + 3 * size_t(y) * w;
+		int nr_valid_in_row = 0;
+		for (int x = 0; x < w; ++x) {
+			// invalid rays and zero depth both result in z = 0 without branching
+			float z = (r[2 * x] < -1000.0f ? 0.0f : depth_scale) * d[x];
+			p[3 * x] = z * r[2 * x];
+			p[3 * x + 1] = z * r[2 * x + 1];
+			p[3 * x + 2] = z;
+			nr_valid_in_row += z > 0.0f ? 1 : 0;
+		}
+		nr_valid += nr_valid_in_row;
+		if (color_data) {
+			const uint8_t* c = color_data + size_t(y) * w * color_stride;
+			cgv::media::color<uint8_t, cgv::media::RGB>* C = colors + size_t(y) * w;
+			for (int x = 0; x < w; ++x, c += color_stride)
+				C[x] = cgv::media::color<uint8_t, cgv::media::RGB>(c[2], c[1], c[0]);
+		}
+	}
+	return size_t(nr_valid);
+}
 void compute_distortion_map(const rgbd_calibration& calib,
 	std::vector<cgv::math::fvec<float, 2>>& distortion_map,
 	unsigned sub_sample, const cgv::math::fvec<float, 2>& invalid_point,
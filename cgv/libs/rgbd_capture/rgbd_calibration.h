@@ -49,6 +49,22 @@ namespace rgbd {
 		double eps = cgv::math::distortion_inversion_epsilon<double>(),
 		unsigned max_nr_iterations = cgv::math::camera<double>::get_standard_max_nr_iterations(),
 		double slow_down = cgv::math::camera<double>::get_standard_slow_down());
+	//! unproject a complete depth frame with a per pixel ray table into preallocated point and color buffers
+	/*! The ray table provides per pixel the xy-coordinates of the point at depth one, i.e. the undistorted
+	    image coordinates as computed by compute_distortion_map() without sub sampling, where x-coordinates
+		below -1000 mark pixels without valid ray. The depth frame needs 16 bit depth values, which are
+		multiplied with depth_scale. The points buffer needs space for 3*width*height floats and is filled
+		per pixel, such that pixels without valid depth or ray result in the origin. If colors is given, it
+		needs space for width*height colors that are copied from a warped color frame of the depth frame
+		size in BGR(A) byte order. Rows are processed in parallel with a branch free inner loop that the
+		compiler can vectorize. Returns the number of valid points. */
+	extern CGV_API size_t unproject_depth_frame(
+		const frame_type& depth_frame,
+		const std::vector<cgv::math::fvec<float, 2>>& ray_table,
+		float depth_scale,
+		float* points,
+		const frame_type* warped_color_frame = 0,
+		cgv::media::color<uint8_t, cgv::media::RGB>* colors = 0);
 	/// compute distortion map from calibration and camera model inversion parameters
 	extern CGV_API void compute_distortion_map(const rgbd_calibration& calib,
 		std::vector<cgv::math::fvec<float, 2>>& distortion_map,
@@ -0,0 +1,370 @@
+#include "rgbd_container.h"
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <zlib.h>
+
+namespace rgbd {
+
+	namespace {
+		const char header_magic[8] = "RGBDC01";
+		const char footer_magic[8] = "RGBDIX1";
+		struct container_footer
+		{
+			uint64_t index_offset;
+			uint64_t nr_frames;
+			char magic[8];
+		};
+		bool is_delta_compressible(const container_frame_entry& e)
+		{
+			return e.nr_bits_per_pixel == 16 && e.buffer_size == 2 * uint32_t(e.width) * uint32_t(e.height) &&
+				(e.pixel_format == PF_DEPTH || e.pixel_format == PF_DEPTH_AND_PLAYER || e.pixel_format == PF_I);
+		}
+		/// replace 16 bit values by differences to left neighbor, split them into byte planes and deflate
+		bool delta_compress(const container_frame_entry& e, const std::vector<char>& data, std::vector<char>& compressed)
+		{
+			size_t n = size_t(e.width) * e.height;
+			const uint16_t* values = reinterpret_cast<const uint16_t*>(data.data());
+			std::vector<Bytef> planes(2 * n);
+			size_t i = 0;
+			for (int y = 0; y < e.height; ++y) {
+				uint16_t prev = 0;
+				for (int x = 0; x < e.width; ++x, ++i) {
+					uint16_t delta = uint16_t(values[i] - prev);
+					prev = values[i];
+					planes[i] = Bytef(delta & 255);
+					planes[n + i] = Bytef(delta >> 8);
+				}
+			}
+			uLongf size = compressBound(uLong(2 * n));
+			compressed.resize(size);
+			if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &size, planes.data(), uLong(2 * n), Z_BEST_SPEED) != Z_OK)
+				return false;
+			compressed.resize(size);
+			return true;
+		}
+		bool delta_decompress(const container_frame_entry& e, const char* compressed, std::vector<char>& data)
+		{
+			size_t n = size_t(e.width) * e.height;
+			std::vector<Bytef> planes(2 * n);
+			uLongf size = uLongf(2 * n);
+			if (uncompress(planes.data(), &size, reinterpret_cast<const Bytef*>(compressed), uLong(e.data_size)) != Z_OK || size != 2 * n)
+				return false;
+			data.resize(2 * n);
+			uint16_t* values = reinterpret_cast<uint16_t*>(data.data());
+			size_t i = 0;
+			for (int y = 0; y < e.height; ++y) {
+				uint16_t prev = 0;
+				for (int x = 0; x < e.width; ++x, ++i) {
+					prev = uint16_t(prev + (planes[i] | (uint16_t(planes[n + i]) << 8)));
+					values[i] = prev;
+				}
+			}
+			return true;
+		}
+	}
+
+	ContainerStream get_container_stream(InputStreams is)
+	{
+		switch (is) {
+		case IS_COLOR: return CS_COLOR;
+		case IS_DEPTH: return CS_DEPTH;
+		case IS_INFRARED: return CS_INFRARED;
+		case IS_MESH: return CS_MESH;
+		default: return CS_END;
+		}
+	}
+
+	rgbd_container_writer::rgbd_container_writer() : fp(0)
+	{
+		compress_depth = true;
+		write_failed = false;
+		max_nr_pending_frames = 16;
+		nr_pending_frames = 0;
+		nr_submitted_frames = nr_written_frames = 0;
+		stop_workers = false;
+	}
+	rgbd_container_writer::~rgbd_container_writer()
+	{
+		close();
+	}
+	bool rgbd_container_writer::open(const std::string& file_name, const std::vector<stream_format>& stream_formats, const emulator_parameters* parameters,
+		bool _compress_depth, unsigned nr_workers, size_t _max_nr_pending_frames)
+	{
+		close();
+		fp = fopen(file_name.c_str(), "wb");
+		if (!fp)
+			return false;
+		// write header
+		uint32_t has_parameters = parameters ? 1 : 0;
+		emulator_parameters params;
+		std::memset(&params, 0, sizeof(params));
+		if (parameters)
+			params = *parameters;
+		// stream formats are assigned to container streams by their pixel format
+		std::vector<std::pair<uint32_t, stream_format>> formats;
+		for (const auto& sf : stream_formats) {
+			switch (sf.pixel_format) {
+			case PF_I: formats.push_back({ CS_INFRARED, sf }); break;
+			case PF_DEPTH:
+			case PF_DEPTH_AND_PLAYER: formats.push_back({ CS_DEPTH, sf }); break;
+			case PF_POINTS_AND_TRIANGLES: formats.push_back({ CS_MESH, sf }); break;
+			case PF_CONFIDENCE: break;
+			default: formats.push_back({ CS_COLOR, sf }); break;
+			}
+		}
+		uint32_t nr_formats = uint32_t(formats.size());
+		bool success = fwrite(header_magic, 1, 8, fp) == 8 && fwrite(&has_parameters, 4, 1, fp) == 1 &&
+			fwrite(&params, sizeof(params), 1, fp) == 1 && fwrite(&nr_formats, 4, 1, fp) == 1;
+		for (const auto& f : formats)
+			success = success && fwrite(&f.first, 4, 1, fp) == 1 && fwrite(&f.second, sizeof(stream_format), 1, fp) == 1;
+		if (!success) {
+			fclose(fp);
+			fp = 0;
+			return false;
+		}
+		file_offset = 8 + 4 + sizeof(params) + 4 + formats.size() * (4 + sizeof(stream_format));
+		compress_depth = _compress_depth;
+		write_failed = false;
+		max_nr_pending_frames = std::max(_max_nr_pending_frames, size_t(1));
+		nr_pending_frames = 0;
+		nr_submitted_frames = nr_written_frames = 0;
+		stop_workers = false;
+		index.clear();
+		if (nr_workers == 0)
+			nr_workers = std::max(std::thread::hardware_concurrency(), 1u);
+		for (unsigned i = 0; i < nr_workers; ++i)
+			workers.push_back(std::thread(&rgbd_container_writer::work, this));
+		return true;
+	}
+	bool rgbd_container_writer::write_frame(ContainerStream cs, const frame_type& frame, uint32_t frame_index)
+	{
+		if (!fp || cs == CS_END || frame.frame_data.empty())
+			return false;
+		job* j = new job;
+		container_frame_entry& e = j->entry;
+		std::memset(&e, 0, sizeof(e));
+		e.stream = cs;
+		e.compression = CC_NONE;
+		e.width = frame.width;
+		e.height = frame.height;
+		e.pixel_format = frame.pixel_format;
+		e.nr_bits_per_pixel = frame.nr_bits_per_pixel;
+		e.buffer_size = uint32_t(frame.frame_data.size());
+		e.frame_index = frame_index;
+		e.time = frame.time;
+		e.system_time_stamp = frame.system_time_stamp;
+		e.device_time_stamp = frame.device_time_stamp;
+		j->data = frame.frame_data;
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			space_cv.wait(lock, [this] { return nr_pending_frames < max_nr_pending_frames; });
+			if (write_failed) {
+				delete j;
+				return false;
+			}
+			j->sequence_index = nr_submitted_frames++;
+			++nr_pending_frames;
+			queue.push_back(j);
+		}
+		queue_cv.notify_one();
+		return true;
+	}
+	void rgbd_container_writer::work()
+	{
+		std::vector<char> compressed;
+		for (;;) {
+			job* j;
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				queue_cv.wait(lock, [this] { return stop_workers || !queue.empty(); });
+				if (queue.empty())
+					return;
+				j = queue.front();
+				queue.pop_front();
+			}
+			container_frame_entry& e = j->entry;
+			if (compress_depth && is_delta_compressible(e) && delta_compress(e, j->data, compressed) && compressed.size() < j->data.size()) {
+				j->data.swap(compressed);
+				e.compression = CC_DELTA_ZLIB;
+			}
+			e.data_size = j->data.size();
+			// wait for turn such that frames are written in the order of submission
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				write_cv.wait(lock, [this, j] { return nr_written_frames == j->sequence_index; });
+			}
+			e.data_offset = file_offset + sizeof(container_frame_entry);
+			bool success = fwrite(&e, sizeof(e), 1, fp) == 1 && fwrite(j->data.data(), 1, j->data.size(), fp) == j->data.size();
+			file_offset = e.data_offset + e.data_size;
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				if (success)
+					index.push_back(e);
+				else
+					write_failed = true;
+				++nr_written_frames;
+				--nr_pending_frames;
+			}
+			write_cv.notify_all();
+			space_cv.notify_one();
+			delete j;
+		}
+	}
+	bool rgbd_container_writer::close()
+	{
+		if (!fp)
+			return false;
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			write_cv.wait(lock, [this] { return nr_written_frames == nr_submitted_frames; });
+			stop_workers = true;
+		}
+		queue_cv.notify_all();
+		for (auto& w : workers)
+			w.join();
+		workers.clear();
+		container_footer footer;
+		footer.index_offset = file_offset;
+		footer.nr_frames = index.size();
+		std::memcpy(footer.magic, footer_magic, 8);
+		bool success = !write_failed;
+		if (!index.empty())
+			success = fwrite(index.data(), sizeof(container_frame_entry), index.size(), fp) == index.size() && success;
+		success = fwrite(&footer, sizeof(footer), 1, fp) == 1 && success;
+		fclose(fp);
+		fp = 0;
+		return success;
+	}
+
+	rgbd_container_reader::rgbd_container_reader()
+	{
+		close();
+	}
+	void rgbd_container_reader::close()
+	{
+		file.close();
+		has_parameters = false;
+		for (unsigned cs = 0; cs < CS_END; ++cs) {
+			has_stream_format[cs] = false;
+			entries[cs].clear();
+		}
+	}
+	bool rgbd_container_reader::open(const std::string& file_name)
+	{
+		close();
+		if (!file.open(file_name))
+			return false;
+		const char* data = file.get_data();
+		size_t size = file.get_size();
+		size_t offset = 8 + 4 + sizeof(emulator_parameters) + 4;
+		if (size < offset || std::memcmp(data, header_magic, 8) != 0) {
+			close();
+			return false;
+		}
+		uint32_t value;
+		std::memcpy(&value, data + 8, 4);
+		has_parameters = value != 0;
+		std::memcpy(&parameters, data + 12, sizeof(emulator_parameters));
+		uint32_t nr_formats;
+		std::memcpy(&nr_formats, data + offset - 4, 4);
+		for (uint32_t i = 0; i < nr_formats; ++i) {
+			if (offset + 4 + sizeof(stream_format) > size) {
+				close();
+				return false;
+			}
+			uint32_t cs;
+			std::memcpy(&cs, data + offset, 4);
+			if (cs < CS_END) {
+				has_stream_format[cs] = true;
+				std::memcpy(&stream_formats[cs], data + offset + 4, sizeof(stream_format));
+			}
+			offset += 4 + sizeof(stream_format);
+		}
+		// warped color frames have the color format with the size of the depth frames
+		if (has_stream_format[CS_COLOR] && has_stream_format[CS_DEPTH]) {
+			has_stream_format[CS_WARPED_COLOR] = true;
+			stream_formats[CS_WARPED_COLOR] = stream_formats[CS_COLOR];
+			static_cast<frame_size&>(stream_formats[CS_WARPED_COLOR]) = stream_formats[CS_DEPTH];
+			stream_formats[CS_WARPED_COLOR].compute_buffer_size();
+		}
+		// read frame index from footer or reconstruct it from the frame entries
+		std::vector<container_frame_entry> index;
+		container_footer footer;
+		if (size >= offset + sizeof(footer))
+			std::memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+		if (size >= offset + sizeof(footer) && std::memcmp(footer.magic, footer_magic, 8) == 0 &&
+			footer.index_offset + footer.nr_frames * sizeof(container_frame_entry) + sizeof(footer) == size) {
+			index.resize(size_t(footer.nr_frames));
+			if (!index.empty())
+				std::memcpy(index.data(), data + footer.index_offset, index.size() * sizeof(container_frame_entry));
+		}
+		else {
+			while (offset + sizeof(container_frame_entry) <= size) {
+				container_frame_entry e;
+				std::memcpy(&e, data + offset, sizeof(e));
+				if (e.stream >= CS_END || e.data_offset != offset + sizeof(e) || e.data_offset + e.data_size > size)
+					break;
+				index.push_back(e);
+				offset = size_t(e.data_offset + e.data_size);
+			}
+		}
+		for (const auto& e : index) {
+			if (e.stream >= CS_END || e.data_offset + e.data_size > size) {
+				close();
+				return false;
+			}
+			entries[e.stream].push_back(e);
+		}
+		for (unsigned cs = 0; cs < CS_END; ++cs)
+			std::stable_sort(entries[cs].begin(), entries[cs].end(),
+				[](const container_frame_entry& e1, const container_frame_entry& e2) { return e1.frame_index < e2.frame_index; });
+		file.advise(cgv::utils::mapped_file::AH_SEQUENTIAL);
+		return true;
+	}
+	bool rgbd_container_reader::get_emulator_parameters(emulator_parameters& _parameters) const
+	{
+		if (!has_parameters)
+			return false;
+		_parameters = parameters;
+		return true;
+	}
+	size_t rgbd_container_reader::find_frame(ContainerStream cs, uint32_t frame_index) const
+	{
+		const auto& E = entries[cs];
+		auto iter = std::lower_bound(E.begin(), E.end(), frame_index,
+			[](const container_frame_entry& e, uint32_t fi) { return e.frame_index < fi; });
+		if (iter == E.end() || iter->frame_index != frame_index)
+			return size_t(-1);
+		return size_t(iter - E.begin());
+	}
+	bool rgbd_container_reader::read_frame(ContainerStream cs, size_t i, frame_type& frame) const
+	{
+		if (i >= entries[cs].size())
+			return false;
+		const container_frame_entry& e = entries[cs][i];
+		frame.width = e.width;
+		frame.height = e.height;
+		frame.pixel_format = PixelFormat(e.pixel_format);
+		frame.nr_bits_per_pixel = e.nr_bits_per_pixel;
+		frame.buffer_size = e.buffer_size;
+		frame.frame_index = e.frame_index;
+		frame.time = e.time;
+		frame.system_time_stamp = e.system_time_stamp;
+		frame.device_time_stamp = e.device_time_stamp;
+		const char* stored_data = file.get_pointer<char>(size_t(e.data_offset));
+		switch (e.compression) {
+		case CC_NONE:
+			if (e.data_size != e.buffer_size)
+				return false;
+			frame.frame_data.resize(e.buffer_size);
+			std::memcpy(frame.frame_data.data(), stored_data, e.buffer_size);
+			return true;
+		case CC_DELTA_ZLIB:
+			return is_delta_compressible(e) && delta_decompress(e, stored_data, frame.frame_data);
+		default:
+			std::cerr << "rgbd_container_reader::read_frame: unknown compression " << e.compression << std::endl;
+			return false;
+		}
+	}
+}
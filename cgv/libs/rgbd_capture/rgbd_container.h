@@ -0,0 +1,140 @@
+#pragma once
+
+#include "rgbd_device.h"
+#include <cgv/utils/mapped_file.h>
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "lib_begin.h"
+
+namespace rgbd {
+
+	/// streams stored in an rgbd container
+	enum ContainerStream {
+		CS_COLOR,
+		CS_DEPTH,
+		CS_INFRARED,
+		CS_MESH,
+		CS_WARPED_COLOR,
+		CS_END
+	};
+	/// return container stream of a single input stream or CS_END if not supported
+	extern CGV_API ContainerStream get_container_stream(InputStreams is);
+
+	/// compression of frame data in an rgbd container
+	enum ContainerCompression {
+		CC_NONE,
+		/// 16 bit values are replaced by differences to their left neighbor, split into low and high byte planes and deflated with zlib
+		CC_DELTA_ZLIB
+	};
+
+	/// description of a frame stored in an rgbd container, which precedes the frame data and is repeated in the frame index
+	struct container_frame_entry
+	{
+		/// offset and size of stored frame data in file
+		uint64_t data_offset;
+		uint64_t data_size;
+		/// container stream and compression of frame
+		uint32_t stream;
+		uint32_t compression;
+		/// frame format
+		int32_t width, height;
+		uint32_t pixel_format, nr_bits_per_pixel;
+		/// size of uncompressed frame data
+		uint32_t buffer_size;
+		/// index of frame in the protocol, where warped color frames share the index of their color frame
+		uint32_t frame_index;
+		/// time stamps of frame
+		double time;
+		int64_t system_time_stamp;
+		int64_t device_time_stamp;
+	};
+
+	/** writes frames of an rgbd device into a single container file. The file starts with a header storing the stream
+	    formats and emulator parameters, followed by one container_frame_entry and the frame data per frame and ends
+		with an index of all frame entries and a footer. Frames are compressed by a pool of worker threads and written
+		in the order of submission. The number of frames that were submitted but not yet written is bounded, such that
+		write_frame() blocks if the disk cannot keep up. */
+	class CGV_API rgbd_container_writer
+	{
+	protected:
+		struct job
+		{
+			uint64_t sequence_index;
+			container_frame_entry entry;
+			std::vector<char> data;
+		};
+		FILE* fp;
+		/// offset of next frame entry in file, which is only accessed by the worker writing the next frame
+		uint64_t file_offset;
+		bool compress_depth;
+		bool write_failed;
+		std::vector<std::thread> workers;
+		std::mutex mtx;
+		std::condition_variable queue_cv, space_cv, write_cv;
+		std::deque<job*> queue;
+		size_t max_nr_pending_frames, nr_pending_frames;
+		uint64_t nr_submitted_frames, nr_written_frames;
+		bool stop_workers;
+		std::vector<container_frame_entry> index;
+		/// compress jobs from queue and write them in order
+		void work();
+	public:
+		/// construct writer without file
+		rgbd_container_writer();
+		/// close file
+		~rgbd_container_writer();
+		/** create container file for the given stream formats and optional emulator parameters. nr_workers defaults to
+		    the number of hardware threads and max_nr_pending_frames bounds the number of frames held in memory. */
+		bool open(const std::string& file_name, const std::vector<stream_format>& stream_formats, const emulator_parameters* parameters = 0,
+			bool compress_depth = true, unsigned nr_workers = 0, size_t max_nr_pending_frames = 16);
+		/// return whether file is open
+		bool is_open() const { return fp != 0; }
+		/// copy frame into write queue, blocks while the queue is full, return false if not open or writing failed before
+		bool write_frame(ContainerStream cs, const frame_type& frame, uint32_t frame_index);
+		/// wait for pending frames, write index and close file, return whether all frames have been written successfully
+		bool close();
+		/// return number of frames written to file
+		uint64_t get_nr_written_frames() const { return nr_written_frames; }
+	};
+
+	/** read access to an rgbd container through a memory mapping. If the index is missing after a crash, it is
+	    reconstructed by scanning the frame entries. */
+	class CGV_API rgbd_container_reader
+	{
+	protected:
+		cgv::utils::mapped_file file;
+		bool has_stream_format[CS_END];
+		stream_format stream_formats[CS_END];
+		bool has_parameters;
+		emulator_parameters parameters;
+		/// per container stream entries of frames in the order of the frame indices
+		std::vector<container_frame_entry> entries[CS_END];
+	public:
+		/// construct reader without container
+		rgbd_container_reader();
+		/// map container file and read index, return false if file is no valid container
+		bool open(const std::string& file_name);
+		/// unmap file
+		void close();
+		/// return whether container is open
+		bool is_open() const { return file.is_open(); }
+		/// check for stream in container
+		bool has_stream(ContainerStream cs) const { return has_stream_format[cs]; }
+		/// return format of stream
+		const stream_format& get_stream_format(ContainerStream cs) const { return stream_formats[cs]; }
+		/// copy emulator parameters if stored in container
+		bool get_emulator_parameters(emulator_parameters& _parameters) const;
+		/// return number of frames stored for stream
+		size_t get_nr_frames(ContainerStream cs) const { return entries[cs].size(); }
+		/// return position of frame with given frame index in stream or -1 if not found
+		size_t find_frame(ContainerStream cs, uint32_t frame_index) const;
+		/// read i-th frame of stream and decompress it
+		bool read_frame(ContainerStream cs, size_t i, frame_type& frame) const;
+	};
+}
+
+#include <cgv/config/lib_end.h>
@@ -35,6 +35,20 @@ namespace rgbd {
 		return false;
 	}
 
+	//camera parameters used if no parameters have been saved with the protocol
+	const emulator_parameters& get_default_emulator_parameters()
+	{
+		static emulator_parameters default_intrinsics;
+		static bool initialized_default_parameters = false;
+		if (!initialized_default_parameters){
+			default_intrinsics.intrinsics = { 5.9421434211923247e+02, 5.9104053696870778e+02,
+					3.3930780975300314e+02,2.4273913761751615e+02,0.0 };
+			default_intrinsics.depth_scale = 1.0;
+			initialized_default_parameters = true;
+		}
+		return default_intrinsics;
+	}
+
 	rgbd_emulation::rgbd_emulation(const std::string& fn):device_is_running(false)
 	{
 		path_name = fn;
@@ -44,6 +58,27 @@ namespace rgbd {
 		last_depth_frame_time = 0;
 		last_ir_frame_time = 0;
 		last_mesh_frame_time = 0;
+		warped_frame_index = -1;
+
+		//a single container file replaces the directory of frame files
+		if (container.open(path_name)) {
+			for (unsigned cs = 0; cs < CS_END; ++cs)
+				container_positions[cs] = 0;
+			has_color_stream = container.has_stream(CS_COLOR);
+			has_depth_stream = container.has_stream(CS_DEPTH);
+			has_ir_stream = container.has_stream(CS_INFRARED);
+			has_mesh_stream = container.has_stream(CS_MESH);
+			color_stream = container.get_stream_format(CS_COLOR);
+			depth_stream = container.get_stream_format(CS_DEPTH);
+			ir_stream = container.get_stream_format(CS_INFRARED);
+			mesh_stream = container.get_stream_format(CS_MESH);
+			number_of_files = 0;
+			for (unsigned cs = 0; cs < CS_END; ++cs)
+				number_of_files += container.get_nr_frames(ContainerStream(cs));
+			if (!container.get_emulator_parameters(parameters))
+				parameters = get_default_emulator_parameters();
+			return;
+		}
 
 		//list of supported extensions
 		static vector<string> color_exts = {"rgb", "bgr", "rgba", "bgra", "byr"};
@@ -70,14 +105,7 @@ namespace rgbd {
 		number_of_files = file_count;
 		
 		//find camera parameters
-		static emulator_parameters default_intrinsics;
-		static bool initialized_default_parameters = false;
-		if (!initialized_default_parameters){
-			default_intrinsics.intrinsics = { 5.9421434211923247e+02, 5.9104053696870778e+02,
-					3.3930780975300314e+02,2.4273913761751615e+02,0.0 };
-			default_intrinsics.depth_scale = 1.0;
-			initialized_default_parameters = true;
-		}
+		const emulator_parameters& default_intrinsics = get_default_emulator_parameters();
 
 		string data;
 		string emulator_parameters_file_name = path_name + "/emulator_parameters";
@@ -107,6 +135,7 @@ namespace rgbd {
 	
 	bool rgbd_emulation::detach()
 	{
+		container.close();
 		path_name = "";
 		return true;
 	}
@@ -312,6 +341,26 @@ namespace rgbd {
 		}
 		*last_frame_time = current_frame_time;
 
+		//read next frame of stream from container
+		if (container.is_open()) {
+			ContainerStream cs = get_container_stream(is);
+			size_t nr_frames = container.get_nr_frames(cs);
+			if (nr_frames == 0)
+				return false;
+			size_t& pos = container_positions[cs];
+			if (pos >= nr_frames)
+				pos = 0;
+			if (!container.read_frame(cs, pos, frame)) {
+				cerr << "rgbd_emulation: could not read frame " << pos << " from " << path_name << '\n';
+				return false;
+			}
+			++pos;
+			if (is == IS_COLOR)
+				warped_frame_index = int(frame.frame_index);
+			frame.time = current_frame_time;
+			return true;
+		}
+
 		//check index
 		if (idx >= number_of_files) idx = 0;
 		frame.frame_index = idx;
@@ -352,6 +401,12 @@ namespace rgbd {
 	void rgbd_emulation::map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame,
 		frame_type& warped_color_frame) const
 	{
+		if (container.is_open()) {
+			size_t i = warped_frame_index == -1 ? size_t(-1) : container.find_frame(CS_WARPED_COLOR, uint32_t(warped_frame_index));
+			if (i == size_t(-1) || !container.read_frame(CS_WARPED_COLOR, i, warped_color_frame))
+				std::cerr << "map_color_to_depth() no warped frame saved for frame " << warped_frame_index << std::endl;
+			return;
+		}
 		if (next_warped_file_name.empty()) {
 			std::cerr << "map_color_to_depth() no warped frames saved" << std::endl;
 			return;
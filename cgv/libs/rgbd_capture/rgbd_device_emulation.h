@@ -1,11 +1,12 @@
 #include "rgbd_device.h"
+#include "rgbd_container.h"
 #include <chrono>
 
 using namespace std;
 
 namespace rgbd {
 
-/// The rgdb device emulator uses protocols created by rgbd_input for replay
+/// The rgdb device emulator uses protocols created by rgbd_input for replay, either a directory of frame files or a container file
 class rgbd_emulation : public rgbd_device
 {
 public:
@@ -56,6 +57,12 @@ private:
 	//frame_type next_color_frame, next_depth_frame, next_ir_frame,next_mesh_frame;
 	size_t number_of_files;
 	emulator_parameters parameters;
+	/// container of protocol if protocol is stored in single file
+	rgbd_container_reader container;
+	/// per container stream position of next frame
+	size_t container_positions[CS_END];
+	/// frame index of last color frame used to look up warped color frame in container
+	int warped_frame_index;
 };
 
 }
\ No newline at end of file
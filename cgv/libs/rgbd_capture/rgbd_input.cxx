@@ -1,10 +1,12 @@
 #include <iostream>
 #include <algorithm>
 #include <future>
+#include <cmath>
 #include "rgbd_input.h"
 #include "rgbd_device_emulation.h"
 #include <cgv/utils/file.h>
 #include <cgv/utils/convert.h>
+#include <cgv/utils/scan.h>
 
 using namespace std;
 
@@ -84,6 +86,7 @@ rgbd_input::rgbd_input()
 	protocol_write_async = true;
 	protocol_idx = 0;
 	protocol_flags = 0;
+	next_warped_protocol_idx = -1;
 }
 
 rgbd_input::~rgbd_input()
@@ -98,6 +101,10 @@ rgbd_input::rgbd_input(const string& serial)
 {
 	rgbd = 0;
 	started = false;
+	protocol_write_async = true;
+	protocol_idx = 0;
+	protocol_flags = 0;
+	next_warped_protocol_idx = -1;
 	attach(serial);
 }
 
@@ -191,6 +198,7 @@ bool rgbd_input::detach()
 	rgbd->detach();
 	delete rgbd;
 	rgbd = 0;
+	depth_ray_table.clear();
 	return true;
 }
 
@@ -200,12 +208,32 @@ void write_protocol_headers(vector<stream_format> streams,std::string path) {
 	}
 }
 
+static bool is_container_file_name(const std::string& path)
+{
+	return cgv::utils::to_lower(cgv::utils::file::get_extension(path)) == "rgbdc";
+}
+
+void rgbd_input::open_protocol_container()
+{
+	emulator_parameters parameters;
+	bool has_parameters = rgbd->get_emulator_configuration(parameters);
+	if (!protocol_container.open(protocol_path, streams, has_parameters ? &parameters : 0))
+		cerr << "rgbd_input: could not open protocol container " << protocol_path << endl;
+}
+
 void rgbd_input::enable_protocol(const std::string& path)
 {
+	protocol_container.close();
 	protocol_path = path;
 	protocol_idx  = 0;
 	protocol_flags = 0;
+	next_warped_protocol_idx = -1;
 
+	if (is_container_file_name(path)) {
+		if (is_started())
+			open_protocol_container();
+		return;
+	}
 	//write the metadata for every stream found
 	if (is_started()) {
 		write_protocol_headers(streams, path);
@@ -220,6 +248,7 @@ void rgbd_input::enable_protocol(const std::string& path)
 /// disable protocolation
 void rgbd_input::disable_protocol()
 {
+	protocol_container.close();
 	protocol_path = "";
 	protocol_idx  = 0;
 	protocol_flags = 0;
@@ -228,6 +257,10 @@ void rgbd_input::disable_protocol()
 void rgbd::rgbd_input::clear_protocol(const string& path)
 {
 	cout << "rgbd::rgbd_input::clear_protocol: removing old protocol\n";
+	if (is_container_file_name(path)) {
+		cgv::utils::file::remove(path);
+		return;
+	}
 	cgv::utils::file::remove(path + "/emulator_parameters");
 	static const char* exts[] = {
 	"ir", "rgb", "bgr", "rgba", "bgra", "byr", "dep", "d_p", "p_tri"
@@ -325,7 +358,12 @@ bool rgbd_input::start(InputStreams is, std::vector<stream_format>& stream_forma
 		return true;
 	started = rgbd->start_device(is, stream_formats);
 	streams = stream_formats;
-	if (!protocol_path.empty()) {
+	depth_ray_table.clear();
+	if (is_container_file_name(protocol_path)) {
+		if (started && !protocol_container.is_open())
+			open_protocol_container();
+	}
+	else if (!protocol_path.empty()) {
 		write_protocol_headers(streams, protocol_path);
 		//write camera parameters
 		emulator_parameters parameters;
@@ -361,7 +399,12 @@ bool rgbd_input::start(const std::vector<stream_format>& stream_formats)
 		return true;
 	started = rgbd->start_device(stream_formats);
 	streams = stream_formats;
-	if (!protocol_path.empty()) {
+	depth_ray_table.clear();
+	if (is_container_file_name(protocol_path)) {
+		if (started && !protocol_container.is_open())
+			open_protocol_container();
+	}
+	else if (!protocol_path.empty()) {
 		write_protocol_headers(streams, protocol_path);
 	}
 	return started;
@@ -425,7 +468,15 @@ bool rgbd_input::get_frame(InputStreams is, frame_type& frame, int timeOut)
 		return false;
 	}
 	if (rgbd->get_frame(is, frame, timeOut)) {
-		if (!protocol_path.empty()) {
+		if (protocol_container.is_open()) {
+			if ((is & IS_COLOR) != 0)
+				next_warped_protocol_idx = protocol_idx;
+			if (!protocol_container.write_frame(get_container_stream(is), frame, protocol_idx))
+				std::cerr << "rgbd_input::get_frame: could not protocol frame to " << protocol_path << std::endl;
+			else
+				++protocol_idx;
+		}
+		else if (!protocol_path.empty()) {
 			string fn = compose_file_name(protocol_path + "/kinect_", frame, protocol_idx);
 			if ((is & IS_COLOR) != 0) {
 				next_warped_file_name = compose_file_name(protocol_path + "/warped_", frame, protocol_idx);
@@ -449,6 +500,11 @@ void rgbd_input::map_color_to_depth(const frame_type& depth_frame, const frame_t
 		return;
 	}
 	rgbd->map_color_to_depth(depth_frame, color_frame, warped_color_frame);
+	if (protocol_container.is_open() && next_warped_protocol_idx != -1) {
+		if (!protocol_container.write_frame(CS_WARPED_COLOR, warped_color_frame, next_warped_protocol_idx))
+			std::cerr << "rgbd_input::map_color_to_depth: could not protocol frame to " << protocol_path << std::endl;
+		next_warped_protocol_idx = -1;
+	}
 	if (!next_warped_file_name.empty()) {
 		if (!write_protocol_frame_async(next_warped_file_name, warped_color_frame))
 			std::cerr << "rgbd_input::map_color_to_depth: could not protocol frame to " << next_warped_file_name << std::endl;
@@ -466,4 +522,56 @@ bool rgbd_input::map_depth_to_point(int x, int y, int depth, float* point_ptr) c
 	return rgbd->map_depth_to_point(x, y, depth, point_ptr);
 }
 
+bool rgbd_input::compute_depth_ray_table(int width, int height) const
+{
+	// sample the device mapping at a reference depth, which is exact for all mappings linear in depth
+	static const int reference_depth = 1000;
+	depth_ray_table.assign(size_t(width) * height, cgv::math::fvec<float, 2>(-10000.0f));
+	depth_ray_table_size.width = width;
+	depth_ray_table_size.height = height;
+	depth_ray_scale = 0;
+	float scale = 0;
+	size_t i = 0;
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x, ++i) {
+			float p[3];
+			bool valid = rgbd->map_depth_to_point(x, y, reference_depth, p) && p[2] > 0;
+			if (valid) {
+				depth_ray_table[i] = cgv::math::fvec<float, 2>(p[0] / p[2], p[1] / p[2]);
+				if (scale == 0)
+					scale = p[2] / reference_depth;
+			}
+			// check linearity at the smallest and a large depth, which fails for example for devices that quantize
+			// depth values before the mapping such that small depths become invalid
+			for (int depth : { 1, 8 * reference_depth }) {
+				float q[3];
+				bool q_valid = rgbd->map_depth_to_point(x, y, depth, q) && q[2] > 0;
+				if (q_valid != valid)
+					return false;
+				if (valid && (std::abs(q[2] - scale * depth) > 1e-4f * q[2] ||
+					std::abs(q[0] - depth_ray_table[i][0] * q[2]) > 1e-4f * q[2] ||
+					std::abs(q[1] - depth_ray_table[i][1] * q[2]) > 1e-4f * q[2]))
+					return false;
+			}
+		}
+	}
+	depth_ray_scale = scale;
+	return depth_ray_scale != 0;
+}
+
+size_t rgbd_input::map_depth_frame_to_points(const frame_type& depth_frame, float* points,
+	const frame_type* warped_color_frame, cgv::media::color<uint8_t, cgv::media::RGB>* colors) const
+{
+	if (!is_attached()) {
+		cerr << "rgbd_input::map_depth_frame_to_points called on device that has not been attached" << endl;
+		return 0;
+	}
+	// a failed computation is remembered through a zero scale until the frame size changes or the device is restarted
+	if (depth_ray_table.empty() || depth_ray_table_size.width != depth_frame.width || depth_ray_table_size.height != depth_frame.height)
+		compute_depth_ray_table(depth_frame.width, depth_frame.height);
+	if (depth_ray_scale == 0)
+		return 0;
+	return unproject_depth_frame(depth_frame, depth_ray_table, depth_ray_scale, points, warped_color_frame, colors);
+}
+
 }
\ No newline at end of file
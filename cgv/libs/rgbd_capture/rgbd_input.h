@@ -1,6 +1,7 @@
 #pragma once
 
 #include "rgbd_driver.h"
+#include "rgbd_container.h"
 
 #include "lib_begin.h"
 
@@ -57,9 +58,11 @@ public:
 	static bool read_frame(const std::string& file_name, frame_type& frame);
 	/// write a frame to a file
 	static bool write_frame(const std::string& file_name, const frame_type& frame);
-	/// attach to a directory that contains saved frames
+	/// attach to a directory that contains saved frames or to an rgbd container file with extension rgbdc
 	bool attach_path(const std::string& path);
-	/// enable protocolation of all frames acquired by the attached rgbd input device
+	/** enable protocolation of all frames acquired by the attached rgbd input device. If path has the extension rgbdc,
+	    all frames are written to a single container file with asynchronous depth compression, otherwise each frame
+		is written to its own file in the directory given by path. */
 	void enable_protocol(const std::string& path);
 	/// disable protocolation
 	void disable_protocol();
@@ -126,7 +129,25 @@ public:
 		Careful: the corresponding coordinate system is left handed!
 	*/
 	bool map_depth_to_point(int x, int y, int depth, float* point_ptr) const;
+	//! map a complete depth frame to points in the coordinate system of map_depth_to_point()
+	/*! points needs to provide space for 3*width*height floats, which are filled per pixel with the
+	    origin for pixels without valid depth. If colors is given, it needs to provide space for
+		width*height colors that are copied from the warped color frame. The per pixel rays are
+		computed on first use with map_depth_to_point() such that all devices including the emulation
+		of recorded protocols are supported, and then applied in parallel with unproject_depth_frame().
+		This requires map_depth_to_point() to be linear in the depth value, which is checked when computing
+		the rays. For devices with a non linear mapping, like the kinect that divides depth values by 8
+		before mapping, 0 is returned without writing points and map_depth_to_point() needs to be called
+		per pixel instead. Otherwise the number of valid points is returned. */
+	size_t map_depth_frame_to_points(const frame_type& depth_frame, float* points,
+		const frame_type* warped_color_frame = 0, cgv::media::color<uint8_t, cgv::media::RGB>* colors = 0) const;
 protected:
+	/// per pixel rays of depth camera, its size and the scale from depth values to the z-coordinate of points
+	mutable std::vector<cgv::math::fvec<float, 2>> depth_ray_table;
+	mutable frame_size depth_ray_table_size;
+	mutable float depth_ray_scale;
+	/// compute ray table of depth camera for given frame size and return whether the mapping is linear in depth and at least one ray is valid
+	bool compute_depth_ray_table(int width, int height) const;
 	/// store whether camera has been started
 	bool started;
 	/// store attached serial
@@ -139,6 +160,12 @@ protected:
 	int protocol_idx;
 	/// flags used to determine which frames have been saved to file for current index
 	unsigned protocol_flags;
+	/// writer used if protocol is written to a container file
+	mutable rgbd_container_writer protocol_container;
+	/// protocol index of last color frame, which is used for the warped color frame written to the container
+	mutable int next_warped_protocol_idx;
+	/// open container for protocol if protocol path is a container file name
+	void open_protocol_container();
 public:
 	/// whether to write protocol frames asynchronously
 	bool protocol_write_async;
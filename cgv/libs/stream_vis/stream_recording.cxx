@@ -0,0 +1,375 @@
+#include "stream_recording.h"
+#include <cstring>
+#include <algorithm>
+#include <zlib.h>
+
+namespace stream_vis {
+
+	namespace {
+		const char header_magic[8] = "SVREC01";
+		const char footer_magic[8] = "SVIDX01";
+		/// round offset up to multiple of 8 bytes
+		size_t align8(size_t offset) { return (offset + 7) & ~size_t(7); }
+	}
+
+	stream_recorder::stream_recorder() : fp(0), file_offset(0), compress(true), chunk_size(4096), poll_ms(10)
+	{
+		nr_lost_samples = 0;
+		write_failed = false;
+	}
+	stream_recorder::~stream_recorder()
+	{
+		close();
+	}
+	bool stream_recorder::open(const std::string& file_name, const std::vector<streaming_time_series*>& _series, bool _compress, size_t _chunk_size, unsigned _poll_ms)
+	{
+		close();
+		for (auto sts : _series)
+			if (!sts->series().has_ringbuffer())
+				return false;
+		fp = fopen(file_name.c_str(), "wb");
+		if (!fp)
+			return false;
+		series = _series;
+		compress = _compress;
+		chunk_size = std::max(_chunk_size, size_t(1));
+		poll_ms = _poll_ms;
+		nr_lost_samples = 0;
+		write_failed = false;
+		chunks.clear();
+		uint32_t n = uint32_t(series.size());
+		file_offset = 0;
+		bool success = write(header_magic, 8) && write(&n, 4);
+		nr_components.resize(n);
+		for (size_t i = 0; i < n; ++i) {
+			const std::string& name = series[i]->get_name();
+			uint32_t name_length = uint32_t(name.size());
+			nr_components[i] = series[i]->series().get_nr_components();
+			success = success && write(&name_length, 4) && write(name.data(), name_length) && write(&nr_components[i], 4);
+		}
+		if (!(success && write_padding())) {
+			fclose(fp);
+			fp = 0;
+			series.clear();
+			return false;
+		}
+		// start recording with the samples arriving from now on
+		nr_read_samples.resize(n);
+		nr_written_samples.assign(n, 0);
+		times.assign(n, std::vector<double>());
+		values.assign(n, std::vector<double>());
+		for (size_t i = 0; i < n; ++i)
+			nr_read_samples[i] = series[i]->series().get_nr_samples();
+		start();
+		return true;
+	}
+	void stream_recorder::run()
+	{
+		while (!have_stop_request()) {
+			poll(false);
+			wait(poll_ms);
+		}
+	}
+	bool stream_recorder::write(const void* data, size_t size)
+	{
+		if (size > 0 && fwrite(data, 1, size, fp) != size)
+			return false;
+		file_offset += size;
+		return true;
+	}
+	bool stream_recorder::write_padding()
+	{
+		static const char zeros[8] = { 0 };
+		return write(zeros, align8(size_t(file_offset)) - size_t(file_offset));
+	}
+	void stream_recorder::poll(bool flush)
+	{
+		std::vector<double> v;
+		for (size_t i = 0; i < series.size(); ++i) {
+			const time_series_base& ts = series[i]->series();
+			unsigned nc = nr_components[i];
+			v.resize(std::max(nc, 1u));
+			size_t& si_read = nr_read_samples[i];
+			size_t nr_samples = ts.get_nr_samples();
+			size_t si_begin = std::min(ts.get_first_intact_sample_index(si_read), nr_samples);
+			size_t nr_buffered = times[i].size();
+			double t;
+			for (size_t si = si_begin; si < nr_samples; ++si) {
+				if (!ts.put_sample_as_double(si, t, v.data())) {
+					// skip samples that left the cache before the first one was copied
+					if (times[i].size() == nr_buffered) {
+						si_begin = si + 1;
+						continue;
+					}
+					break;
+				}
+				times[i].push_back(t);
+				values[i].insert(values[i].end(), v.begin(), v.begin() + nc);
+			}
+			// drop samples that producers overwrote while copying them
+			size_t si_intact = std::min(ts.get_first_intact_sample_index(si_begin), si_begin + times[i].size() - nr_buffered);
+			if (si_intact > si_begin) {
+				times[i].erase(times[i].begin() + nr_buffered, times[i].begin() + nr_buffered + (si_intact - si_begin));
+				values[i].erase(values[i].begin() + nc * nr_buffered, values[i].begin() + nc * (nr_buffered + si_intact - si_begin));
+			}
+			nr_lost_samples += si_intact - si_read;
+			si_read = si_begin + (times[i].size() - nr_buffered) + (si_intact - si_begin);
+			if (times[i].size() >= chunk_size || (flush && !times[i].empty()))
+				if (!write_chunk(i))
+					write_failed = true;
+		}
+	}
+	bool stream_recorder::write_chunk(size_t i)
+	{
+		size_t n = times[i].size();
+		unsigned nc = nr_components[i];
+		// after a failed write the file offsets are unknown and further chunks would corrupt the recording
+		if (write_failed) {
+			times[i].clear();
+			values[i].clear();
+			return false;
+		}
+		// transpose values into columns after the times
+		std::vector<double> payload(n * (nc + 1));
+		std::copy(times[i].begin(), times[i].end(), payload.begin());
+		for (unsigned ci = 0; ci < nc; ++ci)
+			for (size_t k = 0; k < n; ++k)
+				payload[(ci + 1) * n + k] = values[i][k * nc + ci];
+		recording_chunk c;
+		std::memset(&c, 0, sizeof(c));
+		c.series_index = uint32_t(i);
+		c.nr_samples = uint32_t(n);
+		c.first_sample_index = nr_written_samples[i];
+		c.time_begin = times[i].front();
+		c.time_end = times[i].back();
+		const void* data = payload.data();
+		c.payload_size = payload.size() * sizeof(double);
+		std::vector<Bytef> compressed;
+		if (compress) {
+			uLongf size = compressBound(uLong(c.payload_size));
+			compressed.resize(size);
+			if (compress2(compressed.data(), &size, reinterpret_cast<const Bytef*>(data), uLong(c.payload_size), Z_BEST_SPEED) == Z_OK && size < c.payload_size) {
+				data = compressed.data();
+				c.payload_size = size;
+				c.compressed = 1;
+			}
+		}
+		c.payload_offset = file_offset + sizeof(recording_chunk);
+		bool success = write(&c, sizeof(c)) && write(data, size_t(c.payload_size)) && write_padding();
+		if (success)
+			chunks.push_back(c);
+		nr_written_samples[i] += n;
+		times[i].clear();
+		values[i].clear();
+		return success;
+	}
+	bool stream_recorder::close()
+	{
+		if (!fp)
+			return true;
+		stop();
+		poll(true);
+		bool success = !write_failed;
+		// an index is only written for a consistent sequence of chunks, otherwise readers scan the intact chunks
+		if (success) {
+			recording_footer footer;
+			footer.index_offset = file_offset;
+			footer.nr_chunks = chunks.size();
+			std::memcpy(footer.magic, footer_magic, 8);
+			success = write(chunks.data(), chunks.size() * sizeof(recording_chunk)) && write(&footer, sizeof(footer));
+			if (!success)
+				write_failed = true;
+		}
+		if (fclose(fp) != 0) {
+			write_failed = true;
+			success = false;
+		}
+		fp = 0;
+		series.clear();
+		return success;
+	}
+
+	stream_recording::stream_recording()
+	{
+	}
+	bool stream_recording::open(const std::string& file_name)
+	{
+		close();
+		if (!file.open(file_name))
+			return false;
+		const char* data = file.get_data();
+		size_t size = file.get_size();
+		// parse header
+		size_t offset = 12;
+		if (size < offset || std::memcmp(data, header_magic, 8) != 0) {
+			close();
+			return false;
+		}
+		uint32_t n = *file.get_pointer<uint32_t>(8);
+		for (uint32_t i = 0; i < n; ++i) {
+			if (offset + 4 > size) {
+				close();
+				return false;
+			}
+			uint32_t name_length;
+			std::memcpy(&name_length, data + offset, 4);
+			if (offset + 8 + name_length > size) {
+				close();
+				return false;
+			}
+			names.push_back(std::string(data + offset + 4, name_length));
+			uint32_t nc;
+			std::memcpy(&nc, data + offset + 4 + name_length, 4);
+			nr_components.push_back(nc);
+			offset += 8 + name_length;
+		}
+		offset = align8(offset);
+		// read chunk index from footer or reconstruct it by scanning the chunks of an unfinished recording
+		recording_footer footer;
+		if (size >= offset + sizeof(footer))
+			std::memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+		if (size >= offset + sizeof(footer) && std::memcmp(footer.magic, footer_magic, 8) == 0 &&
+			footer.index_offset + footer.nr_chunks * sizeof(recording_chunk) + sizeof(footer) == size) {
+			chunks.resize(size_t(footer.nr_chunks));
+			if (!chunks.empty())
+				std::memcpy(chunks.data(), data + footer.index_offset, chunks.size() * sizeof(recording_chunk));
+		}
+		else {
+			while (offset + sizeof(recording_chunk) <= size) {
+				recording_chunk c;
+				std::memcpy(&c, data + offset, sizeof(c));
+				if (c.series_index >= n || c.payload_offset != offset + sizeof(c) || c.payload_offset + c.payload_size > size)
+					break;
+				chunks.push_back(c);
+				offset = align8(size_t(c.payload_offset + c.payload_size));
+			}
+		}
+		series_chunks.resize(n);
+		for (size_t ci = 0; ci < chunks.size(); ++ci) {
+			const recording_chunk& c = chunks[ci];
+			// uncompressed payloads are accessed in place and need to be aligned and complete
+			if (c.series_index >= n || c.payload_offset + c.payload_size > size || (!c.compressed &&
+				(c.payload_offset % 8 != 0 || c.payload_size != uint64_t(c.nr_samples) * (nr_components[c.series_index] + 1) * sizeof(double)))) {
+				close();
+				return false;
+			}
+			series_chunks[chunks[ci].series_index].push_back(ci);
+		}
+		cached_chunk.assign(n, size_t(-1));
+		cached_payload.resize(n);
+		file.advise(cgv::utils::mapped_file::AH_RANDOM);
+		return true;
+	}
+	void stream_recording::close()
+	{
+		file.close();
+		names.clear();
+		nr_components.clear();
+		series_chunks.clear();
+		chunks.clear();
+		cached_chunk.clear();
+		cached_payload.clear();
+	}
+	int stream_recording::find_series(const std::string& name) const
+	{
+		for (size_t i = 0; i < names.size(); ++i)
+			if (names[i] == name)
+				return int(i);
+		return -1;
+	}
+	size_t stream_recording::get_nr_samples(size_t i) const
+	{
+		if (series_chunks[i].empty())
+			return 0;
+		const recording_chunk& c = chunks[series_chunks[i].back()];
+		return size_t(c.first_sample_index + c.nr_samples);
+	}
+	bool stream_recording::get_time_range(double& time_begin, double& time_end) const
+	{
+		if (chunks.empty())
+			return false;
+		time_begin = chunks.front().time_begin;
+		time_end = chunks.front().time_end;
+		for (const auto& c : chunks) {
+			time_begin = std::min(time_begin, c.time_begin);
+			time_end = std::max(time_end, c.time_end);
+		}
+		return true;
+	}
+	const double* stream_recording::get_payload(size_t i, size_t ci) const
+	{
+		const recording_chunk& c = chunks[ci];
+		if (!c.compressed)
+			return file.get_pointer<double>(size_t(c.payload_offset));
+		if (cached_chunk[i] != ci) {
+			std::vector<double>& payload = cached_payload[i];
+			payload.resize(size_t(c.nr_samples) * (nr_components[i] + 1));
+			uLongf size = uLongf(payload.size() * sizeof(double));
+			if (uncompress(reinterpret_cast<Bytef*>(payload.data()), &size, file.get_pointer<Bytef>(size_t(c.payload_offset)), uLong(c.payload_size)) != Z_OK ||
+				size != payload.size() * sizeof(double)) {
+				cached_chunk[i] = size_t(-1);
+				return 0;
+			}
+			cached_chunk[i] = ci;
+		}
+		return cached_payload[i].data();
+	}
+	size_t stream_recording::find_chunk(size_t i, size_t si) const
+	{
+		const std::vector<size_t>& sc = series_chunks[i];
+		auto iter = std::upper_bound(sc.begin(), sc.end(), si, [this](size_t si, size_t ci) { return si < chunks[ci].first_sample_index; });
+		return size_t(iter - sc.begin()) - 1;
+	}
+	size_t stream_recording::find_sample(size_t i, double time) const
+	{
+		const std::vector<size_t>& sc = series_chunks[i];
+		// find first chunk that ends after the given time
+		auto iter = std::upper_bound(sc.begin(), sc.end(), time, [this](double t, size_t ci) { return t < chunks[ci].time_end; });
+		if (iter == sc.end())
+			return get_nr_samples(i);
+		const recording_chunk& c = chunks[*iter];
+		if (time < c.time_begin)
+			return size_t(c.first_sample_index);
+		const double* times = get_payload(i, *iter);
+		if (!times)
+			return size_t(c.first_sample_index);
+		return size_t(c.first_sample_index) + (std::upper_bound(times, times + c.nr_samples, time) - times);
+	}
+	bool stream_recording::get_sample(size_t i, size_t si, double& time, double* values) const
+	{
+		if (si >= get_nr_samples(i))
+			return false;
+		size_t ci = series_chunks[i][find_chunk(i, si)];
+		const double* payload = get_payload(i, ci);
+		if (!payload)
+			return false;
+		size_t n = chunks[ci].nr_samples, k = si - size_t(chunks[ci].first_sample_index);
+		time = payload[k];
+		for (unsigned j = 0; j < nr_components[i]; ++j)
+			values[j] = payload[(j + 1) * n + k];
+		return true;
+	}
+	size_t stream_recording::read_samples(size_t i, size_t si, size_t count, std::vector<double>& times, std::vector<double>& values) const
+	{
+		times.clear();
+		values.clear();
+		count = std::min(count, get_nr_samples(i) - std::min(si, get_nr_samples(i)));
+		unsigned nc = nr_components[i];
+		times.reserve(count);
+		values.reserve(count * nc);
+		size_t sci = count > 0 ? find_chunk(i, si) : 0;
+		while (times.size() < count) {
+			size_t ci = series_chunks[i][sci++];
+			const double* payload = get_payload(i, ci);
+			if (!payload)
+				break;
+			size_t n = chunks[ci].nr_samples, k0 = si + times.size() - size_t(chunks[ci].first_sample_index);
+			size_t k1 = std::min(n, k0 + count - times.size());
+			times.insert(times.end(), payload + k0, payload + k1);
+			for (size_t k = k0; k < k1; ++k)
+				for (unsigned j = 0; j < nc; ++j)
+					values.push_back(payload[(j + 1) * n + k]);
+		}
+		return times.size();
+	}
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "streaming_time_series.h"
+#include <cgv/os/thread.h>
+#include <cgv/utils/mapped_file.h>
+#include <cstdio>
+
+#include "lib_begin.h"
+
+namespace stream_vis {
+
+	/** binary layout of a stream recording file:
+	    - header with magic "SVREC01", number of time series and per time series the name length, name and number
+		  of value components, padded with zeros to a multiple of 8 bytes
+		- sequence of chunks, each consisting of a recording_chunk followed by the payload that stores the samples of
+		  one time series column wise as doubles, i.e. all times followed by all values of each component. The
+		  payload is optionally compressed with zlib and padded with zeros to a multiple of 8 bytes, such that
+		  uncompressed payloads can be accessed as doubles directly in the memory mapped file.
+		- index with one recording_chunk per chunk followed by a recording_footer, which is written on closing
+		  the recording. If the index is missing after a crash, it is reconstructed by scanning the chunks. */
+	struct recording_chunk
+	{
+		/// index of time series
+		uint32_t series_index;
+		/// number of samples in chunk
+		uint32_t nr_samples;
+		/// size of payload in file
+		uint64_t payload_size;
+		/// offset of payload in file
+		uint64_t payload_offset;
+		/// index of first sample of chunk within its time series
+		uint64_t first_sample_index;
+		/// time of first and last sample
+		double time_begin, time_end;
+		/// whether payload is zlib compressed
+		uint32_t compressed;
+		/// padding to multiple of 8 bytes
+		uint32_t reserved;
+	};
+	/// last bytes of a recording file pointing to the chunk index
+	struct recording_footer
+	{
+		uint64_t index_offset;
+		uint64_t nr_chunks;
+		char magic[8];
+	};
+
+	/** records all samples of a set of streaming time series in a background thread. The thread polls the time series
+	    without locking the producers, converts new samples to doubles and writes them in chunks to disk. As only time
+		series with ring buffer support reading concurrently to appending, other time series cannot be recorded.
+		Samples that are overwritten in the ring buffers of the time series before the recorder could read them are
+		lost and counted. Therefore the ring buffer size should cover the samples arriving during one poll interval.
+		After the first failed write no further chunks are written and close() reports the failure. */
+	class CGV_API stream_recorder : public cgv::os::thread
+	{
+	protected:
+		FILE* fp;
+		/// offset of the end of the written data, which is tracked as ftell is limited to 32 bits on some platforms
+		uint64_t file_offset;
+		bool compress;
+		size_t chunk_size;
+		unsigned poll_ms;
+		std::vector<streaming_time_series*> series;
+		/// per time series number of value components as stored in the file header
+		std::vector<unsigned> nr_components;
+		/// per time series number of samples read from time series and number of samples written to file
+		std::vector<size_t> nr_read_samples, nr_written_samples;
+		/// per time series buffered times and values, where values are interleaved per sample
+		std::vector<std::vector<double>> times, values;
+		std::vector<recording_chunk> chunks;
+		std::atomic<size_t> nr_lost_samples;
+		/// whether writing to the file failed
+		std::atomic<bool> write_failed;
+		/// write data and advance file offset, return false on failure
+		bool write(const void* data, size_t size);
+		/// write zeros up to the next multiple of 8 bytes
+		bool write_padding();
+		/// read new samples from all time series and write complete chunks, if flush is true also incomplete ones
+		void poll(bool flush);
+		/// write the buffered samples of time series i as one chunk, return false if writing failed now or before
+		bool write_chunk(size_t i);
+	public:
+		/// construct recorder that is not recording
+		stream_recorder();
+		/// stop recording and close file
+		~stream_recorder();
+		/// create recording file for the given time series with ring buffer and start background thread that records until close(), fails if a time series has no ring buffer
+		bool open(const std::string& file_name, const std::vector<streaming_time_series*>& _series, bool _compress = true, size_t _chunk_size = 4096, unsigned _poll_ms = 10);
+		/// stop background thread, write remaining samples and chunk index and close file, return false if any write or closing the file failed
+		bool close();
+		/// return whether recording is active
+		bool is_open() const { return fp != 0; }
+		/// return number of samples that were overwritten before the recorder could read them
+		size_t get_nr_lost_samples() const { return nr_lost_samples; }
+		/// return whether writing to the recording file failed
+		bool has_write_error() const { return write_failed; }
+		/// thread function
+		void run();
+	};
+
+	/** read access to a stream recording through a memory mapping. Samples of each time series are located by
+	    timestamp with binary search over the chunks and within the chunk in O(log n). Compressed chunks are
+		decompressed on access and the last decompressed chunk per time series is cached. */
+	class CGV_API stream_recording
+	{
+	protected:
+		cgv::utils::mapped_file file;
+		std::vector<std::string> names;
+		std::vector<unsigned> nr_components;
+		/// per time series the indices of its chunks in the order of samples
+		std::vector<std::vector<size_t>> series_chunks;
+		std::vector<recording_chunk> chunks;
+		/// per time series index of cached chunk and its decompressed payload
+		mutable std::vector<size_t> cached_chunk;
+		mutable std::vector<std::vector<double>> cached_payload;
+		/// return pointer to the uncompressed payload of a chunk or 0 if decompression failed
+		const double* get_payload(size_t i, size_t ci) const;
+		/// return index into series_chunks[i] of the chunk containing sample si
+		size_t find_chunk(size_t i, size_t si) const;
+	public:
+		/// construct without recording
+		stream_recording();
+		/// map recording file and read its index, return false if the file is not a valid recording
+		bool open(const std::string& file_name);
+		/// unmap recording
+		void close();
+		/// return whether a recording is open
+		bool is_open() const { return file.is_open(); }
+		/// return number of recorded time series
+		size_t get_nr_series() const { return names.size(); }
+		/// return name of i-th time series
+		const std::string& get_series_name(size_t i) const { return names[i]; }
+		/// return index of time series with given name or -1
+		int find_series(const std::string& name) const;
+		/// return number of value components of i-th time series
+		unsigned get_nr_components(size_t i) const { return nr_components[i]; }
+		/// return number of recorded samples of i-th time series
+		size_t get_nr_samples(size_t i) const;
+		/// return time range of all recorded samples
+		bool get_time_range(double& time_begin, double& time_end) const;
+		/// return number of samples of i-th time series with time not larger than given time, found in O(log n)
+		size_t find_sample(size_t i, double time) const;
+		/// read time and values of sample si of time series i
+		bool get_sample(size_t i, size_t si, double& time, double* values) const;
+		/// read up to count samples starting at sample si of time series i and return the number of read samples
+		size_t read_samples(size_t i, size_t si, size_t count, std::vector<double>& times, std::vector<double>& values) const;
+	};
+}
+
+#include <cgv/config/lib_end.h>
@@ -8,6 +8,7 @@
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/gui/key_event.h>
 #include <cgv/utils/file.h>
+#include <cgv/utils/convert.h>
 #include "cgv_declaration_reader.h"
 #include <nlohmann/json.hpp>
 #include <limits>
@@ -25,57 +26,59 @@ namespace stream_vis {
 		}
 		return component_index;
 	}
-	void stream_vis_context::construct_streaming_aabbs()
+	void stream_vis_context::construct_streaming_aabb(time_series_ringbuffer& tsrb)
 	{
-		for (auto& tsrb : time_series_ringbuffers) {
-			delete tsrb.streaming_aabb;
-			switch (aabb_mode) {
-			case AM_BRUTE_FORCE:
-				switch (tsrb.nr_time_series_components) {
-				case 1: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 1>(tsrb.time_series_ringbuffer_size); break;
-				case 2: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 2>(tsrb.time_series_ringbuffer_size); break;
-				case 3: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 3>(tsrb.time_series_ringbuffer_size); break;
-				case 4: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 4>(tsrb.time_series_ringbuffer_size); break;
-				case 5: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 5>(tsrb.time_series_ringbuffer_size); break;
-				case 6: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 6>(tsrb.time_series_ringbuffer_size); break;
-				case 7: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 7>(tsrb.time_series_ringbuffer_size); break;
-				case 8: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 8>(tsrb.time_series_ringbuffer_size); break;
-				case 9: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 9>(tsrb.time_series_ringbuffer_size); break;
-				default: std::cerr << "found time series ringbuffer with more than 9 components" << std::endl; abort();
-				}
-				break;
-			case AM_BLOCKED_8:
-				switch (tsrb.nr_time_series_components) {
-				case 1: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 1>(tsrb.time_series_ringbuffer_size, 8); break;
-				case 2: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 2>(tsrb.time_series_ringbuffer_size, 8); break;
-				case 3: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 3>(tsrb.time_series_ringbuffer_size, 8); break;
-				case 4: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 4>(tsrb.time_series_ringbuffer_size, 8); break;
-				case 5: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 5>(tsrb.time_series_ringbuffer_size, 8); break;
-				case 6: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 6>(tsrb.time_series_ringbuffer_size, 8); break;
-				case 7: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 7>(tsrb.time_series_ringbuffer_size, 8); break;
-				case 8: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 8>(tsrb.time_series_ringbuffer_size, 8); break;
-				case 9: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 9>(tsrb.time_series_ringbuffer_size, 8); break;
-				default: std::cerr << "found time series ringbuffer with more than 9 components" << std::endl; abort();
-				}
-				break;
-			case AM_BLOCKED_16:
-				switch (tsrb.nr_time_series_components) {
-				case 1: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 1>(tsrb.time_series_ringbuffer_size, 16); break;
-				case 2: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 2>(tsrb.time_series_ringbuffer_size, 16); break;
-				case 3: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 3>(tsrb.time_series_ringbuffer_size, 16); break;
-				case 4: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 4>(tsrb.time_series_ringbuffer_size, 16); break;
-				case 5: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 5>(tsrb.time_series_ringbuffer_size, 16); break;
-				case 6: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 6>(tsrb.time_series_ringbuffer_size, 16); break;
-				case 7: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 7>(tsrb.time_series_ringbuffer_size, 16); break;
-				case 8: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 8>(tsrb.time_series_ringbuffer_size, 16); break;
-				case 9: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 9>(tsrb.time_series_ringbuffer_size, 16); break;
-				default: std::cerr << "found time series ringbuffer with more than 9 components" << std::endl; abort();
-				}
-				break;
+		delete tsrb.streaming_aabb;
+		switch (aabb_mode) {
+		case AM_BRUTE_FORCE:
+			switch (tsrb.nr_time_series_components) {
+			case 1: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 1>(tsrb.time_series_ringbuffer_size); break;
+			case 2: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 2>(tsrb.time_series_ringbuffer_size); break;
+			case 3: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 3>(tsrb.time_series_ringbuffer_size); break;
+			case 4: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 4>(tsrb.time_series_ringbuffer_size); break;
+			case 5: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 5>(tsrb.time_series_ringbuffer_size); break;
+			case 6: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 6>(tsrb.time_series_ringbuffer_size); break;
+			case 7: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 7>(tsrb.time_series_ringbuffer_size); break;
+			case 8: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 8>(tsrb.time_series_ringbuffer_size); break;
+			case 9: tsrb.streaming_aabb = new streaming_aabb_brute_force<float, 9>(tsrb.time_series_ringbuffer_size); break;
+			default: std::cerr << "found time series ringbuffer with more than 9 components" << std::endl; abort();
 			}
-
+			break;
+		case AM_BLOCKED_8:
+			switch (tsrb.nr_time_series_components) {
+			case 1: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 1>(tsrb.time_series_ringbuffer_size, 8); break;
+			case 2: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 2>(tsrb.time_series_ringbuffer_size, 8); break;
+			case 3: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 3>(tsrb.time_series_ringbuffer_size, 8); break;
+			case 4: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 4>(tsrb.time_series_ringbuffer_size, 8); break;
+			case 5: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 5>(tsrb.time_series_ringbuffer_size, 8); break;
+			case 6: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 6>(tsrb.time_series_ringbuffer_size, 8); break;
+			case 7: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 7>(tsrb.time_series_ringbuffer_size, 8); break;
+			case 8: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 8>(tsrb.time_series_ringbuffer_size, 8); break;
+			case 9: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 9>(tsrb.time_series_ringbuffer_size, 8); break;
+			default: std::cerr << "found time series ringbuffer with more than 9 components" << std::endl; abort();
+			}
+			break;
+		case AM_BLOCKED_16:
+			switch (tsrb.nr_time_series_components) {
+			case 1: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 1>(tsrb.time_series_ringbuffer_size, 16); break;
+			case 2: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 2>(tsrb.time_series_ringbuffer_size, 16); break;
+			case 3: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 3>(tsrb.time_series_ringbuffer_size, 16); break;
+			case 4: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 4>(tsrb.time_series_ringbuffer_size, 16); break;
+			case 5: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 5>(tsrb.time_series_ringbuffer_size, 16); break;
+			case 6: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 6>(tsrb.time_series_ringbuffer_size, 16); break;
+			case 7: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 7>(tsrb.time_series_ringbuffer_size, 16); break;
+			case 8: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 8>(tsrb.time_series_ringbuffer_size, 16); break;
+			case 9: tsrb.streaming_aabb = new streaming_aabb_block_based<float, 9>(tsrb.time_series_ringbuffer_size, 16); break;
+			default: std::cerr << "found time series ringbuffer with more than 9 components" << std::endl; abort();
+			}
+			break;
 		}
 	}
+	void stream_vis_context::construct_streaming_aabbs()
+	{
+		for (auto& tsrb : time_series_ringbuffers)
+			construct_streaming_aabb(tsrb);
+	}
 	void stream_vis_context::construct_storage_buffer()
 	{
 		// initialize component references to point to themselves
@@ -230,6 +233,9 @@ namespace stream_vis {
 	{
 		paused = false;
 		sleep_ms = 20;
+		recording = false;
+		recording_file_name = "stream.svr";
+		replay_time = replay_time_begin = replay_time_end = 0;
 		outofdate = true;
 		last_use_vbo = use_vbo = false;
 		plot_attributes_initialized = false;
@@ -237,11 +243,24 @@ namespace stream_vis {
 	}
 	stream_vis_context::~stream_vis_context()
 	{
+		recorder.close();
 		for (auto& tsp : typed_time_series)
 			delete tsp;
 	}
 	void stream_vis_context::on_set(void* member_ptr)
 	{
+		if (member_ptr == &recording) {
+			if (recording)
+				recording = start_recording(recording_file_name);
+			else
+				stop_recording();
+		}
+		if (member_ptr == &replay_file_name) {
+			open_replay(replay_file_name);
+			post_recreate_gui();
+		}
+		if (member_ptr == &replay_time)
+			seek_replay(replay_time);
 		update_member(member_ptr);
 		post_redraw();
 	}
@@ -484,9 +503,93 @@ namespace stream_vis {
 			std::cout << idx << ":" << typed_time_series[tsrb.time_series_index]->get_name() <<
 				"." << get_accessor_string(tsrb.time_series_access) << "|" << tsrb.nr_time_series_components <<
 				" = " << tsrb.nr_samples << "(" << tsrb.time_series_ringbuffer_size << ") -> " <<
-				tsrb.storage_buffer_index << "|" << tsrb.storage_buffer_offset << std::endl;
+				tsrb.storage_buffer_index << "|" << tsrb.storage_buffer_offset;
+			size_t nr_overrun = typed_time_series[tsrb.time_series_index]->series().get_nr_overrun_samples();
+			if (nr_overrun > 0)
+				std::cout << " overrun=" << nr_overrun;
+			std::cout << std::endl;
 		}
 	}
+	bool stream_vis_context::start_recording(const std::string& file_name)
+	{
+		// only ring buffers support reading concurrently to the producers
+		std::vector<streaming_time_series*> recorded_time_series;
+		for (auto tsp : typed_time_series) {
+			if (tsp->series().has_ringbuffer())
+				recorded_time_series.push_back(tsp);
+			else
+				std::cerr << "time series " << tsp->get_name() << " without ringbuffer is not recorded" << std::endl;
+		}
+		if (!recorder.open(file_name, recorded_time_series)) {
+			std::cerr << "could not open recording file " << file_name << std::endl;
+			return false;
+		}
+		return true;
+	}
+	void stream_vis_context::stop_recording()
+	{
+		if (!recorder.is_open())
+			return;
+		if (!recorder.close())
+			std::cerr << "recording file could not be written completely" << std::endl;
+		if (recorder.get_nr_lost_samples() > 0)
+			std::cerr << "recording lost " << recorder.get_nr_lost_samples() << " samples, consider larger ringbuffers" << std::endl;
+	}
+	bool stream_vis_context::open_replay(const std::string& file_name)
+	{
+		replay_series_indices.clear();
+		replay_sample_indices.clear();
+		if (!replay.open(file_name)) {
+			std::cerr << "could not open recording " << file_name << std::endl;
+			return false;
+		}
+		// match recorded time series by name and number of components
+		for (auto tsp : typed_time_series) {
+			int i = replay.find_series(tsp->get_name());
+			if (i != -1 && replay.get_nr_components(i) != tsp->series().get_nr_components())
+				i = -1;
+			replay_series_indices.push_back(i);
+		}
+		replay_sample_indices.resize(typed_time_series.size(), 0);
+		if (!replay.get_time_range(replay_time_begin, replay_time_end))
+			replay_time_begin = replay_time_end = 0;
+		replay_time = replay_time_begin;
+		seek_replay(replay_time);
+		return true;
+	}
+	void stream_vis_context::seek_replay(double time)
+	{
+		if (!replay.is_open())
+			return;
+		double values[16];
+		for (size_t ti = 0; ti < typed_time_series.size(); ++ti) {
+			int i = replay_series_indices[ti];
+			if (i == -1 || replay.get_nr_components(i) > 16)
+				continue;
+			time_series_base& ts = typed_time_series[ti]->series();
+			size_t si_end = replay.find_sample(i, time);
+			size_t si_begin = replay_sample_indices[ti];
+			// seeking forward appends the skipped samples, seeking backward clears the time series and refills it
+			if (si_end < si_begin) {
+				ts.clear_samples();
+				for (auto& tsrb : time_series_ringbuffers)
+					if (tsrb.time_series_index == ti) {
+						tsrb.nr_samples = 0;
+						construct_streaming_aabb(tsrb);
+					}
+				si_begin = 0;
+			}
+			if (ts.has_ringbuffer() && si_end - si_begin > ts.get_ringbuffer_size())
+				si_begin = si_end - ts.get_ringbuffer_size();
+			double t;
+			for (size_t si = si_begin; si < si_end; ++si)
+				if (replay.get_sample(i, si, t, values))
+					ts.append_sample_from_double(t, values);
+			replay_sample_indices[ti] = si_end;
+		}
+		outofdate = true;
+		post_redraw();
+	}
 	bool stream_vis_context::handle_event(cgv::gui::event& e)
 	{
 		if (e.get_kind() == cgv::gui::EID_KEY) {
@@ -589,20 +692,33 @@ namespace stream_vis {
 		// update time series ringbuffers
 		int i = 0;
 		for (auto& tsrr : time_series_ringbuffers) {
-			const auto& tts = typed_time_series[tsrr.time_series_index];
+			const auto& ts = typed_time_series[tsrr.time_series_index]->series();
 			// check if new samples are available
-			size_t count = tts->series().get_nr_samples() - tsrr.nr_samples;
+			size_t nr_samples = ts.get_nr_samples();
+			size_t count = nr_samples - tsrr.nr_samples;
 			if (count == 0)
 				continue;
-			// convert samples to float and put them directly into CPU side storage buffer
+			// convert samples to float and put them directly into CPU side storage buffer without locking the producers
 			float* storage_ptr = &storage_buffers[tsrr.storage_buffer_index][tsrr.storage_buffer_offset];
-			for (size_t s = 0; s < count; ++s) {
-				size_t si = tsrr.nr_samples + s;
-				size_t csi = si % tsrr.time_series_ringbuffer_size;
-				tts->series().put_sample_as_float(si, storage_ptr + tsrr.nr_time_series_components * csi, tsrr.time_series_access);
-				if (tsrr.streaming_aabb)
-					tsrr.streaming_aabb->add_samples_base(storage_ptr + tsrr.nr_time_series_components * csi, 1);
+			size_t rbs = tsrr.time_series_ringbuffer_size;
+			// samples that were overwritten before we could read them are lost
+			size_t si_begin = std::min(ts.get_first_intact_sample_index(tsrr.nr_samples), nr_samples);
+			ts.add_overrun_samples(si_begin - tsrr.nr_samples);
+			size_t si = si_begin;
+			for (int attempt = 0; attempt < 4; ++attempt) {
+				for (; si < nr_samples; ++si)
+					ts.put_sample_as_float(si, storage_ptr + tsrr.nr_time_series_components * (si % rbs), tsrr.time_series_access);
+				// check whether producers overwrote copied samples of the visible window in the meantime
+				size_t si_check = std::max(si_begin, nr_samples - std::min(nr_samples, rbs));
+				if (ts.get_first_intact_sample_index(si_check) == si_check)
+					break;
+				// the overwriting samples share storage slots with the damaged ones and are copied in the next attempt
+				nr_samples = ts.get_nr_samples();
 			}
+			count = nr_samples - tsrr.nr_samples;
+			if (tsrr.streaming_aabb)
+				for (size_t s = nr_samples - std::min(count, rbs); s < nr_samples; ++s)
+					tsrr.streaming_aabb->add_samples_base(storage_ptr + tsrr.nr_time_series_components * (s % rbs), 1);
 			// three cases exist for the upload of the new samples to GPU:
 
 			// first check for case when complete ringbuffer needs to be replaces
@@ -820,6 +936,18 @@ namespace stream_vis {
 		add_member_control(this, "pause", paused, "toggle");
 		add_member_control(this, "sleep_ms", sleep_ms, "value_slider", "min=0;max=1000;log=true;ticks=true");
 		add_member_control(this, "use_vbo", use_vbo, "check");
+		if (begin_tree_node("Recording", recording, false)) {
+			align("\a");
+			add_member_control(this, "record", recording, "toggle");
+			add_gui("recording_file_name", recording_file_name, "file_name",
+				"save=true;title='record time series';filter='stream recording (svr):*.svr|all files:*.*'");
+			add_gui("replay_file_name", replay_file_name, "file_name",
+				"open=true;title='replay recording';filter='stream recording (svr):*.svr|all files:*.*'");
+			add_member_control(this, "replay_time", replay_time, "value_slider",
+				"min=" + cgv::utils::to_string(replay_time_begin) + ";max=" + cgv::utils::to_string(replay_time_end) + ";ticks=true");
+			align("\b");
+			end_tree_node(recording);
+		}
 		if (begin_tree_node("Plots", plot_pool, true)) {
 			align("\a");
 			for (auto& pl : plot_pool) {
@@ -6,6 +6,7 @@
 #include "view_overlay.h"
 #include "streaming_time_series.h"
 #include "streaming_aabb.h"
+#include "stream_recording.h"
 #include <cgv/base/node.h>
 #include <cgv/os/thread.h>
 #include <cgv/os/mutex.h>
@@ -69,6 +70,18 @@ namespace stream_vis {
 		bool paused;
 		unsigned sleep_ms;
 
+		/// background recorder of all time series
+		stream_recorder recorder;
+		bool recording;
+		std::string recording_file_name;
+		/// recording used for replay, which should be opened only while no live values are announced
+		stream_recording replay;
+		std::string replay_file_name;
+		double replay_time, replay_time_begin, replay_time_end;
+		/// per typed time series index of recorded time series with same name or -1 and number of replayed samples
+		std::vector<int> replay_series_indices;
+		std::vector<size_t> replay_sample_indices;
+
 		/// store view pointer and last view
 		cgv::render::view* view_ptr = 0;
 		cgv::render::view  last_view;
@@ -83,6 +96,8 @@ namespace stream_vis {
 
 		static size_t get_component_index(TimeSeriesAccessor accessor, TimeSeriesAccessor accessors);
 
+		/// construct empty streaming aabb of a time series ringbuffer according to aabb_mode
+		void construct_streaming_aabb(time_series_ringbuffer& tsrb);
 		void construct_streaming_aabbs();
 		void construct_storage_buffer();
 		bool is_paused() const { return paused; }
@@ -99,6 +114,14 @@ namespace stream_vis {
 		void show_time_series() const;
 		void show_plots() const;
 		void show_ringbuffers() const;
+		/// start recording all time series with ring buffer to given file, other time series are skipped
+		bool start_recording(const std::string& file_name);
+		/// stop recording and complete recording file
+		void stop_recording();
+		/// open recording for replay and seek to its begin
+		bool open_replay(const std::string& file_name);
+		/// append the recorded samples up to given time to the time series, such that ring buffers show the samples preceding the time
+		void seek_replay(double time);
 		bool is_outofdate() const { return outofdate; }
 		bool handle_event(cgv::gui::event& e);
 		void stream_help(std::ostream& os);
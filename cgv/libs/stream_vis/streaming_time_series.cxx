@@ -81,10 +81,8 @@ namespace stream_vis {
 		uint16_t vi = val_idx_from_ts_idx[index];
 		if (vi == uint16_t(-1))
 			return false;
-		lock.lock();
 		append_sample(timestamp, reinterpret_cast<const double&>(values[vi].value[0]));
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 	streaming_time_series* float_time_series::construct_resampled_time_series(const std::string& name, streaming_time_series* sampling_ts) const
@@ -123,10 +121,8 @@ namespace stream_vis {
 		// if no value is sampled
 		if (!float_time_series::extract_from_values(num_values, values, timestamp, val_idx_from_ts_idx)) {
 			// either store cached new value or nan value 
-			lock.lock();
 			append_sample(timestamp, have_new_value ? new_value : nan_value);
 			outofdate = true;
-			lock.unlock();
 		}
 		// always clear cache
 		have_new_value = false;
@@ -143,10 +139,8 @@ namespace stream_vis {
 		uint16_t vi = val_idx_from_ts_idx[index];
 		if (vi == uint16_t(-1))
 			return false;
-		lock.lock();
 		append_sample(timestamp, reinterpret_cast<const int64_t&>(values[vi].value[0]));
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 	streaming_time_series* int_time_series::construct_resampled_time_series(const std::string& name, streaming_time_series* sampling_ts) const
@@ -185,10 +179,8 @@ namespace stream_vis {
 		// if no value is sampled
 		if (!int_time_series::extract_from_values(num_values, values, timestamp, val_idx_from_ts_idx)) {
 			// either store cached new value or nan value 
-			lock.lock();
 			append_sample(timestamp, have_new_value ? new_value : int32_t(nan_value));
 			outofdate = true;
-			lock.unlock();
 		}
 		// always clear cache
 		have_new_value = false;
@@ -205,10 +197,8 @@ namespace stream_vis {
 		uint16_t vi = val_idx_from_ts_idx[index];
 		if (vi == uint16_t(-1))
 			return false;
-		lock.lock();
 		append_sample(timestamp, reinterpret_cast<const uint64_t&>(values[vi].value[0]));
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 	streaming_time_series* uint_time_series::construct_resampled_time_series(const std::string& name, streaming_time_series* sampling_ts) const
@@ -247,10 +237,8 @@ namespace stream_vis {
 		// if no value is sampled
 		if (!uint_time_series::extract_from_values(num_values, values, timestamp, val_idx_from_ts_idx)) {
 			// either store cached new value or nan value 
-			lock.lock();
 			append_sample(timestamp, have_new_value ? new_value : uint32_t(nan_value));
 			outofdate = true;
-			lock.unlock();
 		}
 		// always clear cache
 		have_new_value = false;
@@ -265,10 +253,8 @@ namespace stream_vis {
 		uint16_t vi = val_idx_from_ts_idx[index];
 		if (vi == uint16_t(-1))
 			return false;
-		lock.lock();
 		append_sample(timestamp, reinterpret_cast<const bool&>(values[vi].value[0]));
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 	streaming_time_series* bool_time_series::construct_resampled_time_series(const std::string& name, streaming_time_series* sampling_ts) const
@@ -309,21 +295,11 @@ namespace stream_vis {
 		if (bool_time_series::extract_from_values(num_values, values, timestamp, val_idx_from_ts_idx))
 			return true;
 		// otherwise store cached or nan value
-		lock.lock();
-		if (!this->initialized) {
-			this->time_offset = timestamp;
-			this->initialized = true;
-			if (this->has_ringbuffer())
-				sample_cache.reserve(this->get_ringbuffer_size());
-		}
+		if (first_sample_state.load(std::memory_order_acquire) != 2)
+			initialize_from_first_sample(timestamp, have_new_value && new_value);
 		stored_sample_type s(this->construct_stored_time(timestamp), uint8_t(have_new_value ? new_value : nan_value));
-		if (this->has_ringbuffer() && this->get_nr_samples() >= this->ringbuffer_size)
-			sample_cache[this->get_cached_sample_index(this->get_nr_samples())] = s;
-		else
-			sample_cache.push_back(s);
-		++this->nr_samples;
+		append_stored_samples(1, [&](size_t) { return s; });
 		outofdate = true;
-		lock.unlock();
 		have_new_value = false;
 		return true;
 	}
@@ -349,10 +325,8 @@ namespace stream_vis {
 				return false;
 			q[ci] = reinterpret_cast<const double&>(values[vi].value[0]);
 		}
-		lock.lock();
 		append_sample(timestamp, q);
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 }
@@ -2,7 +2,6 @@
 
 #include "time_series.h"
 
-#include <cgv/os/mutex.h>
 #include <cgv/type/info/type_id.h>
 #include <cgv/math/geo_transform.h>
 #include <cgv/media/color.h>
@@ -44,10 +43,8 @@ namespace stream_vis {
 	class CGV_API streaming_time_series
 	{
 	protected:
-		/// mutex used to support parallel appending of new values
-		mutable cgv::os::mutex lock;
-		/// keep track whether time series is out of date due to new sample
-		mutable bool outofdate;
+		/// keep track whether time series is out of date due to new sample, which is set by producer threads that append without mutex
+		mutable std::atomic<bool> outofdate;
 		/// store id of value type
 		cgv::type::info::TypeId type_id;
 		/// store name of streaming time series
@@ -270,10 +267,8 @@ namespace stream_vis {
 			}
 				break;
 			}
-			lock.lock();
 			this->append_sample(timestamp, pos);
 			outofdate = true;
-			lock.unlock();
 			return true;
 		}
 		const time_series_base& series() const { return *this; }
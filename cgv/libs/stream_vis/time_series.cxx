@@ -31,7 +31,30 @@ namespace stream_vis {
 	/// return total number of seen samples
 	size_t time_series_base::get_nr_samples() const
 	{
-		return nr_samples;
+		return nr_samples.load(std::memory_order_acquire);
+	}
+	size_t time_series_base::get_nr_reserved_samples() const
+	{
+		return nr_reserved_samples.load(std::memory_order_acquire);
+	}
+	size_t time_series_base::get_first_intact_sample_index(size_t si) const
+	{
+		if (!has_ringbuffer())
+			return si;
+		// the payload of ring buffer slots is read with acquire loads, such that the reservations of producers whose samples were copied are visible
+		size_t nr_reserved = get_nr_reserved_samples();
+		// slot of sample si is overwritten as soon as sample si + ringbuffer_size is reserved
+		if (nr_reserved > si + get_ringbuffer_size())
+			return nr_reserved - get_ringbuffer_size();
+		return si;
+	}
+	size_t time_series_base::get_nr_overrun_samples() const
+	{
+		return nr_overrun_samples;
+	}
+	void time_series_base::add_overrun_samples(size_t n) const
+	{
+		nr_overrun_samples += n;
 	}
 	/// return index of first sample stored in buffer
 	size_t time_series_base::get_sample_index_of_first_cached_sample() const
@@ -86,6 +109,12 @@ namespace stream_vis {
 	{
 		ringbuffer_size = rbs;
 	}
+	void time_series_base::clear_samples()
+	{
+		nr_samples = 0;
+		nr_reserved_samples = 0;
+		nr_overrun_samples = 0;
+	}
 
 	/// construct time series - ring buffering is turned of if size parameter is 0
 	time_series_base::time_series_base(size_t _ringbuffer_size)
@@ -93,6 +122,9 @@ namespace stream_vis {
 		initialized = false;
 		ringbuffer_size = _ringbuffer_size;
 		nr_samples = 0;
+		nr_reserved_samples = 0;
+		first_sample_state = 0;
+		nr_overrun_samples = 0;
 		time_offset = 0;
 	}
 	/// return name of time series
@@ -110,5 +142,5 @@ namespace stream_vis {
 	template class time_series<float, int32_t, int64_t>;
 	template class time_series<float, uint32_t, uint64_t>;
 	template class time_series<float, cgv::math::fvec<float, 3>, cgv::math::fvec<double, 3>>;
-	template class time_series<float, cgv::math::quaternion<float>, cgv::math::quaternion<double>>;
+	template class time_series<float, cgv::math::quaternion<float>, cgv::math::quaternion<double>, false>;
 }
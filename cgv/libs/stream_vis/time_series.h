@@ -3,6 +3,11 @@
 #include <string>
 #include <vector>
 #include <atomic>
+#include <thread>
+#include <algorithm>
+#include <memory>
+#include <cstring>
+#include <cstdint>
 #include <cgv/math/fvec.h>
 #include <cgv/math/quaternion.h>
 
@@ -35,6 +40,19 @@ namespace stream_vis {
 	    When ringbuffer is used not all samples are stored and one distinguishes between sample index (si) and cached
 		sample index (csi). These can be converted into each other with convert_to_cached_sample_index() and
 		get_cached_sample_index()
+
+		Appending to a time series with ring buffer does not take a mutex. Similar to a Vyukov style multi producer
+		queue, producers reserve consecutive sample indices with an atomic counter and each ring buffer slot carries
+		an atomic sequence word, which tells whether the slot is being written or which sample it holds. A producer
+		claims the slots of its samples, stores the samples into atomic payload words and publishes each slot
+		independently of the other producers. Only if a producer lags a full ring buffer behind and finds its slot 
+		being written with an older sample, it yields until that write is complete. The number of samples is the 
+		length of the prefix of published or already overwritten samples and is advanced by whichever producer 
+		completes the prefix. Readers never wait for producers and validate the sequence word around each copy like 
+		the readers of a sequence lock, such that put_sample_as_float() and put_sample_as_double() fail instead of 
+		returning a torn sample. Readers that copy batches of samples use get_first_intact_sample_index() to find 
+		out how many samples were overwritten before they could be read. Without ring buffer samples are appended 
+		to a growing vector, such that reading concurrently to appending is not safe.
 	*/
 	class CGV_API time_series_base
 	{
@@ -44,7 +62,16 @@ namespace stream_vis {
 		/// keep name of time series
 		std::string name;
 		size_t ringbuffer_size;
+		/// number of published samples
 		std::atomic<size_t> nr_samples;
+		/// number of samples reserved by producers, which can exceed the number of published samples during appending
+		std::atomic<size_t> nr_reserved_samples;
+		/// state of initialization from first sample: 0 .. not started, 1 .. in progress, 2 .. done
+		std::atomic<int> first_sample_state;
+		/// number of samples that readers reported as lost due to overwriting in the ring buffer
+		mutable std::atomic<size_t> nr_overrun_samples;
+		/// reserve n consecutive sample indices and return the first one
+		size_t reserve_samples(size_t n) { return nr_reserved_samples.fetch_add(n); }
 	public:
 		/// construct time series - ring buffering is turned of if size parameter is 0
 		time_series_base(size_t _ringbuffer_size = 0);
@@ -56,12 +83,26 @@ namespace stream_vis {
 		virtual unsigned get_nr_components() const = 0;
 		/// return current number of cached samples
 		virtual size_t get_nr_cached_samples() const = 0;
-		/// return void pointer to stored sample
+		/// return void pointer to stored sample, which is null for time series with ring buffer whose slots are only accessed atomically
 		virtual void* get_void_sample_ptr(size_t index) = 0;
-		/// return const void pointer to stored sample
+		/// return const void pointer to stored sample, which is null for time series with ring buffer whose slots are only accessed atomically
 		virtual const void* get_void_sample_ptr(size_t index) const = 0;
+		/// copy the stored sample of given sample index to the passed memory and return false if it is not or no longer cached
+		virtual bool load_void_sample(size_t index, void* stored_sample) const = 0;
+		/// overwrite the cached stored sample of given sample index, must not be called concurrently to appending
+		virtual bool store_void_sample(size_t index, const void* stored_sample) = 0;
 		/// return total number of seen samples
 		size_t get_nr_samples() const;
+		/// return number of samples reserved by producers including the ones not yet published
+		size_t get_nr_reserved_samples() const;
+		/** to be called after copying samples starting at sample index si, returns the smallest sample index not
+		    smaller than si whose ring buffer slot has not been claimed by a producer of a newer sample, such that
+			samples before the returned index were overwritten and are lost for the reader. */
+		size_t get_first_intact_sample_index(size_t si) const;
+		/// return number of samples that readers reported as lost
+		size_t get_nr_overrun_samples() const;
+		/// report the number of samples that a reader lost because they were overwritten before being read
+		void add_overrun_samples(size_t n) const;
 		/// return sample index of first cached sample
 		size_t get_sample_index_of_first_cached_sample() const;
 		/// return time offset
@@ -82,8 +123,14 @@ namespace stream_vis {
 		inline size_t get_ringbuffer_size() const { return ringbuffer_size; }
 		/// set the ringbuffer size (currently it is assumed that this is called only directly after construction!!)
 		virtual void set_ringbuffer_size(size_t rbs);
+		/// remove all samples and restart sample indices at zero while keeping time and value offsets, must not be called concurrently to appending
+		virtual void clear_samples();
 		/// access sample of given sample index and store components specified in tsa in passed float array that must have sufficient space
 		virtual bool put_sample_as_float(size_t sample_index, float* output, TimeSeriesAccessor tsa = TSA_ALL) const = 0;
+		/// access sample of given sample index in full precision and store time and get_nr_components() value components
+		virtual bool put_sample_as_double(size_t sample_index, double& time, double* values) const = 0;
+		/// append a sample given by time and get_nr_components() value components in double precision
+		virtual void append_sample_from_double(double time, const double* values) = 0;
 	};
 
 	/// template class that optionally allows to subtract value offset from stored values
@@ -102,8 +149,11 @@ namespace stream_vis {
 		{
 			if (value_offset_initialized) // update already stored samples to new offset
 				for (size_t i = get_sample_index_of_first_cached_sample(); i < get_nr_samples(); ++i) {
-					auto& s = reinterpret_cast<std::pair<Time, Store>*>(get_void_sample_ptr(i))->second;
-					s = Store(value_offset + s - offset);
+					std::pair<Time, Store> s;
+					if (!load_void_sample(i, &s))
+						continue;
+					s.second = Store(value_offset + s.second - offset);
+					store_void_sample(i, &s);
 				}
 			else
 				value_offset_initialized = true;
@@ -145,18 +195,127 @@ namespace stream_vis {
 		typedef typename std::pair<double, Value> sample_type;
 		typedef typename std::pair<Time, Store> stored_sample_type;
 	protected:
+		/// samples of time series without ring buffer
 		std::vector<stored_sample_type> sample_cache;
+		/// number of 32 bit words in which a stored sample is copied into a ring buffer slot
+		static const size_t nr_slot_words = (sizeof(stored_sample_type) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+		/** ring buffer slot, whose sequence is 0 before the first write, 2*si+1 while sample si is written and 2*si+2
+		    once sample si is published. The sequence of a slot only grows, such that a slot never goes back to an older sample. */
+		struct ring_slot
+		{
+			std::atomic<size_t> sequence;
+			std::atomic<uint32_t> words[nr_slot_words];
+		};
+		/// slots of time series with ring buffer, allocated on the first sample
+		std::unique_ptr<ring_slot[]> ring_slots;
+		/// mark all ring buffer slots as never written
+		void reset_ring_slots()
+		{
+			if (ring_slots)
+				for (size_t csi = 0; csi < this->get_ringbuffer_size(); ++csi)
+					ring_slots[csi].sequence.store(0, std::memory_order_relaxed);
+		}
+		/// store sample si into its ring buffer slot unless a producer of a newer sample has claimed the slot already
+		void write_ring_slot(size_t si, const stored_sample_type& s)
+		{
+			ring_slot& slot = ring_slots[si % this->get_ringbuffer_size()];
+			size_t writing = 2 * si + 1;
+			size_t sequence = slot.sequence.load(std::memory_order_relaxed);
+			while (true) {
+				// sample si is outdated, as the slot already belongs to a newer sample
+				if (sequence >= writing)
+					return;
+				// wait for a producer lagging a full ring buffer behind to complete the write of an older sample
+				if ((sequence & 1) != 0) {
+					std::this_thread::yield();
+					sequence = slot.sequence.load(std::memory_order_relaxed);
+					continue;
+				}
+				// acquire orders the payload stores after the ones of the previous sample of the slot
+				if (slot.sequence.compare_exchange_weak(sequence, writing, std::memory_order_acquire, std::memory_order_relaxed))
+					break;
+			}
+			// release stores of the payload, such that readers that see one of them also see the claim of the slot
+			uint32_t buffer[nr_slot_words] = {};
+			std::memcpy(buffer, static_cast<const void*>(&s), sizeof(stored_sample_type));
+			for (size_t wi = 0; wi < nr_slot_words; ++wi)
+				slot.words[wi].store(buffer[wi], std::memory_order_release);
+			// sequentially consistent such that the publication cannot be missed by advance_nr_samples() of other producers
+			slot.sequence.store(writing + 1, std::memory_order_seq_cst);
+		}
+		/// copy sample si from its ring buffer slot and return false if the slot does not hold the published sample si
+		bool read_ring_slot(size_t si, stored_sample_type& s) const
+		{
+			const ring_slot& slot = ring_slots[si % this->get_ringbuffer_size()];
+			size_t published = 2 * si + 2;
+			if (slot.sequence.load(std::memory_order_acquire) != published)
+				return false;
+			// acquire loads of the payload, such that the validation sees the claim of a producer whose payload was copied
+			uint32_t buffer[nr_slot_words];
+			for (size_t wi = 0; wi < nr_slot_words; ++wi)
+				buffer[wi] = slot.words[wi].load(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != published)
+				return false;
+			std::memcpy(static_cast<void*>(&s), buffer, sizeof(stored_sample_type));
+			return true;
+		}
+		/// advance the number of samples over all samples that are published or already overwritten by newer samples
+		void advance_nr_samples()
+		{
+			size_t rbs = this->get_ringbuffer_size();
+			size_t n = this->nr_samples.load(std::memory_order_acquire);
+			while (n < this->nr_reserved_samples.load(std::memory_order_acquire)) {
+				// the producer of sample n has not published yet and advances the number of samples itself
+				if (ring_slots[n % rbs].sequence.load(std::memory_order_seq_cst) < 2 * n + 2)
+					return;
+				if (this->nr_samples.compare_exchange_weak(n, n + 1, std::memory_order_acq_rel))
+					++n;
+			}
+		}
 	public:
 		/// construct time series - ring buffering is turned of if size parameter is 0
 		time_series_cache(size_t _ringbuffer_size = 0) : time_series_value_offset<Time, Store, Value, use_value_offset>(_ringbuffer_size) {}
 		/// return number of components per sample
 		unsigned get_nr_components() const { return 1; }
 		/// return current number of cached samples
-		size_t get_nr_cached_samples() const { return sample_cache.size(); }
-		/// return const pointer to stored sample of given index or null if this sample is currently not cached
-		const stored_sample_type* get_sample_ptr(size_t si) const { return this->convert_to_cached_sample_index(si) ? &sample_cache[si] : 0; }
-		/// return pointer to stored sample of given index or null if this sample is currently not cached
-		stored_sample_type* get_sample_ptr(size_t si) { return this->convert_to_cached_sample_index(si) ? &sample_cache[si] : 0; }
+		size_t get_nr_cached_samples() const { return this->has_ringbuffer() ? std::min(this->get_nr_samples(), this->get_ringbuffer_size()) : sample_cache.size(); }
+		/// return const pointer to stored sample of given index or null if this sample is currently not cached or the time series has a ring buffer
+		const stored_sample_type* get_sample_ptr(size_t si) const { return !this->has_ringbuffer() && this->convert_to_cached_sample_index(si) ? &sample_cache[si] : 0; }
+		/// return pointer to stored sample of given index or null if this sample is currently not cached or the time series has a ring buffer
+		stored_sample_type* get_sample_ptr(size_t si) { return !this->has_ringbuffer() && this->convert_to_cached_sample_index(si) ? &sample_cache[si] : 0; }
+		/// copy stored sample of given sample index and return false if it is not cached or was overwritten while copying
+		bool load_sample(size_t si, stored_sample_type& s) const
+		{
+			if (this->has_ringbuffer())
+				return si < this->get_nr_samples() && ring_slots && read_ring_slot(si, s);
+			if (!this->convert_to_cached_sample_index(si))
+				return false;
+			s = sample_cache[si];
+			return true;
+		}
+		/// overwrite the cached stored sample of given sample index, must not be called concurrently to appending
+		bool store_sample(size_t si, const stored_sample_type& s)
+		{
+			if (!this->has_ringbuffer()) {
+				if (!this->convert_to_cached_sample_index(si))
+					return false;
+				sample_cache[si] = s;
+				return true;
+			}
+			stored_sample_type old;
+			if (!load_sample(si, old))
+				return false;
+			ring_slot& slot = ring_slots[si % this->get_ringbuffer_size()];
+			uint32_t buffer[nr_slot_words] = {};
+			std::memcpy(buffer, static_cast<const void*>(&s), sizeof(stored_sample_type));
+			for (size_t wi = 0; wi < nr_slot_words; ++wi)
+				slot.words[wi].store(buffer[wi], std::memory_order_relaxed);
+			return true;
+		}
+		/// copy the stored sample of given sample index to the passed memory and return false if it is not or no longer cached
+		bool load_void_sample(size_t si, void* stored_sample) const { return load_sample(si, *static_cast<stored_sample_type*>(stored_sample)); }
+		/// overwrite the cached stored sample of given sample index, must not be called concurrently to appending
+		bool store_void_sample(size_t si, const void* stored_sample) { return store_sample(si, *static_cast<const stored_sample_type*>(stored_sample)); }
 		/// return const void pointer to stored sample
 		const void* get_void_sample_ptr(size_t si) const { return get_sample_ptr(si); }
 		/// return void pointer to stored sample
@@ -166,8 +325,11 @@ namespace stream_vis {
 		{
 			if (this->initialized) // update time of already stored samples to new offset
 				for (size_t si = this->get_sample_index_of_first_cached_sample(); si < this->get_nr_samples(); ++si) {
-					auto& t = reinterpret_cast<stored_sample_type*>(get_void_sample_ptr(si))->first;
-					t = Time(this->time_offset + t - offset);
+					stored_sample_type s;
+					if (!load_sample(si, s))
+						continue;
+					s.first = Time(this->time_offset + s.first - offset);
+					store_sample(si, s);
 				}
 			else
 				this->initialized = true;
@@ -182,27 +344,73 @@ namespace stream_vis {
 		{
 			return sample_type(reconstruct_time(stored_sample.first), reconstruct_value(stored_sample.second));
 		}
+		/// initialize time and value offset and ring buffer from the first sample, where concurrent producers wait for the first one
+		void initialize_from_first_sample(double time, const Value& value)
+		{
+			int state = 0;
+			if (this->first_sample_state.compare_exchange_strong(state, 1)) {
+				if (!this->initialized) {
+					this->time_offset = time;
+					this->initialized = true;
+				}
+				this->construct_stored_value(value);
+				if (this->has_ringbuffer()) {
+					ring_slots.reset(new ring_slot[this->get_ringbuffer_size()]);
+					reset_ring_slots();
+				}
+				this->first_sample_state.store(2, std::memory_order_release);
+			}
+			else
+				while (this->first_sample_state.load(std::memory_order_acquire) != 2)
+					std::this_thread::yield();
+		}
 		/// append a new sample by conversion to internal types
 		void append_sample(double time, const Value& value)
 		{
-			if (!this->initialized) {
-				this->time_offset = time;
-				this->initialized = true;
-				if (this->has_ringbuffer())
-					sample_cache.reserve(this->get_ringbuffer_size());
+			append_samples(&time, &value, 1);
+		}
+		/// append n samples with one reservation, which is safe to be called from several producer threads
+		void append_samples(const double* times, const Value* values, size_t n)
+		{
+			if (n == 0)
+				return;
+			if (this->first_sample_state.load(std::memory_order_acquire) != 2)
+				initialize_from_first_sample(times[0], values[0]);
+			append_stored_samples(n, [&](size_t i) {
+				return stored_sample_type(this->construct_stored_time(times[i]), this->construct_stored_value(values[i]));
+			});
+		}
+		/// append n samples constructed with stored_sample(i) after initialization from first sample, which is safe to be called from several producer threads
+		template <typename F>
+		void append_stored_samples(size_t n, F stored_sample)
+		{
+			size_t si = this->reserve_samples(n);
+			if (this->has_ringbuffer()) {
+				// only the last ringbuffer_size samples of the batch survive
+				size_t rbs = this->get_ringbuffer_size();
+				for (size_t i = n > rbs ? n - rbs : 0; i < n; ++i)
+					write_ring_slot(si + i, stored_sample(i));
+				advance_nr_samples();
 			}
-			stored_sample_type s(this->construct_stored_time(time), this->construct_stored_value(value));
-			if (this->has_ringbuffer() && this->get_nr_samples() >= this->ringbuffer_size)
-				sample_cache[this->get_cached_sample_index(this->get_nr_samples())] = s;
-			else
-				sample_cache.push_back(s);
-			++this->nr_samples;
+			else {
+				// growing the vector is serialized by waiting for the turn to publish
+				while (this->nr_samples.load(std::memory_order_acquire) != si)
+					std::this_thread::yield();
+				for (size_t i = 0; i < n; ++i)
+					sample_cache.push_back(stored_sample(i));
+				this->nr_samples.store(si + n, std::memory_order_release);
+			}
+		}
+		void clear_samples()
+		{
+			time_series_base::clear_samples();
+			if (!this->has_ringbuffer())
+				sample_cache.clear();
+			reset_ring_slots();
 		}
 		void set_ringbuffer_size(size_t rbs)
 		{
 			time_series_base::set_ringbuffer_size(rbs);
-			if (this->ringbuffer_size > 0)
-				sample_cache.reserve(this->ringbuffer_size);
 		}
 	};
 
@@ -215,11 +423,11 @@ namespace stream_vis {
 		{
 		}
 		/// put time and value of queried sample component into passed references and return whether sample of given index was available
-		bool put_sample_as_float(size_t fst_si_then_csi, float* output, TimeSeriesAccessor tsa = TSA_ALL) const
+		bool put_sample_as_float(size_t si, float* output, TimeSeriesAccessor tsa = TSA_ALL) const
 		{
-			if (!this->convert_to_cached_sample_index(fst_si_then_csi))
+			typename time_series_cache<Time, Store, Value, use_value_offset>::stored_sample_type s;
+			if (!this->load_sample(si, s))
 				return false;
-			const typename time_series_cache<Time, Store, Value, use_value_offset>::stored_sample_type& s = this->sample_cache[fst_si_then_csi];
 			if ((tsa & TSA_TIME) != 0)
 				*output++ = s.first;
 			if ((tsa & TSA_X) != 0)
@@ -228,6 +436,21 @@ namespace stream_vis {
 				*output++ = std::abs(float(s.second));
 			return true;
 		}
+		/// access sample of given sample index in full precision
+		bool put_sample_as_double(size_t si, double& time, double* values) const
+		{
+			typename time_series::stored_sample_type s;
+			if (!this->load_sample(si, s))
+				return false;
+			time = this->reconstruct_time(s.first);
+			values[0] = double(this->reconstruct_value(s.second));
+			return true;
+		}
+		/// append a sample given in double precision
+		void append_sample_from_double(double time, const double* values)
+		{
+			this->append_sample(time, Value(values[0]));
+		}
 	};
 
 	/// specialization for vector types
@@ -241,11 +464,11 @@ namespace stream_vis {
 		/// return number of components per sample
 		unsigned get_nr_components() const { return N; }
 		/// put time and value of queried sample component into passed references and return whether sample of given index was available
-		bool put_sample_as_float(size_t fst_si_snd_csi, float* output, TimeSeriesAccessor tsa = TSA_ALL) const
+		bool put_sample_as_float(size_t si, float* output, TimeSeriesAccessor tsa = TSA_ALL) const
 		{
-			if (!this->convert_to_cached_sample_index(fst_si_snd_csi))
+			typename time_series_cache<Time, cgv::math::fvec<Store, N>, cgv::math::fvec<Value, N>, use_value_offset>::stored_sample_type s;
+			if (!this->load_sample(si, s))
 				return false;
-			const typename time_series_cache<Time, cgv::math::fvec<Store, N>, cgv::math::fvec<Value, N>, use_value_offset>::stored_sample_type& s = this->sample_cache[fst_si_snd_csi];
 			if ((tsa & TSA_TIME) != 0)
 				*output++ = s.first;
 			if ((tsa & TSA_X) != 0)
@@ -272,6 +495,26 @@ namespace stream_vis {
 			}
 			return true;
 		}
+		/// access sample of given sample index in full precision
+		bool put_sample_as_double(size_t si, double& time, double* values) const
+		{
+			typename time_series::stored_sample_type s;
+			if (!this->load_sample(si, s))
+				return false;
+			time = this->reconstruct_time(s.first);
+			cgv::math::fvec<Value, N> v = this->reconstruct_value(s.second);
+			for (uint32_t ci = 0; ci < N; ++ci)
+				values[ci] = double(v[ci]);
+			return true;
+		}
+		/// append a sample given in double precision
+		void append_sample_from_double(double time, const double* values)
+		{
+			cgv::math::fvec<Value, N> v;
+			for (uint32_t ci = 0; ci < N; ++ci)
+				v[ci] = Value(values[ci]);
+			this->append_sample(time, v);
+		}
 	};
 	/// specialization for quaternion types
 	template <typename Time, typename Store, typename Value, bool use_value_offset>
@@ -284,11 +527,11 @@ namespace stream_vis {
 		/// return number of components per sample
 		unsigned get_nr_components() const { return 4; }
 		/// put time and value of queried sample component into passed references and return whether sample of given index was available
-		bool put_sample_as_float(size_t fst_si_then_csi, float* output, TimeSeriesAccessor tsa = TSA_ALL) const
+		bool put_sample_as_float(size_t si, float* output, TimeSeriesAccessor tsa = TSA_ALL) const
 		{
-			if (!this->convert_to_cached_sample_index(fst_si_then_csi))
+			typename time_series_cache<Time, cgv::math::quaternion<Store>, cgv::math::quaternion<Value>, use_value_offset>::stored_sample_type s;
+			if (!this->load_sample(si, s))
 				return false;
-			const typename time_series_cache<Time, cgv::math::quaternion<Store>, cgv::math::quaternion<Value>, use_value_offset>::stored_sample_type& s = this->sample_cache[fst_si_then_csi];
 			if ((tsa & TSA_TIME) != 0)
 				*output++ = s.first;
 			if ((tsa & TSA_X) != 0)
@@ -315,6 +558,26 @@ namespace stream_vis {
 			}
 			return true;
 		}
+		/// access sample of given sample index in full precision
+		bool put_sample_as_double(size_t si, double& time, double* values) const
+		{
+			typename time_series::stored_sample_type s;
+			if (!this->load_sample(si, s))
+				return false;
+			time = this->reconstruct_time(s.first);
+			auto q = this->reconstruct_value(s.second);
+			for (unsigned ci = 0; ci < 4; ++ci)
+				values[ci] = double(q[ci]);
+			return true;
+		}
+		/// append a sample given in double precision
+		void append_sample_from_double(double time, const double* values)
+		{
+			cgv::math::quaternion<Value> q;
+			for (unsigned ci = 0; ci < 4; ++ci)
+				q[ci] = Value(values[ci]);
+			this->append_sample(time, q);
+		}
 	};
 }
 
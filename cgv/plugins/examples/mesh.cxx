@@ -123,6 +123,8 @@ public:
 		show_wireframe = true;
 
 		show_vertices = true;
+		// map obj files from their msm cache when they are loaded again
+		mesh_type::set_msm_cache_enabled(true);
 		if (getenv("CGV_DIR"))
 			M.read(std::string(getenv("CGV_DIR")) + "/plugins/examples/res/example.obj");
 		else
@@ -83,6 +83,7 @@ pointcloud_lod_render_test::pointcloud_lod_render_test() {
 	//rebuild_ptrs.insert(&color_based_on_lod);
 	//rebuild_ptrs.insert(&max_points);
 	rebuild_ptrs.insert(&pointcloud_fit_table);
+	rebuild_ptrs.insert(&out_of_core_lods);
 
 	color_based_on_lod = false;
 	show_environment = true;
@@ -171,7 +172,9 @@ bool pointcloud_lod_render_test::self_reflect(cgv::reflect::reflection_handler &
 		rh.reflect_member("model_rotation_x", model_rotation.x()) &&
 		rh.reflect_member("model_rotation_y", model_rotation.y()) &&
 		rh.reflect_member("model_rotation_z", model_rotation.z()) && 
-		rh.reflect_member("show_environment", show_environment);
+		rh.reflect_member("show_environment", show_environment) &&
+		rh.reflect_member("out_of_core_lods", out_of_core_lods) &&
+		rh.reflect_member("out_of_core_directory", out_of_core_directory);
 }
 
 void pointcloud_lod_render_test::on_set(void * member_ptr)
@@ -350,7 +353,10 @@ void pointcloud_lod_render_test::draw(cgv::render::context & ctx)
 					}
 				}
 				if ((LoDMode)lod_mode == LoDMode::OCTREE) {
-					points_with_lod = std::move(lod_generator.generate_lods(V));
+					if (out_of_core_lods)
+						generate_lods_out_of_core(V);
+					else
+						points_with_lod = std::move(lod_generator.generate_lods(V));
 					//cp_renderer.set_points(&points_with_lod.data()->position, &points_with_lod.data()->colors, &points_with_lod.data()->level, points_with_lod.size(),sizeof(octree_lod_generator::Vertex));
 				}
 				else {
@@ -633,6 +639,7 @@ void pointcloud_lod_render_test::create_gui()
 	connect_copy(add_button("random assign deleted label")->click, rebind(this, &pointcloud_lod_render_test::on_random_labels));
 	std::string mode_defs = "enums='random=2;octree=1'";
 	connect_copy(add_control("lod generator", (DummyEnum&)lod_mode, "dropdown", mode_defs)->value_change, rebind(this, &pointcloud_lod_render_test::on_lod_mode_change));
+	add_member_control(this, "out-of-core octree", out_of_core_lods, "toggle");
 
 	add_decorator("point cloud", "heading", "level=2");
 
@@ -759,6 +766,27 @@ void pointcloud_lod_render_test::on_lod_mode_change()
 	renderer_out_of_date = true;
 }
 
+void pointcloud_lod_render_test::generate_lods_out_of_core(const std::vector<LODPoint>& V)
+{
+	points_with_lod.clear();
+	std::string file_name = out_of_core_directory + "/lod_octree.bin";
+	if (!lod_generator.generate_lods_out_of_core(V.data(), V.size(), file_name, out_of_core_directory)) {
+		std::cerr << "out-of-core lod generation failed" << std::endl;
+		return;
+	}
+	cgv::pointcloud::octree_file_reader<LODPoint> reader;
+	if (reader.open(file_name)) {
+		for (size_t i = 0; i < reader.get_nodes().size(); ++i) {
+			const LODPoint* node_points = reader.get_node_points(i);
+			points_with_lod.insert(points_with_lod.end(), node_points, node_points + reader.get_nodes()[i].num_points);
+		}
+		reader.close();
+	}
+	else
+		std::cerr << "could not read octree file " << file_name << std::endl;
+	cgv::utils::file::remove(file_name);
+}
+
 void pointcloud_lod_render_test::on_random_labels()
 {
 	for (auto& label : point_labels) {
@@ -117,6 +117,8 @@ protected:
 	void on_reg_find_point_cloud_cb();
 	void on_point_cloud_style_cb();
 	void on_lod_mode_change();
+	/// generate octree lods through the out-of-core path of the lod generator and read back all nodes of the written octree file
+	void generate_lods_out_of_core(const std::vector<LODPoint>& V);
 	void on_random_labels();
 
 	void construct_table(float tw, float td, float th, float tW);
@@ -191,6 +193,9 @@ private:
 	static constexpr float max_level_hue = 1.0;
 	
 	int lod_mode = (int)LoDMode::OCTREE;
+	// generate octree lods out-of-core with chunk and octree files in out_of_core_directory
+	bool out_of_core_lods = false;
+	std::string out_of_core_directory = ".";
 	
 	bool gui_model_positioning = false;
 	vec3 model_position= vec3(0);
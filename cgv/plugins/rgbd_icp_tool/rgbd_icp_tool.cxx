@@ -54,6 +54,7 @@ rgbd_icp_tool::rgbd_icp_tool() {
 	icp_iterations = 50;
 	icp_eps = 1e-8;
 	icp_random_samples = 0;
+	icp_accelerated = false;
 
 	show_corresponding_lines = true;
 
@@ -228,6 +229,7 @@ void rgbd_icp_tool::create_gui()
 	add_member_control(this, "Sampling Type", (DummyEnum&)icp_filter_type, "dropdown", "enums='Default Sampling,Radom Sampling,Normal-space Sampling'");
 	add_member_control(this, "Random Samples", icp_random_samples, "value_slider",
 					   "min=0;max=10000;log=true;ticks=false");
+	add_member_control(this, "accelerated", icp_accelerated, "check");
 	add_member_control(this, "show_corresponding_lines", show_corresponding_lines, "check");
 
 	add_decorator("Go-ICP", "heading", "level=2");
@@ -355,8 +357,20 @@ void rgbd_icp_tool::on_reg_ICP_cb()
 	icp.set_eps(icp_eps);
 	icp.set_num_random(icp_random_samples);
 
-	icp.build_ann_tree();
-	icp.reg_icp(rotation, translation);
+	if (icp_accelerated) {
+		// coarse-to-fine from the random sample count to all points, 0 samples select all points on a single level
+		icp.set_iterations(icp_iterations);
+		icp.use_point_to_plane = target_pc.has_normals();
+		icp.subsampling_schedule.clear();
+		if (icp_random_samples > 0)
+			icp.subsampling_schedule.push_back(icp_random_samples);
+		icp.subsampling_schedule.push_back(0);
+		icp.reg_icp_accelerated(rotation, translation);
+	}
+	else {
+		icp.build_ann_tree();
+		icp.reg_icp(rotation, translation);
+	}
 	//icp.get_crspd(rotation, translation, crs_srs_pc, crs_tgt_pc);
 	// need to de-mean for rotation
 	source_pc.rotate(cgv::math::quaternion<float>(rotation));
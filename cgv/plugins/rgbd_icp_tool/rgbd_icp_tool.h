@@ -97,6 +97,8 @@ public:
 	float icp_eps;
 	int icp_iterations;
 	int icp_random_samples;
+	/// register with ICP::reg_icp_accelerated, point to plane if the target cloud has normals
+	bool icp_accelerated;
 	cgv::pointcloud::ICP::Sampling_Type icp_filter_type;
 	bool view_find_point_cloud;
 	bool show_corresponding_lines;
@@ -82,6 +82,8 @@ class vr_rgbd : public cgv::base::node,
 	int imgs_counter;
 	/// intermediate point cloud and to be rendered point cloud
 	std::vector<vertex> intermediate_pc, current_pc;
+	/// per pixel points of the depth frame used to construct intermediate_pc
+	std::vector<vec3> depth_points;
 	/// list of recorded point clouds
 	std::vector<std::vector<vertex>> recorded_pcs;
 	/// translations of recorded point clouds
@@ -339,7 +341,6 @@ class vr_rgbd : public cgv::base::node,
 	size_t construct_point_cloud()
 	{
 		intermediate_pc.clear();
-		const unsigned short* depths = reinterpret_cast<const unsigned short*>(&depth_frame_2.frame_data.front());
 		const unsigned char* colors = reinterpret_cast<const unsigned char*>(&color_frame_2.frame_data.front());
 
 		rgbd_inp.map_color_to_depth(depth_frame_2, color_frame_2, warped_color_frame_2);
@@ -355,11 +356,22 @@ class vr_rgbd : public cgv::base::node,
 			imgs_counter++;
 		}
 
+		depth_points.resize(size_t(depth_frame_2.width) * depth_frame_2.height);
+		if (rgbd_inp.map_depth_frame_to_points(depth_frame_2, &depth_points.front()[0]) == 0) {
+			// fall back to per pixel mapping for devices whose mapping is not linear in depth
+			const unsigned short* depths = reinterpret_cast<const unsigned short*>(&depth_frame_2.frame_data.front());
+			int i = 0;
+			for (int y = 0; y < depth_frame_2.height; ++y)
+				for (int x = 0; x < depth_frame_2.width; ++x, ++i)
+					if (!rgbd_inp.map_depth_to_point(x, y, depths[i], &depth_points[i][0]))
+						depth_points[i] = vec3(0.0f);
+		}
+
 		int i = 0;
 		for (int y = 0; y < depth_frame_2.height; ++y)
 			for (int x = 0; x < depth_frame_2.width; ++x) {
-				vec3 p;
-				if (rgbd_inp.map_depth_to_point(x, y, depths[i], &p[0])) {
+				vec3 p = depth_points[i];
+				if (p[2] > 0) {
 					// flipping y to make it the same direction as in pixel y coordinate
 					p = -p;
 					p = rgbd_2_controller_orientation * p + rgbd_2_controller_position;
@@ -0,0 +1,71 @@
+#include <cgv/base/register.h>
+#include <cgv/data/data_view.h>
+#include <algorithm>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::type;
+
+bool test_data_view_reformat()
+{
+	// permute a small rgba volume and reorder components
+	data_format df(7, 5, 3, TI_UINT16, "R,G,B,A");
+	data_view dv(&df);
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 5; ++j)
+			for (size_t k = 0; k < 7; ++k)
+				for (unsigned ci = 0; ci < 4; ++ci)
+					dv(i, j, k).set(ci, int(1000 * ci + 100 * i + 10 * j + k));
+	data_view pv;
+	TEST_ASSERT(dv.permute_into(pv, "kji"));
+	TEST_ASSERT_EQ(pv.get_format()->get_width(), size_t(3));
+	TEST_ASSERT_EQ(pv.get_format()->get_depth(), size_t(7));
+	TEST_ASSERT_EQ(pv.get<int>(2, 6, 4, 1), 2146);
+	data_view rv;
+	TEST_ASSERT(data_view::reformat(rv, dv.permute("ikj"), "B,G,R", 8));
+	TEST_ASSERT_EQ(rv.get_format()->get_nr_components(), 3u);
+	TEST_ASSERT_EQ(rv.get_format()->get_component_name(0), std::string("B"));
+	TEST_ASSERT_EQ(rv.get_step_size(2), size_t(8));
+	bool all_equal = true;
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 5; ++j)
+			for (size_t k = 0; k < 7; ++k)
+				for (unsigned ci = 0; ci < 3; ++ci)
+					all_equal = all_equal && rv.get<int>(ci, i, k, j) == dv.get<int>(2 - ci, i, j, k);
+	TEST_ASSERT(all_equal);
+	TEST_ASSERT(!data_view::reformat(rv, dv, "R,X"));
+
+	// entry alignment only changes the layout if entry padding is enabled
+	data_format dfa(7, 5, TI_UINT16, "R,G,B");
+	dfa.set_entry_alignment(8);
+	TEST_ASSERT_EQ(dfa.get_nr_bytes(), size_t(7 * 5 * 6));
+	TEST_ASSERT_EQ(data_view(&dfa).get_step_size(1), size_t(6));
+	dfa.set_entry_padding(true);
+	TEST_ASSERT_EQ(dfa.get_nr_bytes(), size_t(7 * 5 * 8));
+	TEST_ASSERT_EQ(data_view(&dfa).get_step_size(1), size_t(8));
+
+	// transposing a larger volume in tiles matches copying in destination order
+	size_t n = 256;
+	data_format dfl(n, n, n, TI_FLT32, "L");
+	data_view dvl(&dfl);
+	float* p = dvl.get_ptr<float>();
+	for (size_t i = 0; i < n * n * n; ++i)
+		p[i] = float(i);
+	data_view tv;
+	TEST_ASSERT(dvl.permute_into(tv, "kji"));
+	std::vector<float> naive(n * n * n);
+	data_view sv = dvl.permute("kji");
+	for (size_t i = 0; i < n; ++i)
+		for (size_t j = 0; j < n; ++j)
+			for (size_t k = 0; k < n; ++k)
+				naive[(i * n + j) * n + k] = *sv.get_ptr<float>(i, j, k);
+	TEST_ASSERT(std::equal(naive.begin(), naive.end(), tv.get_ptr<float>()));
+	TEST_ASSERT_EQ(*tv.get_ptr<float>(1, 2, 3), float((3 * n + 2) * n + 1));
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration data_view_reformat_test_registration(
+	"cgv::data::data_view::reformat", test_data_view_reformat);
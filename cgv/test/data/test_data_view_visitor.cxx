@@ -0,0 +1,104 @@
+#include <cgv/base/register.h>
+#include <cgv/data/data_view_visitor.h>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::type;
+
+bool test_data_view_visitor()
+{
+	// extents of full, sub and permuted views
+	data_format df(5, 4, 3, TI_FLT32, "R,G");
+	data_view dv(&df);
+	TEST_ASSERT_EQ(dv.get_extent(0), size_t(3));
+	TEST_ASSERT_EQ(dv.get_extent(1), size_t(4));
+	TEST_ASSERT_EQ(dv.get_extent(2), size_t(5));
+	TEST_ASSERT_EQ(dv(1).get_extent(0), size_t(4));
+	TEST_ASSERT_EQ(dv.permute("kji").get_extent(0), size_t(5));
+	TEST_ASSERT_EQ(dv.permute("kji").get_extent(2), size_t(3));
+
+	// fill through typed access and compare against component access through the format
+	TEST_ASSERT(visit(dv, [](const auto& tv) {
+		for (size_t i = 0; i < tv.get_extent(0); ++i)
+			for (size_t j = 0; j < tv.get_extent(1); ++j)
+				for (size_t k = 0; k < tv.get_extent(2); ++k)
+					for (unsigned ci = 0; ci < tv.get_nr_components(); ++ci)
+						tv(ci, i, j, k) = float(100 * i + 10 * j + k + 0.5 * ci);
+	}));
+	TEST_ASSERT_EQ(dv.get<float>(1, 2, 3, 4), 234.5f);
+	size_t nr_entries = 0;
+	visit(const_data_view(dv), [&](const auto& tv) {
+		for (size_t r = 0; r < tv.get_nr_rows(); ++r)
+			for (auto it = tv.row(r).begin(); it != tv.row(r).end(); ++it) {
+				++nr_entries;
+				TEST_ASSERT_EQ(it[1] - *it, 0.5f);
+			}
+	});
+	TEST_ASSERT_EQ(nr_entries, size_t(60));
+
+	// transform and reduce on a permuted view match the full view
+	TEST_ASSERT(transform(dv.permute("kji"), [](auto x) { return 2 * x; }));
+	TEST_ASSERT_EQ(dv.get<float>(0, 2, 3, 4), 468.0f);
+	double sum = 0;
+	TEST_ASSERT(reduce(dv.permute("jik"), sum, [](double& s, float x) { s += x; }, [](double& s, double p) { s += p; }));
+	double expected = 0;
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 4; ++j)
+			for (size_t k = 0; k < 5; ++k)
+				expected += 2 * (2 * float(100 * i + 10 * j + k) + 0.5);
+	TEST_ASSERT(std::abs(sum - expected) < 1e-6);
+
+	// convert into other component type and layout
+	data_format df8(5, 4, 3, TI_UINT8, "R,G");
+	data_view dv8(&df8);
+	data_format df16(3, 4, 5, TI_UINT16, "R,G");
+	data_view dv16(&df16);
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 4; ++j)
+			for (size_t k = 0; k < 5; ++k)
+				dv8(i, j, k).set(0, int(i + j + k)), dv8(i, j, k).set(1, int(i * j * k));
+	TEST_ASSERT(convert_into(dv8, dv));
+	TEST_ASSERT_EQ(dv.get<float>(1, 2, 3, 4), 24.0f);
+	TEST_ASSERT(!convert_into(dv8, dv16));
+	TEST_ASSERT(convert_into(dv8.permute("kji"), dv16));
+	TEST_ASSERT_EQ(dv16.get<int>(0, 4, 3, 2), 9);
+	TEST_ASSERT_EQ(dv16.get<int>(1, 4, 3, 2), 24);
+
+	// packed formats are not supported
+	data_format dfp(4, 4, TI_UINT16, "R,G,B", 1, 5, 6, 5);
+	data_view dvp(&dfp);
+	TEST_ASSERT(!transform(dvp, [](auto x) { return x; }));
+
+	// compare bulk kernel with per component access
+	data_format dfl(512, 512, 16, TI_UINT16, "L");
+	data_view dvl(&dfl);
+	TEST_ASSERT(transform(dvl, [](auto) { return 7; }));
+	double s0 = 0;
+	for (size_t i = 0; i < 16; ++i)
+		for (size_t j = 0; j < 512; ++j)
+			for (size_t k = 0; k < 512; ++k)
+				s0 += dvl.get<double>(0, i, j, k);
+	double s1 = 0;
+	reduce(dvl, s1, [](double& s, uint16_type x) { s += x; }, [](double& s, double p) { s += p; });
+	TEST_ASSERT_EQ(s0, s1);
+
+	// extents are stored in the views, also for dimensions of resolution one with coinciding step sizes
+	data_format df1(1, 1, 3, TI_UINT8, "L");
+	data_view dv1(&df1);
+	TEST_ASSERT_EQ(dv1.get_extent(0), size_t(3));
+	TEST_ASSERT_EQ(dv1.get_extent(2), size_t(1));
+	const_data_view dvs = dvl(2);
+	TEST_ASSERT_EQ(dvs.get_dim(), 2u);
+	TEST_ASSERT_EQ(dvs.get_extent(0), size_t(512));
+	TEST_ASSERT_EQ(dvs.permute("ji").get_extent(1), size_t(512));
+	TEST_ASSERT_EQ(dv8.permute("kji").get_extent(0), size_t(5));
+	TEST_ASSERT_EQ(dv8.permute("kji").get_extent(2), size_t(3));
+	TEST_ASSERT_EQ(dv8.get_extent(3), size_t(0));
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration data_view_visitor_test_registration(
+	"cgv::data::data_view_visitor", test_data_view_visitor);
@@ -0,0 +1,193 @@
+#include <cgv/base/register.h>
+#include <plot/min_max_pyramid.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::plot;
+using cgv::vec2;
+
+/// gives access to the blocks of a pyramid
+struct pyramid_inspector : public min_max_pyramid
+{
+	bool same_blocks(const pyramid_inspector& P) const
+	{
+		if (levels.size() != P.levels.size())
+			return false;
+		for (size_t l = 0; l < levels.size(); ++l) {
+			if (levels[l].size() != P.levels[l].size())
+				return false;
+			for (size_t b = 0; b < levels[l].size(); ++b)
+				if (levels[l][b].min_sample != P.levels[l][b].min_sample || levels[l][b].max_sample != P.levels[l][b].max_sample)
+					return false;
+		}
+		return true;
+	}
+};
+
+/// generate a noisy time series with sorted x-coordinates
+static std::vector<vec2> generate_samples(size_t n, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::vector<vec2> samples(n);
+	for (size_t k = 0; k < n; ++k)
+		samples[k] = vec2(0.01f * k, std::sin(0.001f * k) + 0.1f * dist(generator));
+	return samples;
+}
+
+/// check that result contains the given sample
+static bool contains(const std::vector<vec2>& result, const vec2& s)
+{
+	return std::find(result.begin(), result.end(), s) != result.end();
+}
+
+/// check that x-coordinates of result are non decreasing
+static bool is_x_sorted(const std::vector<vec2>& result)
+{
+	for (size_t k = 1; k < result.size(); ++k)
+		if (result[k][0] < result[k - 1][0])
+			return false;
+	return true;
+}
+
+bool test_min_max_pyramid_incremental()
+{
+	std::vector<vec2> all_samples = generate_samples(20000, 1);
+	pyramid_inspector full;
+	full.update(all_samples);
+	TEST_ASSERT_EQ(full.get_nr_samples(), all_samples.size());
+	TEST_ASSERT_EQ(full.get_nr_levels(), 4u);
+	TEST_ASSERT(full.is_sorted());
+
+	// append in chunks of varying size that cross block boundaries of all levels
+	pyramid_inspector incremental;
+	std::vector<vec2> samples;
+	size_t chunk_sizes[] = { 1, 2, 5, 7, 8, 63, 64, 65, 511, 513, 4095, 1 };
+	size_t ci = 0;
+	while (samples.size() < all_samples.size()) {
+		size_t n = std::min(samples.size() + chunk_sizes[ci++ % 12], all_samples.size());
+		samples.insert(samples.end(), all_samples.begin() + samples.size(), all_samples.begin() + n);
+		incremental.update(samples);
+		TEST_ASSERT_EQ(incremental.get_nr_samples(), samples.size());
+	}
+	TEST_ASSERT(incremental.same_blocks(full));
+
+	// extraction results agree as well
+	float intervals[][2] = { { 0.0f, 200.0f }, { 13.37f, 57.5f }, { 150.0f, 199.99f } };
+	for (auto& iv : intervals) {
+		std::vector<vec2> r_full, r_incremental;
+		unsigned l_full = full.extract(all_samples, iv[0], iv[1], 100, r_full);
+		unsigned l_incremental = incremental.extract(samples, iv[0], iv[1], 100, r_incremental);
+		TEST_ASSERT_EQ(l_full, l_incremental);
+		TEST_ASSERT(l_full > 0);
+		TEST_ASSERT(r_full == r_incremental);
+		TEST_ASSERT(r_full.size() <= 4 * 100 + 8);
+	}
+
+	// a shrinking container leads to a rebuild
+	samples.resize(1000);
+	incremental.update(samples);
+	pyramid_inspector rebuilt;
+	rebuilt.update(samples);
+	TEST_ASSERT_EQ(incremental.get_nr_samples(), size_t(1000));
+	TEST_ASSERT(incremental.same_blocks(rebuilt));
+	return true;
+}
+
+bool test_min_max_pyramid_spikes()
+{
+	std::vector<vec2> samples(100000);
+	for (size_t k = 0; k < samples.size(); ++k)
+		samples[k] = vec2(float(k), 0.0f);
+	// single sample spikes at unaligned positions, also close to the boundaries of the extracted interval
+	size_t spike_indices[] = { 3, 12345, 54321, 70001, 99998 };
+	float spike_values[] = { 7.0f, 100.0f, -50.0f, 3.0f, -2.0f };
+	for (unsigned i = 0; i < 5; ++i)
+		samples[spike_indices[i]][1] = spike_values[i];
+
+	min_max_pyramid P;
+	P.update(samples);
+	std::vector<vec2> result;
+	unsigned nr_levels = P.extract(samples, 0.0f, float(samples.size() - 1), 200, result);
+	TEST_ASSERT(nr_levels > 1);
+	TEST_ASSERT(result.size() <= 4 * 200 + 8);
+	TEST_ASSERT(is_x_sorted(result));
+	for (unsigned i = 0; i < 5; ++i)
+		TEST_ASSERT(contains(result, samples[spike_indices[i]]));
+
+	// spikes survive in a partial interval whose boundaries are not aligned to blocks
+	nr_levels = P.extract(samples, 12000.5f, 70001.0f, 50, result);
+	TEST_ASSERT(nr_levels > 1);
+	TEST_ASSERT(is_x_sorted(result));
+	TEST_ASSERT(contains(result, samples[12345]));
+	TEST_ASSERT(contains(result, samples[54321]));
+	TEST_ASSERT(contains(result, samples[70001]));
+	TEST_ASSERT(!contains(result, samples[3]));
+	TEST_ASSERT(!contains(result, samples[99998]));
+	// one sample on each side of the interval is included
+	TEST_ASSERT_EQ(result.front(), samples[12000]);
+	TEST_ASSERT_EQ(result.back(), samples[70002]);
+	return true;
+}
+
+bool test_min_max_pyramid_unsorted_and_nan()
+{
+	// unsorted samples are returned unchanged
+	std::vector<vec2> samples = generate_samples(5000, 2);
+	min_max_pyramid P;
+	P.update(samples);
+	TEST_ASSERT(P.is_sorted());
+	samples.push_back(vec2(1.0f, 0.5f));
+	P.update(samples);
+	TEST_ASSERT(!P.is_sorted());
+	std::vector<vec2> result;
+	TEST_ASSERT_EQ(P.extract(samples, 0.0f, 50.0f, 10, result), 0u);
+	TEST_ASSERT(result == samples);
+	// sortedness is restored only by a rebuild
+	samples.pop_back();
+	P.update(samples);
+	TEST_ASSERT(P.is_sorted());
+
+	// nan samples never replace minima or maxima
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	samples.assign(40000, vec2(0.0f));
+	for (size_t k = 0; k < samples.size(); ++k)
+		samples[k] = vec2(float(k), k % 3 == 0 ? nan : float(k % 5));
+	samples[0][1] = nan;
+	samples[17777][1] = 42.0f;
+	samples[31111][1] = -42.0f;
+	P.clear();
+	P.update(samples);
+	unsigned nr_levels = P.extract(samples, 0.0f, 39999.0f, 100, result);
+	TEST_ASSERT(nr_levels > 0);
+	TEST_ASSERT(result.size() <= 4 * 100 + 8);
+	TEST_ASSERT(is_x_sorted(result));
+	TEST_ASSERT(contains(result, samples[17777]));
+	TEST_ASSERT(contains(result, samples[31111]));
+	// except for first and last samples of columns all extracted samples are finite
+	size_t nr_nan = 0;
+	for (const auto& s : result)
+		if (s[1] != s[1])
+			++nr_nan;
+	TEST_ASSERT(nr_nan <= 2 * 100 + 2);
+	// blocks consisting of nan samples only keep nan extremes
+	std::vector<vec2> nan_samples(100, vec2(0.0f, nan));
+	for (size_t k = 0; k < nan_samples.size(); ++k)
+		nan_samples[k][0] = float(k);
+	P.clear();
+	P.update(nan_samples);
+	P.extract(nan_samples, 0.0f, 99.0f, 2, result);
+	TEST_ASSERT(!result.empty());
+	for (const auto& s : result)
+		TEST_ASSERT(s[1] != s[1]);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_min_max_pyramid_incremental_reg("cgv::plot::min_max_pyramid::incremental", test_min_max_pyramid_incremental);
+extern CGV_API test_registration test_min_max_pyramid_spikes_reg("cgv::plot::min_max_pyramid::spikes", test_min_max_pyramid_spikes);
+extern CGV_API test_registration test_min_max_pyramid_unsorted_and_nan_reg("cgv::plot::min_max_pyramid::unsorted_and_nan", test_min_max_pyramid_unsorted_and_nan);
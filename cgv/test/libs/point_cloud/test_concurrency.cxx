@@ -0,0 +1,157 @@
+#include <cgv/base/register.h>
+#include <point_cloud/concurrency.h>
+#include <point_cloud/neighbor_graph.h>
+#include <point_cloud/point_kd_tree.h>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+
+using namespace cgv::base;
+using cgv::pointcloud::utility::TaskScheduler;
+
+bool test_task_scheduler_parallel_for()
+{
+	TaskScheduler scheduler(3);
+	TEST_ASSERT_EQ(scheduler.get_num_threads(), 4u);
+	// every index is visited exactly once for automatic and explicit grain sizes
+	for (int64_t grain_size : { int64_t(0), int64_t(1), int64_t(7), int64_t(100000) }) {
+		std::vector<std::atomic_int> visits(10007);
+		for (auto& v : visits)
+			v = 0;
+		scheduler.parallel_for(0, visits.size(), grain_size, [&](int64_t begin, int64_t end) {
+			TEST_ASSERT(begin < end);
+			TEST_ASSERT(grain_size <= 0 || end - begin <= grain_size);
+			for (int64_t i = begin; i < end; ++i)
+				++visits[i];
+		});
+		for (auto& v : visits)
+			TEST_ASSERT_EQ(int(v), 1);
+	}
+	// empty ranges do not call the function
+	bool called = false;
+	scheduler.parallel_for(5, 5, 1, [&](int64_t, int64_t) { called = true; });
+	TEST_ASSERT(!called);
+	return true;
+}
+
+bool test_task_scheduler_nesting()
+{
+	TaskScheduler scheduler(3);
+	// nested parallel_for calls wait by executing tasks and cannot deadlock the workers
+	std::atomic_int64_t sum(0);
+	scheduler.parallel_for(0, 64, 1, [&](int64_t begin, int64_t end) {
+		for (int64_t i = begin; i < end; ++i)
+			scheduler.parallel_for(0, 1000, 10, [&](int64_t b, int64_t e) {
+				for (int64_t j = b; j < e; ++j)
+					sum += j;
+			});
+	});
+	TEST_ASSERT_EQ(int64_t(sum), 64 * int64_t(999 * 1000 / 2));
+
+	// spawned tasks of a group are complete after wait
+	TaskScheduler::TaskGroup group;
+	std::atomic_int nr_done(0);
+	for (int t = 0; t < 100; ++t)
+		scheduler.spawn(group, [&]() {
+			TaskScheduler::TaskGroup inner_group;
+			scheduler.spawn(inner_group, [&]() { ++nr_done; });
+			scheduler.wait(inner_group);
+			++nr_done;
+		});
+	scheduler.wait(group);
+	TEST_ASSERT_EQ(int(nr_done), 200);
+
+	// run calls each thread id once
+	std::vector<std::atomic_int> thread_calls(scheduler.get_num_threads());
+	for (auto& c : thread_calls)
+		c = 0;
+	scheduler.run([&](int thread_id) { ++thread_calls[thread_id]; });
+	for (auto& c : thread_calls)
+		TEST_ASSERT_EQ(int(c), 1);
+	return true;
+}
+
+bool test_task_scheduler_exceptions()
+{
+	TaskScheduler scheduler(3);
+	// an exception of a spawned task completes the group and is rethrown by wait
+	TaskScheduler::TaskGroup group;
+	std::atomic_int nr_done(0);
+	for (int t = 0; t < 100; ++t)
+		scheduler.spawn(group, [&, t]() {
+			if (t == 50)
+				throw std::runtime_error("task failed");
+			++nr_done;
+		});
+	bool caught = false;
+	try {
+		scheduler.wait(group);
+	}
+	catch (const std::runtime_error& e) {
+		caught = std::string(e.what()) == "task failed";
+	}
+	TEST_ASSERT(caught);
+	TEST_ASSERT_EQ(group.pending.load(), 0);
+	TEST_ASSERT(nr_done <= 99);
+
+	// exceptions thrown by stolen or local subranges reach the caller of parallel_for and run
+	for (int64_t failing_index : { int64_t(0), int64_t(9999) }) {
+		caught = false;
+		try {
+			scheduler.parallel_for(0, 10000, 10, [&](int64_t begin, int64_t end) {
+				if (begin <= failing_index && failing_index < end)
+					throw std::runtime_error("range failed");
+			});
+		}
+		catch (const std::runtime_error&) {
+			caught = true;
+		}
+		TEST_ASSERT(caught);
+	}
+	for (int failing_thread : { 0, 2 }) {
+		caught = false;
+		try {
+			scheduler.run([&](int thread_id) {
+				if (thread_id == failing_thread)
+					throw std::runtime_error("thread failed");
+			});
+		}
+		catch (const std::runtime_error&) {
+			caught = true;
+		}
+		TEST_ASSERT(caught);
+	}
+
+	// the group and the scheduler remain usable afterwards
+	nr_done = 0;
+	for (int t = 0; t < 10; ++t)
+		scheduler.spawn(group, [&]() { ++nr_done; });
+	scheduler.wait(group);
+	TEST_ASSERT_EQ(int(nr_done), 10);
+	return true;
+}
+
+bool test_neighbor_graph_build_parallel()
+{
+	std::default_random_engine rng(3);
+	std::uniform_real_distribution<float> coord(0, 1);
+	std::vector<point_cloud_types::Pnt> P(5000);
+	for (auto& p : P)
+		p = point_cloud_types::Pnt(coord(rng), coord(rng), coord(rng));
+	point_kd_tree tree;
+	tree.build(P.data(), P.size());
+	neighbor_graph serial_ng, parallel_ng;
+	serial_ng.build(neighbor_graph::Cnt(P.size()), 8, tree);
+	TaskScheduler scheduler(3);
+	parallel_ng.build_parallel(neighbor_graph::Cnt(P.size()), 8, tree, scheduler);
+	TEST_ASSERT_EQ(parallel_ng.nr_half_edges, serial_ng.nr_half_edges);
+	TEST_ASSERT(parallel_ng == serial_ng);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_task_scheduler_parallel_for_reg("cgv::pointcloud::utility::TaskScheduler::parallel_for", test_task_scheduler_parallel_for);
+extern CGV_API test_registration test_task_scheduler_nesting_reg("cgv::pointcloud::utility::TaskScheduler::nesting", test_task_scheduler_nesting);
+extern CGV_API test_registration test_task_scheduler_exceptions_reg("cgv::pointcloud::utility::TaskScheduler::exceptions", test_task_scheduler_exceptions);
+extern CGV_API test_registration test_neighbor_graph_build_parallel_reg("neighbor_graph::build_parallel", test_neighbor_graph_build_parallel);
@@ -0,0 +1,106 @@
+#include <cgv/base/register.h>
+#include <point_cloud/ICP.h>
+#include <point_cloud/point_kd_tree.h>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+using namespace cgv::base;
+
+namespace {
+	/// sample a height field with analytic normals on a regular grid
+	void construct_height_field(point_cloud& pc, int n)
+	{
+		pc.create_normals();
+		pc.resize(n * n);
+		for (int j = 0; j < n; ++j) {
+			for (int i = 0; i < n; ++i) {
+				float x = 2.0f * i / (n - 1) - 1, y = 2.0f * j / (n - 1) - 1;
+				size_t pi = size_t(j) * n + i;
+				pc.pnt(pi) = point_cloud::Pnt(x, y, 0.3f * sin(2 * x) * cos(3 * y));
+				point_cloud::Nml nml(-0.6f * cos(2 * x) * cos(3 * y), 0.9f * sin(2 * x) * sin(3 * y), 1.0f);
+				pc.nml(pi) = normalize(nml);
+			}
+		}
+	}
+
+	/// maximum distance between the transformed source points and the target points with equal index
+	float max_registration_error(const point_cloud& source, const point_cloud& target, const point_cloud::Mat& R, const point_cloud::Dir& t)
+	{
+		float max_error = 0;
+		for (size_t i = 0; i < source.get_nr_points(); ++i)
+			max_error = std::max(max_error, (R * source.pnt(i) + t - target.pnt(i)).length());
+		return max_error;
+	}
+
+	/// register source to target and return the remaining maximum point error
+	float register_clouds(const point_cloud& source, const point_cloud& target, bool point_to_plane, point_cloud::Mat& R, point_cloud::Dir& t)
+	{
+		cgv::pointcloud::ICP icp;
+		icp.set_source_cloud(source);
+		icp.set_target_cloud(target);
+		icp.set_iterations(100);
+		icp.use_point_to_plane = point_to_plane;
+		icp.subsampling_schedule = { 500, 0 };
+		R.identity();
+		t.zeros();
+		icp.reg_icp_accelerated(R, t);
+		return max_registration_error(source, target, R, t);
+	}
+}
+
+bool test_point_kd_tree()
+{
+	std::default_random_engine rng(7);
+	std::uniform_real_distribution<float> coord(-1, 1);
+	std::vector<point_cloud::Pnt> P(2000);
+	for (auto& p : P)
+		p = point_cloud::Pnt(coord(rng), coord(rng), coord(rng));
+	point_kd_tree tree;
+	tree.build(P.data(), P.size());
+	for (int qi = 0; qi < 200; ++qi) {
+		point_cloud::Pnt q(coord(rng), coord(rng), coord(rng));
+		// brute force reference
+		std::vector<std::pair<float, point_cloud::Idx> > dists(P.size());
+		for (size_t i = 0; i < P.size(); ++i)
+			dists[i] = { sqr_length(P[i] - q), point_cloud::Idx(i) };
+		std::sort(dists.begin(), dists.end());
+		float sqr_dist;
+		TEST_ASSERT_EQ(tree.find_closest(q, std::numeric_limits<float>::max(), &sqr_dist), dists[0].second);
+		TEST_ASSERT_EQ(sqr_dist, dists[0].first);
+		TEST_ASSERT_EQ(tree.find_closest(q, 0.5f * dists[0].first), -1);
+		std::vector<point_cloud::Idx> knn;
+		tree.find_closest_points(q, 8, knn);
+		TEST_ASSERT_EQ(knn.size(), 8u);
+		for (size_t k = 0; k < knn.size(); ++k)
+			TEST_ASSERT_EQ(knn[k], dists[k].second);
+	}
+	return true;
+}
+
+bool test_icp_accelerated()
+{
+	point_cloud source, target;
+	construct_height_field(source, 60);
+	target = source;
+	target.rotate(cgv::math::quaternion<float>(normalize(point_cloud::Dir(1, 2, 3)), 0.05f));
+	target.translate(point_cloud::Dir(0.02f, -0.01f, 0.03f));
+	point_cloud::Mat R, R2;
+	point_cloud::Dir t, t2;
+	R.identity();
+	t.zeros();
+	TEST_ASSERT(max_registration_error(source, target, R, t) > 0.05f);
+	TEST_ASSERT(register_clouds(source, target, true, R, t) < 1e-3f);
+	TEST_ASSERT(register_clouds(source, target, false, R2, t2) < 1e-3f);
+
+	// equal seeds and input yield bitwise equal transformations independent of the thread scheduling
+	TEST_ASSERT(register_clouds(source, target, true, R2, t2) < 1e-3f);
+	TEST_ASSERT(R == R2);
+	TEST_ASSERT(t == t2);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_point_kd_tree_reg("point_cloud::point_kd_tree", test_point_kd_tree);
+extern CGV_API test_registration test_icp_accelerated_reg("point_cloud::ICP::reg_icp_accelerated", test_icp_accelerated);
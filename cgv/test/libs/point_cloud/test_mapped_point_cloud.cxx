@@ -0,0 +1,127 @@
+#include <cgv/base/register.h>
+#include <point_cloud/point_cloud.h>
+#include <point_cloud/mapped_point_cloud.h>
+#include <cgv/utils/file.h>
+#include <cstdio>
+#include <cstring>
+
+using namespace cgv::base;
+
+namespace {
+	const std::string mpc_file_name = "test_mapped_point_cloud.mpc";
+
+	/// construct point cloud with normals, colors and two named components
+	void construct_point_cloud(point_cloud& pc, size_t n)
+	{
+		pc.create_normals();
+		pc.create_colors();
+		pc.resize(n);
+		for (size_t i = 0; i < n; ++i) {
+			pc.pnt(i) = point_cloud::Pnt(float(i), float(i % 7), float(i % 3));
+			pc.nml(i) = point_cloud::Nml(0, 0, 1);
+			pc.clr(i) = point_cloud::Clr(float(i % 5) / 4, 0.5f, 1.0f);
+		}
+		pc.create_components();
+		pc.add_component();
+		size_t m = n / 3;
+		pc.component_point_range(0) = point_cloud::component_info(0, m);
+		pc.component_point_range(1) = point_cloud::component_info(m, n - m);
+		pc.component_name(0) = "first";
+		pc.component_name(1) = "second";
+		for (size_t i = 0; i < n; ++i)
+			pc.component_index(i) = i < m ? 0 : 1;
+	}
+
+	/// overwrite bytes of a file at the given offset
+	bool patch_file(const std::string& file_name, size_t offset, const void* data, size_t size)
+	{
+		FILE* fp = fopen(file_name.c_str(), "r+b");
+		if (!fp)
+			return false;
+		bool success = fseek(fp, long(offset), SEEK_SET) == 0 && fwrite(data, 1, size, fp) == size;
+		return fclose(fp) == 0 && success;
+	}
+
+	/// read header of a valid file
+	bool read_header(const std::string& file_name, mpc_header& h)
+	{
+		return cgv::utils::file::read(file_name, reinterpret_cast<char*>(&h), sizeof(mpc_header));
+	}
+}
+
+bool test_mapped_point_cloud_round_trip()
+{
+	point_cloud pc;
+	construct_point_cloud(pc, 1000);
+	TEST_ASSERT(pc.write(mpc_file_name));
+
+	mapped_point_cloud mpc;
+	TEST_ASSERT(mpc.open(mpc_file_name));
+	TEST_ASSERT_EQ(mpc.get_nr_points(), 1000u);
+	TEST_ASSERT_EQ(mpc.get_nr_components(), 2u);
+	TEST_ASSERT(mpc.get_positions() && mpc.get_normals() && mpc.get_colors());
+	TEST_ASSERT(mpc.get_positions()[999] == pc.pnt(999));
+	TEST_ASSERT_EQ(mpc.get_component(1).name, "second");
+	TEST_ASSERT_EQ(mpc.get_component(1).index_of_first_point, 333u);
+	mpc.close();
+
+	point_cloud pc2;
+	TEST_ASSERT(pc2.read(mpc_file_name));
+	TEST_ASSERT_EQ(pc2.get_nr_points(), pc.get_nr_points());
+	TEST_ASSERT(pc2.has_normals() && pc2.has_colors() && pc2.has_components());
+	for (size_t i = 0; i < pc.get_nr_points(); ++i) {
+		TEST_ASSERT(pc2.pnt(i) == pc.pnt(i));
+		TEST_ASSERT(pc2.nml(i) == pc.nml(i));
+		TEST_ASSERT(pc2.clr(i) == pc.clr(i));
+		TEST_ASSERT_EQ(pc2.component_index(i), pc.component_index(i));
+	}
+	TEST_ASSERT_EQ(pc2.get_nr_components(), 2u);
+	TEST_ASSERT_EQ(pc2.component_name(0), "first");
+	TEST_ASSERT_EQ(pc2.component_point_range(1).nr_points, 667u);
+	cgv::utils::file::remove(mpc_file_name);
+	return true;
+}
+
+bool test_mapped_point_cloud_corrupt_file()
+{
+	point_cloud pc;
+	construct_point_cloud(pc, 100);
+	mpc_header h;
+	mapped_point_cloud mpc;
+	point_cloud pc2;
+
+	// component range beyond the number of points
+	TEST_ASSERT(pc.write(mpc_file_name) && read_header(mpc_file_name, h));
+	size_t entry_offset = size_t(h.sections[MPC_COMPONENTS].offset) + sizeof(mpc_component_entry);
+	cgv::type::uint64_type nr_points = 1000000;
+	TEST_ASSERT(patch_file(mpc_file_name, entry_offset + offsetof(mpc_component_entry, nr_points), &nr_points, sizeof(nr_points)));
+	TEST_ASSERT(!mpc.open(mpc_file_name));
+	TEST_ASSERT(!pc2.read(mpc_file_name));
+
+	// component name outside of the mapping
+	TEST_ASSERT(pc.write(mpc_file_name));
+	cgv::type::uint64_type name_offset = cgv::type::uint64_type(1) << 40;
+	TEST_ASSERT(patch_file(mpc_file_name, entry_offset + offsetof(mpc_component_entry, name_offset), &name_offset, sizeof(name_offset)));
+	TEST_ASSERT(!mpc.open(mpc_file_name));
+	TEST_ASSERT(!pc2.read(mpc_file_name));
+
+	// more points announced in header than stored in the sections
+	TEST_ASSERT(pc.write(mpc_file_name));
+	nr_points = 101;
+	TEST_ASSERT(patch_file(mpc_file_name, offsetof(mpc_header, nr_points), &nr_points, sizeof(nr_points)));
+	TEST_ASSERT(!mpc.open(mpc_file_name));
+
+	// section size overflowing the file size
+	TEST_ASSERT(pc.write(mpc_file_name));
+	cgv::type::uint64_type size = cgv::type::uint64_type(-1);
+	TEST_ASSERT(patch_file(mpc_file_name, offsetof(mpc_header, sections) + MPC_NORMALS * sizeof(mpc_section) + offsetof(mpc_section, size), &size, sizeof(size)));
+	TEST_ASSERT(!mpc.open(mpc_file_name));
+
+	cgv::utils::file::remove(mpc_file_name);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_mapped_point_cloud_round_trip_reg("point_cloud::mapped_point_cloud_round_trip", test_mapped_point_cloud_round_trip);
+extern CGV_API test_registration test_mapped_point_cloud_corrupt_file_reg("point_cloud::mapped_point_cloud_corrupt_file", test_mapped_point_cloud_corrupt_file);
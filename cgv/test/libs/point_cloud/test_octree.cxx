@@ -0,0 +1,83 @@
+#include <cgv/base/register.h>
+#include <point_cloud/octree.h>
+#include <cgv/utils/file.h>
+#include <cgv/utils/dir.h>
+#include <random>
+#include <algorithm>
+
+using namespace cgv::base;
+using namespace cgv::pointcloud;
+
+namespace {
+	/// lexicographic order of point positions
+	bool position_less(const SimpleLODPoint& a, const SimpleLODPoint& b)
+	{
+		return std::lexicographical_compare(a.position().begin(), a.position().end(), b.position().begin(), b.position().end());
+	}
+}
+
+bool test_octree_lod_generator_out_of_core()
+{
+	std::default_random_engine rng(11);
+	std::uniform_real_distribution<float> coord(-1, 1);
+	std::vector<SimpleLODPoint> points(100000);
+	for (auto& p : points) {
+		p.position() = cgv::vec3(coord(rng), coord(rng), 0.25f * coord(rng));
+		p.color() = cgv::rgb8(255, 0, 0);
+		p.level() = 0;
+	}
+	octree_lod_generator<SimpleLODPoint> generator;
+	// small chunks such that several chunks share the spill file
+	generator.max_chunk_points_limit = 2000;
+	std::vector<SimpleLODPoint> in_core_points = generator.generate_lods(points);
+
+	std::string file_name = "test_octree_lod_generator.bin";
+	TEST_ASSERT(generator.generate_lods_out_of_core(points.data(), points.size(), file_name, "."));
+	std::vector<std::string> spill_file_names;
+	cgv::utils::dir::glob(".", spill_file_names, "lod_chunks_*.bin");
+	TEST_ASSERT(spill_file_names.empty());
+
+	octree_file_reader<SimpleLODPoint> reader;
+	TEST_ASSERT(reader.open(file_name));
+	TEST_ASSERT(reader.find_node("r") >= 0);
+	TEST_ASSERT(reader.get_nodes().size() > 8);
+	std::vector<SimpleLODPoint> out_of_core_points;
+	for (size_t i = 0; i < reader.get_nodes().size(); ++i) {
+		const OctreeFileNode& node = reader.get_nodes()[i];
+		TEST_ASSERT_EQ(reader.find_node(node.name), int64_t(i));
+		const SimpleLODPoint* node_points = reader.get_node_points(i);
+		for (int64_t j = 0; j < node.num_points; ++j) {
+			const cgv::vec3& p = node_points[j].position();
+			TEST_ASSERT_EQ(int64_t(node_points[j].level()), node.level());
+			for (int c = 0; c < 3; ++c)
+				TEST_ASSERT(p[c] >= node.min[c] && p[c] <= node.max[c]);
+		}
+		out_of_core_points.insert(out_of_core_points.end(), node_points, node_points + node.num_points);
+	}
+	reader.close();
+	cgv::utils::file::remove(file_name);
+
+	// both modes keep every point exactly once
+	TEST_ASSERT_EQ(out_of_core_points.size(), points.size());
+	TEST_ASSERT_EQ(in_core_points.size(), points.size());
+	std::sort(points.begin(), points.end(), position_less);
+	std::sort(in_core_points.begin(), in_core_points.end(), position_less);
+	std::sort(out_of_core_points.begin(), out_of_core_points.end(), position_less);
+	for (size_t i = 0; i < points.size(); ++i) {
+		TEST_ASSERT(out_of_core_points[i].position() == points[i].position());
+		TEST_ASSERT(in_core_points[i].position() == points[i].position());
+	}
+
+#ifdef __linux__
+	// write errors in the indexing tasks on the worker threads are reported by the return value instead of terminating
+	TEST_ASSERT(!generator.generate_lods_out_of_core(points.data(), points.size(), "/dev/full", "."));
+	spill_file_names.clear();
+	cgv::utils::dir::glob(".", spill_file_names, "lod_chunks_*.bin");
+	TEST_ASSERT(spill_file_names.empty());
+#endif
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_octree_lod_generator_out_of_core_reg("cgv::pointcloud::octree_lod_generator::out_of_core", test_octree_lod_generator_out_of_core);
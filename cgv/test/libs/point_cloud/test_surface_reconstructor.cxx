@@ -0,0 +1,88 @@
+#include <cgv/base/register.h>
+#include <point_cloud/surface_reconstructor.h>
+#include <point_cloud/point_kd_tree.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <cmath>
+
+using namespace cgv::base;
+
+/// reconstruct a jittered height field sample with either the serial or the parallel region growing
+static std::vector<unsigned int> reconstruct_height_field(bool parallel)
+{
+	point_cloud pc;
+	pc.create_normals();
+	unsigned int res = 60;
+	pc.resize(res * res);
+	std::default_random_engine rng(7);
+	std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+	for (unsigned int y = 0; y < res; ++y) {
+		for (unsigned int x = 0; x < res; ++x) {
+			float u = (x + jitter(rng)) / res, v = (y + jitter(rng)) / res;
+			// gentle wave with analytic normal
+			float h = 0.05f * std::sin(6 * u) * std::cos(4 * v);
+			point_cloud_types::Nml n(-0.3f * std::cos(6 * u) * std::cos(4 * v), 0.2f * std::sin(6 * u) * std::sin(4 * v), 1);
+			pc.pnt(y * res + x) = point_cloud_types::Pnt(u, v, h);
+			pc.nml(y * res + x) = n / length(n);
+		}
+	}
+	point_kd_tree tree;
+	tree.build(&pc.pnt(0), pc.get_nr_points());
+	neighbor_graph ng;
+	ng.build(neighbor_graph::Cnt(pc.get_nr_points()), 12, tree);
+
+	surface_reconstructor sr;
+	sr.pc = &pc;
+	sr.ng = &ng;
+	sr.sort_by_tangential_angle();
+	sr.delaunay_fan_neighbor_graph_filter();
+	std::vector<unsigned int> T[3];
+	sr.find_consistent_triangles(T);
+	sr.mark_triangular_faces(T[0]);
+	if (parallel) {
+		sr.nr_parallel_regions = 16;
+		sr.grow_all_parallel(T[0]);
+	}
+	else {
+		sr.build_grow_queue(T[0]);
+		sr.grow_all(T[0]);
+	}
+	return T[0];
+}
+
+/// check that no edge has more than two and no triangle is generated twice
+static bool is_manifold(const std::vector<unsigned int>& T)
+{
+	std::map<std::pair<unsigned int, unsigned int>, unsigned int> edge_count;
+	std::map<std::vector<unsigned int>, unsigned int> triangle_count;
+	for (size_t i = 0; i < T.size(); i += 3) {
+		std::vector<unsigned int> t(T.begin() + i, T.begin() + i + 3);
+		for (int e = 0; e < 3; ++e) {
+			unsigned int vi = t[e], vj = t[(e + 1) % 3];
+			if (vi == vj || ++edge_count[std::make_pair(std::min(vi, vj), std::max(vi, vj))] > 2)
+				return false;
+		}
+		std::sort(t.begin(), t.end());
+		if (++triangle_count[t] > 1)
+			return false;
+	}
+	return true;
+}
+
+bool test_surface_reconstructor_grow_all_parallel()
+{
+	std::vector<unsigned int> serial_T = reconstruct_height_field(false);
+	std::vector<unsigned int> parallel_T = reconstruct_height_field(true);
+	TEST_ASSERT(is_manifold(serial_T));
+	TEST_ASSERT(is_manifold(parallel_T));
+	// a height field of n points triangulates into about 2n triangles in both versions
+	size_t nr_serial = serial_T.size() / 3, nr_parallel = parallel_T.size() / 3;
+	TEST_ASSERT(nr_serial > 6000);
+	TEST_ASSERT(10 * nr_parallel > 9 * nr_serial && 10 * nr_serial > 9 * nr_parallel);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_surface_reconstructor_grow_all_parallel_reg("surface_reconstructor::grow_all_parallel", test_surface_reconstructor_grow_all_parallel);
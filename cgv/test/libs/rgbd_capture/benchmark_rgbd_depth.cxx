@@ -0,0 +1,89 @@
+// Measures the conversion of depth frames to points with the per pixel ray table of unproject_depth_frame, which
+// rgbd_input::map_depth_frame_to_points uses, against per pixel calls of map_depth_to_point. The device is the
+// emulation of a container without frames that only provides the camera intrinsics.
+// Usage: benchmark_rgbd_depth [width [height [nr_frames]]]
+#include <cgv/utils/stopwatch.h>
+#include <cgv/utils/file.h>
+#include <rgbd_capture/rgbd_input.h>
+#include <rgbd_capture/rgbd_container.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace rgbd;
+
+int main(int argc, char** argv)
+{
+	int width = argc > 1 ? std::max(1, atoi(argv[1])) : 640;
+	int height = argc > 2 ? std::max(1, atoi(argv[2])) : 576;
+	unsigned nr_frames = argc > 3 ? unsigned(std::max(1, atoi(argv[3]))) : 30;
+
+	// create container that provides the intrinsics to the emulation device
+	const std::string file_name = "benchmark_rgbd_depth.rgbdc";
+	emulator_parameters params = {};
+	params.intrinsics.fx = params.intrinsics.fy = 0.9 * width;
+	params.intrinsics.cx = 0.5 * width;
+	params.intrinsics.cy = 0.5 * height;
+	params.intrinsics.image_width = width;
+	params.intrinsics.image_height = height;
+	params.depth_scale = 0.001;
+	rgbd_container_writer writer;
+	if (!writer.open(file_name, { stream_format(width, height, PF_DEPTH, 30, 16) }, &params) || !writer.close()) {
+		std::cerr << "could not write container " << file_name << std::endl;
+		return 1;
+	}
+	rgbd_input input;
+	input.attach_path(file_name);
+
+	// smooth depth frame with invalid pixels
+	frame_type depth_frame;
+	static_cast<frame_format&>(depth_frame) = stream_format(width, height, PF_DEPTH, 30, 16);
+	depth_frame.frame_data.resize(depth_frame.buffer_size);
+	uint16_t* depths = reinterpret_cast<uint16_t*>(depth_frame.frame_data.data());
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			depths[y * width + x] = (x * 7 + y * 3) % 31 == 0 ? 0 : uint16_t(500 + (x * x + y * y) % 4000);
+	size_t n = size_t(width) * height;
+	std::vector<float> table_points(3 * n), pixel_points(3 * n);
+
+	cgv::utils::stopwatch watch(true);
+	size_t nr_valid = input.map_depth_frame_to_points(depth_frame, table_points.data());
+	double t_first = watch.restart();
+	if (nr_valid == 0) {
+		std::cerr << "ray table could not be computed" << std::endl;
+		return 1;
+	}
+	for (unsigned k = 0; k < nr_frames; ++k)
+		input.map_depth_frame_to_points(depth_frame, table_points.data());
+	double t_table = watch.restart() / nr_frames;
+	size_t nr_pixel_valid = 0;
+	for (unsigned k = 0; k < nr_frames; ++k) {
+		nr_pixel_valid = 0;
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x) {
+				float* p = &pixel_points[3 * (size_t(y) * width + x)];
+				if (input.map_depth_to_point(x, y, depths[y * width + x], p))
+					++nr_pixel_valid;
+				else
+					p[0] = p[1] = p[2] = 0;
+			}
+	}
+	double t_pixel = watch.restart() / nr_frames;
+
+	float max_error = 0;
+	for (size_t i = 0; i < 3 * n; ++i)
+		max_error = std::max(max_error, std::abs(table_points[i] - pixel_points[i]));
+	std::cout << width << "x" << height << " depth frame with " << nr_valid << " valid pixels:\n"
+		<< "first frame with ray table setup: " << 1000 * t_first << "ms\n"
+		<< "unproject_depth_frame:            " << 1000 * t_table << "ms, " << n / t_table * 1e-6 << " Mpixels/s\n"
+		<< "per pixel map_depth_to_point:     " << 1000 * t_pixel << "ms, " << n / t_pixel * 1e-6 << " Mpixels/s\n"
+		<< "speedup " << t_pixel / t_table << ", max deviation " << max_error << "m" << std::endl;
+	input.detach();
+	cgv::utils::file::remove(file_name);
+	if (nr_pixel_valid != nr_valid || max_error > 1e-4f) {
+		std::cerr << "unprojected points deviate from per pixel mapping" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,139 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/file.h>
+#include <rgbd_capture/rgbd_container.h>
+
+using namespace cgv::base;
+using namespace rgbd;
+
+namespace {
+	const std::string container_file_name = "test_rgbd_container.rgbdc";
+	const std::string truncated_file_name = "test_rgbd_container_truncated.rgbdc";
+	const int width = 64, height = 48;
+	const uint32_t nr_frames = 40;
+
+	/// container reader with access to its frame entries
+	struct inspectable_container_reader : public rgbd_container_reader
+	{
+		const std::vector<container_frame_entry>& get_entries(ContainerStream cs) const { return entries[cs]; }
+	};
+
+	/// construct color frame of byte noise, which does not compress
+	frame_type construct_color_frame(uint32_t k)
+	{
+		frame_type f;
+		static_cast<frame_format&>(f) = stream_format(width, height, PF_BGRA, 30, 32);
+		f.frame_index = k;
+		f.time = 0.1 * k;
+		f.system_time_stamp = 1000 + k;
+		f.device_time_stamp = 2000 + k;
+		f.frame_data.resize(f.buffer_size);
+		uint32_t state = 17 + k;
+		for (auto& c : f.frame_data) {
+			state = 1664525u * state + 1013904223u;
+			c = char(state >> 24);
+		}
+		return f;
+	}
+	/// construct smooth 16 bit depth frame with small noise and invalid pixels, which the delta+zlib codec compresses
+	frame_type construct_depth_frame(uint32_t k)
+	{
+		frame_type f;
+		static_cast<frame_format&>(f) = stream_format(width, height, PF_DEPTH, 30, 16);
+		f.frame_index = k;
+		f.time = 0.1 * k + 0.01;
+		f.system_time_stamp = 3000 + k;
+		f.device_time_stamp = 4000 + k;
+		f.frame_data.resize(f.buffer_size);
+		uint16_t* depths = reinterpret_cast<uint16_t*>(f.frame_data.data());
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+				depths[y * width + x] = (x + y + k) % 23 == 0 ? 0 : uint16_t(60000 + 7 * x + 3 * y + (k * x * y) % 5);
+		return f;
+	}
+	bool equal_frames(const frame_type& f1, const frame_type& f2)
+	{
+		return f1.width == f2.width && f1.height == f2.height && f1.pixel_format == f2.pixel_format &&
+			f1.nr_bits_per_pixel == f2.nr_bits_per_pixel && f1.buffer_size == f2.buffer_size && f1.frame_index == f2.frame_index &&
+			f1.time == f2.time && f1.system_time_stamp == f2.system_time_stamp && f1.device_time_stamp == f2.device_time_stamp &&
+			f1.frame_data == f2.frame_data;
+	}
+	/// check that the container reproduces the first nr_color and nr_depth frames
+	bool check_container(const rgbd_container_reader& reader, uint32_t nr_color, uint32_t nr_depth)
+	{
+		if (!reader.has_stream(CS_COLOR) || !reader.has_stream(CS_DEPTH) || !reader.has_stream(CS_WARPED_COLOR) || reader.has_stream(CS_INFRARED) ||
+			reader.get_nr_frames(CS_COLOR) != nr_color || reader.get_nr_frames(CS_DEPTH) != nr_depth)
+			return false;
+		emulator_parameters params;
+		if (!reader.get_emulator_parameters(params) || params.depth_scale != 0.001 || params.intrinsics.image_width != width)
+			return false;
+		frame_type f;
+		for (uint32_t k = 0; k < nr_color; ++k)
+			if (reader.find_frame(CS_COLOR, k) != k || !reader.read_frame(CS_COLOR, k, f) || !equal_frames(f, construct_color_frame(k)))
+				return false;
+		for (uint32_t k = 0; k < nr_depth; ++k)
+			if (reader.find_frame(CS_DEPTH, k) != k || !reader.read_frame(CS_DEPTH, k, f) || !equal_frames(f, construct_depth_frame(k)))
+				return false;
+		return reader.find_frame(CS_DEPTH, nr_depth) == size_t(-1) && !reader.read_frame(CS_DEPTH, nr_depth, f);
+	}
+}
+
+bool test_rgbd_container_round_trip()
+{
+	// write alternating color and depth frames with several workers and a short queue, such that workers finish out of order
+	emulator_parameters params = {};
+	params.intrinsics.image_width = width;
+	params.intrinsics.image_height = height;
+	params.depth_scale = 0.001;
+	std::vector<stream_format> formats = { stream_format(width, height, PF_BGRA, 30, 32), stream_format(width, height, PF_DEPTH, 30, 16) };
+	rgbd_container_writer writer;
+	TEST_ASSERT(writer.open(container_file_name, formats, &params, true, 4, 3));
+	for (uint32_t k = 0; k < nr_frames; ++k) {
+		TEST_ASSERT(writer.write_frame(CS_COLOR, construct_color_frame(k), k));
+		TEST_ASSERT(writer.write_frame(CS_DEPTH, construct_depth_frame(k), k));
+	}
+	TEST_ASSERT(writer.close());
+	TEST_ASSERT_EQ(writer.get_nr_written_frames(), uint64_t(2 * nr_frames));
+
+	// read with index from footer
+	inspectable_container_reader reader;
+	TEST_ASSERT(reader.open(container_file_name));
+	TEST_ASSERT(check_container(reader, nr_frames, nr_frames));
+	const auto& color_entries = reader.get_entries(CS_COLOR);
+	const auto& depth_entries = reader.get_entries(CS_DEPTH);
+	// frames are stored in the order of submission and only depth frames are compressed
+	bool in_order = true, depth_compressed = true, color_uncompressed = true;
+	for (uint32_t k = 0; k < nr_frames; ++k) {
+		in_order = in_order && color_entries[k].data_offset < depth_entries[k].data_offset &&
+			(k + 1 == nr_frames || depth_entries[k].data_offset < color_entries[k + 1].data_offset);
+		depth_compressed = depth_compressed && depth_entries[k].compression == CC_DELTA_ZLIB && depth_entries[k].data_size < depth_entries[k].buffer_size;
+		color_uncompressed = color_uncompressed && color_entries[k].compression == CC_NONE;
+	}
+	TEST_ASSERT(in_order);
+	TEST_ASSERT(depth_compressed);
+	TEST_ASSERT(color_uncompressed);
+	size_t data_end = size_t(depth_entries.back().data_offset + depth_entries.back().data_size);
+	reader.close();
+
+	// cut off index and footer as after a crash, such that the index is rebuilt from the frame entries
+	std::string content;
+	TEST_ASSERT(cgv::utils::file::read(container_file_name, content, false));
+	TEST_ASSERT(content.size() > data_end);
+	TEST_ASSERT(cgv::utils::file::write(truncated_file_name, content.data(), data_end, false));
+	TEST_ASSERT(reader.open(truncated_file_name));
+	TEST_ASSERT(check_container(reader, nr_frames, nr_frames));
+	reader.close();
+
+	// a partially written last frame is dropped
+	TEST_ASSERT(cgv::utils::file::write(truncated_file_name, content.data(), data_end - 10, false));
+	TEST_ASSERT(reader.open(truncated_file_name));
+	TEST_ASSERT(check_container(reader, nr_frames, nr_frames - 1));
+	reader.close();
+
+	cgv::utils::file::remove(container_file_name);
+	cgv::utils::file::remove(truncated_file_name);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_rgbd_container_round_trip_reg("rgbd::rgbd_container::round_trip", test_rgbd_container_round_trip);
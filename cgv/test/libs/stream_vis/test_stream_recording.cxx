@@ -0,0 +1,159 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/file.h>
+#include <stream_vis/stream_recording.h>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace stream_vis;
+
+namespace {
+	const std::string recording_file_name = "test_stream_recording.svrec";
+	const std::string truncated_file_name = "test_stream_recording_truncated.svrec";
+	const std::string aligned_file_name = "test_stream_recording_aligned.svrec";
+
+	/// recording with access to its chunk index
+	struct inspectable_recording : public stream_recording
+	{
+		const std::vector<recording_chunk>& get_chunks() const { return chunks; }
+	};
+
+	/// check that the recording reproduces all samples, where value of sample k of series i is i+k%7 at time 0.01*k up to the float precision of stored times
+	bool check_recording(const stream_recording& rec, size_t n)
+	{
+		if (rec.get_nr_series() != 2 || rec.get_series_name(0) != "speed" || rec.get_series_name(1) != "count" ||
+			rec.get_nr_components(0) != 1 || rec.get_nr_samples(0) != n || rec.get_nr_samples(1) != n)
+			return false;
+		for (size_t i = 0; i < 2; ++i) {
+			for (size_t k = 0; k < n; ++k) {
+				double t, v;
+				if (!rec.get_sample(i, k, t, &v) || std::abs(t - 0.01 * k) > 1e-4 || v != double(i + k % 7))
+					return false;
+			}
+			// find_sample returns the number of samples not later than the given time
+			if (rec.find_sample(i, 0.01 * 100 + 0.001) != 101 || rec.find_sample(i, -1.0) != 0 || rec.find_sample(i, 1e6) != n)
+				return false;
+		}
+		return true;
+	}
+}
+
+bool test_stream_recording_round_trip()
+{
+	float_time_series speed(0);
+	int_time_series count(1);
+	speed.streaming_time_series::set_name("speed");
+	count.streaming_time_series::set_name("count");
+	speed.set_ringbuffer_size(1 << 16);
+	count.set_ringbuffer_size(1 << 16);
+
+	// record samples with repeating values such that chunks compress well
+	size_t n = 5000;
+	stream_recorder recorder;
+	TEST_ASSERT(recorder.open(recording_file_name, { &speed, &count }, true, 512, 1));
+	for (size_t k = 0; k < n; ++k) {
+		speed.append_sample(0.01 * k, double(k % 7));
+		count.append_sample(0.01 * k, int64_t(1 + k % 7));
+	}
+	recorder.close();
+	TEST_ASSERT_EQ(recorder.get_nr_lost_samples(), size_t(0));
+
+	// replay with index from footer
+	inspectable_recording rec;
+	TEST_ASSERT(rec.open(recording_file_name));
+	TEST_ASSERT(check_recording(rec, n));
+	size_t nr_chunks = rec.get_chunks().size(), nr_compressed = 0;
+	for (const auto& c : rec.get_chunks())
+		nr_compressed += c.compressed;
+	// chunks hold at least chunk_size samples except for the last one per series
+	TEST_ASSERT(nr_chunks >= 2 && nr_chunks <= 2 * (n / 512 + 1));
+	TEST_ASSERT(nr_compressed > 0);
+	double time_begin, time_end;
+	TEST_ASSERT(rec.get_time_range(time_begin, time_end));
+	TEST_ASSERT_EQ(time_begin, 0.0);
+	TEST_ASSERT(std::abs(time_end - 0.01 * (n - 1)) < 1e-4);
+	rec.close();
+
+	// cut off chunk index and footer as after a crash, such that the index is rebuilt by scanning the chunks
+	std::string content;
+	TEST_ASSERT(cgv::utils::file::read(recording_file_name, content, false));
+	size_t index_size = nr_chunks * sizeof(recording_chunk) + sizeof(recording_footer);
+	TEST_ASSERT(content.size() > index_size);
+	TEST_ASSERT(cgv::utils::file::write(truncated_file_name, content.data(), content.size() - index_size, false));
+	TEST_ASSERT(rec.open(truncated_file_name));
+	TEST_ASSERT_EQ(rec.get_chunks().size(), nr_chunks);
+	TEST_ASSERT(check_recording(rec, n));
+	rec.close();
+
+	cgv::utils::file::remove(recording_file_name);
+	cgv::utils::file::remove(truncated_file_name);
+	return true;
+}
+
+bool test_stream_recording_layout_and_errors()
+{
+	// names of odd length let the header end at an unaligned offset
+	float_time_series speed(0);
+	fvec_time_series<3> position(1, 2, 3);
+	speed.streaming_time_series::set_name("v");
+	position.streaming_time_series::set_name("position");
+	position.set_ringbuffer_size(1 << 12);
+
+	// time series without ring buffer cannot be read concurrently and are rejected
+	stream_recorder recorder;
+	TEST_ASSERT(!recorder.open(aligned_file_name, { &speed, &position }));
+	TEST_ASSERT(!recorder.is_open());
+	speed.set_ringbuffer_size(1 << 12);
+
+	size_t n = 1000;
+	for (int compress = 0; compress < 2; ++compress) {
+		TEST_ASSERT(recorder.open(aligned_file_name, { &speed, &position }, compress == 1, 77, 1));
+		for (size_t k = 0; k < n; ++k) {
+			speed.append_sample(0.5 * k, double(k % 3));
+			position.append_sample(0.5 * k, cgv::math::fvec<double, 3>(double(k % 11), double(k % 13), -double(k % 17)));
+		}
+		TEST_ASSERT(recorder.close());
+		TEST_ASSERT(!recorder.has_write_error());
+		TEST_ASSERT_EQ(recorder.get_nr_lost_samples(), size_t(0));
+
+		inspectable_recording rec;
+		TEST_ASSERT(rec.open(aligned_file_name));
+		TEST_ASSERT_EQ(rec.get_nr_components(0), 1u);
+		TEST_ASSERT_EQ(rec.get_nr_components(1), 3u);
+		TEST_ASSERT(rec.get_chunks().size() >= 2);
+		// all payloads start at multiples of 8 bytes such that uncompressed ones are accessed as doubles in place
+		for (const auto& c : rec.get_chunks()) {
+			TEST_ASSERT_EQ(c.payload_offset % 8, uint64_t(0));
+			if (compress == 0)
+				TEST_ASSERT_EQ(c.compressed, 0u);
+		}
+		TEST_ASSERT_EQ(rec.get_nr_samples(1), n);
+		for (size_t k = 0; k < n; ++k) {
+			double t, p[3];
+			TEST_ASSERT(rec.get_sample(1, k, t, p));
+			TEST_ASSERT_EQ(t, 0.5 * k);
+			TEST_ASSERT_EQ(p[0], double(k % 11));
+			TEST_ASSERT_EQ(p[1], double(k % 13));
+			TEST_ASSERT_EQ(p[2], -double(k % 17));
+		}
+		rec.close();
+		speed.clear_samples();
+		position.clear_samples();
+	}
+	cgv::utils::file::remove(aligned_file_name);
+
+#ifdef __linux__
+	// writes to a full device fail at the latest when the file is closed
+	TEST_ASSERT(recorder.open("/dev/full", { &speed, &position }, false, 16, 1));
+	for (size_t k = 0; k < 10000; ++k)
+		speed.append_sample(0.5 * k, double(k % 3));
+	TEST_ASSERT(!recorder.close());
+	TEST_ASSERT(recorder.has_write_error());
+	TEST_ASSERT(!recorder.is_open());
+#endif
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_stream_recording_round_trip_reg("stream_vis::stream_recording::round_trip", test_stream_recording_round_trip);
+extern CGV_API test_registration test_stream_recording_layout_and_errors_reg("stream_vis::stream_recording::layout_and_errors", test_stream_recording_layout_and_errors);
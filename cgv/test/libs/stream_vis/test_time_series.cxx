@@ -0,0 +1,153 @@
+#include <cgv/base/register.h>
+#include <stream_vis/time_series.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace cgv::base;
+using namespace stream_vis;
+
+typedef time_series<float, int32_t, int64_t> int_time_series;
+
+/// let nr_producers threads append samples whose time equals their value, which encodes producer and running index
+static void append_concurrently(int_time_series& ts, unsigned nr_producers, int64_t nr_samples_per_producer)
+{
+	std::vector<std::thread> producers;
+	for (unsigned p = 0; p < nr_producers; ++p)
+		producers.push_back(std::thread([&ts, p, nr_samples_per_producer]() {
+			for (int64_t k = 0; k < nr_samples_per_producer; ) {
+				int64_t value = 1000000 * int64_t(p + 1) + k;
+				if (k % 3 == 0 || k + 1 == nr_samples_per_producer) {
+					ts.append_sample(double(value), value);
+					++k;
+				}
+				else {
+					// append batches of two samples
+					double times[2] = { double(value), double(value + 1) };
+					int64_t values[2] = { value, value + 1 };
+					ts.append_samples(times, values, 2);
+					k += 2;
+				}
+			}
+		}));
+	for (auto& t : producers)
+		t.join();
+}
+
+/// check that samples in [si_begin,si_end( keep time equal to value and the order of each producer
+static bool check_samples(const int_time_series& ts, size_t si_begin, size_t si_end, std::vector<int64_t>& last_values)
+{
+	for (size_t si = si_begin; si < si_end; ++si) {
+		double time, value;
+		if (!ts.put_sample_as_double(si, time, &value) || time != value)
+			return false;
+		size_t p = size_t(value / 1000000) - 1;
+		if (p >= last_values.size() || int64_t(value) <= last_values[p])
+			return false;
+		last_values[p] = int64_t(value);
+	}
+	return true;
+}
+
+bool test_time_series_multi_producer()
+{
+	const unsigned nr_producers = 4;
+	const int64_t n = 20000;
+	// without overrun all samples are kept in the order of each producer
+	int_time_series ts(2 * nr_producers * n);
+	append_concurrently(ts, nr_producers, n);
+	TEST_ASSERT_EQ(ts.get_nr_samples(), size_t(nr_producers * n));
+	TEST_ASSERT_EQ(ts.get_nr_reserved_samples(), size_t(nr_producers * n));
+	std::vector<int64_t> last_values(nr_producers, 0);
+	TEST_ASSERT(check_samples(ts, 0, ts.get_nr_samples(), last_values));
+	bool all_complete = true;
+	for (unsigned p = 0; p < nr_producers; ++p)
+		all_complete = all_complete && last_values[p] == 1000000 * int64_t(p + 1) + n - 1;
+	TEST_ASSERT(all_complete);
+
+	// with a small ring buffer a concurrent reader only accepts intact samples
+	int_time_series rts(997);
+	std::atomic<bool> done(false);
+	bool reader_consistent = true;
+	size_t nr_read = 0;
+	std::thread reader([&]() {
+		std::vector<int64_t> reader_last_values(nr_producers, 0);
+		size_t si_read = 0;
+		// read once more after the producers are done
+		for (bool last_pass = false; !last_pass; ) {
+			last_pass = done;
+			size_t nr_samples = rts.get_nr_samples();
+			size_t si_begin = std::min(rts.get_first_intact_sample_index(si_read), nr_samples);
+			std::vector<std::pair<double, double> > copies;
+			for (size_t si = si_begin; si < nr_samples; ++si) {
+				double time, value;
+				if (!rts.put_sample_as_double(si, time, &value)) {
+					// skip samples that left the cache before the first one was copied
+					if (copies.empty()) {
+						si_begin = si + 1;
+						continue;
+					}
+					break;
+				}
+				copies.push_back(std::make_pair(time, value));
+			}
+			size_t si_intact = std::min(rts.get_first_intact_sample_index(si_begin), si_begin + copies.size());
+			for (size_t si = si_intact; si < si_begin + copies.size(); ++si) {
+				const auto& c = copies[si - si_begin];
+				size_t p = size_t(c.second / 1000000) - 1;
+				if (c.first != c.second || p >= nr_producers || int64_t(c.second) <= reader_last_values[p])
+					reader_consistent = false;
+				else
+					reader_last_values[p] = int64_t(c.second);
+			}
+			nr_read += si_begin + copies.size() - si_intact;
+			si_read = si_begin + copies.size();
+		}
+	});
+	append_concurrently(rts, nr_producers, n);
+	done = true;
+	reader.join();
+	TEST_ASSERT(reader_consistent);
+	TEST_ASSERT(nr_read > 0);
+	TEST_ASSERT_EQ(rts.get_nr_samples(), size_t(nr_producers * n));
+	TEST_ASSERT_EQ(rts.get_nr_cached_samples(), size_t(997));
+	std::vector<int64_t> cached_last_values(nr_producers, 0);
+	TEST_ASSERT(check_samples(rts, rts.get_sample_index_of_first_cached_sample() + 1, rts.get_nr_samples(), cached_last_values));
+	return true;
+}
+
+bool test_time_series_ringbuffer_offsets()
+{
+	// ring buffer slots are not accessible through pointers but offsets can be changed through copies
+	int_time_series ts(4);
+	for (int64_t k = 0; k < 6; ++k)
+		ts.append_sample(double(10 + k), 100 + k);
+	TEST_ASSERT_EQ(ts.get_nr_samples(), size_t(6));
+	TEST_ASSERT(ts.get_sample_ptr(5) == 0);
+	int_time_series::stored_sample_type s;
+	TEST_ASSERT(!ts.load_sample(1, s));
+	TEST_ASSERT(ts.load_sample(5, s));
+	ts.set_time_offset(12);
+	ts.set_value_offset(103);
+	for (size_t si = 2; si < 6; ++si) {
+		double time, value;
+		TEST_ASSERT(ts.put_sample_as_double(si, time, &value));
+		TEST_ASSERT_EQ(time, double(10 + si));
+		TEST_ASSERT_EQ(value, double(100 + si));
+		TEST_ASSERT(ts.load_sample(si, s));
+		TEST_ASSERT_EQ(s.second, int32_t(si) - 3);
+	}
+	// the ring buffer restarts after clearing
+	ts.clear_samples();
+	double time, value;
+	TEST_ASSERT(!ts.put_sample_as_double(0, time, &value));
+	ts.append_sample(20, 120);
+	TEST_ASSERT(ts.put_sample_as_double(0, time, &value));
+	TEST_ASSERT_EQ(value, 120.0);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_time_series_multi_producer_reg("stream_vis::time_series::multi_producer", test_time_series_multi_producer);
+extern CGV_API test_registration test_time_series_ringbuffer_offsets_reg("stream_vis::time_series::ringbuffer_offsets", test_time_series_ringbuffer_offsets);
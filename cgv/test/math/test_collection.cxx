@@ -26,6 +26,7 @@
 #include <test/math/test_distance_transform.h>
 #include <test/math/test_fibo_heap.h>
 #include <test/math/test_statistics.h>
+#include <test/math/test_iterative_sparse_les.h>
 
 #include <cgv/base/register.h>
 
@@ -55,6 +56,8 @@ bool test_collection()
 	test_align<float, double>(100, 100, true, true);
 	test_align<double, float>(100, 100, true, true);
 	test_align<double>(100, 100, true, true);
+	test_iterative_sparse_les();
+	test_distance_transform_3d();
 	//test_lin_solve();
 	/*test_low_tri_mat();
 	test_transformations();
@@ -1,5 +1,8 @@
 #pragma once
 #include <cgv/math/distance_transform.h>
+#include <cgv/base/register.h>
+#include <limits>
+#include <cmath>
 
 void test_distance_transform()
 {
@@ -20,4 +23,52 @@ void test_distance_transform()
 	
 
 
-}
\ No newline at end of file
+}
+
+void test_distance_transform_3d()
+{
+	using namespace cgv::math;
+	const float INF = std::numeric_limits<float>::infinity();
+	// compare against brute force for random sites with anisotropic spacing and a width that is no multiple of the block size
+	{
+		size_t w = 37, h = 23, d = 19;
+		float sx = 0.5f, sy = 1.0f, sz = 2.5f;
+		std::vector<float> D(w * h * d, INF);
+		std::vector<size_t> sites;
+		unsigned seed = 17;
+		for (int s = 0; s < 25; ++s) {
+			seed = seed * 1664525u + 1013904223u;
+			size_t i = (seed >> 8) % D.size();
+			D[i] = 0;
+			sites.push_back(i);
+		}
+		sqrdist_transf_3d(&D[0], w, h, d, sx, sy, sz);
+		float max_error = 0;
+		for (size_t i = 0; i < D.size(); ++i) {
+			float best = INF;
+			for (size_t s : sites) {
+				float dx = sx * (float(i % w) - float(s % w));
+				float dy = sy * (float(i / w % h) - float(s / w % h));
+				float dz = sz * (float(i / (w * h)) - float(s / (w * h)));
+				best = std::min(best, dx * dx + dy * dy + dz * dz);
+			}
+			max_error = std::max(max_error, std::abs(best - D[i]));
+		}
+		TEST_ASSERT(max_error < 1e-3f);
+	}
+	// without sites all distances stay infinite
+	{
+		std::vector<double> D(8 * 8 * 8, std::numeric_limits<double>::infinity());
+		sqrdist_transf_3d(&D[0], 8, 8, 8);
+		TEST_ASSERT(D[100] == std::numeric_limits<double>::infinity());
+	}
+	// distance to the center of a cubic volume
+	{
+		size_t n = 64;
+		std::vector<float> D(n * n * n, INF);
+		D[(n / 2) * n * n + (n / 2) * n + n / 2] = 0;
+		sqrdist_transf_3d(&D[0], n, n, n);
+		TEST_ASSERT_EQ(D[0], float(3 * (n / 2) * (n / 2)));
+		TEST_ASSERT_EQ(D[(n / 2) * n * n + (n / 2) * n + n - 1], float((n / 2 - 1) * (n / 2 - 1)));
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cgv/math/iterative_sparse_les.h>
+#include <cgv/base/register.h>
+#include <cmath>
+
+/// fill the system of the 2d poisson equation on a res x res grid with a known solution and return it
+std::vector<double> setup_poisson(cgv::math::sparse_les& S, int res, double convection = 0)
+{
+	int n = res * res;
+	std::vector<double> x(n), b(n, 0.0);
+	for (int i = 0; i < n; ++i)
+		x[i] = std::sin(0.1 * i) + 0.001 * i;
+	for (int y = 0; y < res; ++y)
+		for (int x_ = 0; x_ < res; ++x_) {
+			int i = y * res + x_;
+			S.set_mat_entry(i, i, 4);
+			b[i] += 4 * x[i];
+			int nbs[4] = { x_ > 0 ? i - 1 : -1, x_ + 1 < res ? i + 1 : -1, y > 0 ? i - res : -1, y + 1 < res ? i + res : -1 };
+			for (int k = 0; k < 4; ++k)
+				if (nbs[k] >= 0) {
+					// a convection term makes the matrix unsymmetric
+					double v = -1 + ((k & 1) ? convection : -convection);
+					S.set_mat_entry(i, nbs[k], v);
+					b[i] += v * x[nbs[k]];
+				}
+		}
+	for (int i = 0; i < n; ++i)
+		S.set_b_entry(i, b[i]);
+	return x;
+}
+
+double max_error(const cgv::math::sparse_les& S, const std::vector<double>& x)
+{
+	double e = 0;
+	for (int i = 0; i < int(x.size()); ++i)
+		e = std::max(e, std::abs(S.get_x_entry(i) - x[i]));
+	return e;
+}
+
+void test_iterative_sparse_les()
+{
+	using namespace cgv::math;
+	int res = 200, n = res * res;
+	// built-in solvers are available through the factory without registration
+	for (const char* name : { "cg_jacobi", "cg_ic0", "bicgstab" }) {
+		sparse_les_ptr S = sparse_les::create_by_name(name, n, 1, 5 * n);
+		TEST_ASSERT(!S.empty());
+		std::vector<double> x = setup_poisson(*S, res);
+		TEST_ASSERT(S->solve(true));
+		TEST_ASSERT(max_error(*S, x) < 1e-6);
+		TEST_ASSERT(dynamic_cast<const iterative_sparse_les*>(&*S) != 0);
+	}
+	TEST_ASSERT(!sparse_les::create_by_cap(SLC_SYMMETRIC, n, 1, 5 * n).empty());
+	TEST_ASSERT(!sparse_les::create_by_cap(SLC_ALL, n, 1, 5 * n).empty());
+
+	// incomplete cholesky needs fewer iterations than jacobi preconditioning
+	{
+		iterative_sparse_les J(n, 1, 5 * n, IST_CG, IPT_JACOBI), C(n, 1, 5 * n, IST_CG, IPT_IC0);
+		setup_poisson(J, res);
+		setup_poisson(C, res);
+		TEST_ASSERT(J.solve() && C.solve());
+		TEST_ASSERT(C.get_nr_iterations() < J.get_nr_iterations());
+		TEST_ASSERT_EQ(C.get_active_preconditioner(), IPT_IC0);
+		TEST_ASSERT(J.get_matrix().is_symmetric());
+		TEST_ASSERT_EQ(J.get_matrix().get_nr_entries(), size_t(5 * n - 4 * res));
+	}
+
+	// bicgstab solves an unsymmetric system
+	{
+		iterative_sparse_les S(n, 1, 5 * n, IST_BICGSTAB);
+		std::vector<double> x = setup_poisson(S, res, 0.4);
+		TEST_ASSERT(S.solve(true));
+		TEST_ASSERT(!S.get_matrix().is_symmetric());
+		TEST_ASSERT(max_error(S, x) < 1e-6);
+	}
+
+	// multiple right hand sides and repeated entries, where the last one wins
+	{
+		iterative_sparse_les S(3, 2);
+		S.set_mat_entry(0, 0, 1);
+		S.set_mat_entry(0, 0, 2);
+		S.set_mat_entry(1, 1, 3);
+		S.set_mat_entry(2, 2, 4);
+		S.set_mat_entry(0, 1, 1);
+		S.set_mat_entry(1, 0, 1);
+		S.set_b_entry(0, 0, 3); S.set_b_entry(1, 0, 4); S.set_b_entry(2, 0, 4);
+		S.set_b_entry(0, 1, 0); S.set_b_entry(1, 1, 0); S.set_b_entry(2, 1, 8);
+		TEST_ASSERT(S.solve(true));
+		TEST_ASSERT(std::abs(S.get_x_entry(0, 0) - 1) < 1e-9 && std::abs(S.get_x_entry(1, 0) - 1) < 1e-9 && std::abs(S.get_x_entry(2, 0) - 1) < 1e-9);
+		TEST_ASSERT(std::abs(S.get_x_entry(0, 1)) < 1e-9 && std::abs(S.get_x_entry(2, 1) - 2) < 1e-9);
+	}
+
+	// incomplete cholesky fails for all diagonal shifts on an indefinite matrix and jacobi preconditioning is used
+	{
+		iterative_sparse_les S(2, 1, 4, IST_CG, IPT_IC0);
+		S.set_mat_entry(0, 0, 1); S.set_mat_entry(0, 1, 3);
+		S.set_mat_entry(1, 0, 3); S.set_mat_entry(1, 1, 1);
+		S.set_b_entry(0, 4); S.set_b_entry(1, 4);
+		TEST_ASSERT(S.solve(true));
+		TEST_ASSERT_EQ(S.get_active_preconditioner(), IPT_JACOBI);
+		TEST_ASSERT(std::abs(S.get_x_entry(0) - 1) < 1e-9 && std::abs(S.get_x_entry(1) - 1) < 1e-9);
+	}
+}
@@ -0,0 +1,83 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/adaptive_dual_contouring.h>
+#include <map>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef adaptive_dual_contouring<double, double> adc_type;
+
+/// sphere given by the squared distance to its center minus the squared radius
+struct sphere_func : public cgv::math::v3_func<double, double>
+{
+	double r;
+	sphere_func(double _r) : r(_r) {}
+	double evaluate(const pnt_type& p) const { return p(0)*p(0) + p(1)*p(1) + p(2)*p(2) - r*r; }
+	vec_type evaluate_gradient(const pnt_type& p) const { return 2.0*p; }
+};
+
+/// collect polygons and vertex locations of the extracted mesh
+struct mesh_collector : public streaming_mesh_callback_handler
+{
+	adc_type* adc;
+	std::vector<cgv::math::fvec<double, 3> > positions;
+	std::vector<std::vector<unsigned> > polygons;
+	void new_vertex(unsigned int vi) { positions.push_back(adc->vertex_location(vi)); }
+	void new_polygon(const std::vector<unsigned int>& vis) { polygons.push_back(vis); }
+	void before_drop_vertex(unsigned int) {}
+	/// check that every directed edge has exactly one opposite edge
+	bool is_closed_and_oriented() const
+	{
+		std::map<std::pair<unsigned, unsigned>, int> edges;
+		for (const auto& P : polygons)
+			for (size_t i = 0; i < P.size(); ++i)
+				++edges[std::make_pair(P[i], P[(i + 1) % P.size()])];
+		for (const auto& e : edges)
+			if (e.second != 1 || edges.find(std::make_pair(e.first.second, e.first.first)) == edges.end())
+				return false;
+		return true;
+	}
+	/// compute the signed volume enclosed by the polygons
+	double compute_volume() const
+	{
+		double V = 0;
+		for (const auto& P : polygons)
+			for (size_t i = 1; i + 1 < P.size(); ++i)
+				V += dot(positions[P[0]], cross(positions[P[i]], positions[P[i + 1]])) / 6;
+		return V;
+	}
+};
+
+bool test_adaptive_dual_contouring()
+{
+	const double pi = 3.14159265358979;
+	sphere_func sphere(0.8);
+	cgv::media::axis_aligned_box<double, 3> box(cgv::math::fvec<double, 3>(-1, -1, -1), cgv::math::fvec<double, 3>(1, 1, 1));
+	size_t nr_uniform_polygons = 0;
+	for (double max_error : { 0.0, 1e-4 }) {
+		mesh_collector M;
+		adc_type adc(sphere, &M, max_error);
+		M.adc = &adc;
+		adc.extract(0.0, box, 7);
+		TEST_ASSERT(!M.polygons.empty());
+		TEST_ASSERT_EQ(M.positions.size(), adc.get_nr_leaves());
+		// the surface is closed, consistently oriented with outward normals and close to the sphere
+		TEST_ASSERT(M.is_closed_and_oriented());
+		TEST_ASSERT(std::abs(M.compute_volume() / (4.0 / 3 * pi * 0.512) - 1) < 0.01);
+		double max_deviation = 0;
+		for (const auto& p : M.positions)
+			max_deviation = std::max(max_deviation, std::abs(p.length() - 0.8));
+		TEST_ASSERT(max_deviation < 0.02);
+		TEST_ASSERT(dot(adc.vertex_normal(0), adc.vertex_location(0)) > 0);
+		if (max_error == 0)
+			nr_uniform_polygons = M.polygons.size();
+		else
+			TEST_ASSERT(3 * M.polygons.size() < nr_uniform_polygons);
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_adaptive_dual_contouring_reg("cgv::media::mesh::adaptive_dual_contouring", test_adaptive_dual_contouring);
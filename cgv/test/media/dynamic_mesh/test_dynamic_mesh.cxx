@@ -0,0 +1,93 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/dynamic_mesh.h>
+#include <cgv/math/ftransform.h>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef dynamic_mesh<float> mesh_type;
+typedef mesh_type::idx_type idx_type;
+typedef mesh_type::vec3 vec3;
+typedef mesh_type::mat4 mat4;
+
+/// construct a mesh with direct, indexed and range indexed blend shapes and four sparse weights per vertex
+void construct_skinned_mesh(mesh_type& M, unsigned nr_vertices, unsigned nr_joints, unsigned nr_direct_shapes)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+	for (unsigned vi = 0; vi < nr_vertices; ++vi)
+		M.new_position(vec3(d(rng), d(rng), d(rng)));
+	M.store_in_reference_positions();
+	for (unsigned bi = 0; bi < nr_direct_shapes; ++bi) {
+		M.add_blend_shape(mesh_type::blend_shape_mode::direct, nr_vertices);
+		for (unsigned vi = 0; vi < nr_vertices; ++vi)
+			M.add_blend_shape_data(vi % 3 == bi % 3 ? vec3(0.0f) : 0.1f * vec3(d(rng), d(rng), d(rng)));
+	}
+	M.add_blend_shape(mesh_type::blend_shape_mode::indexed, nr_vertices / 10, nr_vertices / 10);
+	for (unsigned i = 0; i < nr_vertices / 10; ++i) {
+		M.add_blend_shape_index(10 * i + 3);
+		M.add_blend_shape_data(0.1f * vec3(d(rng), d(rng), d(rng)));
+	}
+	M.add_blend_shape(mesh_type::blend_shape_mode::range_indexed, 200, 4);
+	M.add_blend_shape_index(100); M.add_blend_shape_index(200);
+	M.add_blend_shape_index(500); M.add_blend_shape_index(600);
+	for (unsigned i = 0; i < 200; ++i)
+		M.add_blend_shape_data(0.1f * vec3(d(rng), d(rng), d(rng)));
+
+	M.ref_joint_parents().resize(nr_joints, -1);
+	M.set_vertex_weight_mode(mesh_type::vertex_weight_mode::sparse);
+	for (unsigned vi = 0; vi < nr_vertices; ++vi) {
+		M.begin_vertex_weight_vertex();
+		float w[4] = { 0.4f, 0.3f, 0.2f, 0.1f };
+		for (unsigned k = 0; k < 4; ++k) {
+			M.add_vertex_weight_index((vi + 5 * k) % nr_joints);
+			M.add_vertex_weight_data(w[k]);
+		}
+	}
+}
+
+bool test_dynamic_mesh()
+{
+	unsigned nr_vertices = 100000, nr_joints = 24, nr_direct_shapes = 10;
+	mesh_type M;
+	construct_skinned_mesh(M, nr_vertices, nr_joints, nr_direct_shapes);
+	std::vector<float> weights;
+	for (unsigned bi = 0; bi < nr_direct_shapes + 2; ++bi)
+		weights.push_back(0.1f * (bi + 1));
+	std::vector<mat4> joint_matrices;
+	for (unsigned ji = 0; ji < nr_joints; ++ji)
+		joint_matrices.push_back(cgv::math::translate4<float>(vec3(0.1f * ji, 0, -0.2f)) *
+			cgv::math::rotate4<float>(10.0f * ji, vec3(1, 2, 3)));
+
+	// reference result of separate blend shape and skinning passes
+	M.apply_blend_shapes(weights);
+	M.store_in_intermediate_positions();
+	M.lbs(joint_matrices, mesh_type::lbs_source_mode::intermediate);
+	std::vector<vec3> blended = M.get_intermediate_positions();
+	std::vector<vec3> skinned = M.get_positions();
+
+	M.prepare_skinning();
+	M.skin(weights, joint_matrices, 0, true);
+	float max_error = 0, max_blend_error = 0;
+	for (idx_type vi = 0; vi < nr_vertices; ++vi) {
+		max_error = std::max(max_error, (M.position(vi) - skinned[vi]).length());
+		max_blend_error = std::max(max_blend_error, (M.get_intermediate_positions()[vi] - blended[vi]).length());
+	}
+	TEST_ASSERT(max_error < 1e-4f);
+	TEST_ASSERT(max_blend_error < 1e-5f);
+
+	// blend shapes only with an offset into the blend shapes
+	M.apply_blend_shapes({ 1.0f }, nr_direct_shapes);
+	std::vector<vec3> P = M.get_positions();
+	float max_offset_error = 0;
+	M.skin({ 1.0f }, {}, nr_direct_shapes);
+	for (idx_type vi = 0; vi < nr_vertices; ++vi)
+		max_offset_error = std::max(max_offset_error, (M.position(vi) - P[vi]).length());
+	TEST_ASSERT(max_offset_error < 1e-6f);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_dynamic_mesh_reg("cgv::media::mesh::dynamic_mesh::skin", test_dynamic_mesh);
@@ -0,0 +1,204 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/simple_mesh.h>
+#include <cgv/media/mesh/mapped_simple_mesh.h>
+#include <cgv/utils/file.h>
+#include <cmath>
+#include <cstring>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef simple_mesh<float> mesh_type;
+typedef simple_mesh_base::idx_type idx_type;
+
+/// construct a triangulated grid with texture coordinates, two groups, two materials and per vertex colors
+void construct_test_mesh(mesh_type& M, unsigned res)
+{
+	for (unsigned y = 0; y <= res; ++y)
+		for (unsigned x = 0; x <= res; ++x) {
+			M.new_position(mesh_type::vec3(float(x), float(y), float((x * 7 + y * 13) % 5)));
+			M.new_tex_coord(mesh_type::vec2(float(x) / res, float(y) / res));
+		}
+	M.ensure_colors(cgv::media::CT_RGB8, M.get_nr_positions());
+	for (idx_type pi = 0; pi < M.get_nr_positions(); ++pi)
+		M.set_color(pi, cgv::media::color_storage_types::rgb8(pi % 256, (3 * pi) % 256, 7));
+	M.new_group("left");
+	M.new_group("right");
+	M.new_material();
+	M.ref_material(M.new_material()).set_name("red");
+	M.ref_material(1).set_diffuse_reflectance(mesh_type::mat_type::color_type(1, 0, 0));
+	for (unsigned y = 0; y < res; ++y)
+		for (unsigned x = 0; x < res; ++x) {
+			idx_type p0 = y * (res + 1) + x, p1 = p0 + 1, p2 = p0 + res + 1, p3 = p2 + 1;
+			idx_type ni = M.new_normal(normalize(mesh_type::vec3(float(x) - res / 2.0f, float(y), 1)));
+			idx_type fi = M.start_face(); M.new_corner(p0, ni, p0); M.new_corner(p1, ni, p1); M.new_corner(p3, ni, p3);
+			M.group_index(fi) = 2 * x < res ? 0 : 1; M.material_index(fi) = (x + y) % 2;
+			fi = M.start_face(); M.new_corner(p0, ni, p0); M.new_corner(p3, ni, p3); M.new_corner(p2, ni, p2);
+			M.group_index(fi) = 2 * x < res ? 0 : 1; M.material_index(fi) = (x + y) % 2;
+		}
+}
+
+bool equal_topology(const mesh_type& A, const mesh_type& B)
+{
+	if (A.get_nr_corners() != B.get_nr_corners() || A.get_nr_faces() != B.get_nr_faces() ||
+		A.get_nr_groups() != B.get_nr_groups() || A.get_nr_materials() != B.get_nr_materials())
+		return false;
+	for (idx_type ci = 0; ci < A.get_nr_corners(); ++ci)
+		if (A.c2p(ci) != B.c2p(ci) || A.c2n(ci) != B.c2n(ci) || A.c2t(ci) != B.c2t(ci))
+			return false;
+	for (idx_type fi = 0; fi < A.get_nr_faces(); ++fi)
+		if (A.begin_corner(fi) != B.begin_corner(fi) || A.group_index(fi) != B.group_index(fi) || A.material_index(fi) != B.material_index(fi))
+			return false;
+	for (idx_type gi = 0; gi < A.get_nr_groups(); ++gi)
+		if (A.group_name(gi) != B.group_name(gi))
+			return false;
+	return true;
+}
+
+bool test_mapped_simple_mesh()
+{
+	const std::string file_name = "test_mapped_simple_mesh.msm";
+	mesh_type M;
+	construct_test_mesh(M, 64);
+
+	// lossless round trip
+	TEST_ASSERT(M.write(file_name));
+	{
+		mapped_simple_mesh msm(file_name);
+		TEST_ASSERT(msm.is_open());
+		TEST_ASSERT(msm.verify());
+		TEST_ASSERT(msm.get_section(MSM_TRIANGLES) != 0);
+		TEST_ASSERT_EQ(msm.get_section(MSM_TRIANGLES)->count, 3 * size_t(M.get_nr_faces()));
+		TEST_ASSERT_EQ(msm.get_section(MSM_POSITIONS)->offset % MSM_SECTION_ALIGNMENT, 0);
+		mesh_type N;
+		TEST_ASSERT(N.read_msm(msm));
+		TEST_ASSERT(equal_topology(M, N));
+		TEST_ASSERT(M.get_positions() == N.get_positions());
+		TEST_ASSERT(M.get_normals() == N.get_normals());
+		TEST_ASSERT_EQ(N.get_nr_colors(), M.get_nr_colors());
+		TEST_ASSERT_EQ(N.get_color_storage_type(), cgv::media::CT_RGB8);
+		cgv::media::color_storage_types::rgb8 c;
+		N.put_color(5, c);
+		TEST_ASSERT_EQ(int(c[1]), 15);
+		TEST_ASSERT_EQ(N.get_material(1).get_name(), "red");
+		TEST_ASSERT_EQ(N.get_material(1).get_diffuse_reflectance()[0], 1.0f);
+
+		// stored element buffers equal the ones computed from the mesh until the connectivity changes
+		const simple_mesh_base::element_buffers* eb = N.get_stored_element_buffers();
+		TEST_ASSERT(eb != 0);
+		TEST_ASSERT(eb->vertex_cache_optimized);
+		TEST_ASSERT(eb->include_tex_coords && eb->include_normals && !eb->include_tangents);
+		std::vector<idx_type> perm, vertex_indices, triangle_element_buffer, edge_element_buffer;
+		std::vector<simple_mesh_base::vec4i> unique_tuples;
+		std::vector<simple_mesh_base::vec3i> material_group_start;
+		bool include_tex_coords = true, include_normals = true, include_tangents = true;
+		M.sort_faces(perm, true, true);
+		M.merge_indices(vertex_indices, unique_tuples, &include_tex_coords, &include_normals, &include_tangents);
+		M.extract_triangle_element_buffer(vertex_indices, triangle_element_buffer, &perm, &material_group_start);
+		M.optimize_element_buffers(vertex_indices, unique_tuples, triangle_element_buffer, &material_group_start);
+		M.extract_wireframe_element_buffer(vertex_indices, edge_element_buffer);
+		TEST_ASSERT(eb->unique_tuples == unique_tuples);
+		TEST_ASSERT(eb->triangle_element_buffer == triangle_element_buffer);
+		TEST_ASSERT(eb->edge_element_buffer == edge_element_buffer);
+		TEST_ASSERT(eb->material_group_start == material_group_start);
+		mesh_type C(N);
+		TEST_ASSERT(C.get_stored_element_buffers() != 0);
+		N.revert_face_orientation();
+		TEST_ASSERT(N.get_stored_element_buffers() == 0);
+	}
+
+	// quantized positions and normals
+	TEST_ASSERT(M.write_msm(file_name, true, true, false));
+	{
+		mapped_simple_mesh msm(file_name);
+		TEST_ASSERT(msm.get_section(MSM_POSITIONS) == 0);
+		TEST_ASSERT(msm.get_section(MSM_QUANTIZED_POSITIONS) != 0);
+		TEST_ASSERT(msm.get_section(MSM_TRIANGLES) == 0);
+		mesh_type N;
+		TEST_ASSERT(N.read_msm(msm));
+		TEST_ASSERT(equal_topology(M, N));
+		float max_pos_err = 0, max_nml_err = 0;
+		for (idx_type i = 0; i < M.get_nr_positions(); ++i)
+			max_pos_err = std::max(max_pos_err, length(M.position(i) - N.position(i)));
+		for (idx_type i = 0; i < M.get_nr_normals(); ++i)
+			max_nml_err = std::max(max_nml_err, length(M.normal(i) - N.normal(i)));
+		TEST_ASSERT(max_pos_err < 64.0f / 65535.0f);
+		TEST_ASSERT(max_nml_err < 1e-3f);
+	}
+
+	// corrupted section is detected by verify and corrupted header by open
+	{
+		std::string content;
+		TEST_ASSERT(cgv::utils::file::read(file_name, content));
+		content[content.size() - 1] ^= 1;
+		TEST_ASSERT(cgv::utils::file::write(file_name, content));
+		mapped_simple_mesh msm(file_name);
+		TEST_ASSERT(msm.is_open());
+		TEST_ASSERT(!msm.verify());
+		msm.close();
+		content[20] ^= 1;
+		TEST_ASSERT(cgv::utils::file::write(file_name, content));
+		TEST_ASSERT(!msm.open(file_name));
+	}
+	// section sizes whose sums or products overflow 64 bit are rejected even with a valid header checksum
+	TEST_ASSERT(M.write_msm(file_name));
+	{
+		std::string content;
+		TEST_ASSERT(cgv::utils::file::read(file_name, content));
+		msm_header h;
+		std::memcpy(&h, content.data(), sizeof(msm_header));
+		const msm_section s = h.sections[MSM_POSITIONS];
+		TEST_ASSERT(s.count > 0 && s.size >= h.alignment && s.element_size % 4 == 0);
+		for (int variant = 0; variant < 3; ++variant) {
+			msm_section& t = h.sections[MSM_POSITIONS];
+			t = s;
+			if (variant == 0)
+				// offset + size wraps around to a position inside of the file
+				t.offset = cgv::type::uint64_type(0) - h.alignment;
+			else if (variant == 1)
+				// count * element_size wraps around to the unchanged size
+				t.count += cgv::type::uint64_type(1) << 62;
+			else
+				t.element_size = 0;
+			h.header_checksum = 0;
+			h.header_checksum = mapped_simple_mesh::compute_checksum(&h, sizeof(msm_header));
+			std::memcpy(&content[0], &h, sizeof(msm_header));
+			TEST_ASSERT(cgv::utils::file::write(file_name, content));
+			mapped_simple_mesh msm;
+			TEST_ASSERT(!msm.open(file_name));
+		}
+	}
+	cgv::utils::file::remove(file_name);
+
+	// obj files are cached in msm files only on request or after enabling the cache globally
+	const std::string obj_file_name = "test_mapped_simple_mesh.obj";
+	const std::string cache_file_name = "test_mapped_simple_mesh.msm";
+	mesh_type P;
+	construct_test_mesh(P, 64);
+	TEST_ASSERT(P.write(obj_file_name));
+	mesh_type A, B;
+	TEST_ASSERT(A.read(obj_file_name));
+	TEST_ASSERT(!cgv::utils::file::exists(cache_file_name));
+	TEST_ASSERT(A.get_stored_element_buffers() == 0);
+	TEST_ASSERT(A.read(obj_file_name, true));
+	TEST_ASSERT(cgv::utils::file::exists(cache_file_name));
+	TEST_ASSERT(B.read(obj_file_name, true));
+	TEST_ASSERT(B.get_stored_element_buffers() != 0);
+	TEST_ASSERT(equal_topology(A, B));
+	TEST_ASSERT(A.get_positions() == B.get_positions());
+	cgv::utils::file::remove(cache_file_name);
+	TEST_ASSERT(!simple_mesh_base::is_msm_cache_enabled());
+	simple_mesh_base::set_msm_cache_enabled(true);
+	TEST_ASSERT(A.read(obj_file_name));
+	TEST_ASSERT(cgv::utils::file::exists(cache_file_name));
+	TEST_ASSERT(B.read(obj_file_name));
+	TEST_ASSERT(B.get_stored_element_buffers() != 0);
+	simple_mesh_base::set_msm_cache_enabled(false);
+	cgv::utils::file::remove(obj_file_name);
+	cgv::utils::file::remove(cache_file_name);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_mapped_simple_mesh_reg("cgv::media::mesh::mapped_simple_mesh", test_mapped_simple_mesh);
@@ -0,0 +1,51 @@
+// Measures build time and ray throughput of mesh_bvh for coherent camera rays onto a finely tessellated sphere, where
+// packets of rays are compared with single rays. Usage: benchmark_mesh_bvh [nr_rings [image_resolution]]
+#include <cgv/utils/stopwatch.h>
+#include "mesh_bvh_scene.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+	unsigned nr_rings = argc > 1 ? unsigned(std::max(2, atoi(argv[1]))) : 512;
+	unsigned res = argc > 2 ? unsigned(std::max(1, atoi(argv[2]))) : 1024;
+	mesh_type M;
+	construct_sphere_mesh(M, nr_rings, 2 * nr_rings);
+	std::vector<bvh_type::ray_type> rays = generate_camera_rays(res, 3);
+	double nr_rays = double(rays.size());
+
+	bvh_type B;
+	cgv::utils::stopwatch watch(true);
+	B.build(M);
+	double t_build = watch.restart();
+	std::vector<bvh_type::hit_info> hits;
+	B.closest_hits(rays, hits);
+	double t_packets = watch.restart();
+	size_t nr_mismatches = 0;
+	for (size_t i = 0; i < rays.size(); ++i) {
+		bvh_type::hit_info hit;
+		B.closest_hit(rays[i], hit);
+		if (hit.valid() != hits[i].valid())
+			++nr_mismatches;
+	}
+	double t_single = watch.restart();
+	std::vector<char> any;
+	B.any_hits(rays, any);
+	double t_any_packets = watch.restart();
+	for (const auto& r : rays)
+		B.any_hit(r);
+	double t_any_single = watch.restart();
+
+	std::cout << "built bvh over " << B.get_nr_triangles() << " triangles in " << 1000 * t_build << "ms, "
+		<< B.get_nr_nodes() << " nodes, depth " << B.get_depth() << "\n"
+		<< "closest hits: " << nr_rays / t_packets * 1e-6 << " Mrays/s with packets, "
+		<< nr_rays / t_single * 1e-6 << " Mrays/s single\n"
+		<< "any hits:     " << nr_rays / t_any_packets * 1e-6 << " Mrays/s with packets, "
+		<< nr_rays / t_any_single * 1e-6 << " Mrays/s single" << std::endl;
+	if (nr_mismatches > 0) {
+		std::cerr << nr_mismatches << " rays hit with packets but not as single rays or vice versa" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cgv/media/mesh/mesh_bvh.h>
+#include <cmath>
+
+// scene construction shared by test_mesh_bvh and benchmark_mesh_bvh
+
+typedef cgv::media::mesh::simple_mesh<float> mesh_type;
+typedef mesh_type::idx_type idx_type;
+typedef mesh_type::vec3 vec3;
+typedef cgv::media::mesh::mesh_bvh<float> bvh_type;
+
+/// construct a closed unit sphere from rings of quads and two fans of triangles at the poles
+inline void construct_sphere_mesh(mesh_type& M, unsigned nr_rings, unsigned nr_segments)
+{
+	const float pi = 3.14159265358979f;
+	idx_type south = M.new_position(vec3(0, 0, -1));
+	for (unsigned r = 1; r < nr_rings; ++r) {
+		float theta = pi * r / nr_rings;
+		for (unsigned s = 0; s < nr_segments; ++s) {
+			float phi = 2 * pi * s / nr_segments;
+			M.new_position(vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), -std::cos(theta)));
+		}
+	}
+	idx_type north = M.new_position(vec3(0, 0, 1));
+	auto ring_vertex = [&](unsigned r, unsigned s) { return idx_type(1 + (r - 1) * nr_segments + s % nr_segments); };
+	for (unsigned s = 0; s < nr_segments; ++s) {
+		M.start_face(); M.new_corner(south); M.new_corner(ring_vertex(1, s + 1)); M.new_corner(ring_vertex(1, s));
+		M.start_face(); M.new_corner(north); M.new_corner(ring_vertex(nr_rings - 1, s)); M.new_corner(ring_vertex(nr_rings - 1, s + 1));
+	}
+	for (unsigned r = 1; r + 1 < nr_rings; ++r)
+		for (unsigned s = 0; s < nr_segments; ++s) {
+			M.start_face(); M.new_corner(ring_vertex(r, s)); M.new_corner(ring_vertex(r, s + 1)); M.new_corner(ring_vertex(r + 1, s + 1)); M.new_corner(ring_vertex(r + 1, s));
+		}
+}
+
+/// generate camera rays of a res x res image looking at the origin from the given distance
+inline std::vector<bvh_type::ray_type> generate_camera_rays(unsigned res, float distance)
+{
+	std::vector<bvh_type::ray_type> rays;
+	vec3 eye(0.3f, 0.2f, distance);
+	for (unsigned y = 0; y < res; ++y)
+		for (unsigned x = 0; x < res; ++x) {
+			vec3 d(2.4f * (x + 0.5f) / res - 1.2f - eye[0], 2.4f * (y + 0.5f) / res - 1.2f - eye[1], -distance);
+			rays.push_back(bvh_type::ray_type(eye, normalize(d)));
+		}
+	return rays;
+}
@@ -0,0 +1,113 @@
+#include <cgv/base/register.h>
+#include "mesh_bvh_scene.h"
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+/// intersect ray with all fan triangulated faces and return the closest ray parameter
+float brute_force_hit(const simple_mesh<float>& M, const bvh_type::ray_type& r, idx_type& face)
+{
+	float t_best = std::numeric_limits<float>::max();
+	face = idx_type(-1);
+	for (idx_type fi = 0; fi < M.get_nr_faces(); ++fi) {
+		idx_type c0 = M.begin_corner(fi);
+		for (idx_type ci = c0 + 1; ci + 1 < M.end_corner(fi); ++ci) {
+			vec3 p0 = M.position(M.c2p(c0)), e1 = M.position(M.c2p(ci)) - p0, e2 = M.position(M.c2p(ci + 1)) - p0;
+			vec3 p = cross(r.direction, e2), s = r.origin - p0, q = cross(s, e1);
+			float det = dot(e1, p);
+			if (det == 0)
+				continue;
+			float u = dot(s, p) / det, v = dot(r.direction, q) / det, t = dot(e2, q) / det;
+			if (u >= 0 && v >= 0 && u + v <= 1 && t >= 0 && t < t_best) {
+				t_best = t;
+				face = fi;
+			}
+		}
+	}
+	return t_best;
+}
+
+bool test_mesh_bvh()
+{
+	simple_mesh<float> M;
+	construct_sphere_mesh(M, 64, 128);
+	bvh_type B;
+	B.build(M);
+	TEST_ASSERT_EQ(B.get_nr_triangles(), size_t(2 * 128 * 63));
+	TEST_ASSERT(B.get_depth() < 64);
+	TEST_ASSERT_EQ(B.get_nodes()[0].count, 0u);
+
+	// single ray queries agree with brute force intersection
+	std::vector<bvh_type::ray_type> rays = generate_camera_rays(32, 3);
+	size_t nr_hits = 0;
+	for (const auto& r : rays) {
+		idx_type face;
+		float t = brute_force_hit(M, r, face);
+		bvh_type::hit_info hit;
+		bool found = B.closest_hit(r, hit);
+		TEST_ASSERT_EQ(found, face != idx_type(-1));
+		TEST_ASSERT_EQ(B.any_hit(r), found);
+		if (!found)
+			continue;
+		++nr_hits;
+		TEST_ASSERT(std::abs(hit.t - t) < 1e-5f);
+		vec3 p = r.origin + hit.t * r.direction;
+		TEST_ASSERT(std::abs(length(p) - 1) < 1e-3f);
+		// occlusion test is limited to the given ray interval
+		TEST_ASSERT(!B.any_hit(r, 0, 0.9f * t));
+	}
+	TEST_ASSERT(nr_hits > rays.size() / 2 && nr_hits < rays.size());
+
+	// batch queries agree with single ray queries
+	std::vector<bvh_type::hit_info> hits;
+	std::vector<char> any;
+	B.closest_hits(rays, hits);
+	B.any_hits(rays, any);
+	TEST_ASSERT_EQ(hits.size(), rays.size());
+	for (size_t i = 0; i < rays.size(); ++i) {
+		bvh_type::hit_info hit;
+		bool found = B.closest_hit(rays[i], hit);
+		TEST_ASSERT_EQ(hits[i].valid(), found);
+		TEST_ASSERT_EQ(any[i] != 0, found);
+		if (found) {
+			TEST_ASSERT(std::abs(hits[i].t - hit.t) < 1e-5f);
+			TEST_ASSERT_EQ(hits[i].face_index, hit.face_index);
+		}
+	}
+
+	// refit after scaling and translating the sphere
+	for (idx_type pi = 0; pi < M.get_nr_positions(); ++pi)
+		M.position(pi) = 0.5f * M.position(pi) + vec3(0, 0, 0.25f);
+	B.refit(M);
+	for (int a = 0; a < 3; ++a) {
+		TEST_ASSERT(std::abs(B.get_nodes()[0].box_min[a] - (a == 2 ? -0.25f : -0.5f)) < 1e-5f);
+		TEST_ASSERT(std::abs(B.get_nodes()[0].box_max[a] - (a == 2 ? 0.75f : 0.5f)) < 1e-5f);
+	}
+	B.closest_hits(rays, hits);
+	for (size_t i = 0; i < rays.size(); i += 7) {
+		idx_type face;
+		float t = brute_force_hit(M, rays[i], face);
+		TEST_ASSERT_EQ(hits[i].valid(), face != idx_type(-1));
+		if (face != idx_type(-1))
+			TEST_ASSERT(std::abs(hits[i].t - t) < 1e-5f);
+	}
+
+	// packets of coherent camera rays find the same hits as single rays
+	M.clear();
+	construct_sphere_mesh(M, 128, 256);
+	B.build(M);
+	rays = generate_camera_rays(128, 3);
+	B.closest_hits(rays, hits);
+	for (size_t i = 0; i < rays.size(); ++i) {
+		bvh_type::hit_info hit;
+		B.closest_hit(rays[i], hit);
+		TEST_ASSERT_EQ(hits[i].valid(), hit.valid());
+		if (hit.valid())
+			TEST_ASSERT(std::abs(hits[i].t - hit.t) < 1e-6f);
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_mesh_bvh_reg("cgv::media::mesh::mesh_bvh", test_mesh_bvh);
@@ -0,0 +1,136 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/mesh_decimator.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef simple_mesh_base::idx_type idx_type;
+typedef simple_mesh<float>::vec3 vec3;
+
+/// construct a closed unit sphere from rings of vertices and two poles
+void construct_sphere_mesh(simple_mesh<float>& M, unsigned nr_rings, unsigned nr_segments)
+{
+	const float pi = 3.14159265358979f;
+	idx_type south = M.new_position(vec3(0, 0, -1));
+	for (unsigned r = 1; r < nr_rings; ++r) {
+		float theta = pi * r / nr_rings;
+		for (unsigned s = 0; s < nr_segments; ++s) {
+			float phi = 2 * pi * s / nr_segments;
+			M.new_position(vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), -std::cos(theta)));
+		}
+	}
+	idx_type north = M.new_position(vec3(0, 0, 1));
+	auto ring_vertex = [&](unsigned r, unsigned s) { return idx_type(1 + (r - 1) * nr_segments + s % nr_segments); };
+	for (unsigned s = 0; s < nr_segments; ++s) {
+		M.start_face(); M.new_corner(south); M.new_corner(ring_vertex(1, s + 1)); M.new_corner(ring_vertex(1, s));
+		M.start_face(); M.new_corner(north); M.new_corner(ring_vertex(nr_rings - 1, s)); M.new_corner(ring_vertex(nr_rings - 1, s + 1));
+	}
+	for (unsigned r = 1; r + 1 < nr_rings; ++r)
+		for (unsigned s = 0; s < nr_segments; ++s) {
+			M.start_face(); M.new_corner(ring_vertex(r, s)); M.new_corner(ring_vertex(r, s + 1)); M.new_corner(ring_vertex(r + 1, s + 1)); M.new_corner(ring_vertex(r + 1, s));
+		}
+}
+
+/// count the edges that are not shared by exactly two faces
+size_t count_non_manifold_edges(const simple_mesh<float>& M)
+{
+	std::vector<std::pair<idx_type, idx_type> > edges;
+	for (idx_type fi = 0; fi < M.get_nr_faces(); ++fi)
+		for (idx_type ci = M.begin_corner(fi); ci < M.end_corner(fi); ++ci) {
+			idx_type cj = ci + 1 == M.end_corner(fi) ? M.begin_corner(fi) : ci + 1;
+			edges.push_back(std::make_pair(std::min(M.c2p(ci), M.c2p(cj)), std::max(M.c2p(ci), M.c2p(cj))));
+		}
+	std::sort(edges.begin(), edges.end());
+	size_t count = 0;
+	for (size_t i = 0; i < edges.size(); ) {
+		size_t j = i;
+		while (j < edges.size() && edges[j] == edges[i])
+			++j;
+		if (j - i != 2)
+			++count;
+		i = j;
+	}
+	return count;
+}
+
+/// return the maximum deviation of the mesh vertices from the unit sphere
+float compute_max_sphere_deviation(const simple_mesh<float>& M)
+{
+	float max_deviation = 0;
+	for (const auto& p : M.get_positions())
+		max_deviation = std::max(max_deviation, std::abs(p.length() - 1));
+	return max_deviation;
+}
+
+bool test_mesh_decimation()
+{
+	simple_mesh<float> M;
+	construct_sphere_mesh(M, 200, 400);
+	size_t nr_triangles = 2 * 400 * 199;
+
+	// serial and parallel decimation to 5% of the triangles keeps the sphere closed and close to its surface
+	for (unsigned n : { 1u, 4u }) {
+		mesh_decimator<float> decimator;
+		decimator.target_nr_triangles = nr_triangles / 20;
+		decimator.nr_partitions_per_axis = n;
+		simple_mesh<float> D;
+		TEST_ASSERT(decimator.decimate(M, D));
+		TEST_ASSERT(D.get_nr_faces() <= decimator.target_nr_triangles);
+		TEST_ASSERT(D.get_nr_faces() > decimator.target_nr_triangles - 10);
+		TEST_ASSERT_EQ(count_non_manifold_edges(D), size_t(0));
+		TEST_ASSERT(compute_max_sphere_deviation(D) < 0.02f);
+	}
+
+	// error bound stops decimation before the mesh degenerates
+	{
+		mesh_decimator<float> decimator;
+		decimator.max_error = 1e-6;
+		simple_mesh<float> D;
+		TEST_ASSERT(decimator.decimate(M, D));
+		TEST_ASSERT(D.get_nr_faces() < nr_triangles);
+		TEST_ASSERT(D.get_nr_faces() > 100);
+		TEST_ASSERT(decimator.get_max_collapse_error() <= 1e-6);
+	}
+
+	// progressive levels of detail with decreasing triangle counts
+	{
+		mesh_decimator<float> decimator;
+		std::vector<simple_mesh<float> > levels;
+		TEST_ASSERT(decimator.decimate_progressive(M, { nr_triangles / 4, nr_triangles / 16, 500 }, levels));
+		TEST_ASSERT_EQ(levels.size(), size_t(3));
+		TEST_ASSERT(levels[0].get_nr_faces() <= nr_triangles / 4);
+		TEST_ASSERT(levels[1].get_nr_faces() <= nr_triangles / 16);
+		TEST_ASSERT(levels[1].get_nr_faces() < levels[0].get_nr_faces());
+		TEST_ASSERT(levels[2].get_nr_faces() <= 500);
+		for (const auto& L : levels)
+			TEST_ASSERT_EQ(count_non_manifold_edges(L), size_t(0));
+	}
+
+	// corners of an open quad grid are preserved by the border quadrics
+	{
+		simple_mesh<float> G;
+		unsigned res = 100;
+		for (unsigned y = 0; y <= res; ++y)
+			for (unsigned x = 0; x <= res; ++x)
+				G.new_position(vec3(float(x), float(y), 0.01f * float((x * 7 + y * 13) % 5)));
+		for (unsigned y = 0; y < res; ++y)
+			for (unsigned x = 0; x < res; ++x) {
+				idx_type p0 = y * (res + 1) + x;
+				G.start_face(); G.new_corner(p0); G.new_corner(p0 + 1); G.new_corner(p0 + res + 2); G.new_corner(p0 + res + 1);
+			}
+		mesh_decimator<float> decimator;
+		decimator.target_nr_triangles = 400;
+		simple_mesh<float> D;
+		TEST_ASSERT(decimator.decimate(G, D));
+		simple_mesh<float>::box_type box = D.compute_box();
+		TEST_ASSERT(std::abs(box.get_min_pnt()[0]) < 1e-3f && std::abs(box.get_min_pnt()[1]) < 1e-3f);
+		TEST_ASSERT(std::abs(box.get_max_pnt()[0] - res) < 1e-3f && std::abs(box.get_max_pnt()[1] - res) < 1e-3f);
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_mesh_decimation_reg("cgv::media::mesh::mesh_decimator", test_mesh_decimation);
@@ -0,0 +1,72 @@
+// Compares the running times of the map based reference implementations with the radix sort based corner welding
+// of simple_mesh on triangulated grids. Usage: benchmark_mesh_welding [resolution [nr_repetitions]]
+#include <cgv/utils/stopwatch.h>
+#include "mesh_welding_reference.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+/// call f nr_repetitions times and return the minimal running time in seconds
+template <typename F>
+double measure(unsigned nr_repetitions, const F& f)
+{
+	double t_min = 0;
+	for (unsigned r = 0; r < nr_repetitions; ++r) {
+		cgv::utils::stopwatch watch(true);
+		f();
+		double t = watch.get_elapsed_time();
+		if (r == 0 || t < t_min)
+			t_min = t;
+	}
+	return t_min;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned res = argc > 1 ? unsigned(std::max(1, atoi(argv[1]))) : 1024;
+	unsigned nr_repetitions = argc > 2 ? unsigned(std::max(1, atoi(argv[2]))) : 3;
+	mesh_type M;
+	construct_grid_mesh(M, res);
+
+	std::vector<idx_type> indices_ref, indices;
+	std::vector<vec4i> unique_ref, unique;
+	double t_merge_ref = measure(nr_repetitions, [&]() {
+		indices_ref.clear(); unique_ref.clear();
+		merge_indices_map(M, indices_ref, unique_ref);
+	});
+	double t_merge = measure(nr_repetitions, [&]() {
+		indices.clear(); unique.clear();
+		bool include_normals = true;
+		M.merge_indices(indices, unique, 0, &include_normals);
+	});
+
+	std::vector<idx_type> edges_ref, edges;
+	double t_wire_ref = measure(nr_repetitions, [&]() {
+		edges_ref.clear();
+		extract_wireframe_element_buffer_map(M, indices, edges_ref);
+	});
+	double t_wire = measure(nr_repetitions, [&]() {
+		edges.clear();
+		M.extract_wireframe_element_buffer(indices, edges);
+	});
+
+	std::vector<uint32_t> inv_ref, inv;
+	double t_inv_ref = measure(nr_repetitions, [&]() {
+		inv_ref.clear();
+		compute_inv_map(M, inv_ref);
+	});
+	double t_inv = measure(nr_repetitions, [&]() {
+		M.compute_inv(inv);
+	});
+
+	bool equal = indices == indices_ref && unique == unique_ref && edges == edges_ref && inv == inv_ref;
+	std::cout << "mesh welding with " << M.get_nr_corners() << " corners, best of " << nr_repetitions << " runs (map / radix sort):\n"
+		<< "  merge_indices                    " << 1000 * t_merge_ref << "ms / " << 1000 * t_merge << "ms\n"
+		<< "  extract_wireframe_element_buffer " << 1000 * t_wire_ref << "ms / " << 1000 * t_wire << "ms\n"
+		<< "  compute_inv                      " << 1000 * t_inv_ref << "ms / " << 1000 * t_inv << "ms" << std::endl;
+	if (!equal) {
+		std::cerr << "results of map and radix sort implementations differ" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cgv/media/mesh/simple_mesh.h>
+#include <map>
+#include <tuple>
+
+// map based reference implementations of the corner welding of simple_mesh, shared by test_mesh_welding and benchmark_mesh_welding
+
+typedef cgv::media::mesh::simple_mesh<float> mesh_type;
+typedef mesh_type::idx_type idx_type;
+typedef mesh_type::vec4i vec4i;
+
+/// construct a triangulated grid with per face normals, such that corners share positions but not normals
+inline void construct_grid_mesh(mesh_type& M, unsigned res)
+{
+	for (unsigned y = 0; y <= res; ++y)
+		for (unsigned x = 0; x <= res; ++x)
+			M.new_position(mesh_type::vec3(float(x), float(y), float((x * 7 + y * 13) % 5)));
+	for (unsigned y = 0; y < res; ++y)
+		for (unsigned x = 0; x < res; ++x) {
+			idx_type p0 = y * (res + 1) + x, p1 = p0 + 1, p2 = p0 + res + 1, p3 = p2 + 1;
+			idx_type ni = M.new_normal(mesh_type::vec3(0, 0, 1));
+			M.start_face(); M.new_corner(p0, ni); M.new_corner(p1, ni); M.new_corner(p3, ni);
+			ni = M.new_normal(mesh_type::vec3(0, 0, 1));
+			M.start_face(); M.new_corner(p0, ni); M.new_corner(p3, ni); M.new_corner(p2, ni);
+		}
+}
+
+/// map based reference implementation of simple_mesh_base::merge_indices
+inline void merge_indices_map(const mesh_type& M, std::vector<idx_type>& indices, std::vector<vec4i>& unique_quadruples)
+{
+	std::map<std::tuple<idx_type, idx_type, idx_type, idx_type>, idx_type> corner_to_index;
+	for (idx_type ci = 0; ci < M.get_nr_corners(); ++ci) {
+		vec4i c(M.c2p(ci), 0, M.c2n(ci), 0);
+		std::tuple<idx_type, idx_type, idx_type, idx_type> quadruple(c(0), c(1), c(2), c(3));
+		auto iter = corner_to_index.find(quadruple);
+		idx_type vi;
+		if (iter == corner_to_index.end()) {
+			vi = idx_type(unique_quadruples.size());
+			corner_to_index[quadruple] = vi;
+			unique_quadruples.push_back(c);
+		}
+		else
+			vi = iter->second;
+		indices.push_back(vi);
+	}
+}
+
+/// map based reference implementation of simple_mesh_base::extract_wireframe_element_buffer
+inline void extract_wireframe_element_buffer_map(const mesh_type& M, const std::vector<idx_type>& vertex_indices, std::vector<idx_type>& edge_element_buffer)
+{
+	std::map<std::tuple<idx_type, idx_type>, idx_type> halfedge_to_count;
+	for (idx_type fi = 0; fi < M.get_nr_faces(); ++fi) {
+		idx_type last_vi = vertex_indices.at(M.end_corner(fi) - 1);
+		for (idx_type ci = M.begin_corner(fi); ci < M.end_corner(fi); ++ci) {
+			idx_type vi = vertex_indices.at(ci);
+			std::tuple<idx_type, idx_type> halfedge(std::min(last_vi, vi), std::max(last_vi, vi));
+			auto iter = halfedge_to_count.find(halfedge);
+			if (iter == halfedge_to_count.end()) {
+				halfedge_to_count[halfedge] = 1;
+				edge_element_buffer.push_back(last_vi);
+				edge_element_buffer.push_back(vi);
+			}
+			else
+				++iter->second;
+			last_vi = vi;
+		}
+	}
+}
+
+/// map based reference implementation of simple_mesh_base::compute_inv
+inline void compute_inv_map(const mesh_type& M, std::vector<uint32_t>& inv)
+{
+	inv.resize(M.get_nr_corners(), uint32_t(-1));
+	std::map<std::pair<uint32_t, uint32_t>, uint32_t> pipj2ci;
+	for (uint32_t fi = 0; fi < M.get_nr_faces(); ++fi) {
+		for (uint32_t ci = M.begin_corner(fi); ci < M.end_corner(fi); ++ci) {
+			uint32_t next_ci = ci + 1 == M.end_corner(fi) ? M.begin_corner(fi) : ci + 1;
+			uint32_t pi = M.c2p(ci), pj = M.c2p(next_ci);
+			std::pair<uint32_t, uint32_t> pipj(std::min(pi, pj), std::max(pi, pj));
+			auto iter = pipj2ci.find(pipj);
+			if (iter == pipj2ci.end())
+				pipj2ci[pipj] = ci;
+			else {
+				inv[ci] = iter->second;
+				inv[iter->second] = ci;
+				pipj2ci.erase(iter);
+			}
+		}
+	}
+}
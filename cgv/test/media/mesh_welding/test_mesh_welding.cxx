@@ -0,0 +1,36 @@
+#include <cgv/base/register.h>
+#include "mesh_welding_reference.h"
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+bool test_mesh_welding()
+{
+	for (unsigned res : { 16u, 512u }) {
+		simple_mesh<float> M;
+		construct_grid_mesh(M, res);
+
+		std::vector<idx_type> indices_ref, indices;
+		std::vector<vec4i> unique_ref, unique;
+		merge_indices_map(M, indices_ref, unique_ref);
+		bool include_normals = true;
+		M.merge_indices(indices, unique, 0, &include_normals);
+		TEST_ASSERT(indices == indices_ref);
+		TEST_ASSERT(unique == unique_ref);
+
+		std::vector<idx_type> edges_ref, edges;
+		extract_wireframe_element_buffer_map(M, indices, edges_ref);
+		M.extract_wireframe_element_buffer(indices, edges);
+		TEST_ASSERT(edges == edges_ref);
+
+		std::vector<uint32_t> inv_ref, inv;
+		compute_inv_map(M, inv_ref);
+		M.compute_inv(inv);
+		TEST_ASSERT(inv == inv_ref);
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_mesh_welding_reg("cgv::media::mesh::simple_mesh::welding", test_mesh_welding);
@@ -0,0 +1,94 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/obj_loader.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+/// reader that records all callbacks as text, where element indices are converted to positive ones as the parallel parser resolves them
+struct recording_obj_reader : public obj_readerf
+{
+	std::vector<std::string> calls;
+	unsigned nr_v = 0, nr_t = 0, nr_n = 0;
+	void record(const std::string& call)
+	{
+		calls.push_back(call + " g" + std::to_string(int(get_current_group())) + " m" + std::to_string(int(get_current_material())));
+	}
+	void process_vertex(const v3d_type& p) { std::ostringstream os; os << "v " << p; calls.push_back(os.str()); ++nr_v; }
+	void process_texcoord(const v2d_type& t) { std::ostringstream os; os << "vt " << t; calls.push_back(os.str()); ++nr_t; }
+	void process_normal(const v3d_type& n) { std::ostringstream os; os << "vn " << n; calls.push_back(os.str()); ++nr_n; }
+	void process_color(const color_type& c) { std::ostringstream os; os << "c " << c; calls.push_back(os.str()); }
+	void process_group(const std::string& name, const std::string& parameters) { calls.push_back("g " + name + " " + parameters); }
+	void process_material(const cgv::media::illum::obj_material& mtl, unsigned idx) { calls.push_back("m " + mtl.get_name() + " " + std::to_string(idx)); }
+	void process_element(const char* type, unsigned vcount, int* vertices, int* texcoords, int* normals)
+	{
+		convert_to_positive(vcount, vertices, texcoords, normals, nr_v, nr_n, nr_t);
+		std::string call = type;
+		for (unsigned i = 0; i < vcount; ++i)
+			call += " " + std::to_string(vertices[i]) + "/" + (texcoords ? std::to_string(texcoords[i]) : "") + "/" + (normals ? std::to_string(normals[i]) : "");
+		record(call);
+	}
+	void process_face(unsigned vcount, int* vertices, int* texcoords, int* normals) { process_element("f", vcount, vertices, texcoords, normals); }
+	void process_line(unsigned vcount, int* vertices, int* texcoords, int* normals) { process_element("l", vcount, vertices, texcoords, normals); }
+};
+
+/// generate content with interleaved attributes, elements and group changes that spans several parser chunks
+std::string generate_obj_content()
+{
+	std::ostringstream os;
+	os << "# generated\nl 1 2\nv 0 0 0\nv 1 0 0\nv 0 1 0 0.5 0.25 1\n";
+	for (int i = 0; os.tellp() < 3 * (1 << 20); ++i) {
+		if (i % 997 == 0)
+			os << "g part" << i % 5 << " smooth\n";
+		if (i % 1511 == 0)
+			os << "usemtl unknown\n";
+		os << "v " << i << " " << 0.5 * i << " 1\nvt 0." << i % 10 << " 1\nvn 0 0 1\n";
+		if (i % 3 == 0)
+			os << "vc 1 0 0\n";
+		if (i % 4 == 0)
+			os << "f -1/-1/-1 -2/-1/-1 -3/-1/-1\n";
+		else if (i % 4 == 1)
+			os << "f " << i + 1 << " " << i + 2 << " " << i + 3 << "\n";
+		else if (i % 4 == 2)
+			os << "l -1 -2\n";
+		else
+			os << "f 1//1 2//2 3//3 4//4\n";
+	}
+	return os.str();
+}
+
+bool test_obj_reader_parallel_callback_order()
+{
+	std::string content = generate_obj_content();
+	recording_obj_reader serial, parallel;
+	serial.use_parallel_parser = false;
+	TEST_ASSERT(serial.parse_obj(content));
+	TEST_ASSERT(parallel.parse_obj(content));
+	TEST_ASSERT(serial.calls.size() > 100000);
+	TEST_ASSERT_EQ(parallel.calls.size(), serial.calls.size());
+	size_t i = 0;
+	while (i < serial.calls.size() && parallel.calls[i] == serial.calls[i])
+		++i;
+	TEST_ASSERT_EQ(i, serial.calls.size());
+
+	// the loader takes the arrays of the parallel parser without recording the file order
+	obj_loaderf serial_loader, parallel_loader;
+	serial_loader.use_parallel_parser = false;
+	TEST_ASSERT(serial_loader.parse_obj(content));
+	TEST_ASSERT(parallel_loader.parse_obj(content));
+	TEST_ASSERT(parallel_loader.vertices == serial_loader.vertices);
+	TEST_ASSERT(parallel_loader.vertex_indices == serial_loader.vertex_indices);
+	TEST_ASSERT(parallel_loader.normal_indices == serial_loader.normal_indices);
+	TEST_ASSERT_EQ(parallel_loader.faces.size(), serial_loader.faces.size());
+	TEST_ASSERT_EQ(parallel_loader.lines.size(), serial_loader.lines.size());
+	TEST_ASSERT_EQ(parallel_loader.groups.size(), serial_loader.groups.size());
+	for (size_t fi = 0; fi < serial_loader.faces.size(); ++fi)
+		TEST_ASSERT_EQ(parallel_loader.faces[fi].group_index, serial_loader.faces[fi].group_index);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_obj_reader_parallel_callback_order_reg("cgv::media::mesh::obj_reader::parallel_callback_order", test_obj_reader_parallel_callback_order);
@@ -0,0 +1,123 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/file.h>
+#include <cgv/media/image/image_writer.h>
+#include <cgv/media/volume/slice_stack_reader.h>
+#include <chrono>
+#include <cstring>
+#include <set>
+#include <thread>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::media::volume;
+
+namespace {
+	const size_t width = 32, height = 16, nr_slices = 24;
+
+	/// return file name of i-th slice
+	std::string get_slice_file_name(size_t i)
+	{
+		return "test_slice_stack_reader_" + std::to_string(i) + ".bmp";
+	}
+	/// value of pixel x,y in slice i, which is the same for all rgb components
+	unsigned char get_value(size_t i, size_t x, size_t y)
+	{
+		return (unsigned char)((11 * i + x + 3 * y) % 256);
+	}
+	/// write gray rgb slice of given size
+	bool write_slice(size_t i, size_t w, size_t h)
+	{
+		data_format df(w, h, cgv::type::info::TI_UINT8, CF_RGB);
+		std::vector<unsigned char> data(df.get_nr_bytes());
+		for (size_t y = 0; y < h; ++y)
+			for (size_t x = 0; x < w; ++x)
+				std::memset(&data[3 * (y * w + x)], get_value(i, x, y), 3);
+		cgv::media::image::image_writer iw(get_slice_file_name(i));
+		return iw.write_image(const_data_view(&df, data.data()));
+	}
+	/// check that slice_ptr holds i-th slice independent of the row order in which the bmp reader delivers rows
+	bool check_slice(size_t i, const void* slice_ptr)
+	{
+		const unsigned char* data = static_cast<const unsigned char*>(slice_ptr);
+		bool top_down = true, bottom_up = true;
+		for (size_t y = 0; y < height; ++y)
+			for (size_t x = 0; x < width; ++x)
+				for (size_t c = 0; c < 3; ++c) {
+					top_down = top_down && data[3 * (y * width + x) + c] == get_value(i, x, y);
+					bottom_up = bottom_up && data[3 * (y * width + x) + c] == get_value(i, x, height - 1 - y);
+				}
+		return top_down || bottom_up;
+	}
+
+	/// record of callbacks
+	struct slice_record
+	{
+		size_t nr_calls = 0;
+		bool in_order = true;
+		bool correct = true;
+		std::set<const void*> slice_ptrs;
+	};
+	bool on_slice(size_t slice_index, const void* slice_ptr, void* user_data)
+	{
+		slice_record& record = *static_cast<slice_record*>(user_data);
+		record.in_order = record.in_order && slice_index == record.nr_calls;
+		record.correct = record.correct && check_slice(slice_index, slice_ptr);
+		record.slice_ptrs.insert(slice_ptr);
+		++record.nr_calls;
+		// slow consumer such that workers run into the bound of pending slices
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		return true;
+	}
+}
+
+bool test_slice_stack_reader_ordered_window()
+{
+	std::vector<std::string> file_names;
+	for (size_t i = 0; i < nr_slices; ++i) {
+		TEST_ASSERT(write_slice(i, width, height));
+		file_names.push_back(get_slice_file_name(i));
+	}
+
+	// without destination slices are passed in order from a ring of three buffers that workers must not overwrite early
+	slice_stack_reader ssr(4, 3);
+	ssr.add_slice_files(file_names);
+	TEST_ASSERT_EQ(ssr.get_nr_slices(), nr_slices);
+	slice_record record;
+	TEST_ASSERT(ssr.read(0, on_slice, &record));
+	TEST_ASSERT_EQ(ssr.get_format().get_width(), width);
+	TEST_ASSERT_EQ(ssr.get_format().get_height(), height);
+	TEST_ASSERT_EQ(record.nr_calls, nr_slices);
+	TEST_ASSERT(record.in_order);
+	TEST_ASSERT(record.correct);
+	TEST_ASSERT(record.slice_ptrs.size() <= 3);
+	TEST_ASSERT_EQ(ssr.get_statistics().nr_slices, nr_slices);
+
+	// decode into contiguous destination
+	size_t slice_size = ssr.get_format().get_nr_bytes();
+	std::vector<unsigned char> volume_data(nr_slices * slice_size);
+	TEST_ASSERT(ssr.read(volume_data.data()));
+	bool volume_correct = true;
+	for (size_t i = 0; i < nr_slices; ++i)
+		volume_correct = volume_correct && check_slice(i, &volume_data[i * slice_size]);
+	TEST_ASSERT(volume_correct);
+
+	// a slice of different size is reported as error and no later slices are delivered
+	size_t mismatch_index = nr_slices / 2;
+	TEST_ASSERT(write_slice(mismatch_index, width / 2, height));
+	slice_stack_reader mismatch_ssr(4, 3);
+	mismatch_ssr.add_slice_files(file_names);
+	slice_record mismatch_record;
+	TEST_ASSERT(!mismatch_ssr.read(0, on_slice, &mismatch_record));
+	TEST_ASSERT(mismatch_ssr.get_last_error().find("differs") != std::string::npos);
+	TEST_ASSERT(mismatch_record.nr_calls <= mismatch_index);
+	TEST_ASSERT(mismatch_record.in_order);
+	TEST_ASSERT(mismatch_record.correct);
+
+	for (const auto& file_name : file_names)
+		cgv::utils::file::remove(file_name);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_slice_stack_reader_ordered_window_reg("cgv::media::volume::slice_stack_reader::ordered_window", test_slice_stack_reader_ordered_window);
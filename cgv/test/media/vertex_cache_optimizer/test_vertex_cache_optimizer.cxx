@@ -0,0 +1,86 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/vertex_cache_optimizer.h>
+#include <algorithm>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef cgv::type::uint32_type idx_type;
+
+/// construct the triangles of a regular grid in random order
+static std::vector<idx_type> construct_shuffled_grid(idx_type res)
+{
+	std::vector<std::vector<idx_type> > triangles;
+	for (idx_type y = 0; y < res; ++y)
+		for (idx_type x = 0; x < res; ++x) {
+			idx_type p0 = y * (res + 1) + x, p1 = p0 + 1, p2 = p0 + res + 1, p3 = p2 + 1;
+			triangles.push_back({ p0, p1, p3 });
+			triangles.push_back({ p0, p3, p2 });
+		}
+	std::shuffle(triangles.begin(), triangles.end(), std::default_random_engine(11));
+	std::vector<idx_type> T;
+	for (const auto& t : triangles)
+		T.insert(T.end(), t.begin(), t.end());
+	return T;
+}
+
+/// return the sorted list of triangles in the index range [begin, end) with their vertex order kept
+static std::vector<std::vector<idx_type> > sorted_triangles(const std::vector<idx_type>& T, size_t begin, size_t end)
+{
+	std::vector<std::vector<idx_type> > triangles;
+	for (size_t i = begin; i < end; i += 3)
+		triangles.push_back({ T[i], T[i + 1], T[i + 2] });
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+bool test_vertex_cache_optimizer()
+{
+	std::vector<idx_type> T = construct_shuffled_grid(64);
+	double acmr_before = compute_acmr(T);
+
+	// optimizing the whole buffer reduces the cache miss ratio and only reorders the triangles
+	std::vector<idx_type> O = T;
+	optimize_vertex_cache(O);
+	double acmr_after = compute_acmr(O);
+	TEST_ASSERT(acmr_after <= acmr_before);
+	TEST_ASSERT(acmr_after < 1.0);
+	TEST_ASSERT(sorted_triangles(O, 0, O.size()) == sorted_triangles(T, 0, T.size()));
+
+	// optimizing again does not increase the cache miss ratio
+	std::vector<idx_type> O2 = O;
+	optimize_vertex_cache(O2);
+	TEST_ASSERT(compute_acmr(O2) <= acmr_after + 1e-9);
+
+	// triangles are not moved across range boundaries
+	size_t split = 3 * (T.size() / 9);
+	std::vector<idx_type> R = T;
+	optimize_vertex_cache(R, 0, split);
+	optimize_vertex_cache(R, split, R.size());
+	TEST_ASSERT(compute_acmr(R) <= acmr_before);
+	TEST_ASSERT(sorted_triangles(R, 0, split) == sorted_triangles(T, 0, split));
+	TEST_ASSERT(sorted_triangles(R, split, R.size()) == sorted_triangles(T, split, T.size()));
+
+	// the vertex fetch order is a permutation that numbers vertices by their first use
+	idx_type nr_vertices = 65 * 65 + 3;
+	std::vector<idx_type> old_to_new;
+	compute_vertex_fetch_order(O, nr_vertices, old_to_new);
+	TEST_ASSERT_EQ(old_to_new.size(), size_t(nr_vertices));
+	std::vector<idx_type> sorted = old_to_new;
+	std::sort(sorted.begin(), sorted.end());
+	for (idx_type vi = 0; vi < nr_vertices; ++vi)
+		TEST_ASSERT_EQ(sorted[vi], vi);
+	idx_type next = 0;
+	for (idx_type vi : O) {
+		TEST_ASSERT(old_to_new[vi] <= next);
+		if (old_to_new[vi] == next)
+			++next;
+	}
+	TEST_ASSERT_EQ(next, idx_type(65 * 65));
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_vertex_cache_optimizer_reg("cgv::media::mesh::vertex_cache_optimizer", test_vertex_cache_optimizer);
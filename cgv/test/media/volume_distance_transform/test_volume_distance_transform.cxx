@@ -0,0 +1,75 @@
+#include <cgv/base/register.h>
+#include <cgv/media/volume/volume_distance_transform.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::media::volume;
+
+/// brute force signed distance between voxel centers with the given spacing
+static float brute_force_distance(const std::vector<bool>& inside, const volume::dimension_type& dims, const volume::extent_type& spacing, size_t i, bool signed_distance)
+{
+	int w = dims(0), h = dims(1);
+	int x = int(i % w), y = int(i / w % h), z = int(i / (size_t(w) * h));
+	bool site_value = signed_distance && inside[i] ? false : true;
+	float best = std::numeric_limits<float>::infinity();
+	for (size_t j = 0; j < inside.size(); ++j) {
+		if (inside[j] != site_value)
+			continue;
+		float dx = spacing(0) * (int(j % w) - x), dy = spacing(1) * (int(j / w % h) - y), dz = spacing(2) * (int(j / (size_t(w) * h)) - z);
+		best = std::min(best, dx * dx + dy * dy + dz * dz);
+	}
+	best = std::sqrt(best);
+	return signed_distance && inside[i] ? -best : best;
+}
+
+bool test_volume_distance_transform()
+{
+	// two channel volume with an ellipsoid in the first channel and noise in the second one
+	volume V;
+	V.set_component_format("uint8[L,A]");
+	volume::dimension_type dims(19, 13, 11);
+	V.resize(dims);
+	V.ref_extent() = volume::extent_type(9.5f, 13.0f, 22.0f);
+	volume::extent_type spacing = V.get_spacing();
+	std::vector<bool> inside(V.get_nr_voxels());
+	cgv::type::uint8_type* data = V.get_data_ptr<cgv::type::uint8_type>();
+	for (size_t i = 0; i < inside.size(); ++i) {
+		float x = float(i % dims(0)) - 9, y = float(i / dims(0) % dims(1)) - 6, z = float(i / (dims(0) * dims(1))) - 5;
+		inside[i] = x * x / 36 + y * y / 16 + z * z / 9 < 1;
+		data[2 * i] = inside[i] ? 200 : 10;
+		data[2 * i + 1] = cgv::type::uint8_type(i * 37 % 251);
+	}
+	for (bool signed_distance : { false, true }) {
+		volume D;
+		TEST_ASSERT(compute_distance_field(V, D, signed_distance, 100));
+		TEST_ASSERT(D.get_dimensions() == dims);
+		TEST_ASSERT_EQ(D.get_component_type(), cgv::type::info::TI_FLT32);
+		TEST_ASSERT_EQ(D.get_nr_components(), 1u);
+		TEST_ASSERT(D.get_extent() == V.get_extent());
+		const float* d = D.get_data_ptr<cgv::type::flt32_type>();
+		float max_error = 0;
+		for (size_t i = 0; i < inside.size(); ++i)
+			max_error = std::max(max_error, std::abs(d[i] - brute_force_distance(inside, dims, spacing, i, signed_distance)));
+		TEST_ASSERT(max_error < 1e-4f);
+	}
+
+	// without inside voxels distances are infinite and empty volumes are rejected
+	{
+		volume W;
+		W.set_component_format("flt32[L]");
+		W.resize(volume::dimension_type(4, 4, 4));
+		std::fill(W.get_data_ptr<cgv::type::flt32_type>(), W.get_data_ptr<cgv::type::flt32_type>() + W.get_nr_voxels(), 0.0f);
+		volume D;
+		TEST_ASSERT(compute_distance_field(W, D, false));
+		TEST_ASSERT(D.get_data_ptr<cgv::type::flt32_type>()[5] == std::numeric_limits<float>::infinity());
+		volume E;
+		TEST_ASSERT(!compute_distance_field(volume(), E));
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_volume_distance_transform_reg("cgv::media::volume::compute_distance_field", test_volume_distance_transform);
@@ -0,0 +1,87 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/scan.h>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+bool test_scan_numbers()
+{
+	// numbers with exact fast path and library fallback convert identically to strtod
+	const char* numbers[] = {
+		"0", "-0", "1", "-17.25", "3.14159265358979", "1e22", "1e23", "2.2250738585072014e-308", "4.9e-324",
+		"123456789012345678901234567890", "0.1", "0.30000000000000004", "1.7976931348623157e308", "7e-10",
+		"9007199254740993", ".5", "5.", 0
+	};
+	for (const char** s = numbers; *s; ++s) {
+		double v = 0;
+		const char* end = *s + strlen(*s);
+		TEST_ASSERT(scan_double(*s, end, v) == end);
+		TEST_ASSERT_EQ(v, strtod(*s, 0));
+		// single precision only for numbers in the range of normalized floats
+		if (v != 0 && (std::abs(v) > 1e38 || std::abs(v) < 1e-37))
+			continue;
+		float f = 0;
+		TEST_ASSERT(scan_float(*s, end, f) == end);
+		TEST_ASSERT_EQ(f, strtof(*s, 0));
+	}
+	double v = 0;
+	const char inf[] = "-Infinity";
+	TEST_ASSERT(scan_double(inf, inf + 9, v) == inf + 9 && std::isinf(v) && v < 0);
+	const char nan[] = "nan(1)";
+	TEST_ASSERT(scan_double(nan, nan + 6, v) == nan + 6 && std::isnan(v));
+
+	// partial and invalid numbers
+	const char partial[] = "12.5e+x";
+	TEST_ASSERT(scan_double(partial, partial + 7, v) == partial + 4 && v == 12.5);
+	const char* invalid[] = { "", "-", ".", "+1", " 1", "e5", "1e400", 0 };
+	for (const char** s = invalid; *s; ++s)
+		TEST_ASSERT_EQ(is_double(std::string(*s), v), false);
+
+	// integers
+	int i = 0;
+	int64_t l = 0;
+	TEST_ASSERT(is_integer("-2147483648", i) && i == -2147483647 - 1);
+	TEST_ASSERT(!is_integer("2147483648", i));
+	TEST_ASSERT(!is_integer("+5", i) && !is_integer("0x10", i) && !is_integer("", i));
+	TEST_ASSERT(is_integer("42 tail", i) && i == 42);
+	const char big[] = "-9223372036854775808";
+	TEST_ASSERT(scan_integer(big, big + 20, l) == big + 20 && l == INT64_MIN);
+	TEST_ASSERT(is_double("7\n", v) && v == 7);
+
+	// column parsing with comments, plus signs, invalid and short lines
+	const char text[] = "# x y z\n1 2 3\n\n  4\t5.5 -6 7\r\n8 9\nfoo 1 2\n+1 2 3\n1e1 2e1 3e1";
+	std::vector<float> values;
+	size_t nr_invalid = 0;
+	TEST_ASSERT_EQ(parse_columns(text, text + strlen(text), 3, values, '#', &nr_invalid), size_t(3));
+	TEST_ASSERT_EQ(nr_invalid, size_t(3));
+	float expected[] = { 1, 2, 3, 4, 5.5f, -6, 10, 20, 30 };
+	TEST_ASSERT(values.size() == 9 && std::equal(values.begin(), values.end(), expected));
+	std::vector<int> ints;
+	const char int_text[] = "1 2\n3 4.5\n5 6\n";
+	TEST_ASSERT_EQ(parse_columns(int_text, int_text + strlen(int_text), 2, ints), size_t(2));
+	TEST_ASSERT(ints.size() == 4 && ints[2] == 5);
+
+	// batch parsing of a point cloud in comparison to stream extraction
+	std::ostringstream os;
+	os.precision(7);
+	size_t n = 200000;
+	for (size_t k = 0; k < n; ++k)
+		os << 0.001 * k << " " << -0.5 * k << " " << std::sqrt(double(k)) << " " << k % 256 << " " << (k * 7) % 256 << " " << (k * 13) % 256 << "\n";
+	std::string content = os.str();
+	std::vector<double> columns;
+	TEST_ASSERT_EQ(parse_columns(content.data(), content.data() + content.size(), 6, columns), n);
+	std::vector<double> reference;
+	std::istringstream is(content);
+	double r;
+	while (is >> r)
+		reference.push_back(r);
+	TEST_ASSERT(columns == reference);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration scan_numbers_test_registration("cgv::utils::scan_numbers", test_scan_numbers);